@@ -21,6 +21,7 @@
    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 
+   17-Oct-2026  agent   transpose_bits32()
    14-Feb-2012  JH      created
 */
 
@@ -354,3 +355,23 @@ int digitcount_from_bitlen(int radix, int bitlen)
 	return 0 ; // not reached, assert()
 }
 
+
+/*
+ * transpose a 32x32 bit matrix in place:
+ * bit j of a[i] is exchanged with bit i of a[j].
+ * Word parallel, 5 rounds of swapping ever smaller blocks.
+ * (H.S. Warren, "Hacker's Delight", 7-3)
+ */
+void transpose_bits32(uint32_t a[32])
+{
+	unsigned j, k;
+	uint32_t m, t;
+
+	m = 0x0000ffff;
+	for (j = 16; j != 0; j >>= 1, m ^= (m << j))
+		for (k = 0; k < 32; k = (k + j + 1) & ~j) {
+			t = ((a[k] >> j) ^ a[k + j]) & m;
+			a[k + j] ^= t;
+			a[k] ^= t << j;
+		}
+}
@@ -21,6 +21,7 @@
    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 
+   17-Oct-2026  agent   transpose_bits32()
    14-Feb-2012  JH      created
 */
 
@@ -53,5 +54,7 @@ uint64_t decode_uint64_from_bytes(unsigned char *buffer, unsigned bytecount);
 
 int digitcount_from_bitlen(int radix, int bitlen) ;
 
+void transpose_bits32(uint32_t a[32]) ;
+
 
 #endif /* BITCALC_H_ */
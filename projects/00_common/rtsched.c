@@ -0,0 +1,185 @@
+/* rtsched.c: absolute deadline scheduler for multiplexing threads
+
+   Copyright (c) 2026, agent
+   j_hoppe@t-online.de, www.retrocmp.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+   THE AUTHOR BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+   IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+   17-Oct-2026  agent   created
+
+
+   Multiplexing threads light a lamp row for a phase, then the next.
+   Brightness is the share of phases a lamp is lit, so all phases
+   must have exactly the same length.
+   A relative sleep after the work of a phase adds the variable work time
+   and the wake up latency to every phase, so phases drift and flicker.
+
+   Here phases start at absolute deadlines on CLOCK_MONOTONIC:
+   deadline(n+1) = deadline(n) + duration(n).
+   A late wake up shortens only the late phase, not all following ones.
+   The thread sleeps with clock_nanosleep(TIMER_ABSTIME) until shortly
+   before the deadline, then busy waits the rest ("spin"),
+   as kernel wake up latency is often larger than a short phase.
+
+   The lateness of every phase start is counted in a histogram.
+ */
+#ifndef WIN32
+
+#define _GNU_SOURCE // pthread_setaffinity_np()
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "rtsched.h"
+
+int rtsched_cpu = -1;
+unsigned rtsched_spin_ns = RTSCHED_DEFAULT_SPIN_NS;
+
+uint64_t rtsched_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/*
+ * bind the calling thread to a cpu.
+ * result: 0 = OK, else error code
+ */
+int rtsched_pin_cpu(int cpu)
+{
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+}
+
+/*
+ * to be called by the scheduled thread itself.
+ * First phase starts now.
+ */
+void rtsched_init(rtsched_t *_this, char *name)
+{
+    unsigned i;
+    int res;
+
+    _this->name = name;
+    _this->spin_ns = rtsched_spin_ns;
+    for (i = 0; i < RTSCHED_HISTOGRAM_BUCKETS; i++)
+        _this->histogram[i] = 0;
+    _this->phases = 0;
+    _this->overruns = 0;
+    _this->jitter_max_ns = 0;
+    if (rtsched_cpu >= 0) {
+        res = rtsched_pin_cpu(rtsched_cpu);
+        if (res)
+            fprintf(stderr, "Warning: %s thread not bound to CPU %d, error %d\n", name,
+                    rtsched_cpu, res);
+    }
+    _this->phase_start_ns = _this->next_deadline_ns = rtsched_now_ns();
+}
+
+/*
+ * wait until absolute time "deadline_ns": sleep, then spin.
+ */
+void rtsched_sleep_until(rtsched_t *_this, uint64_t deadline_ns)
+{
+    uint64_t now_ns = rtsched_now_ns();
+
+    if (deadline_ns > now_ns + _this->spin_ns) {
+        struct timespec ts;
+        uint64_t wakeup_ns = deadline_ns - _this->spin_ns;
+        ts.tv_sec = wakeup_ns / 1000000000;
+        ts.tv_nsec = wakeup_ns % 1000000000;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+            ;
+    }
+    while (rtsched_now_ns() < deadline_ns)
+        ;
+}
+
+// short wait inside a phase, does not touch the phase grid
+void rtsched_delay(rtsched_t *_this, unsigned ns)
+{
+    rtsched_sleep_until(_this, rtsched_now_ns() + ns);
+}
+
+/*
+ * wait for the start of the next phase, which then lasts "duration_ns".
+ * The lateness of the start is recorded.
+ * If a whole phase was missed, the grid restarts now instead of
+ * catching up with a burst of short phases.
+ */
+void rtsched_phase(rtsched_t *_this, unsigned duration_ns)
+{
+    uint64_t now_ns, late_ns, late_us;
+    unsigned bucket;
+
+    rtsched_sleep_until(_this, _this->next_deadline_ns);
+    now_ns = rtsched_now_ns();
+    late_ns = now_ns - _this->next_deadline_ns;
+
+    late_us = late_ns / 1000;
+    for (bucket = 0; late_us && bucket < RTSCHED_HISTOGRAM_BUCKETS - 1; bucket++)
+        late_us >>= 1;
+    _this->histogram[bucket]++;
+    if (late_ns > _this->jitter_max_ns)
+        _this->jitter_max_ns = late_ns > 0xffffffff ? 0xffffffff : (uint32_t) late_ns;
+    _this->phases++;
+
+    if (late_ns >= duration_ns) {
+        _this->overruns++;
+        _this->phase_start_ns = now_ns;
+    } else
+        _this->phase_start_ns = _this->next_deadline_ns;
+    _this->next_deadline_ns = _this->phase_start_ns + duration_ns;
+}
+
+/*
+ * print statistics of phase start jitter, for "get_info" display
+ */
+char *rtsched_histogram_text(rtsched_t *_this, char *buffer, unsigned buffer_size)
+{
+    unsigned bucket;
+    int n;
+    char *wp = buffer;
+
+    n = snprintf(wp, buffer_size, "%s: %u phases, %u overruns, max jitter %u us\n"
+            "               jitter histogram [us]:", _this->name ? _this->name : "-", _this->phases,
+            _this->overruns, _this->jitter_max_ns / 1000);
+    for (bucket = 0; bucket < RTSCHED_HISTOGRAM_BUCKETS && n >= 0 && (unsigned) n < buffer_size;
+            bucket++) {
+        uint32_t count = _this->histogram[bucket];
+        buffer_size -= n;
+        wp += n;
+        if (count == 0)
+            n = 0;
+        else if (bucket < RTSCHED_HISTOGRAM_BUCKETS - 1)
+            n = snprintf(wp, buffer_size, " <%u:%u", 1u << bucket, count);
+        else
+            n = snprintf(wp, buffer_size, " >=%u:%u", 1u << (bucket - 1), count);
+    }
+    return buffer;
+}
+
+#endif
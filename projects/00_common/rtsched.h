@@ -0,0 +1,66 @@
+/* rtsched.h: absolute deadline scheduler for multiplexing threads
+
+   Copyright (c) 2026, agent
+   j_hoppe@t-online.de, www.retrocmp.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+   THE AUTHOR BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+   IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+   17-Oct-2026  agent   created
+*/
+
+#ifndef RTSCHED_H_
+#define RTSCHED_H_
+
+#include <stdint.h>
+
+// jitter histogram: bucket i counts phase starts late by < 2^i us
+// last bucket: all later
+#define RTSCHED_HISTOGRAM_BUCKETS	16
+
+#define RTSCHED_DEFAULT_SPIN_NS	10000	// busy wait the last 10 us before a deadline
+
+typedef struct {
+    char *name; // for reports
+    unsigned spin_ns; // wake up this early, then busy wait to the deadline
+
+    uint64_t phase_start_ns; // deadline of current phase
+    uint64_t next_deadline_ns; // start of next phase
+
+    // statistics, written only by the scheduled thread.
+    // Readers see consistent single values without locks.
+    volatile uint32_t histogram[RTSCHED_HISTOGRAM_BUCKETS];
+    volatile uint32_t phases; // count of phases started
+    volatile uint32_t overruns; // phases started later than their complete duration
+    volatile uint32_t jitter_max_ns; // max lateness of a phase start
+} rtsched_t;
+
+// options for all multiplexing threads, set from the command line
+extern int rtsched_cpu; // pin to this CPU, -1 = no pinning
+extern unsigned rtsched_spin_ns;
+
+uint64_t rtsched_now_ns(void);
+
+void rtsched_init(rtsched_t *_this, char *name);
+int rtsched_pin_cpu(int cpu);
+void rtsched_sleep_until(rtsched_t *_this, uint64_t deadline_ns);
+void rtsched_delay(rtsched_t *_this, unsigned ns);
+void rtsched_phase(rtsched_t *_this, unsigned duration_ns);
+char *rtsched_histogram_text(rtsched_t *_this, char *buffer, unsigned buffer_size);
+
+#endif /* RTSCHED_H_ */
@@ -715,6 +715,9 @@ int		realcons_bus_ID_mode; // 1 = DATA space access, 0 = instruction space acces
 t_value realcons_DATAPATH_shifter;  // value of shifter in PDP-11 processor data paths
 t_value realcons_IR; // buffer for instruction register (opcode)
 t_value realcons_PSW; // buffer for program status word
+// per-bit ON counts of all bus cycles, enabled by panel logic (11/70)
+realcons_dutycycle_t realcons_memory_address_phys_dutycycle;
+realcons_dutycycle_t realcons_memory_data_dutycycle;
 
 								   // Pointers to event handlers
 								   // Events are called in SimH-code as pointers to functions in panel logic
@@ -747,6 +750,8 @@ console_controller_event_func_t	realcons_event_opcode_wait; // triggered after e
 				    realcons_memory_address_virt_register = (va) & 0xffff ; \
 				  realcons_memory_data_register = (data_expr) ; \
 				  realcons_memory_write_access = (write) ; \
+				  REALCONS_DUTYCYCLE_ADD(&realcons_memory_address_phys_dutycycle, (pa)) ; \
+				  REALCONS_DUTYCYCLE_ADD(&realcons_memory_data_dutycycle, realcons_memory_data_register) ; \
 /*printf("%s M[va=%o, pa=%o] = %o, line #%d\n", realcons_memory_write_access?"WRITE":"READ", realcons_memory_address_virt_register, realcons_memory_address_phys_register, realcons_memory_data_register, __LINE__) ;/**/ \
 			  } while(0)
 
@@ -758,6 +763,8 @@ console_controller_event_func_t	realcons_event_opcode_wait; // triggered after e
 				    realcons_memory_address_virt_register = (va) & 0xffff ; \
 				  realcons_memory_write_access = (write) ; \
 				  realcons_memory_data_register = (data_expr) ; \
+				  REALCONS_DUTYCYCLE_ADD(&realcons_memory_address_phys_dutycycle, (pa)) ; \
+				  REALCONS_DUTYCYCLE_ADD(&realcons_memory_data_dutycycle, realcons_memory_data_register) ; \
 /*printf("RETURN %s M[va=%o, pa=%o] = %o, line #%d\n", realcons_memory_write_access?"WRITE":"READ", realcons_memory_address_virt_register, realcons_memory_address_phys_register, realcons_memory_data_register, __LINE__) ;/**/ \
   				  return realcons_memory_data_register ; /* eval data_expr only once!!*/ \
 			  } while(0)
@@ -20,6 +20,12 @@
    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+   17-Oct-2026  agent   worker and subscriber set the error under rpc_mutex
+   17-Oct-2026  agent   control values optionally over shared memory
+   17-Oct-2026  agent   inputs pushed by server to a subscriber thread, if supported
+   17-Oct-2026  agent   worker: outputs and inputs in one EXCHANGE round trip
+   17-Oct-2026  agent   bit duty cycle accumulation for dimmed lamp rows
+   17-Oct-2026  agent   RPC traffic moved to separate worker thread
    24-Mar-2018  JH      scp.c: speed up readline_p() if realcons is disconnected
    18-Jun-2016  JH      added PDP-15, with param "bootimage" file path
    23-Apr-2016  JH      added PDP-11/20
@@ -40,6 +46,8 @@
    - Panel is provided with computing time: SimH calls realcons_service()
   	 in interactive input loop
   	 and instruction execution loop
+   - RPC traffic to the Blinkenlight API server is done by a worker thread,
+     see "RPC worker" below. No blocking network calls on the simulated CPU.
 
    Modularity:
    ===========
@@ -82,6 +90,7 @@
 
 #include <stdlib.h>
 #include <time.h>
+#include <pthread.h>
 
 #include "sim_defs.h"
 #include "realcons.h"
@@ -94,6 +103,264 @@
 // Later, every device unit may have its own ... may be ...
 realcons_t *cpu_realcons;
 
+/*
+ * RPC worker
+ * ==========
+ * Calls to the Blinkenlight API server are blocking UDP round trips.
+ * A slow or lost datagram must not stall the simulated CPU,
+ * so the periodic GET inputs / SET outputs is done by a worker thread.
+ * - The worker has a private copy of the console panel.
+ * - CPU thread and worker exchange only control values over two
+ *   "seqlock" protected snapshots: outputs (CPU -> worker)
+ *   and inputs (worker -> CPU).
+ *   The writer never waits. The reader discards a snapshot changed while
+ *   reading: the CPU thread tries again on next service, the worker on next cycle.
+ * - If the server supports input change subscription, a second thread
+ *   waits on its own connection for input changes pushed by the server.
+ *   Then the worker only transmits changed outputs, no steady state polling.
+ * - RPC errors are flagged to the CPU thread, which then disconnects.
+ * - Other API calls (params, server info) from the SimH thread must be
+ *   enclosed in realcons_rpc_lock()/unlock().
+ */
+
+// orders data access against the sequence counter of a snapshot
+#ifdef _WIN32
+#define REALCONS_MEMORY_BARRIER()	MemoryBarrier()
+#else
+#define REALCONS_MEMORY_BARRIER()	__sync_synchronize()
+#endif
+
+// values of all controls of a panel, indexed like panel->controls[]
+typedef struct
+{
+	volatile unsigned sequence; // odd while writer updates values[]
+	uint64_t values[MAX_BLINKENLIGHT_PANEL_CONTROLS];
+} realcons_value_snapshot_t;
+
+typedef struct realcons_rpc_worker_struct
+{
+	pthread_t thread;
+	pthread_mutex_t rpc_mutex; // serializes use of blinkenlight_api_client, and setting "error"
+	volatile int stop; // set by CPU thread: worker shall terminate
+	volatile int error; // set by worker or subscriber: RPC failed, thread terminated
+	char error_text[2048];
+
+	blinkenlight_api_client_t *blinkenlight_api_client;
+	blinkenlight_panel_t panel; // private copy of console_model
+	volatile unsigned interval_msec;
+
+	realcons_value_snapshot_t outputs; // written by CPU, read by worker
+	realcons_value_snapshot_t inputs; // written by worker, read by CPU
+	volatile int force_output_update; // set by CPU thread, cleared by worker
+
+	// input change subscription. 0: worker polls inputs
+	int subscribed;
+	pthread_t subscriber_thread;
+	blinkenlight_api_client_t *subscriber_client; // own connection
+	blinkenlight_panel_t subscriber_panel; // private copy of console_model
+
+	// thread local
+	unsigned outputs_sequence_sent; // worker: last transmitted output snapshot
+	uint64_t output_values[MAX_BLINKENLIGHT_PANEL_CONTROLS]; // worker: read buffer
+	unsigned inputs_sequence_seen; // CPU: last applied input snapshot
+	uint64_t input_values[MAX_BLINKENLIGHT_PANEL_CONTROLS]; // CPU: read buffer
+} realcons_rpc_worker_t;
+
+// publish the values of all input or all output controls of p
+static void realcons_snapshot_write(realcons_value_snapshot_t *s, blinkenlight_panel_t *p,
+	int is_input)
+{
+	unsigned i;
+	s->sequence++; // odd: update in progress
+	REALCONS_MEMORY_BARRIER();
+	for (i = 0; i < p->controls_count; i++)
+		if (p->controls[i].is_input == is_input)
+			s->values[i] = p->controls[i].value;
+	REALCONS_MEMORY_BARRIER();
+	s->sequence++; // even: consistent again
+}
+
+// copy a snapshot into "values", if it was changed since "*sequence".
+// result: 1 = new consistent values read, *sequence updated
+//  0 = no news, or writer was active
+static int realcons_snapshot_read(realcons_value_snapshot_t *s, uint64_t *values,
+	unsigned count, unsigned *sequence)
+{
+	unsigned seq_start = s->sequence;
+	REALCONS_MEMORY_BARRIER();
+	if ((seq_start & 1) || seq_start == *sequence)
+		return 0;
+	memcpy(values, s->values, count * sizeof(uint64_t));
+	REALCONS_MEMORY_BARRIER();
+	if (s->sequence != seq_start)
+		return 0; // torn by writer
+	*sequence = seq_start;
+	return 1;
+}
+
+// max wait for an input change, until the subscriber checks "stop"
+#define REALCONS_SUBSCRIBER_WAIT_MSEC	200
+
+// worker and subscriber may fail at the same time: caller holds w->rpc_mutex
+static void realcons_rpc_worker_set_error(realcons_rpc_worker_t *w,
+	blinkenlight_api_client_t *blinkenlight_api_client)
+{
+	if (w->error)
+		return; // keep first error
+	strncpy(w->error_text, blinkenlight_api_client_get_error_text(blinkenlight_api_client),
+		sizeof(w->error_text) - 1);
+	REALCONS_MEMORY_BARRIER();
+	w->error = 1;
+}
+
+static void *realcons_rpc_worker_thread(void *arg)
+{
+	realcons_rpc_worker_t *w = (realcons_rpc_worker_t *)arg;
+	blinkenlight_panel_t *p = &w->panel;
+	int set_outputs;
+	unsigned i;
+
+	while (!w->stop) {
+		// 1) take output control values, if CPU thread published new ones
+		set_outputs = 0;
+		if (realcons_snapshot_read(&w->outputs, w->output_values, p->controls_count,
+			&w->outputs_sequence_sent) || w->force_output_update) {
+			w->force_output_update = 0;
+			for (i = 0; i < p->controls_count; i++)
+				if (!p->controls[i].is_input)
+					p->controls[i].value = w->output_values[i];
+			set_outputs = 1;
+		}
+		// 2) transmit outputs and query new input values in one round trip.
+		// if inputs are pushed to the subscriber, only changed outputs are sent.
+		if (set_outputs || !w->subscribed) {
+			pthread_mutex_lock(&w->rpc_mutex);
+			if (blinkenlight_api_client_exchange_controls_values(w->blinkenlight_api_client, &p,
+				&set_outputs, 1) != 0) {
+				realcons_rpc_worker_set_error(w, w->blinkenlight_api_client);
+				pthread_mutex_unlock(&w->rpc_mutex);
+				break;
+			}
+			pthread_mutex_unlock(&w->rpc_mutex);
+			// 3) publish inputs to CPU thread
+			if (!w->subscribed)
+				realcons_snapshot_write(&w->inputs, p, /*is_input*/1);
+		}
+		sim_os_ms_sleep(w->interval_msec);
+	}
+	return NULL;
+}
+
+// waits for input changes pushed by the server, publishes them to CPU thread
+static void *realcons_rpc_subscriber_thread(void *arg)
+{
+	realcons_rpc_worker_t *w = (realcons_rpc_worker_t *)arg;
+	blinkenlight_panel_t *p = &w->subscriber_panel;
+	int changed;
+
+	while (!w->stop) {
+		if (blinkenlight_api_client_wait_inputcontrols_values(w->subscriber_client, p,
+			REALCONS_SUBSCRIBER_WAIT_MSEC, &changed) != 0) {
+			pthread_mutex_lock(&w->rpc_mutex);
+			realcons_rpc_worker_set_error(w, w->subscriber_client);
+			pthread_mutex_unlock(&w->rpc_mutex);
+			break;
+		}
+		if (changed)
+			realcons_snapshot_write(&w->inputs, p, /*is_input*/1);
+	}
+	return NULL;
+}
+
+// try to subscribe to input changes. Not supported by older servers
+// and the Java panelsim: then the worker keeps on polling.
+static void realcons_rpc_subscriber_start(realcons_t *_this, realcons_rpc_worker_t *w)
+{
+	blinkenlight_api_client_t *c;
+	int changed;
+
+	c = blinkenlight_api_client_constructor();
+	if (blinkenlight_api_client_connect(c, _this->application_server_hostname) != 0) {
+		blinkenlight_api_client_destructor(c);
+		return;
+	}
+	w->subscriber_panel = *(_this->console_model);
+	w->subscriber_panel.inputs_sequence = 0;
+	// probe: without known sequence, the server answers at once with all inputs
+	if (blinkenlight_api_client_wait_inputcontrols_values(c, &w->subscriber_panel, 0,
+		&changed) != 0) {
+		if (!c->wait_unavailable)
+			realcons_printf(_this, stdout, "Input change subscription failed, polling inputs: %s\n",
+				blinkenlight_api_client_get_error_text(c));
+		blinkenlight_api_client_destructor(c);
+		return;
+	}
+	if (changed)
+		realcons_snapshot_write(&w->inputs, &w->subscriber_panel, /*is_input*/1);
+	w->subscriber_client = c;
+	if (pthread_create(&w->subscriber_thread, NULL, realcons_rpc_subscriber_thread, w) != 0) {
+		blinkenlight_api_client_destructor(c);
+		w->subscriber_client = NULL;
+		return;
+	}
+	w->subscribed = 1;
+}
+
+// start worker after the console_model was loaded and initialized
+static realcons_rpc_worker_t *realcons_rpc_worker_start(realcons_t *_this)
+{
+	realcons_rpc_worker_t *w;
+	w = (realcons_rpc_worker_t *)calloc(1, sizeof(realcons_rpc_worker_t));
+	pthread_mutex_init(&w->rpc_mutex, NULL);
+	w->blinkenlight_api_client = _this->blinkenlight_api_client;
+	w->panel = *(_this->console_model);
+	w->interval_msec = _this->service_interval_msec;
+	// both sides start with the same values
+	realcons_snapshot_write(&w->outputs, _this->console_model, /*is_input*/0);
+	realcons_snapshot_write(&w->inputs, _this->console_model, /*is_input*/1);
+	w->outputs_sequence_sent = w->outputs.sequence;
+	w->inputs_sequence_seen = w->inputs.sequence;
+	// decide on polling before the worker runs.
+	// Over shared memory polling is cheap, no subscription needed.
+	if (!w->blinkenlight_api_client->shm)
+		realcons_rpc_subscriber_start(_this, w);
+	if (pthread_create(&w->thread, NULL, realcons_rpc_worker_thread, w) != 0) {
+		w->stop = 1;
+		if (w->subscribed) {
+			pthread_join(w->subscriber_thread, NULL);
+			blinkenlight_api_client_destructor(w->subscriber_client);
+		}
+		pthread_mutex_destroy(&w->rpc_mutex);
+		free(w);
+		return NULL;
+	}
+	return w;
+}
+
+static void realcons_rpc_worker_stop(realcons_rpc_worker_t *w)
+{
+	w->stop = 1;
+	pthread_join(w->thread, NULL);
+	if (w->subscribed) {
+		pthread_join(w->subscriber_thread, NULL);
+		blinkenlight_api_client_destructor(w->subscriber_client);
+	}
+	pthread_mutex_destroy(&w->rpc_mutex);
+	free(w);
+}
+
+void realcons_rpc_lock(realcons_t *_this)
+{
+	if (_this->rpc_worker)
+		pthread_mutex_lock(&_this->rpc_worker->rpc_mutex);
+}
+
+void realcons_rpc_unlock(realcons_t *_this)
+{
+	if (_this->rpc_worker)
+		pthread_mutex_unlock(&_this->rpc_worker->rpc_mutex);
+}
+
 /*
  *	constructor/destructor
  */
@@ -145,6 +412,7 @@ void realcons_init(realcons_t *_this)
     _this->boot_image_filepath[0] = '\0';
 	_this->blinkenlight_api_client = NULL; /// created in connect()
 	_this->connected = 0;
+	_this->transport = REALCONS_TRANSPORT_RPC;
 
 	_this->service_interval_msec = REALCONS_DEFAULT_SERVICE_INTERVAL_MSEC;
 	_this->service_highspeed_prescaler = 0;
@@ -382,6 +650,23 @@ t_stat realcons_connect(realcons_t *_this, char *consolelogic_name, char *server
 	blinkenlight_api_client_set_outputcontrols_values(_this->blinkenlight_api_client,
 		_this->console_model);
 
+	// values over shared memory: server must run on this host
+	if (_this->transport == REALCONS_TRANSPORT_SHM
+		&& blinkenlight_api_client_shm_attach(_this->blinkenlight_api_client) != 0) {
+		realcons_printf(_this, stdout, "Shared memory transport to host %s failed: %s\n",
+			server_hostname, blinkenlight_api_client_get_error_text(_this->blinkenlight_api_client));
+		realcons_disconnect(_this);
+		return SCPE_OPENERR;
+	}
+
+	// from now on RPC traffic runs in the worker thread
+	_this->rpc_worker = realcons_rpc_worker_start(_this);
+	if (_this->rpc_worker == NULL) {
+		realcons_printf(_this, stdout, "Can not start RPC worker thread.\n");
+		realcons_disconnect(_this);
+		return SCPE_OPENERR;
+	}
+
 	return SCPE_OK;
 }
 
@@ -391,11 +676,18 @@ t_stat realcons_disconnect(realcons_t *_this)
 	if (!_this->connected)
 		return SCPE_OK; // not attached, error tolerant
 
+	// RPC calls are done by this thread again
+	if (_this->rpc_worker) {
+		realcons_rpc_worker_stop(_this->rpc_worker);
+		_this->rpc_worker = NULL;
+	}
+
 	// notify panel on disconnect
 	if (_this->console_controller_interface.event_disconnect)
 		_this->console_controller_interface.event_disconnect(_this->console_controller);
 
 	// update outputs immediately
+	blinkenlight_api_client_shm_detach(_this->blinkenlight_api_client);
 	blinkenlight_api_client_set_outputcontrols_values(_this->blinkenlight_api_client,
 		_this->console_model);
 
@@ -430,8 +722,8 @@ t_stat realcons_disconnect(realcons_t *_this)
 void realcons_service(realcons_t *_this, int highspeed)
 {
 	int i;
-    if (!_this->connected)
-        return;
+    if (!_this->connected || !_this->rpc_worker)
+        return; // also while connect() is in progress
 
 	// if called by high speed loop: check only
 	if (highspeed && _this->service_highspeed_prescaler > 0) {
@@ -456,14 +748,28 @@ void realcons_service(realcons_t *_this, int highspeed)
 		_this->service_cycle_count++;
 	//// do your jobs only if not disconnected
 	if (_this->connected) {
-		// 1) query new input values from console
-		if (blinkenlight_api_client_get_inputcontrols_values(_this->blinkenlight_api_client,
-			_this->console_model) != 0) {
+		realcons_rpc_worker_t *w = _this->rpc_worker;
+		blinkenlight_panel_t *p = _this->console_model;
+		// 0) RPC failed in worker thread?
+		if (w->error) {
 			// error in service: disconnect
-			realcons_printf(_this, stderr,
-				blinkenlight_api_client_get_error_text(_this->blinkenlight_api_client));
+			REALCONS_MEMORY_BARRIER();
+			realcons_printf(_this, stderr, "%s", w->error_text);
 			realcons_disconnect(_this);
 		}
+		else {
+			// 1) take latest input values received by the worker. No news: values unchanged
+			int news = realcons_snapshot_read(&w->inputs, w->input_values, p->controls_count,
+				&w->inputs_sequence_seen);
+			for (i = 0; i < (int)p->controls_count; i++) {
+				blinkenlight_control_t *c = &(p->controls[i]);
+				if (c->is_input) {
+					c->value_previous = c->value;
+					if (news)
+						c->value = w->input_values[i];
+				}
+			}
+		}
 	}
 
 	if (_this->connected) {
@@ -475,20 +781,23 @@ void realcons_service(realcons_t *_this, int highspeed)
 		unsigned n = blinkenlight_panels_get_control_value_changes(
 			_this->blinkenlight_api_client->panel_list, _this->console_model, /*output*/0);
 		if (n > 0 || _this->force_output_update) {
+			blinkenlight_panel_t *p = _this->console_model;
 			if (_this->debug)
 				printf("realcons_server(): outputcontrols\n");
-			// 3) transmit output control values to panel
+			// 3) publish output control values, worker transmits them to panel.
 			// Transmit not if nothing changed.
 			//always: server panel simulation may relay on display clock!
+			if (_this->force_output_update)
+				_this->rpc_worker->force_output_update = 1;
 			_this->force_output_update = 0; // done
-			if (blinkenlight_api_client_set_outputcontrols_values(_this->blinkenlight_api_client,
-				_this->console_model) != 0) {
-				// error in service: disconnect
-				realcons_printf(_this, stderr,
-					blinkenlight_api_client_get_error_text(_this->blinkenlight_api_client));
-				realcons_disconnect(_this);
-			}
+			realcons_snapshot_write(&_this->rpc_worker->outputs, p, /*is_input*/0);
+			// mark as "sent" for change detection
+			for (i = 0; i < (int)p->controls_count; i++)
+				if (!p->controls[i].is_input)
+					p->controls[i].value_previous = p->controls[i].value;
 		}
+		_this->rpc_worker->interval_msec = _this->debug ?
+			REALCONS_SERVICE_INTERVAL_DEBUG_MSEC : _this->service_interval_msec;
 	}
 
 	// 2 options
@@ -523,6 +832,62 @@ void realcons_ms_sleep(realcons_t *_this, int ms)
 	}
 }
 
+/*
+ * Duty cycle accumulation, see REALCONS_DUTYCYCLE_ADD()
+ */
+void realcons_dutycycle_clear(realcons_dutycycle_t *dc)
+{
+	int enabled = dc->enabled;
+	memset(dc, 0, sizeof(*dc));
+	dc->enabled = enabled;
+}
+
+// add bit-sliced block counters to the per-bit sums
+void realcons_dutycycle_flush(realcons_dutycycle_t *dc)
+{
+	unsigned k, b;
+	for (k = 0; k < REALCONS_DUTYCYCLE_PLANES; k++) {
+		uint32 bits = dc->plane[k];
+		for (b = 0; bits; b++, bits >>= 1)
+			if (bits & 1)
+				dc->sum[b] += 1 << k;
+		dc->plane[k] = 0;
+	}
+	dc->samples += dc->block_samples;
+	dc->block_samples = 0;
+}
+
+/*
+ * Get lamp value for the interval since last call, and start a new interval.
+ * The server transmits only bit values, not brightness. The ON ratio of each
+ * bit is converted into a bit sequence over successive calls ("sigma-delta"),
+ * the low pass in the Blinkenlight API server then reproduces the brightness.
+ * If no samples where taken (cpu halted), "sampled_value" is returned.
+ */
+uint32 realcons_dutycycle_get_value(realcons_dutycycle_t *dc, unsigned bitlen,
+	uint32 sampled_value)
+{
+	uint32 result = 0;
+	unsigned b;
+
+	realcons_dutycycle_flush(dc);
+	if (dc->samples == 0)
+		return sampled_value;
+	if (bitlen > REALCONS_DUTYCYCLE_BITS)
+		bitlen = REALCONS_DUTYCYCLE_BITS;
+	for (b = 0; b < bitlen; b++) {
+		// brightness 0..255
+		dc->dither[b] += (unsigned)(((t_uint64)dc->sum[b] * 255) / dc->samples);
+		if (dc->dither[b] >= 255) {
+			result |= (uint32)1 << b;
+			dc->dither[b] -= 255;
+		}
+	}
+	memset(dc->sum, 0, sizeof(dc->sum));
+	dc->samples = 0;
+	return result;
+}
+
 /*
  * get a control over name
  */
@@ -680,9 +1045,11 @@ void realcons_lamp_test(realcons_t *_this, int testmode)
 		_this->lamp_test = 0;
 		_this->console_model->mode = 0; // back to normal
 	}
+	realcons_rpc_lock(_this);
 	blinkenlight_api_client_set_object_param(_this->blinkenlight_api_client,
 		RPC_PARAM_CLASS_PANEL, _this->console_model->index, RPC_PARAM_HANDLE_PANEL_MODE,
 		_this->console_model->mode);
+	realcons_rpc_unlock(_this);
 }
 
 
@@ -692,9 +1059,11 @@ void realcons_power_mode(realcons_t *_this, int power_on) {
 	  _this->console_model->mode = RPC_PARAM_VALUE_PANEL_MODE_NORMAL;
 	else
 	_this->console_model->mode = RPC_PARAM_VALUE_PANEL_MODE_POWERLESS;
+realcons_rpc_lock(_this);
 blinkenlight_api_client_set_object_param(_this->blinkenlight_api_client,
 	RPC_PARAM_CLASS_PANEL, _this->console_model->index, RPC_PARAM_HANDLE_PANEL_MODE,
 	_this->console_model->mode);
+realcons_rpc_unlock(_this);
 }
 
 
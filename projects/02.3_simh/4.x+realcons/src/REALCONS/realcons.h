@@ -20,6 +20,9 @@
    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+   17-Oct-2026  agent   transport selection RPC or shared memory
+   17-Oct-2026  agent   bit duty cycle accumulation for dimmed lamp rows
+   17-Oct-2026  agent   RPC traffic moved to separate worker thread
    18-Jun-2016  JH      added PDP-15, with param "bootimage" file path
    23-Apr-2016  JH      added PDP-11/20
    20-Feb-2016  JH      added PANEL_MODE_POWERLESS
@@ -96,6 +99,46 @@ typedef int(*console_controller_test_func_t)(void *console_controller, int arg);
 
 
 
+/*
+ * Duty cycle of the bits of a fast changing cpu signal (memory address, data)
+ * A panel samples signals only on service(). To show the dimmed lamp rows of
+ * a running machine, every bus cycle is added to per-bit ON counters.
+ * Counting is bit-sliced: plane[k] holds bit k of the counters of all 32 signal
+ * bits, so one sample costs some word operations, not a loop over bits.
+ * After 255 samples the planes are flushed into sum[].
+ */
+#define REALCONS_DUTYCYCLE_PLANES	8	// counters 0..255
+#define REALCONS_DUTYCYCLE_BITS	32
+typedef struct realcons_dutycycle_struct
+{
+	int enabled; // 0: REALCONS_DUTYCYCLE_ADD() is a no-op
+	uint32 plane[REALCONS_DUTYCYCLE_PLANES]; // bit-sliced counters of current block
+	unsigned block_samples; // samples in plane[]
+	uint32 sum[REALCONS_DUTYCYCLE_BITS]; // ON count per bit since last get_value()
+	uint32 samples; // samples in sum[]
+	unsigned dither[REALCONS_DUTYCYCLE_BITS]; // brightness error, carried to next service
+} realcons_dutycycle_t;
+
+// add one sample to the counters. Called in every simulated bus cycle!
+#define REALCONS_DUTYCYCLE_ADD(dc,val) do {	\
+		if ((dc)->enabled) {	\
+			uint32 _x = (uint32)(val), _carry ;	\
+			int _k ;	\
+			for (_k = 0; _x && _k < REALCONS_DUTYCYCLE_PLANES; _k++) {	\
+				_carry = (dc)->plane[_k] & _x ;	\
+				(dc)->plane[_k] ^= _x ;	\
+				_x = _carry ;	\
+			}	\
+			if (++(dc)->block_samples == 255)	\
+				realcons_dutycycle_flush(dc) ;	\
+		}	\
+	} while(0)
+
+void realcons_dutycycle_clear(realcons_dutycycle_t *dc);
+void realcons_dutycycle_flush(realcons_dutycycle_t *dc);
+uint32 realcons_dutycycle_get_value(realcons_dutycycle_t *dc, unsigned bitlen, uint32 sampled_value);
+
+
 // call event callback with console_controller as argument
 // no call, if console is disconnect. so invalid event pointer are no problem
 // events are called in SimH-code as pointers to functions  in panel logic
@@ -137,6 +180,11 @@ typedef struct realcons_console_controller_interface_struct
 #include "realcons_console_pdp15.h"
 #endif
 
+// how control values are exchanged with the Blinkenlight API server.
+// Shared memory needs the server on the same host, panel definitions still come over RPC.
+#define REALCONS_TRANSPORT_RPC	0
+#define REALCONS_TRANSPORT_SHM	1
+
 // global data
 typedef struct realcons_struct
 {
@@ -150,7 +198,11 @@ typedef struct realcons_struct
 
 
 	blinkenlight_api_client_t * blinkenlight_api_client;
+	// Thread which owns the RPC traffic to the Blinkenlight API server.
+	// Simulated CPU and worker exchange only value snapshots, see realcons.c
+	struct realcons_rpc_worker_struct *rpc_worker;
 	int connected; // 1: Connected to Blinkenlight_API and logic
+	int transport; // REALCONS_TRANSPORT_*, for control values after connect
 	int debug; // 1: debug mode
 
 	// cmd for Simh, to be queried by realcons_simh_get_cmd()
@@ -236,6 +288,10 @@ void realcons_service(realcons_t *_this, int highspeed);
 
 void realcons_ms_sleep(realcons_t *_this, int ms);
 
+// serialize direct Blinkenlight API calls against the RPC worker thread
+void realcons_rpc_lock(realcons_t *_this);
+void realcons_rpc_unlock(realcons_t *_this);
+
 void realcons_printf(realcons_t *_this, FILE *stream, const char *fmt, ...);
 
 t_stat realcons_connect(realcons_t *_this, char *console_controllername, char *server_hostname,
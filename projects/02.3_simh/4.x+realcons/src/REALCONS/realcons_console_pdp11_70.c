@@ -289,6 +289,11 @@ void realcons_console_pdp11_70_event_connect(realcons_console_logic_pdp11_70_t *
     // set panel mode to "powerless". all lights go off,
     // On Java panels the power switch should flip to the ON position
     realcons_power_mode(_this->realcons, 1);
+    // count bus cycles for dimmed ADDRESS and DATA lamps
+    realcons_dutycycle_clear(_this->cpusignal_memory_address_phys_dutycycle);
+    realcons_dutycycle_clear(_this->cpusignal_memory_data_dutycycle);
+    _this->cpusignal_memory_address_phys_dutycycle->enabled = 1;
+    _this->cpusignal_memory_data_dutycycle->enabled = 1;
 }
 
 void realcons_console_pdp11_70_event_disconnect(realcons_console_logic_pdp11_70_t *_this)
@@ -296,6 +301,8 @@ void realcons_console_pdp11_70_event_disconnect(realcons_console_logic_pdp11_70_
     // set panel mode to "powerless". all lights go off,
     // On Java panels the power switch should flip to the OFF position
     realcons_power_mode(_this->realcons, 0);
+    _this->cpusignal_memory_address_phys_dutycycle->enabled = 0;
+    _this->cpusignal_memory_data_dutycycle->enabled = 0;
 }
 
 void realcons_console_pdp11_70__event_opcode_any(realcons_console_logic_pdp11_70_t *_this)
@@ -533,6 +540,8 @@ void realcons_console_pdp11_70_interface_connect(realcons_console_logic_pdp11_70
         extern t_value realcons_DATAPATH_shifter; // output of ALU
         extern t_value realcons_IR; // buffer for instruction register (opcode)
         extern t_value realcons_PSW; // buffer for program status word
+        extern realcons_dutycycle_t realcons_memory_address_phys_dutycycle;
+        extern realcons_dutycycle_t realcons_memory_data_dutycycle;
 
         realcons_console_halt = 0;
 
@@ -541,6 +550,8 @@ void realcons_console_pdp11_70_interface_connect(realcons_console_logic_pdp11_70
         _this->cpusignal_memory_address_virt_register = &realcons_memory_address_virt_register;
         _this->cpusignal_register_name = &realcons_register_name; // pseudo: name of last accessed register
         _this->cpusignal_memory_data_register = &realcons_memory_data_register;
+        _this->cpusignal_memory_address_phys_dutycycle = &realcons_memory_address_phys_dutycycle;
+        _this->cpusignal_memory_data_dutycycle = &realcons_memory_data_dutycycle;
 		_this->cpusignal_memory_write_access = &realcons_memory_write_access ;
         _this->cpusignal_memory_status = &realcons_memory_status;
         _this->cpusignal_console_halt = &realcons_console_halt;
@@ -763,6 +774,13 @@ t_stat realcons_console_pdp11_70_service(realcons_console_logic_pdp11_70_t *_thi
 
     blinkenlight_control_t *action_switch; // current action switch
 
+    // evaluate bus cycles since last service, also if lamps are not updated
+    _this->dimmed_memory_address_phys = realcons_dutycycle_get_value(
+            _this->cpusignal_memory_address_phys_dutycycle, 22,
+            SIGNAL_GET(cpusignal_memory_address_phys_register));
+    _this->dimmed_memory_data = realcons_dutycycle_get_value(
+            _this->cpusignal_memory_data_dutycycle, 16, SIGNAL_GET(cpusignal_memory_data_register));
+
     if (_this->keyswitch_power->value == 0) {
         SIGNAL_SET(cpusignal_console_halt, 1); // stop execution
         if (_this->keyswitch_power->value_previous == 1) {
@@ -1033,8 +1051,11 @@ t_stat realcons_console_pdp11_70_service(realcons_console_logic_pdp11_70_t *_thi
             }
             break;
         case ADDR_SELECT_VALUE_PROG_PHY:
-            // show last physical UNIBUS address
-            _this->leds_ADDRESS->value = SIGNAL_GET(cpusignal_memory_address_phys_register);
+            // show physical UNIBUS addresses, dimmed if running
+            if (console_mode)
+                _this->leds_ADDRESS->value = SIGNAL_GET(cpusignal_memory_address_phys_register);
+            else
+                _this->leds_ADDRESS->value = _this->dimmed_memory_address_phys;
             break;
         default: // One of the VIRTUAL positions:
                  // interpret console address as 16 bit virtual and display
@@ -1076,7 +1097,7 @@ t_stat realcons_console_pdp11_70_service(realcons_console_logic_pdp11_70_t *_thi
             // when halted, BUS_REG shows switches
             _this->leds_DATA->value = _this->switch_SR->value;
         else
-            _this->leds_DATA->value = SIGNAL_GET(cpusignal_memory_data_register);
+            _this->leds_DATA->value = _this->dimmed_memory_data;
         break;
     }
 
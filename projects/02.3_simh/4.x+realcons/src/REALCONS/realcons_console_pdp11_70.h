@@ -70,6 +70,8 @@ typedef struct
         t_addr *cpusignal_memory_address_virt_register; // virtual address of last bus cycle (EXAM/DEPOSIT)
         char **cpusignal_register_name; // name of last accessed exam/deposit register
 		t_value *cpusignal_memory_data_register; // data of last bus cycle
+		realcons_dutycycle_t *cpusignal_memory_address_phys_dutycycle; // all bus cycles since last service
+		realcons_dutycycle_t *cpusignal_memory_data_dutycycle;
 		int		*cpusignal_memory_write_access ; // is last memory accessa WRITE?
         t_stat *cpusignal_memory_status; // last memory access status
 		int *cpusignal_console_halt; // 1, if a real console halts program execution
@@ -122,6 +124,10 @@ typedef struct
 	// NULL = no autoinc
 
     t_stat last_memory_status; // recognize changes in cpusignal_memory_status
+
+    // ADDRESS and DATA of all bus cycles since last service, as dimmed lamp values
+    t_value dimmed_memory_address_phys;
+    t_value dimmed_memory_data;
 } realcons_console_logic_pdp11_70_t;
 
 realcons_console_logic_pdp11_70_t *realcons_console_pdp11_70_constructor(
@@ -20,6 +20,7 @@
    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+   17-Oct-2026  agent   "set realcons connected=shm|rpc" selects transport
    18-Jun-2016  JH      added param "bootimage" (for PDP-15)
    25-Feb-2016  JH      disconnect on host or panel change
    25-Mar-2012  JH      created
@@ -63,7 +64,8 @@ static SHTAB show_realcons_tab[] =
 /*
  * set realcons host=<hostname>
  * set realcons panel=<panelname>
- * set realcons enabled
+ * set realcons connected[=rpc|shm]
+ * set realcons disconnected
  * set realcons disabled
  * set realcons bootimage=<filename>
  * set realcons debug
@@ -148,10 +150,20 @@ t_stat realcons_simh_set_service_interval(int32 flg, CONST char *cptr)
 
 /*
  * set realcons connected / disconnected
+ * "connected=shm": control values over shared memory, server on same host.
+ * "connected=rpc" or no value: all over RPC.
  */
 t_stat realcons_simh_set_connect(int32 flg, CONST char *cptr)
 {
 	t_stat reason;
+	if (flg && cptr && *cptr) {
+		if (!strcasecmp(cptr, "SHM"))
+			cpu_realcons->transport = REALCONS_TRANSPORT_SHM;
+		else if (!strcasecmp(cptr, "RPC"))
+			cpu_realcons->transport = REALCONS_TRANSPORT_RPC;
+		else
+			return SCPE_ARG;
+	}
 	if (flg) // connect to host
 		reason = realcons_connect(cpu_realcons, cpu_realcons->console_logic_name,
 				cpu_realcons->application_server_hostname,
@@ -257,6 +269,7 @@ t_stat realcons_simh_show_server(FILE *st, DEVICE *dunused, UNIT *uunused, int32
 		if (strlen(cpu_realcons->console_model->info))
 			fprintf(st, "panel info=\n\"%s\",\n", cpu_realcons->console_model->info);
 
+		realcons_rpc_lock(cpu_realcons);
 		if (blinkenlight_api_client_get_object_param(cpu_realcons->blinkenlight_api_client,
 				&blinkenboards_state, RPC_PARAM_CLASS_PANEL, cpu_realcons->console_model->index,
 				RPC_PARAM_HANDLE_PANEL_BLINKENBOARDS_STATE) != RPC_ERR_OK)
@@ -270,6 +283,7 @@ t_stat realcons_simh_show_server(FILE *st, DEVICE *dunused, UNIT *uunused, int32
 									"TRISTATE" : "OFF"));
 		blinkenlight_api_client_get_serverinfo(cpu_realcons->blinkenlight_api_client, buffer,
 				sizeof(buffer));
+		realcons_rpc_unlock(cpu_realcons);
 		fprintf(st, "\nserver info=\n%s", buffer);
 	} else
 		fprintf(st, "no server");
@@ -282,7 +296,8 @@ t_stat realcons_simh_show_connected(FILE *st, DEVICE *dunused, UNIT *uunused, in
 	if (cptr && (*cptr != 0))
 		return SCPE_2MARG;
 	if (cpu_realcons->connected)
-		fprintf(st, "connected");
+		fprintf(st, "connected, %s", cpu_realcons->transport == REALCONS_TRANSPORT_SHM ?
+				"shared memory" : "RPC");
 	else
 		fprintf(st, "disconnected");
 	return SCPE_OK;
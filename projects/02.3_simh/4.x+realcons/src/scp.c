@@ -23,6 +23,8 @@
    used in advertising or otherwise to promote the sale, use or other dealings
    in this Software without prior written authorization from Robert M Supnik.
 
+   17-Oct-26    agent   Indexed, incremental checkpoints (SAVE -I)
+   17-Oct-26    agent   Event queue kept as indexed binary heap
    08-Mar-16    RMS     Added shutdown flag for detach_all
    20-Mar-12    MP      Fixes to "SHOW <x> SHOW" commands
    06-Jan-12    JDB     Fixed "SHOW DEVICE" with only one enabled unit (Dave Bryan)
@@ -240,6 +242,10 @@
 #endif
 #include <sys/stat.h>
 #include <setjmp.h>
+#if !defined(_WIN32) && !defined(VMS)
+#include <sys/mman.h>
+#define SIM_CKP_MMAP 1                                  /* map checkpoints on restore */
+#endif
 
 #if defined(HAVE_DLOPEN)                                /* Dynamic Readline support */
 #include <dlfcn.h>
@@ -431,6 +437,8 @@ t_stat ssh_break (FILE *st, const char *cptr, int32 flg);
 t_stat show_cmd_fi (FILE *ofile, int32 flag, CONST char *cptr);
 t_stat show_config (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_queue (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
+static t_int64 sim_clock_now (void);
+static int sim_clock_compare (const void *pa, const void *pb);
 t_stat show_time (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_mod_names (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 t_stat show_show_commands (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
@@ -568,6 +576,11 @@ size_t *sim_sub_instr_off = NULL;
 static double sim_time;
 static uint32 sim_rtime;
 static int32 noqueue_time;
+static UNIT **sim_clock_heap = NULL;                    /* clock queue: heap of queued units */
+static int32 sim_clock_heap_count = 0;
+static int32 sim_clock_heap_size = 0;
+static t_uint64 sim_clock_seq = 0;                      /* activation counter */
+static t_int64 sim_clock_empty_time = 0;                /* queue time, while queue empty */
 volatile t_bool stop_cpu = FALSE;
 static unsigned int sim_stop_sleep_ms = 250;
 static char **sim_argv;
@@ -849,6 +862,14 @@ static const char simh_help[] =
       " to a file.  This includes the contents of main memory and all registers,\n"
       " and the I/O connections of devices:\n\n"
       "++SAVE <filename>\n\n"
+      "4Switches\n"
+      " Switches can influence the output and behavior of the SAVE command\n\n"
+      "++-I      Write an indexed checkpoint, or update an existing one\n"
+      "++-C      Compress the memory pages of an indexed checkpoint\n\n"
+      " An indexed checkpoint keeps memory in pages.  Saving to an existing one only\n"
+      " writes the pages which changed since it was last saved, which makes frequent\n"
+      " saves during long runs cheap.  The previous checkpoint stays valid until the\n"
+      " update is complete.\n\n"
 #define HLP_RESTORE     "*Commands Saving_and_Restoring_State RESTORE"
       "3RESTORE\n"
       " The RESTORE command (abbreviation REST, alternately GET) restores a\n"
@@ -862,7 +883,9 @@ static const char simh_help[] =
       "\n"
       "4Notes:\n"
       " 1) SAVE file format compresses zeroes to minimize file size.\n"
-      " 2) The simulator can't restore active incoming telnet sessions to\n"
+      " 2) RESTORE recognizes indexed checkpoints by their contents, no switch\n"
+      " is needed.\n"
+      " 3) The simulator can't restore active incoming telnet sessions to\n"
       " multiplexer devices, but the listening ports will be restored across a\n"
       " save/restore.\n"
        /***************** 80 character line width template *************************/
@@ -2269,6 +2292,7 @@ t_stat process_stdin_commands (t_stat stat, char *argv[]);
 
 /* Main command loop */
 
+#if !defined (SIM_QUEUE_BENCH)                          /* sim_queue_bench.c has its own */
 int main (int argc, char *argv[])
 {
 char cbuf[4*CBUFSIZE], *cptr, *cptr2;
@@ -2448,6 +2472,7 @@ fclose (stdnul);                                        /* close bit bucket file
 free (targv);                                           /* release any argv copy that was made */
 return 0;
 }
+#endif
 
 t_stat process_stdin_commands (t_stat stat, char *argv[])
 {
@@ -5337,7 +5362,9 @@ t_stat show_queue (FILE *st, DEVICE *dnotused, UNIT *unotused, int32 flag, CONST
 {
 DEVICE *dptr;
 UNIT *uptr;
-int32 accum;
+UNIT **queue;
+int32 i, accum;
+t_int64 now;
 MEMFILE buf;
 
 memset (&buf, 0, sizeof (buf));
@@ -5351,8 +5378,15 @@ else {
 
     fprintf (st, "%s event queue status, time = %.0f, executing %s instructions/sec\n",
              sim_name, sim_time, sim_fmt_numeric (sim_timer_inst_per_sec ()));
-    accum = 0;
-    for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next) {
+    queue = (UNIT **) malloc (sim_clock_heap_count * sizeof (*queue));
+    if (queue == NULL)
+        return SCPE_MEM;
+    memcpy (queue, sim_clock_heap, sim_clock_heap_count * sizeof (*queue));
+    qsort (queue, sim_clock_heap_count, sizeof (*queue), sim_clock_compare);
+    now = sim_clock_now ();
+    for (i = 0; i < sim_clock_heap_count; i++) {
+        uptr = queue[i];
+        accum = (int32) (uptr->q_time - now);
         if (uptr == &sim_step_unit)
             fprintf (st, "  Step timer");
         else
@@ -5366,17 +5400,17 @@ else {
                     }
                 else
                     fprintf (st, "  Unknown");
-        tim = sim_fmt_secs(((accum + uptr->time) / sim_timer_inst_per_sec ()) + (uptr->usecs_remaining / 1000000.0));
+        tim = sim_fmt_secs((accum / sim_timer_inst_per_sec ()) + (uptr->usecs_remaining / 1000000.0));
         if (uptr->usecs_remaining)
-            fprintf (st, " at %d plus %.0f usecs%s%s%s%s\n", accum + uptr->time, uptr->usecs_remaining,
+            fprintf (st, " at %d plus %.0f usecs%s%s%s%s\n", accum, uptr->usecs_remaining,
                                             (*tim) ? " (" : "", tim, (*tim) ? " total)" : "",
                                             (uptr->flags & UNIT_IDLE) ? " (Idle capable)" : "");
         else
-            fprintf (st, " at %d%s%s%s%s\n", accum + uptr->time,
+            fprintf (st, " at %d%s%s%s%s\n", accum,
                                             (*tim) ? " (" : "", tim, (*tim) ? ")" : "",
                                             (uptr->flags & UNIT_IDLE) ? " (Idle capable)" : "");
-        accum = accum + uptr->time;
         }
+    free (queue);
     }
 sim_show_clock_queues (st, dnotused, unotused, flag, cptr);
 #if defined (SIM_ASYNCH_IO)
@@ -6621,10 +6655,582 @@ free (uptr->uname);
 return uptr->uname = strcpy ((char *)malloc (1 + strlen (uname)), uname);
 }
 
+/* Indexed checkpoints (SAVE -I)
+
+   An indexed checkpoint holds the same device and register stream as a
+   SAVE file (the STATE section), but the contents of each memory-like
+   unit are kept in a section of their own, split into pages:
+
+       header          magic, page size, section count, index location
+       index           name, offset, length, capacity, word count and
+                       word size of each section
+       STATE           the SAVE stream, without memory contents
+       <unit name>     page table: offset and length/capacity of each
+                       page.  A length of 0 is a page of zeroes, a length
+                       below the page size a compressed page.
+       pages           memory words in little endian order
+
+   Saving to an existing checkpoint updates it: each page is compared
+   with what the file holds and only the pages which changed are written,
+   so frequent saves of a mostly idle memory cost little more than the
+   register state.  Nothing the current index refers to is overwritten:
+   changed pages, page tables, STATE and the index go to fresh space at
+   the end of the file (a page may also take the slot of a page which
+   was all zeroes).  The file is synced, then a single write of the
+   header switches to the new index, and the file is synced again.  A
+   crash before that leaves the previous checkpoint intact.  Once the
+   file is more than twice the size of what is in use, it is rewritten
+   into <filename>.tmp, which is then renamed over it.  A new checkpoint
+   is written the same way.
+
+   -C compresses pages with a byte run-length code (nothing heavier is
+   linked into every simulator).  RESTORE recognizes a checkpoint by its
+   magic, maps it where the host supports that, and deposits memory page
+   by page straight from the mapping.
+*/
+
+#define CKP_MAGIC       "SIMHCKP1"
+#define CKP_PAGE        4096                            /* page size (bytes) */
+#define CKP_NAMSIZ      32                              /* section name size */
+#define CKP_SECTSIZ     (CKP_NAMSIZ + 5 * sizeof (t_uint64))/* index entry size */
+
+typedef struct {
+    char                name[CKP_NAMSIZ];               /* STATE or unit name */
+    t_uint64            offset;
+    t_uint64            length;
+    t_uint64            capacity;                       /* size of the slot */
+    t_uint64            words;                          /* memory words */
+    t_uint64            word_size;                      /* bytes per word */
+    } CKP_SECT;
+
+typedef struct {
+    FILE                *file;
+    t_bool              compress;
+    t_offset            end;                            /* end of allocated space */
+    t_offset            live;                           /* space in use */
+    CKP_SECT            *sect;                          /* index being written or restored */
+    uint32              count;
+    CKP_SECT            *old;                           /* index of the file being updated */
+    uint32              old_count;
+    uint8               *map;                           /* mapped checkpoint (restore) */
+    size_t              map_size;
+    uint8               page[CKP_PAGE];
+    uint8               code[CKP_PAGE];                 /* compressed page */
+    uint8               file_page[CKP_PAGE];            /* page as in the file */
+    } SIM_CKP;
+
+static SIM_CKP *sim_ckp = NULL;                         /* checkpoint being saved or restored */
+
+static t_stat sim_ckp_io (SIM_CKP *ckp, t_bool wr, void *buf, size_t size, size_t count, t_offset pos)
+{
+if (!wr && ckp->map) {                                  /* mapped? */
+    if ((pos + size * count) > ckp->map_size)
+        return SCPE_IOERR;
+    memcpy (buf, ckp->map + (size_t)pos, size * count);
+    if ((!sim_end) && (size > sizeof (char)))
+        sim_buf_swap_data (buf, size, count);
+    return SCPE_OK;
+    }
+if (sim_fseeko (ckp->file, pos, SEEK_SET))
+    return SCPE_IOERR;
+if (wr)
+    return (sim_fwrite (buf, size, count, ckp->file) == count) ? SCPE_OK : SCPE_IOERR;
+return (sim_fread (buf, size, count, ckp->file) == count) ? SCPE_OK : SCPE_IOERR;
+}
+
+static t_offset sim_ckp_alloc (SIM_CKP *ckp, t_offset size, t_offset align)
+{
+t_offset pos = ((ckp->end + align - 1) / align) * align;
+
+ckp->end = pos + size;
+return pos;
+}
+
+static CKP_SECT *sim_ckp_find (CKP_SECT *sect, uint32 count, const char *name)
+{
+uint32 i;
+
+for (i = 0; i < count; i++)
+    if (strncmp (sect[i].name, name, CKP_NAMSIZ - 1) == 0)
+        return &sect[i];
+return NULL;
+}
+
+static CKP_SECT *sim_ckp_add (SIM_CKP *ckp, const char *name)
+{
+CKP_SECT *sect = (CKP_SECT *)realloc (ckp->sect, (ckp->count + 1) * sizeof (*sect));
+
+if (sect == NULL)
+    return NULL;
+ckp->sect = sect;
+sect = &ckp->sect[ckp->count++];
+memset (sect, 0, sizeof (*sect));
+strlcpy (sect->name, name, sizeof (sect->name));
+return sect;
+}
+
+/* Write a section's data.  It keeps its previous slot if it didn't change,
+   else it goes to fresh space: the checkpoint still refers to the old slot */
+
+static t_stat sim_ckp_put (SIM_CKP *ckp, CKP_SECT *sp, const CKP_SECT *old, void *buf, size_t size, size_t count)
+{
+t_offset len = (t_offset)size * count;
+uint8 *cur;
+t_bool same = FALSE;
+
+if (old && (old->length == (t_uint64)len)) {            /* unchanged? */
+    if ((cur = (uint8 *)malloc ((size_t)len + 1)) == NULL)
+        return SCPE_MEM;
+    same = (sim_ckp_io (ckp, FALSE, cur, size, count, (t_offset)old->offset) == SCPE_OK) &&
+           (memcmp (cur, buf, (size_t)len) == 0);
+    free (cur);
+    }
+sp->length = len;
+if (same) {
+    sp->offset = old->offset;
+    sp->capacity = old->capacity;
+    ckp->live += sp->capacity;
+    return SCPE_OK;
+    }
+sp->capacity = len;
+sp->offset = sim_ckp_alloc (ckp, len, sizeof (t_uint64));
+ckp->live += len;
+return sim_ckp_io (ckp, TRUE, buf, size, count, sp->offset);
+}
+
+/* Flush a checkpoint to the disk: what the header refers to must be there
+   before the header is written */
+
+static t_stat sim_ckp_sync (FILE *f)
+{
+if (fflush (f))
+    return SCPE_IOERR;
+#if defined (_WIN32)
+return _commit (_fileno (f)) ? SCPE_IOERR : SCPE_OK;
+#else
+return fsync (fileno (f)) ? SCPE_IOERR : SCPE_OK;
+#endif
+}
+
+/* Read a checkpoint's header and index */
+
+static t_stat sim_ckp_read_index (SIM_CKP *ckp, CKP_SECT **psect, uint32 *pcount, t_offset *pindex, t_offset *pcapacity)
+{
+char magic[sizeof (CKP_MAGIC) - 1];
+t_uint64 hdr[4], v[5];
+t_offset size = sim_fsize_ex (ckp->file);
+CKP_SECT *sect;
+uint32 i;
+
+*psect = NULL;
+*pcount = 0;
+if ((sim_ckp_io (ckp, FALSE, magic, 1, sizeof (magic), 0) != SCPE_OK) ||
+    (memcmp (magic, CKP_MAGIC, sizeof (magic)) != 0) ||
+    (sim_ckp_io (ckp, FALSE, hdr, sizeof (t_uint64), 4, sizeof (magic)) != SCPE_OK) ||
+    (hdr[0] != CKP_PAGE) ||                             /* page size */
+    (hdr[1] > (t_uint64)size / CKP_SECTSIZ) ||          /* section count */
+    (hdr[2] + hdr[1] * CKP_SECTSIZ > (t_uint64)size) || /* index */
+    (hdr[3] < hdr[1] * CKP_SECTSIZ))
+    return SCPE_INCOMP;
+sect = (CKP_SECT *)calloc ((size_t)hdr[1] + 1, sizeof (*sect));
+if (sect == NULL)
+    return SCPE_MEM;
+for (i = 0; i < (uint32)hdr[1]; i++) {
+    t_offset pos = (t_offset)(hdr[2] + i * CKP_SECTSIZ);
+
+    if ((sim_ckp_io (ckp, FALSE, sect[i].name, 1, CKP_NAMSIZ, pos) != SCPE_OK) ||
+        (sim_ckp_io (ckp, FALSE, v, sizeof (t_uint64), 5, pos + CKP_NAMSIZ) != SCPE_OK)) {
+        free (sect);
+        return SCPE_IOERR;
+        }
+    sect[i].name[CKP_NAMSIZ - 1] = '\0';
+    sect[i].offset = v[0];
+    sect[i].length = v[1];
+    sect[i].capacity = v[2];
+    sect[i].words = v[3];
+    sect[i].word_size = v[4];
+    }
+*psect = sect;
+*pcount = (uint32)hdr[1];
+*pindex = (t_offset)hdr[2];
+*pcapacity = (t_offset)hdr[3];
+return SCPE_OK;
+}
+
+/* Byte run-length code: a control byte below 128 is followed by that many
+   plus one literal bytes, one of 128 or above by a byte to repeat
+   (control - 125) times.  Returns the coded length, 0 if not smaller. */
+
+static size_t sim_ckp_pack (const uint8 *src, size_t n, uint8 *dst)
+{
+size_t i = 0, o = 0, run, lit;
+
+while (i < n) {
+    for (run = 1; (i + run < n) && (run < 130) && (src[i + run] == src[i]); run++);
+    if (run >= 3) {                                     /* repeat */
+        if (o + 2 >= n)
+            return 0;
+        dst[o++] = (uint8)(run + 125);
+        dst[o++] = src[i];
+        i += run;
+        continue;
+        }
+    for (lit = 1; (i + lit < n) && (lit < 128); lit++)  /* literals up to the next run */
+        if ((i + lit + 2 < n) && (src[i + lit] == src[i + lit + 1]) && (src[i + lit] == src[i + lit + 2]))
+            break;
+    if (o + 1 + lit >= n)
+        return 0;
+    dst[o++] = (uint8)(lit - 1);
+    memcpy (dst + o, src + i, lit);
+    o += lit;
+    i += lit;
+    }
+return o;
+}
+
+static t_stat sim_ckp_unpack (const uint8 *src, size_t len, uint8 *dst, size_t n)
+{
+size_t i = 0, o = 0, c;
+
+while (i < len) {
+    c = src[i++];
+    if (c < 128) {                                      /* literals */
+        if ((i + c + 1 > len) || (o + c + 1 > n))
+            return SCPE_IOERR;
+        memcpy (dst + o, src + i, c + 1);
+        i += c + 1;
+        o += c + 1;
+        }
+    else {                                              /* repeat */
+        c -= 125;
+        if ((i >= len) || (o + c > n))
+            return SCPE_IOERR;
+        memset (dst + o, src[i++], c);
+        o += c;
+        }
+    }
+return (o == n) ? SCPE_OK : SCPE_IOERR;
+}
+
+/* Save a memory-like unit into its own section (called from sim_save) */
+
+static t_stat sim_ckp_save_mem (SIM_CKP *ckp, DEVICE *dptr, UNIT *uptr, t_addr high)
+{
+size_t sz = SZ_D (dptr);
+t_uint64 words = ((t_uint64)high + dptr->aincr - 1) / dptr->aincr;
+uint32 wpp = (uint32)(CKP_PAGE / sz);                   /* words per page */
+uint32 pages = (uint32)((words + wpp - 1) / wpp);
+t_uint64 *pt = (t_uint64 *)calloc (2 * (size_t)pages, sizeof (*pt));
+CKP_SECT *sp, *old;
+uint8 *data;
+t_addr k = 0;
+t_value val;
+uint32 p, l, raw, len, cap, old_len;
+t_bool zero;
+t_stat r = SCPE_OK;
+
+if (pt == NULL)
+    return SCPE_MEM;
+old = sim_ckp_find (ckp->old, ckp->old_count, sim_uname (uptr));
+if (old && ((old->words != words) || (old->word_size != sz) ||
+            (old->length != 2 * (t_uint64)pages * sizeof (*pt))))
+    old = NULL;                                         /* different memory, start over */
+if (old)
+    r = sim_ckp_io (ckp, FALSE, pt, sizeof (*pt), 2 * (size_t)pages, (t_offset)old->offset);
+for (p = 0; (r == SCPE_OK) && (p < pages); p++) {
+    zero = TRUE;
+    for (l = 0; (l < wpp) && (k < high); l++, k = k + (dptr->aincr)) {
+        r = dptr->examine (&val, k, uptr, SIM_SW_REST);
+        if (r != SCPE_OK)
+            break;
+        if (val)
+            zero = FALSE;
+        SZ_STORE (sz, val, ckp->page, l);
+        }
+    if (r != SCPE_OK)
+        break;
+    raw = l * (uint32)sz;
+    sim_buf_swap_data (ckp->page, sz, l);               /* little endian in the file */
+    data = ckp->page;
+    len = zero ? 0 : raw;
+    if ((len != 0) && ckp->compress &&
+        ((l = (uint32)sim_ckp_pack (ckp->page, raw, ckp->code)) != 0)) {
+        data = ckp->code;
+        len = l;
+        }
+    cap = (uint32)(pt[2 * p + 1] >> 32);
+    old_len = (uint32)pt[2 * p + 1];
+    if (len == 0) {                                     /* zero page, keep the slot */
+        ckp->live += cap;
+        pt[2 * p + 1] = ((t_uint64)cap) << 32;
+        continue;
+        }
+    if (len == old_len) {                               /* same size? */
+        r = sim_ckp_io (ckp, FALSE, ckp->file_page, 1, len, (t_offset)pt[2 * p]);
+        if (r != SCPE_OK)
+            break;
+        if (memcmp (ckp->file_page, data, len) == 0) {  /* unchanged */
+            ckp->live += cap;
+            continue;
+            }
+        }
+    if ((old_len != 0) || (len > cap)) {                /* slot in use or too small: new slot */
+        cap = (len == raw) ? raw : ((len + 511) & ~511);
+        if (cap > raw)
+            cap = raw;
+        pt[2 * p] = (t_uint64)sim_ckp_alloc (ckp, cap, (cap == CKP_PAGE) ? CKP_PAGE : sizeof (t_uint64));
+        }
+    ckp->live += cap;
+    r = sim_ckp_io (ckp, TRUE, data, 1, len, (t_offset)pt[2 * p]);
+    pt[2 * p + 1] = (((t_uint64)cap) << 32) | len;
+    }
+if (r == SCPE_OK) {
+    sp = sim_ckp_add (ckp, sim_uname (uptr));
+    if (sp == NULL)
+        r = SCPE_MEM;
+    else {
+        sp->words = words;
+        sp->word_size = sz;
+        r = sim_ckp_put (ckp, sp, old, pt, sizeof (*pt), 2 * (size_t)pages);
+        }
+    }
+free (pt);
+return r;
+}
+
+/* Restore a memory-like unit from its section (called from sim_rest) */
+
+static t_stat sim_ckp_rest_mem (SIM_CKP *ckp, DEVICE *dptr, UNIT *uptr, t_addr high)
+{
+size_t sz = SZ_D (dptr);
+t_uint64 words = ((t_uint64)high + dptr->aincr - 1) / dptr->aincr;
+uint32 wpp = (uint32)(CKP_PAGE / sz);
+uint32 pages = (uint32)((words + wpp - 1) / wpp);
+CKP_SECT *sp = sim_ckp_find (ckp->sect, ckp->count, sim_uname (uptr));
+t_offset pos = sim_ftell (ckp->file);                   /* the stream continues here */
+t_uint64 *pt;
+const uint8 *data;
+t_addr k = 0;
+t_value val;
+uint32 p, l, n, raw, len;
+t_stat r = SCPE_OK;
+
+if ((sp == NULL) || (sp->words != words) || (sp->word_size != sz) ||
+    (sp->length != 2 * (t_uint64)pages * sizeof (*pt))) {
+    sim_printf ("Checkpoint memory doesn't match: %s\n", sim_uname (uptr));
+    return SCPE_INCOMP;
+    }
+if ((pt = (t_uint64 *)malloc (2 * (size_t)pages * sizeof (*pt))) == NULL)
+    return SCPE_MEM;
+r = sim_ckp_io (ckp, FALSE, pt, sizeof (*pt), 2 * (size_t)pages, (t_offset)sp->offset);
+for (p = 0; (r == SCPE_OK) && (p < pages); p++) {
+    n = ((words - (t_uint64)p * wpp) < wpp) ? (uint32)(words - (t_uint64)p * wpp) : wpp;
+    raw = n * (uint32)sz;
+    len = (uint32)pt[2 * p + 1];
+    data = ckp->page;
+    if (len == 0)                                       /* zero page */
+        memset (ckp->page, 0, raw);
+    else if ((len == raw) && ckp->map && sim_end &&     /* straight from the mapping? */
+             (pt[2 * p] + raw <= ckp->map_size))
+        data = ckp->map + (size_t)pt[2 * p];
+    else if (len == raw)
+        r = sim_ckp_io (ckp, FALSE, ckp->page, 1, raw, (t_offset)pt[2 * p]);
+    else if (len < raw) {                               /* compressed */
+        r = sim_ckp_io (ckp, FALSE, ckp->code, 1, len, (t_offset)pt[2 * p]);
+        if (r == SCPE_OK)
+            r = sim_ckp_unpack (ckp->code, len, ckp->page, raw);
+        }
+    else
+        r = SCPE_IOERR;
+    if (r != SCPE_OK)
+        break;
+    if (data == ckp->page)
+        sim_buf_swap_data (ckp->page, sz, n);
+    for (l = 0; l < n; l++, k = k + (dptr->aincr)) {
+        SZ_LOAD (sz, val, data, l);
+        r = dptr->deposit (val, k, uptr, SIM_SW_REST);
+        if (r != SCPE_OK)
+            break;
+        }
+    }
+free (pt);
+if ((ckp->map == NULL) && sim_fseeko (ckp->file, pos, SEEK_SET))
+    r = SCPE_IOERR;
+return r;
+}
+
+static void sim_ckp_free (SIM_CKP *ckp)
+{
+#if defined (SIM_CKP_MMAP)
+if (ckp->map)
+    munmap (ckp->map, ckp->map_size);
+#endif
+free (ckp->sect);
+free (ckp->old);
+free (ckp);
+}
+
+/* Save to an indexed checkpoint, updating it if it already is one */
+
+static t_stat sim_ckp_save (const char *filename, t_bool compress, t_bool update)
+{
+SIM_CKP *ckp = (SIM_CKP *)calloc (1, sizeof (*ckp));
+FILE *tmp = NULL;
+CKP_SECT *sp = NULL;
+uint8 *state = NULL;
+char tmpname[CBUFSIZE + 8];
+t_offset len = 0, ipos, old_index, old_capacity;
+t_uint64 hdr[4], v[5];
+uint32 i;
+t_stat r;
+
+if (ckp == NULL)
+    return SCPE_MEM;
+ckp->compress = compress;
+tmpname[0] = '\0';
+if (update && ((ckp->file = sim_fopen (filename, "rb+")) != NULL) &&
+    (sim_ckp_read_index (ckp, &ckp->old, &ckp->old_count, &old_index, &old_capacity) == SCPE_OK))
+    ckp->end = sim_fsize_ex (ckp->file);                /* append behind what's in use */
+else {
+    update = FALSE;
+    if (ckp->file)
+        fclose (ckp->file);
+    snprintf (tmpname, sizeof (tmpname), "%s.tmp", filename);/* written aside, then renamed */
+    if ((ckp->file = sim_fopen (tmpname, "wb+")) == NULL) {
+        sim_ckp_free (ckp);
+        return SCPE_OPENERR;
+        }
+    ckp->end = CKP_PAGE;                                /* header page */
+    }
+ckp->live = CKP_PAGE;
+if ((tmp = tmpfile ()) == NULL)
+    r = SCPE_OPENERR;
+else {
+    sim_ckp = ckp;
+    r = sim_save (tmp);                                 /* memory goes to its sections */
+    sim_ckp = NULL;
+    }
+if (r == SCPE_OK) {                                     /* state section */
+    len = sim_ftell (tmp);
+    if ((state = (uint8 *)malloc ((size_t)len + 1)) == NULL)
+        r = SCPE_MEM;
+    else {
+        rewind (tmp);
+        if (fread (state, 1, (size_t)len, tmp) != (size_t)len)
+            r = SCPE_IOERR;
+        }
+    }
+if ((r == SCPE_OK) && ((sp = sim_ckp_add (ckp, "STATE")) == NULL))
+    r = SCPE_MEM;
+if (r == SCPE_OK)
+    r = sim_ckp_put (ckp, sp, sim_ckp_find (ckp->old, ckp->old_count, "STATE"), state, 1, (size_t)len);
+if (r == SCPE_OK) {                                     /* index */
+    len = ckp->count * CKP_SECTSIZ;
+    ipos = sim_ckp_alloc (ckp, len, sizeof (t_uint64)); /* never over the current index */
+    ckp->live += len;
+    for (i = 0; (r == SCPE_OK) && (i < ckp->count); i++) {
+        sp = &ckp->sect[i];
+        v[0] = sp->offset;
+        v[1] = sp->length;
+        v[2] = sp->capacity;
+        v[3] = sp->words;
+        v[4] = sp->word_size;
+        r = sim_ckp_io (ckp, TRUE, sp->name, 1, CKP_NAMSIZ, ipos + i * CKP_SECTSIZ);
+        if (r == SCPE_OK)
+            r = sim_ckp_io (ckp, TRUE, v, sizeof (t_uint64), 5, ipos + i * CKP_SECTSIZ + CKP_NAMSIZ);
+        }
+    if ((r == SCPE_OK) && (sim_fsize_ex (ckp->file) < ckp->end)) {
+        uint8 pad = 0;                                  /* the file covers every slot */
+
+        r = sim_ckp_io (ckp, TRUE, &pad, 1, 1, ckp->end - 1);
+        }
+    if ((r == SCPE_OK) && !update)
+        r = sim_ckp_io (ckp, TRUE, (void *)CKP_MAGIC, 1, sizeof (CKP_MAGIC) - 1, 0);
+    if (r == SCPE_OK)                                   /* everything on disk */
+        r = sim_ckp_sync (ckp->file);
+    hdr[0] = CKP_PAGE;
+    hdr[1] = ckp->count;
+    hdr[2] = ipos;
+    hdr[3] = len;
+    if (r == SCPE_OK)                                   /* then switch to the new index */
+        r = sim_ckp_io (ckp, TRUE, hdr, sizeof (t_uint64), 4, sizeof (CKP_MAGIC) - 1);
+    if (r == SCPE_OK)
+        r = sim_ckp_sync (ckp->file);
+    }
+if (tmp)
+    fclose (tmp);
+free (state);
+if (fclose (ckp->file) && (r == SCPE_OK))
+    r = SCPE_IOERR;
+ckp->file = NULL;
+if (tmpname[0]) {                                       /* replace the file as a whole */
+#if defined (_WIN32)
+    if (r == SCPE_OK)                                   /* rename doesn't replace here */
+        remove (filename);
+#endif
+    if ((r == SCPE_OK) && rename (tmpname, filename))
+        r = SCPE_IOERR;
+    if (r != SCPE_OK)
+        remove (tmpname);
+    }
+if ((r == SCPE_OK) && update && (ckp->end > 2 * ckp->live)) {
+    sim_ckp_free (ckp);                                 /* mostly garbage, rewrite */
+    return sim_ckp_save (filename, compress, FALSE);
+    }
+sim_ckp_free (ckp);
+return r;
+}
+
+/* Restore from an indexed checkpoint; FALSE if rfile isn't one */
+
+static t_bool sim_ckp_rest (FILE *rfile, t_stat *stat)
+{
+SIM_CKP *ckp = (SIM_CKP *)calloc (1, sizeof (*ckp));
+CKP_SECT *sp = NULL;
+t_offset icap, ipos;
+t_stat r;
+
+if (ckp == NULL) {
+    *stat = SCPE_MEM;
+    return TRUE;
+    }
+ckp->file = rfile;
+r = sim_ckp_read_index (ckp, &ckp->sect, &ckp->count, &ipos, &icap);
+if (r == SCPE_INCOMP) {                                 /* not a checkpoint */
+    sim_ckp_free (ckp);
+    rewind (rfile);
+    return FALSE;
+    }
+if ((r == SCPE_OK) &&
+    ((sp = sim_ckp_find (ckp->sect, ckp->count, "STATE")) == NULL))
+    r = SCPE_IOERR;
+#if defined (SIM_CKP_MMAP)
+if (r == SCPE_OK) {
+    void *map;
+
+    ckp->map_size = (size_t)sim_fsize_ex (rfile);
+    map = mmap (NULL, ckp->map_size, PROT_READ, MAP_PRIVATE, fileno (rfile), 0);
+    if (map != MAP_FAILED)
+        ckp->map = (uint8 *)map;
+    }
+#endif
+if ((r == SCPE_OK) && sim_fseeko (rfile, (t_offset)sp->offset, SEEK_SET))
+    r = SCPE_IOERR;
+if (r == SCPE_OK) {
+    sim_ckp = ckp;
+    r = sim_rest (rfile);
+    sim_ckp = NULL;
+    }
+sim_ckp_free (ckp);
+*stat = r;
+return TRUE;
+}
+
 
 /* Save command
 
    sa[ve] filename              save state to specified file
+   sa[ve] -i{c} filename        save (or update) an indexed checkpoint
 */
 
 t_stat save_cmd (int32 flag, CONST char *cptr)
@@ -6639,6 +7245,8 @@ if (*cptr == 0)                                         /* must be more */
 gbuf[sizeof(gbuf)-1] = '\0';
 strlcpy (gbuf, cptr, sizeof(gbuf));
 sim_trim_endspc (gbuf);
+if (sim_switches & SWMASK ('I'))                        /* indexed checkpoint? */
+    return sim_ckp_save (gbuf, (sim_switches & SWMASK ('C')) != 0, TRUE);
 if ((sfile = sim_fopen (gbuf, "wb")) == NULL)
     return SCPE_OPENERR;
 r = sim_save (sfile);
@@ -6726,6 +7334,12 @@ for (i = 0; i < (device_count + sim_internal_device_count); i++) {/* loop thru d
              (dptr->examine != NULL) &&
              ((high = uptr->capac) != 0)) {             /* memory-like unit? */
             WRITE_I (high);                             /* [V2.5] write size */
+            if (sim_ckp != NULL) {                      /* checkpoint has memory sections */
+                r = sim_ckp_save_mem (sim_ckp, dptr, uptr, high);
+                if (r != SCPE_OK)
+                    return r;
+                continue;
+                }
             sz = SZ_D (dptr);
             if ((mbuf = calloc (SRBSIZ, sz)) == NULL) {
                 fclose (sfile);
@@ -6796,7 +7410,8 @@ strlcpy (gbuf, cptr, sizeof(gbuf));
 sim_trim_endspc (gbuf);
 if ((rfile = sim_fopen (gbuf, "rb")) == NULL)
     return SCPE_OPENERR;
-r = sim_rest (rfile);
+if (!sim_ckp_rest (rfile, &r))                          /* indexed checkpoint? */
+    r = sim_rest (rfile);
 fclose (rfile);
 return r;
 }
@@ -7021,6 +7636,12 @@ for ( ;; ) {                                            /* device loop */
                     fprint_capac (sim_log, dptr, uptr);
                 sim_printf ("\n");
                 }
+            if (sim_ckp != NULL) {                      /* checkpoint has memory sections */
+                r = sim_ckp_rest_mem (sim_ckp, dptr, uptr, high);
+                if (r != SCPE_OK)
+                    goto Cleanup_Return;
+                continue;
+                }
             sz = SZ_D (dptr);                           /* allocate buffer */
             if ((mbuf = calloc (SRBSIZ, sz)) == NULL) {
                 r = SCPE_MEM;
@@ -10112,6 +10733,113 @@ for (c=0, p=buf; c < len; c++) {
 return buf;
 }
 
+/* Clock queue heap */
+
+#define CLOCK_BEFORE(a,b) (((a)->q_time < (b)->q_time) ||  \
+                           (((a)->q_time == (b)->q_time) && ((a)->q_seq < (b)->q_seq)))
+
+static void sim_clock_heap_put (int32 slot, UNIT *uptr)
+{
+sim_clock_heap[slot] = uptr;
+uptr->q_slot = slot + 1;
+}
+
+static void sim_clock_heap_up (int32 slot, UNIT *uptr)
+{
+int32 parent;
+
+while (slot > 0) {
+    parent = (slot - 1) / 2;
+    if (!CLOCK_BEFORE (uptr, sim_clock_heap[parent]))
+        break;
+    sim_clock_heap_put (slot, sim_clock_heap[parent]);
+    slot = parent;
+    }
+sim_clock_heap_put (slot, uptr);
+}
+
+static void sim_clock_heap_down (int32 slot, UNIT *uptr)
+{
+int32 child;
+
+while ((child = 2 * slot + 1) < sim_clock_heap_count) {
+    if ((child + 1 < sim_clock_heap_count) &&
+        CLOCK_BEFORE (sim_clock_heap[child + 1], sim_clock_heap[child]))
+        child = child + 1;
+    if (!CLOCK_BEFORE (sim_clock_heap[child], uptr))
+        break;
+    sim_clock_heap_put (slot, sim_clock_heap[child]);
+    slot = child;
+    }
+sim_clock_heap_put (slot, uptr);
+}
+
+static t_stat sim_clock_heap_insert (UNIT *uptr)
+{
+if (sim_clock_heap_count == sim_clock_heap_size) {
+    int32 size = sim_clock_heap_size ? 2 * sim_clock_heap_size : 64;
+    UNIT **heap = (UNIT **) realloc (sim_clock_heap, size * sizeof (*heap));
+
+    if (heap == NULL)
+        return SCPE_MEM;
+    sim_clock_heap = heap;
+    sim_clock_heap_size = size;
+    }
+sim_clock_heap_up (sim_clock_heap_count++, uptr);
+return SCPE_OK;
+}
+
+static void sim_clock_heap_remove (UNIT *uptr)
+{
+int32 slot = uptr->q_slot - 1;
+UNIT *last = sim_clock_heap[--sim_clock_heap_count];
+
+uptr->q_slot = 0;
+if (slot == sim_clock_heap_count)                       /* was last? */
+    return;
+if ((slot > 0) && CLOCK_BEFORE (last, sim_clock_heap[(slot - 1) / 2]))
+    sim_clock_heap_up (slot, last);
+else
+    sim_clock_heap_down (slot, last);
+}
+
+/* queue time of now, valid after UPDATE_SIM_TIME */
+
+static t_int64 sim_clock_now (void)
+{
+if (sim_clock_queue == QUEUE_LIST_END)
+    return sim_clock_empty_time;
+return sim_clock_queue->q_time - sim_clock_queue->time;
+}
+
+/* make the first heap entry the queue head, with its delay from queue time now */
+
+static void sim_clock_set_head (t_int64 now)
+{
+if (sim_clock_heap_count == 0) {
+    sim_clock_queue = QUEUE_LIST_END;
+    sim_clock_empty_time = now;
+    sim_interval = noqueue_time = NOQUEUE_WAIT;
+    }
+else {
+    sim_clock_queue = sim_clock_heap[0];
+    sim_clock_queue->time = (int32) (sim_clock_queue->q_time - now);
+    sim_interval = sim_clock_queue->time;
+    }
+}
+
+/* compare two queued units in clock order, for qsort */
+
+static int sim_clock_compare (const void *pa, const void *pb)
+{
+const UNIT *a = *(const UNIT * const *) pa;
+const UNIT *b = *(const UNIT * const *) pb;
+
+if (CLOCK_BEFORE (a, b))
+    return -1;
+return CLOCK_BEFORE (b, a) ? 1 : 0;
+}
+
 /* Event queue package
 
         sim_activate            add entry to event queue
@@ -10135,8 +10863,17 @@ return buf;
    and to see if further events need to be processed, or sim_interval
    reset to count the next one.
 
-   The event queue is maintained in clock order; entry timeouts are
-   RELATIVE to the time in the previous entry.
+   The event queue is maintained in clock order: a binary heap of the
+   queued units, ordered by absolute queue time and, for equal times, by
+   activation order.  Each queued unit knows its heap slot, so activate
+   and cancel take O(log n) instead of a walk of the queue.
+   sim_clock_queue is always the first entry; its time field is the
+   delay from now to that entry, which the simulator counts down in
+   sim_interval.  Units on the queue have next = QUEUE_LIST_END.
+
+   Queue time advances with executed instructions, and jumps to the time
+   of an entry when the entry is processed, so instructions executed past
+   the due time of an entry delay all later entries, as they always did.
 
    sim_process_event - process event
 
@@ -10167,13 +10904,10 @@ if (sim_clock_queue == QUEUE_LIST_END) {                /* queue empty? */
 sim_processing_event = TRUE;
 do {
     uptr = sim_clock_queue;                             /* get first */
-    sim_clock_queue = uptr->next;                       /* remove first */
+    sim_clock_heap_remove (uptr);                       /* remove first */
     uptr->next = NULL;                                  /* hygiene */
     uptr->time = 0;
-    if (sim_clock_queue != QUEUE_LIST_END)
-        sim_interval = sim_clock_queue->time;
-    else
-        sim_interval = noqueue_time = NOQUEUE_WAIT;
+    sim_clock_set_head (uptr->q_time);                  /* now is its due time */
     sim_debug (SIM_DBG_EVENT, sim_dflt_dev, "Processing Event for %s\n", sim_uname (uptr));
     AIO_EVENT_BEGIN(uptr);
     if (uptr->usecs_remaining)
@@ -10223,8 +10957,7 @@ return _sim_activate (uptr, event_time);
 
 t_stat _sim_activate (UNIT *uptr, int32 event_time)
 {
-UNIT *cptr, *prvptr;
-int32 accum;
+t_int64 now;
 
 AIO_ACTIVATE (_sim_activate, uptr, event_time);
 if (sim_is_active (uptr))                               /* already active? */
@@ -10233,26 +10966,14 @@ UPDATE_SIM_TIME;                                        /* update sim time */
 
 sim_debug (SIM_DBG_ACTIVATE, sim_dflt_dev, "Activating %s delay=%d\n", sim_uname (uptr), event_time);
 
-prvptr = NULL;
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (event_time < (accum + cptr->time))
-        break;
-    accum = accum + cptr->time;
-    prvptr = cptr;
-    }
-if (prvptr == NULL) {                                   /* insert at head */
-    cptr = uptr->next = sim_clock_queue;
-    sim_clock_queue = uptr;
-    }
-else {
-    cptr = uptr->next = prvptr->next;                   /* insert at prvptr */
-    prvptr->next = uptr;
-    }
-uptr->time = event_time - accum;
-if (cptr != QUEUE_LIST_END)
-    cptr->time = cptr->time - uptr->time;
-sim_interval = sim_clock_queue->time;
+now = sim_clock_now ();
+uptr->q_time = now + event_time;                        /* after all entries due */
+uptr->q_seq = sim_clock_seq++;                          /* at the same time */
+if (sim_clock_heap_insert (uptr) != SCPE_OK)
+    return SCPE_MEM;
+uptr->next = QUEUE_LIST_END;
+uptr->time = event_time;
+sim_clock_set_head (now);
 return SCPE_OK;
 }
 
@@ -10351,7 +11072,7 @@ return sim_timer_activate_after (uptr, usec_delay);
 
 t_stat sim_cancel (UNIT *uptr)
 {
-UNIT *cptr, *nptr;
+t_int64 now;
 
 AIO_VALIDATE;
 if ((uptr->cancel) && uptr->cancel (uptr))
@@ -10366,29 +11087,15 @@ sim_debug (SIM_DBG_EVENT, sim_dflt_dev, "Canceling Event for %s\n", sim_uname(up
 UPDATE_SIM_TIME;                                        /* update sim time */
 if (!sim_is_active (uptr))
     return SCPE_OK;
-nptr = QUEUE_LIST_END;
-
-if (sim_clock_queue == uptr) {
-    nptr = sim_clock_queue = uptr->next;
+if (uptr->q_slot) {                                     /* on clock queue? */
+    now = sim_clock_now ();
+    sim_clock_heap_remove (uptr);
     uptr->next = NULL;                                  /* hygiene */
+    sim_clock_set_head (now);
     }
-else {
-    for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-        if (cptr->next == uptr) {
-            nptr = cptr->next = uptr->next;
-            uptr->next = NULL;                          /* hygiene */
-            break;                                      /* end queue scan */
-            }
-        }
-    }
-if (nptr != QUEUE_LIST_END)
-    nptr->time += (uptr->next) ? 0 : uptr->time;
 if (!uptr->next)
     uptr->time = 0;
 uptr->usecs_remaining = 0;
-if (sim_clock_queue != QUEUE_LIST_END)
-    sim_interval = sim_clock_queue->time;
-else sim_interval = noqueue_time = NOQUEUE_WAIT;
 if (uptr->next) {
     sim_printf ("Cancel failed for %s\n", sim_uname(uptr));
     if (sim_deb)
@@ -10421,23 +11128,19 @@ return (((uptr->next) || AIO_IS_ACTIVE(uptr) || ((uptr->dynflags & UNIT_TMR_UNIT
         result =        absolute activation time + 1, 0 if inactive
 */
 
-int32 _sim_activate_time (UNIT *uptr)
+/* delay from now to a queued unit, in the queue walk of the former delta list:
+   the first entry counts the remaining interval, if not overdue */
+
+static int32 sim_clock_delay (UNIT *uptr)
 {
-UNIT *cptr;
-int32 accum;
+return ((sim_interval > 0) ? sim_interval : 0) + (int32) (uptr->q_time - sim_clock_queue->q_time);
+}
 
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (cptr == sim_clock_queue) {
-        if (sim_interval > 0)
-            accum = accum + sim_interval;
-        }
-    else
-        accum = accum + cptr->time;
-    if (cptr == uptr)
-        return accum + 1 + (int32)((uptr->usecs_remaining * sim_timer_inst_per_sec ()) / 1000000.0);
-    }
-return 0;
+int32 _sim_activate_time (UNIT *uptr)
+{
+if (uptr->q_slot == 0)
+    return 0;
+return sim_clock_delay (uptr) + 1 + (int32)((uptr->usecs_remaining * sim_timer_inst_per_sec ()) / 1000000.0);
 }
 
 int32 sim_activate_time (UNIT *uptr)
@@ -10453,26 +11156,15 @@ return _sim_activate_time (uptr);
 
 double sim_activate_time_usecs (UNIT *uptr)
 {
-UNIT *cptr;
-int32 accum;
 double result;
 
 AIO_VALIDATE;
 result = sim_timer_activate_time_usecs (uptr);
 if (result >= 0)
     return result;
-accum = 0;
-for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
-    if (cptr == sim_clock_queue) {
-        if (sim_interval > 0)
-            accum = accum + sim_interval;
-        }
-    else
-        accum = accum + cptr->time;
-    if (cptr == uptr)
-        return 1.0 + uptr->usecs_remaining + ((1000000.0 * accum) / sim_timer_inst_per_sec ());
-    }
-return 0.0;
+if (uptr->q_slot == 0)
+    return 0.0;
+return 1.0 + uptr->usecs_remaining + ((1000000.0 * sim_clock_delay (uptr)) / sim_timer_inst_per_sec ());
 }
 
 /* sim_gtime - return global time
@@ -10506,13 +11198,7 @@ return sim_rtime;
 
 int32 sim_qcount (void)
 {
-int32 cnt;
-UNIT *uptr;
-
-cnt = 0;
-for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next)
-    cnt++;
-return cnt;
+return sim_clock_heap_count;
 }
 
 /* Breakpoint package.  This module replaces the VM-implemented one
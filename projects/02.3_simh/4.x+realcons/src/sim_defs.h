@@ -23,6 +23,7 @@
    used in advertising or otherwise to promote the sale, use or other dealings
    in this Software without prior written authorization from Robert M Supnik.
 
+   17-Oct-26    agent   Added clock queue heap linkage to UNIT
    25-Sep-16    RMS     Removed KBD_WAIT and friends
    08-Mar-16    RMS     Added shutdown invisible switch
    24-Dec-14    JDB     Added T_ADDR_FMT
@@ -580,6 +581,9 @@ struct UNIT {
     t_bool              (*cancel)(UNIT *);
     double              usecs_remaining;                /* time balance for long delays */
     char                *uname;                         /* Unit name */
+    t_int64             q_time;                         /* clock queue: absolute event time */
+    t_uint64            q_seq;                          /* clock queue: activation order */
+    int32               q_slot;                         /* clock queue: heap slot + 1, 0 if not queued */
 #ifdef SIM_ASYNCH_IO
     void                (*a_check_completion)(UNIT *);
     t_bool              (*a_is_active)(UNIT *);
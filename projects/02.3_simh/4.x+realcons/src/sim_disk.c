@@ -28,6 +28,11 @@
    This is the place which hides processing of various disk formats,
    as well as OS-specific direct hardware access.
 
+   17-Oct-26    agent   Sparse copy-on-write overlays (ATTACH -S)
+   17-Oct-26    agent   ATTACH -P memory maps SIMH and RAW containers
+   17-Oct-26    agent   Asynchronous I/O through one shared engine (io_uring
+                        or worker pool) with several requests in flight per
+                        unit; SIMH format transfers use pread/pwrite
    25-Jan-11    MP      Initial Implemementation
 
 Public routines:
@@ -79,10 +84,34 @@ Internal routines:
 #include "sim_ether.h"
 #include <ctype.h>
 #include <sys/stat.h>
+#if defined (_WIN32)
+#include <io.h>
+#endif
+
+#if !defined (_WIN32) && !defined (VMS)
+#define SIM_DISK_PIO 1          /* positional pread/pwrite on SIMH format containers */
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
 
 #if defined SIM_ASYNCH_IO
 #include <pthread.h>
+#if defined (__linux) || defined (__linux__)
+#include <sys/syscall.h>
+#if defined (__NR_io_uring_setup) && defined (__NR_io_uring_enter)
+#if defined (__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define SIM_DISK_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+#endif
+#endif
 #endif
+#endif
+#endif
+
+struct disk_aio_req;
+struct disk_overlay;
 
 struct disk_context {
     DEVICE              *dptr;              /* Device for unit (access to debug flags) */
@@ -95,135 +124,587 @@ struct disk_context {
     uint32              is_cdrom;           /* Host system CDROM Device */
     uint32              media_removed;      /* Media not available flag */
     uint32              auto_format;        /* Format determined dynamically */
+    uint8               *map;               /* Memory mapped container (ATTACH -P) */
+    t_offset            map_size;           /* Bytes mapped */
+    struct disk_overlay *overlay;           /* Sparse copy-on-write overlay (ATTACH -S) */
 #if defined _WIN32
     HANDLE              disk_handle;        /* OS specific Raw device handle */
 #endif
 #if defined SIM_ASYNCH_IO
     int                 asynch_io;          /* Asynchronous Interrupt scheduling enabled */
     int                 asynch_io_latency;  /* instructions to delay pending interrupt */
-    pthread_mutex_t     lock;
-    pthread_t           io_thread;          /* I/O Thread Id */
-    pthread_mutex_t     io_lock;
-    pthread_cond_t      io_cond;
-    pthread_cond_t      io_done;
-    pthread_cond_t      startup_cond;
-    int                 io_dop;
+    pthread_mutex_t     lock;               /* protects io_outstanding and the done list */
+    pthread_mutex_t     io_lock;            /* serializes transfers which aren't positional */
+    pthread_cond_t      io_done;            /* signalled when io_outstanding drops to 0 */
+    int                 io_outstanding;     /* requests submitted but not yet completed */
+    struct disk_aio_req *done_head;         /* completed requests awaiting dispatch */
+    struct disk_aio_req *done_tail;
+#endif
+    };
+
+#define disk_ctx up8                        /* Field in Unit structure which points to the disk_context */
+
+#if defined (SIM_DISK_PIO)
+/* Positional transfer on a file descriptor.  Returns the number of bytes
+   transferred (short only at end of file) or -1 on error.  Since no file
+   position is involved, any number of these may run concurrently against
+   the same container. */
+static ssize_t _sim_disk_pio (int fd, t_bool write, uint8 *buf, size_t bytes, t_offset da)
+{
+size_t done = 0;
+ssize_t n;
+
+while (done < bytes) {
+    if (write)
+        n = pwrite (fd, buf + done, bytes - done, (off_t)(da + done));
+    else
+        n = pread (fd, buf + done, bytes - done, (off_t)(da + done));
+    if (n < 0) {
+        if (errno == EINTR)
+            continue;
+        return -1;
+        }
+    if (n == 0)                                         /* end of file */
+        break;
+    done += (size_t)n;
+    }
+return (ssize_t)done;
+}
+
+/* Finish a SIMH format transfer the way sim_fread/sim_fwrite would have:
+   reads beyond the end of the container are zero filled, data elements are
+   put into host order and the transferred sector count is rounded up. */
+static t_stat _sim_disk_pio_done (struct disk_context *ctx, t_bool write, uint8 *buf, t_seccnt *sectsxfer, t_seccnt sects, ssize_t bytes)
+{
+size_t tbc = sects * ctx->sector_size;
+size_t i = (bytes < 0) ? 0 : ((size_t)bytes) / ctx->xfer_element_size;
+
+if (sectsxfer)
+    *sectsxfer = 0;
+if (!write) {
+    if (i * ctx->xfer_element_size < tbc)               /* fill */
+        memset (&buf[i * ctx->xfer_element_size], 0, tbc - (i * ctx->xfer_element_size));
+    sim_buf_swap_data (buf, ctx->xfer_element_size, i);
+    }
+if (bytes < 0)
+    return SCPE_IOERR;
+if (sectsxfer)
+    *sectsxfer = (t_seccnt)((i * ctx->xfer_element_size + ctx->sector_size - 1) / ctx->sector_size);
+return SCPE_OK;
+}
+
+/* Transfer between a memory mapped container and the caller's buffer.
+   Returns FALSE for transfers the mapping doesn't cover entirely (beyond
+   the container's size at attach time) and for writes to a read only
+   unit; those go through the file, which zero fills reads past its end. */
+static t_bool _sim_disk_map_xfer (UNIT *uptr, t_bool write, t_lba lba, uint8 *buf, t_seccnt *sectsxfer, t_seccnt sects, t_stat *stat)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_offset da = ((t_offset)lba) * ctx->sector_size;
+size_t tbc = sects * ctx->sector_size;
+size_t avail = (da >= ctx->map_size) ? 0 : (size_t)(((ctx->map_size - da) < (t_offset)tbc) ? (ctx->map_size - da) : tbc);
+
+if ((avail < tbc) || (write && (uptr->flags & UNIT_RO)))
+    return FALSE;
+if (write)
+    sim_buf_copy_swapped (ctx->map + da, buf, ctx->xfer_element_size, tbc / ctx->xfer_element_size);
+else
+    memcpy (buf, ctx->map + da, tbc);
+*stat = _sim_disk_pio_done (ctx, write, buf, sectsxfer, sects, (ssize_t)tbc);
+return TRUE;
+}
+#endif
+
+#if defined SIM_ASYNCH_IO
+/* Asynchronous disk engine
+
+   All units with asynchronous I/O enabled share one engine rather than
+   each owning a thread.  A request is handled in one of three ways:
+
+   - SIMH format transfers which need no byte swapping are positional
+     (pread/pwrite on the container's descriptor) and are independent of
+     each other, so any number may be in flight per unit (they complete
+     in no particular order, see sim_disk_rdsect_a).  On Linux they
+     are submitted to an io_uring if the kernel provides one; a single
+     reaper thread collects their completions.  A completion may be short
+     of the request without being at end of file; the reaper then submits
+     the rest again (or hands it to the pool if the ring is full) until
+     the request is complete or a transfer of 0 bytes marks end of file.
+   - Without io_uring, those same positional transfers are run by a small
+     pool of worker threads.
+   - Everything else (VHD, raw devices, byte swapping, write checking,
+     availability tests) runs the synchronous routine in a pool worker,
+     serialized per unit by ctx->io_lock since those paths keep state.
+
+   Completed requests are appended to the unit's done list and the unit is
+   activated through the asynchronous event queue.  The completion check
+   then runs in the simulator thread and calls the callbacks of every
+   request which completed since the last check. */
+
+#define DOP_RSEC  1             /* sim_disk_rdsect_a */
+#define DOP_WSEC  2             /* sim_disk_wrsect_a */
+#define DOP_IAVL  3             /* sim_disk_isavailable_a */
+
+#define DISK_AIO_THREADS        4           /* worker pool size */
+#define DISK_AIO_RING_ENTRIES   64          /* io_uring submission queue size */
+
+struct disk_aio_req {
+    struct disk_aio_req *next;
+    UNIT                *uptr;
+    int                 dop;
+    int                 fd;                 /* >= 0 for positional transfers */
+    t_lba               lba;
     uint8               *buf;
     t_seccnt            *rsects;
     t_seccnt            sects;
-    t_lba               lba;
+    size_t              done;               /* bytes moved by earlier, short transfers */
     DISK_PCALLBACK      callback;
     t_stat              io_status;
+#if defined (SIM_DISK_IO_URING)
+    struct iovec        iov;
 #endif
     };
 
-#define disk_ctx up8                        /* Field in Unit structure which points to the disk_context */
+static pthread_mutex_t _disk_aio_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _disk_aio_work = PTHREAD_COND_INITIALIZER;
+static int _disk_aio_users;                 /* units with asynchronous I/O enabled */
+static int _disk_aio_shutdown;
+static struct disk_aio_req *_disk_aio_head; /* requests for the worker pool */
+static struct disk_aio_req *_disk_aio_tail;
+static pthread_t _disk_aio_threads[DISK_AIO_THREADS];
+static int _disk_aio_nthreads;
+
+/* Hand a request to the worker pool.  Called with _disk_aio_lock held. */
+static void _disk_aio_queue (struct disk_aio_req *req)
+{
+req->next = NULL;
+if (_disk_aio_tail)
+    _disk_aio_tail->next = req;
+else
+    _disk_aio_head = req;
+_disk_aio_tail = req;
+pthread_cond_signal (&_disk_aio_work);
+}
 
-#if defined SIM_ASYNCH_IO
-#define AIO_CALLSETUP                                               \
-struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;   \
-                                                                    \
-if ((!callback) || !ctx->asynch_io)
+static void _disk_aio_complete (struct disk_aio_req *req)
+{
+UNIT *uptr = req->uptr;
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
-#define AIO_CALL(op, _lba, _buf, _rsects, _sects,  _callback)   \
-    if (ctx->asynch_io) {                                       \
-        struct disk_context *ctx =                              \
-                      (struct disk_context *)uptr->disk_ctx;    \
-                                                                \
-        pthread_mutex_lock (&ctx->io_lock);                     \
-                                                                \
-        sim_debug (ctx->dbit, ctx->dptr,                        \
-      "sim_disk AIO_CALL(op=%d, unit=%d, lba=0x%X, sects=%d)\n",\
-                op, (int)(uptr-ctx->dptr->units), _lba, _sects);\
-                                                                \
-        if (ctx->callback)                                      \
-            abort(); /* horrible mistake, stop */               \
-        ctx->io_dop = op;                                       \
-        ctx->lba = _lba;                                        \
-        ctx->buf = _buf;                                        \
-        ctx->sects = _sects;                                    \
-        ctx->rsects = _rsects;                                  \
-        ctx->callback = _callback;                              \
-        pthread_cond_signal (&ctx->io_cond);                    \
-        pthread_mutex_unlock (&ctx->io_lock);                   \
-        }                                                       \
-    else                                                        \
-        if (_callback)                                          \
-            (_callback) (uptr, r);
+pthread_mutex_lock (&ctx->lock);
+req->next = NULL;
+if (ctx->done_tail)
+    ctx->done_tail->next = req;
+else
+    ctx->done_head = req;
+ctx->done_tail = req;
+sim_activate (uptr, ctx->asynch_io_latency);
+if (--ctx->io_outstanding == 0)
+    pthread_cond_broadcast (&ctx->io_done);
+pthread_mutex_unlock (&ctx->lock);
+}
 
+static void _disk_aio_execute (struct disk_aio_req *req)
+{
+UNIT *uptr = req->uptr;
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
-#define DOP_DONE  0             /* close */
-#define DOP_RSEC  1             /* sim_disk_rdsect_a */
-#define DOP_WSEC  2             /* sim_disk_wrsect_a */
-#define DOP_IAVL  3             /* sim_disk_isavailable_a */
+#if defined (SIM_DISK_PIO)
+if (req->fd >= 0) {
+    t_bool write = (req->dop == DOP_WSEC);
+    ssize_t bytes = _sim_disk_pio (req->fd, write, req->buf + req->done, req->sects * ctx->sector_size - req->done,
+                                   ((t_offset)req->lba) * ctx->sector_size + req->done);
+
+    req->io_status = _sim_disk_pio_done (ctx, write, req->buf, req->rsects, req->sects, (bytes < 0) ? -1 : (ssize_t)req->done + bytes);
+    return;
+    }
+#endif
+pthread_mutex_lock (&ctx->io_lock);
+switch (req->dop) {
+    case DOP_RSEC:
+        req->io_status = sim_disk_rdsect (uptr, req->lba, req->buf, req->rsects, req->sects);
+        break;
+    case DOP_WSEC:
+        req->io_status = sim_disk_wrsect (uptr, req->lba, req->buf, req->rsects, req->sects);
+        break;
+    case DOP_IAVL:
+        req->io_status = sim_disk_isavailable (uptr);
+        break;
+    }
+pthread_mutex_unlock (&ctx->io_lock);
+}
 
 static void *
-_disk_io(void *arg)
+_disk_aio_worker (void *arg)
 {
-UNIT* volatile uptr = (UNIT*)arg;
-struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_aio_req *req;
 
 /* Boost Priority for this I/O thread vs the CPU instruction execution
    thread which in general won't be readily yielding the processor when
    this thread needs to run */
 sim_os_set_thread_priority (PRIORITY_ABOVE_NORMAL);
 
-sim_debug (ctx->dbit, ctx->dptr, "_disk_io(unit=%d) starting\n", (int)(uptr-ctx->dptr->units));
+pthread_mutex_lock (&_disk_aio_lock);
+while (1) {
+    while ((_disk_aio_head == NULL) && !_disk_aio_shutdown)
+        pthread_cond_wait (&_disk_aio_work, &_disk_aio_lock);
+    if (_disk_aio_head == NULL)
+        break;
+    req = _disk_aio_head;
+    _disk_aio_head = req->next;
+    if (_disk_aio_head == NULL)
+        _disk_aio_tail = NULL;
+    pthread_mutex_unlock (&_disk_aio_lock);
+    _disk_aio_execute (req);
+    _disk_aio_complete (req);
+    pthread_mutex_lock (&_disk_aio_lock);
+    }
+pthread_mutex_unlock (&_disk_aio_lock);
+return NULL;
+}
 
-pthread_mutex_lock (&ctx->io_lock);
-pthread_cond_signal (&ctx->startup_cond);   /* Signal we're ready to go */
-while (ctx->asynch_io) {
-    pthread_cond_wait (&ctx->io_cond, &ctx->io_lock);
-    if (ctx->io_dop == DOP_DONE)
+#if defined (SIM_DISK_IO_URING)
+/* io_uring, driven through the raw system calls.  Submission happens in
+   the simulator thread under _disk_aio_lock, so the submission queue has
+   a single producer.  Requests which don't fit in the ring go to the
+   worker pool. */
+
+static int _disk_ring_fd = -1;
+static unsigned _disk_ring_entries;
+static unsigned _disk_ring_inflight;
+static void *_disk_ring_sq_ptr, *_disk_ring_cq_ptr;
+static size_t _disk_ring_sq_size, _disk_ring_cq_size;
+static struct io_uring_sqe *_disk_ring_sqes;
+static unsigned *_disk_ring_sq_tail, *_disk_ring_sq_mask, *_disk_ring_sq_array;
+static unsigned *_disk_ring_cq_head, *_disk_ring_cq_tail, *_disk_ring_cq_mask;
+static struct io_uring_cqe *_disk_ring_cqes;
+static pthread_t _disk_ring_reaper;
+
+static int _disk_ring_enter (unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+return (int)syscall (__NR_io_uring_enter, _disk_ring_fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+/* Queue one SQE and hand it to the kernel.  Called with _disk_aio_lock held.
+   req == NULL submits a NOP which wakes the reaper. */
+static t_bool _disk_ring_submit (struct disk_aio_req *req)
+{
+unsigned tail = *_disk_ring_sq_tail;
+unsigned idx = tail & *_disk_ring_sq_mask;
+struct io_uring_sqe *sqe = &_disk_ring_sqes[idx];
+int r;
+
+memset (sqe, 0, sizeof (*sqe));
+if (req) {
+    struct disk_context *ctx = (struct disk_context *)req->uptr->disk_ctx;
+
+    req->iov.iov_base = req->buf + req->done;           /* what's left of it */
+    req->iov.iov_len = req->sects * ctx->sector_size - req->done;
+    sqe->opcode = (req->dop == DOP_WSEC) ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = req->fd;
+    sqe->off = ((t_offset)req->lba) * ctx->sector_size + req->done;
+    sqe->addr = (unsigned long)&req->iov;
+    sqe->len = 1;
+    }
+else
+    sqe->opcode = IORING_OP_NOP;
+sqe->user_data = (unsigned long)req;
+_disk_ring_sq_array[idx] = idx;
+__atomic_store_n (_disk_ring_sq_tail, tail + 1, __ATOMIC_RELEASE);
+do
+    r = _disk_ring_enter (1, 0, 0);
+while ((r < 0) && (errno == EINTR));
+if (r != 1) {                                           /* not consumed by the kernel */
+    __atomic_store_n (_disk_ring_sq_tail, tail, __ATOMIC_RELEASE);
+    return FALSE;
+    }
+++_disk_ring_inflight;
+return TRUE;
+}
+
+static void *
+_disk_ring_reap (void *arg)
+{
+unsigned head;
+struct io_uring_cqe *cqe;
+struct disk_aio_req *req;
+ssize_t bytes;
+
+sim_os_set_thread_priority (PRIORITY_ABOVE_NORMAL);
+
+while (1) {
+    head = *_disk_ring_cq_head;
+    if (head == __atomic_load_n (_disk_ring_cq_tail, __ATOMIC_ACQUIRE)) {
+        _disk_ring_enter (0, 1, IORING_ENTER_GETEVENTS);
+        continue;
+        }
+    cqe = &_disk_ring_cqes[head & *_disk_ring_cq_mask];
+    req = (struct disk_aio_req *)(unsigned long)cqe->user_data;
+    bytes = cqe->res;
+    __atomic_store_n (_disk_ring_cq_head, head + 1, __ATOMIC_RELEASE);
+    pthread_mutex_lock (&_disk_aio_lock);
+    --_disk_ring_inflight;
+    if (req == NULL) {                                  /* shutdown NOP */
+        pthread_mutex_unlock (&_disk_aio_lock);
         break;
-    pthread_mutex_unlock (&ctx->io_lock);
-    switch (ctx->io_dop) {
-        case DOP_RSEC:
-            ctx->io_status = sim_disk_rdsect (uptr, ctx->lba, ctx->buf, ctx->rsects, ctx->sects);
-            break;
-        case DOP_WSEC:
-            ctx->io_status = sim_disk_wrsect (uptr, ctx->lba, ctx->buf, ctx->rsects, ctx->sects);
-            break;
-        case DOP_IAVL:
-            ctx->io_status = sim_disk_isavailable (uptr);
-            break;
         }
-    pthread_mutex_lock (&ctx->io_lock);
-    ctx->io_dop = DOP_DONE;
-    pthread_cond_signal (&ctx->io_done);
-    sim_activate (uptr, ctx->asynch_io_latency);
+    if (bytes > 0)
+        req->done += (size_t)bytes;
+    if (((bytes > 0) &&                                 /* short, but not at end of file? */
+         (req->done < req->sects * ((struct disk_context *)req->uptr->disk_ctx)->sector_size)) ||
+        (bytes == -EINTR) || (bytes == -EAGAIN)) {
+        if ((bytes < 0) ||                              /* transient error: the pool blocks */
+            (_disk_ring_inflight >= _disk_ring_entries - 1) ||
+            !_disk_ring_submit (req))                   /* else the rest to the ring */
+            _disk_aio_queue (req);
+        pthread_mutex_unlock (&_disk_aio_lock);
+        continue;
+        }
+    pthread_mutex_unlock (&_disk_aio_lock);
+    req->io_status = _sim_disk_pio_done ((struct disk_context *)req->uptr->disk_ctx, (req->dop == DOP_WSEC),
+                                         req->buf, req->rsects, req->sects, (bytes < 0) ? -1 : (ssize_t)req->done);
+    _disk_aio_complete (req);
     }
-pthread_mutex_unlock (&ctx->io_lock);
+return NULL;
+}
 
-sim_debug (ctx->dbit, ctx->dptr, "_disk_io(unit=%d) exiting\n", (int)(uptr-ctx->dptr->units));
+static void _disk_ring_close (void)
+{
+if (_disk_ring_sqes)
+    munmap (_disk_ring_sqes, _disk_ring_entries * sizeof (struct io_uring_sqe));
+if (_disk_ring_cq_ptr && (_disk_ring_cq_ptr != _disk_ring_sq_ptr))
+    munmap (_disk_ring_cq_ptr, _disk_ring_cq_size);
+if (_disk_ring_sq_ptr)
+    munmap (_disk_ring_sq_ptr, _disk_ring_sq_size);
+close (_disk_ring_fd);
+_disk_ring_fd = -1;
+_disk_ring_sqes = NULL;
+_disk_ring_sq_ptr = _disk_ring_cq_ptr = NULL;
+}
 
-return NULL;
+/* Set up the ring.  Any failure (old kernel, seccomp, memlock limits)
+   simply leaves _disk_ring_fd at -1 and the worker pool does the work. */
+static void _disk_ring_open (void)
+{
+struct io_uring_params p;
+uint8 *sq, *cq;
+
+memset (&p, 0, sizeof (p));
+_disk_ring_fd = (int)syscall (__NR_io_uring_setup, DISK_AIO_RING_ENTRIES, &p);
+if (_disk_ring_fd < 0) {
+    _disk_ring_fd = -1;
+    return;
+    }
+_disk_ring_entries = p.sq_entries;                      /* completion queue is at least as large */
+_disk_ring_sq_size = p.sq_off.array + p.sq_entries * sizeof (unsigned);
+_disk_ring_cq_size = p.cq_off.cqes + p.cq_entries * sizeof (struct io_uring_cqe);
+#if defined (IORING_FEAT_SINGLE_MMAP)
+if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    if (_disk_ring_cq_size > _disk_ring_sq_size)
+        _disk_ring_sq_size = _disk_ring_cq_size;
+    _disk_ring_cq_size = _disk_ring_sq_size;
+    }
+#endif
+_disk_ring_sq_ptr = mmap (NULL, _disk_ring_sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _disk_ring_fd, IORING_OFF_SQ_RING);
+if (_disk_ring_sq_ptr == MAP_FAILED) {
+    _disk_ring_sq_ptr = NULL;
+    _disk_ring_close ();
+    return;
+    }
+#if defined (IORING_FEAT_SINGLE_MMAP)
+if (p.features & IORING_FEAT_SINGLE_MMAP)
+    _disk_ring_cq_ptr = _disk_ring_sq_ptr;
+else
+#endif
+    {
+    _disk_ring_cq_ptr = mmap (NULL, _disk_ring_cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _disk_ring_fd, IORING_OFF_CQ_RING);
+    if (_disk_ring_cq_ptr == MAP_FAILED) {
+        _disk_ring_cq_ptr = NULL;
+        _disk_ring_close ();
+        return;
+        }
+    }
+_disk_ring_sqes = (struct io_uring_sqe *)mmap (NULL, p.sq_entries * sizeof (struct io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _disk_ring_fd, IORING_OFF_SQES);
+if (_disk_ring_sqes == MAP_FAILED) {
+    _disk_ring_sqes = NULL;
+    _disk_ring_close ();
+    return;
+    }
+sq = (uint8 *)_disk_ring_sq_ptr;
+cq = (uint8 *)_disk_ring_cq_ptr;
+_disk_ring_sq_tail = (unsigned *)(sq + p.sq_off.tail);
+_disk_ring_sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+_disk_ring_sq_array = (unsigned *)(sq + p.sq_off.array);
+_disk_ring_cq_head = (unsigned *)(cq + p.cq_off.head);
+_disk_ring_cq_tail = (unsigned *)(cq + p.cq_off.tail);
+_disk_ring_cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+_disk_ring_cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+_disk_ring_inflight = 0;
+if (pthread_create (&_disk_ring_reaper, NULL, _disk_ring_reap, NULL))
+    _disk_ring_close ();
+}
+#endif
+
+/* Start the engine for the first asynchronous unit */
+static t_stat _disk_aio_start (void)
+{
+pthread_attr_t attr;
+
+pthread_mutex_lock (&_disk_aio_lock);
+if (_disk_aio_users++ > 0) {
+    pthread_mutex_unlock (&_disk_aio_lock);
+    return SCPE_OK;
+    }
+_disk_aio_shutdown = FALSE;
+pthread_attr_init (&attr);
+pthread_attr_setscope (&attr, PTHREAD_SCOPE_SYSTEM);
+for (_disk_aio_nthreads = 0; _disk_aio_nthreads < DISK_AIO_THREADS; _disk_aio_nthreads++)
+    if (pthread_create (&_disk_aio_threads[_disk_aio_nthreads], &attr, _disk_aio_worker, NULL))
+        break;
+pthread_attr_destroy (&attr);
+if (_disk_aio_nthreads == 0) {
+    --_disk_aio_users;
+    pthread_mutex_unlock (&_disk_aio_lock);
+    return SCPE_NOFNC;
+    }
+#if defined (SIM_DISK_IO_URING)
+_disk_ring_open ();
+#endif
+pthread_mutex_unlock (&_disk_aio_lock);
+return SCPE_OK;
+}
+
+/* Stop the engine when the last asynchronous unit goes away.  Every unit
+   has drained its requests before getting here. */
+static void _disk_aio_stop (void)
+{
+int i;
+
+pthread_mutex_lock (&_disk_aio_lock);
+if (--_disk_aio_users > 0) {
+    pthread_mutex_unlock (&_disk_aio_lock);
+    return;
+    }
+_disk_aio_shutdown = TRUE;
+pthread_cond_broadcast (&_disk_aio_work);
+#if defined (SIM_DISK_IO_URING)
+if (_disk_ring_fd >= 0) {
+    while (!_disk_ring_submit (NULL)) {                 /* wake the reaper */
+        pthread_mutex_unlock (&_disk_aio_lock);
+        sim_os_ms_sleep (1);
+        pthread_mutex_lock (&_disk_aio_lock);
+        }
+    pthread_mutex_unlock (&_disk_aio_lock);
+    pthread_join (_disk_ring_reaper, NULL);
+    pthread_mutex_lock (&_disk_aio_lock);
+    _disk_ring_close ();
+    }
+#endif
+pthread_mutex_unlock (&_disk_aio_lock);
+for (i = 0; i < _disk_aio_nthreads; i++)
+    pthread_join (_disk_aio_threads[i], NULL);
+_disk_aio_nthreads = 0;
 }
 
+/* Descriptor for a transfer which can be done positionally, or -1 if the
+   request has to go through the synchronous routines */
+static int _disk_aio_fd (UNIT *uptr, int dop, t_lba lba, t_seccnt sects)
+{
+#if defined (SIM_DISK_PIO)
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+if ((DK_GET_FMT (uptr) != DKUF_F_STD) || ctx->overlay)
+    return -1;
+if ((!sim_end) && (ctx->xfer_element_size != sizeof (char)))
+    return -1;                                          /* byte swapping needed */
+switch (dop) {
+    case DOP_RSEC:
+        if ((sects == 1) &&                             /* bad block probe beyond the end? */
+            (lba >= (uptr->capac*ctx->capac_factor)/(ctx->sector_size/((ctx->dptr->flags & DEV_SECTORS) ? 512 : 1))))
+            return -1;
+        return fileno (uptr->fileref);
+    case DOP_WSEC:
+        if (uptr->dynflags & UNIT_DISK_CHK)             /* write address verification */
+            return -1;
+        return fileno (uptr->fileref);
+    }
+#endif
+return -1;
+}
+
+static void _disk_aio_submit (UNIT *uptr, int dop, t_lba lba, uint8 *buf, t_seccnt *rsects, t_seccnt sects, DISK_PCALLBACK callback)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_aio_req *req = (struct disk_aio_req *)calloc (1, sizeof (*req));
+
+sim_debug (ctx->dbit, ctx->dptr, "_disk_aio_submit(op=%d, unit=%d, lba=0x%X, sects=%d)\n", dop, (int)(uptr-ctx->dptr->units), lba, sects);
+
+if (req == NULL) {
+    callback (uptr, SCPE_MEM);
+    return;
+    }
+req->uptr = uptr;
+req->dop = dop;
+req->lba = lba;
+req->buf = buf;
+req->rsects = rsects;
+req->sects = sects;
+req->callback = callback;
+req->fd = _disk_aio_fd (uptr, dop, lba, sects);
+pthread_mutex_lock (&ctx->lock);
+++ctx->io_outstanding;
+pthread_mutex_unlock (&ctx->lock);
+pthread_mutex_lock (&_disk_aio_lock);
+#if defined (SIM_DISK_IO_URING)
+if ((req->fd >= 0) && (_disk_ring_fd >= 0) &&
+    (_disk_ring_inflight < _disk_ring_entries - 1) &&   /* leave room for the shutdown NOP */
+    _disk_ring_submit (req)) {
+    pthread_mutex_unlock (&_disk_aio_lock);
+    return;
+    }
+#endif
+_disk_aio_queue (req);
+pthread_mutex_unlock (&_disk_aio_lock);
+}
+
+#define AIO_CALLSETUP                                               \
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;   \
+                                                                    \
+if ((!callback) || !ctx->asynch_io)
+
+#define AIO_CALL(op, _lba, _buf, _rsects, _sects,  _callback)   \
+    if ((_callback) && ctx->asynch_io)                          \
+        _disk_aio_submit (uptr, op, _lba, _buf, _rsects, _sects, _callback); \
+    else                                                        \
+        if (_callback)                                          \
+            (_callback) (uptr, r);
+
 /* This routine is called in the context of the main simulator thread before
    processing events for any unit. It is only called when an asynchronous
-   thread has called sim_activate() to activate a unit.  The job of this
-   routine is to put the unit in proper condition to digest what may have
-   occurred in the asynchrconous thread.
-  
-   Since disk processing only handles a single I/O at a time to a
-   particular disk device (due to using stdio for the SimH Disk format
-   and stdio doesn't have an atomic seek+(read|write) operation),
-   we have the opportunity to possibly detect improper attempts to
-   issue multiple concurrent I/O requests. */
+   thread has called sim_activate() to activate a unit.  It hands every
+   request which has completed since the last call to its callback, in
+   completion order. */
 static void _disk_completion_dispatch (UNIT *uptr)
 {
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-DISK_PCALLBACK callback = ctx->callback;
-
-sim_debug (ctx->dbit, ctx->dptr, "_disk_completion_dispatch(unit=%d, dop=%d, callback=%p)\n", (int)(uptr-ctx->dptr->units), ctx->io_dop, ctx->callback);
-
-if (ctx->io_dop != DOP_DONE)
-    abort();                                            /* horribly wrong, stop */
+struct disk_aio_req *req, *next;
+DISK_PCALLBACK callback;
+t_stat status;
 
-if (ctx->callback && ctx->io_dop == DOP_DONE) {
-    ctx->callback = NULL;
-    callback (uptr, ctx->io_status);
+if (ctx == NULL)                                        /* detached meanwhile */
+    return;
+pthread_mutex_lock (&ctx->lock);
+req = ctx->done_head;
+ctx->done_head = ctx->done_tail = NULL;
+pthread_mutex_unlock (&ctx->lock);
+
+for (; req; req = next) {
+    next = req->next;
+    callback = req->callback;
+    status = req->io_status;
+    sim_debug (ctx->dbit, ctx->dptr, "_disk_completion_dispatch(unit=%d, dop=%d, callback=%p)\n", (int)(uptr-ctx->dptr->units), req->dop, callback);
+    free (req);
+    callback (uptr, status);
     }
 }
 
@@ -232,24 +713,29 @@ static t_bool _disk_is_active (UNIT *uptr)
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 if (ctx) {
-    sim_debug (ctx->dbit, ctx->dptr, "_disk_is_active(unit=%d, dop=%d)\n", (int)(uptr-ctx->dptr->units), ctx->io_dop);
-    return (ctx->io_dop != DOP_DONE);
+    sim_debug (ctx->dbit, ctx->dptr, "_disk_is_active(unit=%d, outstanding=%d)\n", (int)(uptr-ctx->dptr->units), ctx->io_outstanding);
+    return (ctx->io_outstanding != 0);
     }
 return FALSE;
 }
 
+/* Wait for every outstanding request of a unit to complete */
+static void _disk_aio_drain (struct disk_context *ctx)
+{
+pthread_mutex_lock (&ctx->lock);
+while (ctx->io_outstanding != 0)
+    pthread_cond_wait (&ctx->io_done, &ctx->lock);
+pthread_mutex_unlock (&ctx->lock);
+}
+
 static t_bool _disk_cancel (UNIT *uptr)
 {
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 if (ctx) {
-    sim_debug (ctx->dbit, ctx->dptr, "_disk_cancel(unit=%d, dop=%d)\n", (int)(uptr-ctx->dptr->units), ctx->io_dop);
-    if (ctx->asynch_io) {
-        pthread_mutex_lock (&ctx->io_lock);
-        while (ctx->io_dop != DOP_DONE)
-            pthread_cond_wait (&ctx->io_done, &ctx->io_lock);
-        pthread_mutex_unlock (&ctx->io_lock);
-        }
+    sim_debug (ctx->dbit, ctx->dptr, "_disk_cancel(unit=%d, outstanding=%d)\n", (int)(uptr-ctx->dptr->units), ctx->io_outstanding);
+    if (ctx->asynch_io)
+        _disk_aio_drain (ctx);
     }
 return FALSE;
 }
@@ -288,6 +774,9 @@ static t_stat sim_os_disk_info_raw (FILE *f, uint32 *sector_size, uint32 *remova
 static char *HostPathToVhdPath (const char *szHostPath, char *szVhdPath, size_t VhdPathSize);
 static char *VhdPathToHostPath (const char *szVhdPath, char *szHostPath, size_t HostPathSize);
 static t_offset get_filesystem_size (UNIT *uptr);
+static t_stat _sim_disk_rdsect_base (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects);
+static t_stat _sim_disk_ovl_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects);
+static t_stat _sim_disk_ovl_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects);
 
 struct sim_disk_fmt {
     const char          *name;                          /* name */
@@ -479,25 +968,23 @@ sim_printf ("%s", msg);
 return SCPE_NOFNC;
 #else
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-pthread_attr_t attr;
 
 sim_debug (ctx->dbit, ctx->dptr, "sim_disk_set_async(unit=%d)\n", (int)(uptr-ctx->dptr->units));
 
-ctx->asynch_io = sim_asynch_enabled;
+if (ctx->asynch_io)                                     /* already enabled */
+    return SCPE_OK;
 ctx->asynch_io_latency = latency;
-if (ctx->asynch_io) {
+if (sim_asynch_enabled &&
+    (ctx->map == NULL) &&                               /* mapped transfers are plain memcpy */
+    (_disk_aio_start () == SCPE_OK)) {
+    pthread_mutex_init (&ctx->lock, NULL);
     pthread_mutex_init (&ctx->io_lock, NULL);
-    pthread_cond_init (&ctx->io_cond, NULL);
     pthread_cond_init (&ctx->io_done, NULL);
-    pthread_cond_init (&ctx->startup_cond, NULL);
-    pthread_attr_init(&attr);
-    pthread_attr_setscope(&attr, PTHREAD_SCOPE_SYSTEM);
-    pthread_mutex_lock (&ctx->io_lock);
-    pthread_create (&ctx->io_thread, &attr, _disk_io, (void *)uptr);
-    pthread_attr_destroy(&attr);
-    pthread_cond_wait (&ctx->startup_cond, &ctx->io_lock); /* Wait for thread to stabilize */
-    pthread_mutex_unlock (&ctx->io_lock);
-    pthread_cond_destroy (&ctx->startup_cond);
+    ctx->io_outstanding = 0;
+    ctx->done_head = ctx->done_tail = NULL;
+    if (DK_GET_FMT (uptr) == DKUF_F_STD)
+        fflush (uptr->fileref);                         /* positional I/O from here on */
+    ctx->asynch_io = 1;
     }
 uptr->a_check_completion = _disk_completion_dispatch;
 uptr->a_is_active = _disk_is_active;
@@ -521,13 +1008,12 @@ if (!ctx) return SCPE_UNATT;
 sim_debug (ctx->dbit, ctx->dptr, "sim_disk_clr_async(unit=%d)\n", (int)(uptr-ctx->dptr->units));
 
 if (ctx->asynch_io) {
-    pthread_mutex_lock (&ctx->io_lock);
+    _disk_aio_drain (ctx);
     ctx->asynch_io = 0;
-    pthread_cond_signal (&ctx->io_cond);
-    pthread_mutex_unlock (&ctx->io_lock);
-    pthread_join (ctx->io_thread, NULL);
+    _disk_completion_dispatch (uptr);                   /* deliver what has completed */
+    _disk_aio_stop ();
+    pthread_mutex_destroy (&ctx->lock);
     pthread_mutex_destroy (&ctx->io_lock);
-    pthread_cond_destroy (&ctx->io_cond);
     pthread_cond_destroy (&ctx->io_done);
     }
 return SCPE_OK;
@@ -539,14 +1025,21 @@ return SCPE_OK;
 static t_stat _sim_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
 {
 t_offset da;
-uint32 err, tbc;
+uint32 tbc;
+#if !defined (SIM_DISK_PIO)
+uint32 err;
 size_t i;
+#endif
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 sim_debug (ctx->dbit, ctx->dptr, "_sim_disk_rdsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr-ctx->dptr->units), lba, sects);
 
 da = ((t_offset)lba) * ctx->sector_size;
 tbc = sects * ctx->sector_size;
+#if defined (SIM_DISK_PIO)
+return _sim_disk_pio_done (ctx, FALSE, buf, sectsread, sects,
+                           _sim_disk_pio (fileno (uptr->fileref), FALSE, buf, tbc, da));
+#else
 if (sectsread)
     *sectsread = 0;
 err = sim_fseeko (uptr->fileref, da, SEEK_SET);          /* set pos */
@@ -559,13 +1052,12 @@ if (!err) {
         *sectsread = (t_seccnt)((i*ctx->xfer_element_size+ctx->sector_size-1)/ctx->sector_size);
     }
 return err;
+#endif
 }
 
 t_stat sim_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
 {
-t_stat r;
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-t_seccnt sread = 0;
 
 sim_debug (ctx->dbit, ctx->dptr, "sim_disk_rdsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr-ctx->dptr->units), lba, sects);
 
@@ -576,6 +1068,24 @@ if ((sects == 1) &&                                     /* Single sector reads *
         *sectsread = 1;
     return SCPE_OK;                                     /* return success */
     }
+if (ctx->overlay)                                       /* sparse overlay? */
+    return _sim_disk_ovl_rdsect (uptr, lba, buf, sectsread, sects);
+return _sim_disk_rdsect_base (uptr, lba, buf, sectsread, sects);
+}
+
+/* Read sectors from the container itself (beneath any overlay) */
+
+static t_stat _sim_disk_rdsect_base (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+t_stat r;
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_seccnt sread = 0;
+
+#if defined (SIM_DISK_PIO)
+if (ctx->map &&                                         /* memory mapped? */
+    _sim_disk_map_xfer (uptr, FALSE, lba, buf, sectsread, sects, &r))
+    return r;
+#endif
 
 if ((0 == (ctx->sector_size & (ctx->storage_sector_size - 1))) ||   /* Sector Aligned & whole sector transfers */
     ((0 == ((lba*ctx->sector_size) & (ctx->storage_sector_size - 1))) &&
@@ -641,6 +1151,13 @@ else { /* Unaligned and/or partial sector transfers */
     }
 }
 
+/* Asynchronous sector transfers.  The callback runs in the simulator thread
+   once the transfer is complete.  Requests in flight on the same unit are
+   not ordered against each other: a read issued after a write of the same
+   sectors may complete first and return the old data.  A controller which
+   keeps more than one request per unit in flight must not let their sector
+   ranges overlap.  (The MSCP controller has one transfer per unit in flight.) */
+
 t_stat sim_disk_rdsect_a (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects, DISK_PCALLBACK callback)
 {
 t_stat r = SCPE_OK;
@@ -655,14 +1172,35 @@ return r;
 static t_stat _sim_disk_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
 {
 t_offset da;
-uint32 err, tbc;
+uint32 tbc;
+#if !defined (SIM_DISK_PIO)
+uint32 err;
 size_t i;
+#endif
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 sim_debug (ctx->dbit, ctx->dptr, "_sim_disk_wrsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr-ctx->dptr->units), lba, sects);
 
 da = ((t_offset)lba) * ctx->sector_size;
 tbc = sects * ctx->sector_size;
+#if defined (SIM_DISK_PIO)
+if ((!sim_end) && (ctx->xfer_element_size != sizeof (char))) {
+    uint8 *tbuf = (uint8 *)malloc (tbc);
+    t_stat r;
+
+    if (sectswritten)
+        *sectswritten = 0;
+    if (tbuf == NULL)
+        return SCPE_MEM;
+    sim_buf_copy_swapped (tbuf, buf, ctx->xfer_element_size, tbc/ctx->xfer_element_size);
+    r = _sim_disk_pio_done (ctx, TRUE, tbuf, sectswritten, sects,
+                            _sim_disk_pio (fileno (uptr->fileref), TRUE, tbuf, tbc, da));
+    free (tbuf);
+    return r;
+    }
+return _sim_disk_pio_done (ctx, TRUE, buf, sectswritten, sects,
+                           _sim_disk_pio (fileno (uptr->fileref), TRUE, buf, tbc, da));
+#else
 if (sectswritten)
     *sectswritten = 0;
 err = sim_fseeko (uptr->fileref, da, SEEK_SET);          /* set pos */
@@ -673,6 +1211,7 @@ if (!err) {
         *sectswritten = (t_seccnt)((i*ctx->xfer_element_size+ctx->sector_size-1)/ctx->sector_size);
     }
 return err;
+#endif
 }
 
 t_stat sim_disk_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
@@ -713,6 +1252,13 @@ if (uptr->dynflags & UNIT_DISK_CHK) {
             }
         }
     }
+if (ctx->overlay)                                       /* sparse overlay? */
+    return _sim_disk_ovl_wrsect (uptr, lba, buf, sectswritten, sects);
+#if defined (SIM_DISK_PIO)
+if (ctx->map &&                                         /* memory mapped? */
+    _sim_disk_map_xfer (uptr, TRUE, lba, buf, sectswritten, sects, &r))
+    return r;
+#endif
 if (f == DKUF_F_STD)
     return _sim_disk_wrsect (uptr, lba, buf, sectswritten, sects);
 if ((0 == (ctx->sector_size & (ctx->storage_sector_size - 1))) ||   /* Sector Aligned & whole sector transfers */
@@ -820,6 +1366,419 @@ AIO_CALL(DOP_WSEC, lba, buf, sectswritten, sects, callback);
 return r;
 }
 
+/* Memory mapped containers (ATTACH -P)
+
+   A SIMH or RAW container is mapped shared over its size at attach time
+   (at most the drive size) so sector transfers become memcpy operations
+   against the page cache.  The container is never resized for the
+   mapping: sectors beyond it are transferred through the file as before,
+   and a container which grows by such writes is still mapped only over
+   its original size.  Written data is pushed back with msync when the
+   unit is flushed (the simulator stops, or the unit is detached). */
+
+static t_stat _sim_disk_map (UNIT *uptr)
+{
+#if defined (SIM_DISK_PIO)
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+DEVICE *dptr = ctx->dptr;
+t_offset size = ((t_offset)uptr->capac)*ctx->capac_factor*((dptr->flags & DEV_SECTORS) ? 512 : 1);
+t_offset fsize;
+void *map;
+int fd;
+
+switch (DK_GET_FMT (uptr)) {                            /* case on format */
+    case DKUF_F_STD:                                    /* SIMH format */
+        fflush (uptr->fileref);
+        fd = fileno (uptr->fileref);
+        fsize = sim_fsize_ex (uptr->fileref);
+        break;
+    case DKUF_F_RAW:                                    /* Raw Physical Disk Access */
+        fd = (int)((long)uptr->fileref);
+        fsize = sim_os_disk_size_raw (uptr->fileref);
+        break;
+    default:
+        return sim_messagef (SCPE_NOFNC, "%s: only SIMH and RAW format containers can be memory mapped\n", sim_uname (uptr));
+    }
+if (fsize == (t_offset)-1)
+    fsize = 0;
+if (fsize < size)                                       /* map what's there */
+    size = fsize;
+if ((size == 0) || ((t_offset)((size_t)size) != size))
+    return sim_messagef (SCPE_NOFNC, "%s: container can't be memory mapped\n", sim_uname (uptr));
+map = mmap (NULL, (size_t)size, PROT_READ | ((uptr->flags & UNIT_RO) ? 0 : PROT_WRITE), MAP_SHARED, fd, 0);
+if (map == MAP_FAILED)
+    return sim_messagef (SCPE_NOFNC, "%s: can't memory map container: %s\n", sim_uname (uptr), strerror (errno));
+ctx->map = (uint8 *)map;
+ctx->map_size = size;
+sim_debug (ctx->dbit, ctx->dptr, "_sim_disk_map(unit=%d, size=%" LL_FMT "d)\n", (int)(uptr-ctx->dptr->units), (LL_TYPE)size);
+return SCPE_OK;
+#else
+return sim_messagef (SCPE_NOFNC, "%s: memory mapped containers aren't supported on this host\n", sim_uname (uptr));
+#endif
+}
+
+static void _sim_disk_unmap (UNIT *uptr)
+{
+#if defined (SIM_DISK_PIO)
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+if (ctx->map) {
+    if (!(uptr->flags & UNIT_RO))
+        msync (ctx->map, (size_t)ctx->map_size, MS_SYNC);
+    munmap (ctx->map, (size_t)ctx->map_size);
+    ctx->map = NULL;
+    ctx->map_size = 0;
+    }
+#endif
+}
+
+/* Sparse copy-on-write overlays (ATTACH -S)
+
+   An overlay file holds the sectors a simulator has written on top of a
+   base container (SIMH, RAW or VHD) which is only ever opened read only,
+   so many simulators can share one golden image.  The file is
+
+       header                      512 bytes, struct disk_overlay_header
+       block bitmap                one bit per block, 1 = block in overlay
+       data                        block n at data_offset + n * block_size
+
+   Blocks are a whole number of sectors of about 4KB.  The data area is
+   addressed directly by block number and never written for blocks that
+   are not present, so on file systems with sparse files the overlay only
+   occupies the space of what has been written and creating one is just
+   writing the header and an empty bitmap.  The bitmap is kept in memory
+   (an O(1) test per block).  Its changed bytes are written back when the
+   unit is flushed (the simulator stops, or the unit is detached), after
+   the data has been synced, so after a host crash the bitmap on disk
+   never marks a block whose data didn't make it; blocks copied up since
+   the last flush read from the base again.  Data in the overlay is kept
+   in container (little endian) order like SIMH format.
+
+   The header names the base container, so an overlay can be attached by
+   its own name later (including by RESTORE).  ATTACH -M on an overlay
+   writes the present blocks back into the base and deletes the overlay. */
+
+#define DISK_OVERLAY_MAGIC      "SIMHOVL1"
+#define DISK_OVERLAY_HDR_SIZE   512
+#define DISK_OVERLAY_BLOCK      4096
+
+struct disk_overlay_header {
+    char                magic[8];
+    uint32              sector_size;
+    uint32              block_size;         /* bytes per block */
+    uint32              block_count;
+    uint32              size_lo;            /* drive size in bytes */
+    uint32              size_hi;
+    uint32              data_offset;        /* start of block 0 */
+    char                base[DISK_OVERLAY_HDR_SIZE - 8 - 6*sizeof (uint32)];/* base container name */
+    };
+
+struct disk_overlay {
+    FILE                *file;
+    uint32              block_size;
+    t_seccnt            spb;                /* sectors per block */
+    uint32              block_count;
+    t_offset            data_offset;
+    uint8               *bitmap;
+    uint32              dirty_lo;           /* bitmap bytes dirty_lo..dirty_hi-1 */
+    uint32              dirty_hi;           /* not yet written back */
+    uint8               *scratch;           /* one block */
+    };
+
+#define OVL_PRESENT(o, b)   ((o)->bitmap[(b) >> 3] & (1 << ((b) & 7)))
+
+static t_stat _sim_disk_ovl_io (struct disk_overlay *ovl, t_bool write, uint8 *buf, size_t bytes, t_offset pos)
+{
+size_t xfered;
+
+#if defined (SIM_DISK_PIO)
+ssize_t n = _sim_disk_pio (fileno (ovl->file), write, buf, bytes, pos);
+
+if (n < 0)
+    return SCPE_IOERR;
+xfered = (size_t)n;
+#else
+if (sim_fseeko (ovl->file, pos, SEEK_SET))
+    return SCPE_IOERR;
+xfered = write ? fwrite (buf, 1, bytes, ovl->file) : fread (buf, 1, bytes, ovl->file);
+if (ferror (ovl->file))
+    return SCPE_IOERR;
+#endif
+if (xfered < bytes) {
+    if (write)
+        return SCPE_IOERR;
+    memset (buf + xfered, 0, bytes - xfered);
+    }
+return SCPE_OK;
+}
+
+/* Write buffered data through to the disk */
+static t_stat _sim_disk_sync_file (FILE *f)
+{
+if (fflush (f))
+    return SCPE_IOERR;
+#if defined (_WIN32)
+return _commit (_fileno (f)) ? SCPE_IOERR : SCPE_OK;
+#else
+return fsync (fileno (f)) ? SCPE_IOERR : SCPE_OK;
+#endif
+}
+
+/* Header fields are little endian on disk */
+static void _sim_disk_ovl_swap_header (struct disk_overlay_header *hdr)
+{
+sim_buf_swap_data (&hdr->sector_size, sizeof (uint32), 6);
+}
+
+static void _sim_disk_ovl_free (struct disk_overlay *ovl)
+{
+if (ovl->file)
+    fclose (ovl->file);
+free (ovl->bitmap);
+free (ovl->scratch);
+free (ovl);
+}
+
+/* Open an overlay, reading its header (into hdr) and bitmap */
+static t_stat _sim_disk_ovl_open (const char *name, const char *mode, struct disk_overlay **povl, struct disk_overlay_header *hdr)
+{
+struct disk_overlay *ovl = (struct disk_overlay *)calloc (1, sizeof (*ovl));
+t_offset size;
+
+*povl = NULL;
+if (ovl == NULL)
+    return SCPE_MEM;
+ovl->file = sim_fopen (name, mode);
+if ((ovl->file == NULL) ||
+    (_sim_disk_ovl_io (ovl, FALSE, (uint8 *)hdr, sizeof (*hdr), 0) != SCPE_OK) ||
+    memcmp (hdr->magic, DISK_OVERLAY_MAGIC, sizeof (hdr->magic))) {
+    _sim_disk_ovl_free (ovl);
+    return SCPE_OPENERR;
+    }
+_sim_disk_ovl_swap_header (hdr);
+hdr->base[sizeof (hdr->base) - 1] = '\0';
+size = (((t_offset)hdr->size_hi) << 32) | hdr->size_lo;
+if ((hdr->sector_size == 0) || (hdr->block_size % hdr->sector_size) ||
+    (hdr->block_count != (uint32)((size + hdr->block_size - 1) / hdr->block_size)) ||
+    (hdr->data_offset < DISK_OVERLAY_HDR_SIZE + (hdr->block_count + 7) / 8)) {
+    _sim_disk_ovl_free (ovl);
+    return SCPE_OPENERR;
+    }
+ovl->block_size = hdr->block_size;
+ovl->spb = hdr->block_size / hdr->sector_size;
+ovl->block_count = hdr->block_count;
+ovl->data_offset = hdr->data_offset;
+ovl->bitmap = (uint8 *)calloc ((ovl->block_count + 7) / 8, 1);
+ovl->scratch = (uint8 *)malloc (ovl->block_size);
+if ((ovl->bitmap == NULL) || (ovl->scratch == NULL)) {
+    _sim_disk_ovl_free (ovl);
+    return SCPE_MEM;
+    }
+if (_sim_disk_ovl_io (ovl, FALSE, ovl->bitmap, (ovl->block_count + 7) / 8, DISK_OVERLAY_HDR_SIZE) != SCPE_OK) {
+    _sim_disk_ovl_free (ovl);
+    return SCPE_IOERR;
+    }
+*povl = ovl;
+return SCPE_OK;
+}
+
+/* Create an empty overlay for a drive of size bytes */
+static t_stat _sim_disk_ovl_create (const char *name, const char *base, uint32 sector_size, t_offset size)
+{
+struct disk_overlay_header hdr;
+uint32 block_size = (sector_size >= DISK_OVERLAY_BLOCK) ? sector_size : (DISK_OVERLAY_BLOCK / sector_size) * sector_size;
+uint32 block_count = (uint32)((size + block_size - 1) / block_size);
+uint32 bitmap_bytes = (block_count + 7) / 8;
+uint8 *bitmap = (uint8 *)calloc (bitmap_bytes ? bitmap_bytes : 1, 1);
+FILE *f;
+t_stat r = SCPE_OK;
+
+if (bitmap == NULL)
+    return SCPE_MEM;
+if (strlen (base) >= sizeof (hdr.base)) {
+    free (bitmap);
+    return sim_messagef (SCPE_ARG, "Overlay base name too long: %s\n", base);
+    }
+memset (&hdr, 0, sizeof (hdr));
+memcpy (hdr.magic, DISK_OVERLAY_MAGIC, sizeof (hdr.magic));
+hdr.sector_size = sector_size;
+hdr.block_size = block_size;
+hdr.block_count = block_count;
+hdr.size_lo = (uint32)size;
+hdr.size_hi = (uint32)(size >> 32);
+hdr.data_offset = ((DISK_OVERLAY_HDR_SIZE + bitmap_bytes + block_size - 1) / block_size) * block_size;
+strcpy (hdr.base, base);
+_sim_disk_ovl_swap_header (&hdr);
+f = sim_fopen (name, "wb");
+if (f == NULL) {
+    free (bitmap);
+    return SCPE_OPENERR;
+    }
+if ((fwrite (&hdr, sizeof (hdr), 1, f) != 1) ||
+    (bitmap_bytes && (fwrite (bitmap, bitmap_bytes, 1, f) != 1)))
+    r = SCPE_IOERR;
+if (fclose (f))
+    r = SCPE_IOERR;
+free (bitmap);
+if (r != SCPE_OK)
+    (void)remove (name);
+return r;
+}
+
+/* Mark a block present, the file's bitmap follows at the next flush */
+static void _sim_disk_ovl_set (struct disk_overlay *ovl, uint32 blk)
+{
+ovl->bitmap[blk >> 3] |= (1 << (blk & 7));
+if (ovl->dirty_lo == ovl->dirty_hi) {
+    ovl->dirty_lo = blk >> 3;
+    ovl->dirty_hi = (blk >> 3) + 1;
+    }
+else {
+    if ((blk >> 3) < ovl->dirty_lo)
+        ovl->dirty_lo = blk >> 3;
+    if ((blk >> 3) >= ovl->dirty_hi)
+        ovl->dirty_hi = (blk >> 3) + 1;
+    }
+}
+
+/* Sync the overlay's data, then write back and sync the changed bitmap bytes */
+static t_stat _sim_disk_ovl_flush (struct disk_overlay *ovl)
+{
+t_stat r = _sim_disk_sync_file (ovl->file);
+
+if ((r == SCPE_OK) && (ovl->dirty_lo != ovl->dirty_hi)) {
+    r = _sim_disk_ovl_io (ovl, TRUE, &ovl->bitmap[ovl->dirty_lo], ovl->dirty_hi - ovl->dirty_lo, DISK_OVERLAY_HDR_SIZE + ovl->dirty_lo);
+    if (r == SCPE_OK)
+        r = _sim_disk_sync_file (ovl->file);
+    if (r == SCPE_OK)
+        ovl->dirty_lo = ovl->dirty_hi = 0;
+    }
+return r;
+}
+
+static t_stat _sim_disk_ovl_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_overlay *ovl = ctx->overlay;
+t_seccnt done = 0, n;
+uint32 blk;
+t_stat r = SCPE_OK;
+
+if (sectsread)
+    *sectsread = 0;
+while ((r == SCPE_OK) && (done < sects)) {
+    blk = (lba + done) / ovl->spb;
+    n = ovl->spb - ((lba + done) % ovl->spb);
+    if ((blk < ovl->block_count) && OVL_PRESENT (ovl, blk)) {
+        while ((done + n < sects) && (blk + 1 < ovl->block_count) && OVL_PRESENT (ovl, blk + 1)) {
+            n += ovl->spb;                              /* run of present blocks */
+            ++blk;
+            }
+        if (n > sects - done)
+            n = sects - done;
+        r = _sim_disk_ovl_io (ovl, FALSE, buf + done * ctx->sector_size, n * ctx->sector_size,
+                              ovl->data_offset + ((t_offset)(lba + done)) * ctx->sector_size);
+        sim_buf_swap_data (buf + done * ctx->sector_size, ctx->xfer_element_size, (n * ctx->sector_size) / ctx->xfer_element_size);
+        }
+    else {
+        while ((done + n < sects) && (blk + 1 < ovl->block_count) && !OVL_PRESENT (ovl, blk + 1)) {
+            n += ovl->spb;                              /* run from the base */
+            ++blk;
+            }
+        if (n > sects - done)
+            n = sects - done;
+        r = _sim_disk_rdsect_base (uptr, lba + done, buf + done * ctx->sector_size, NULL, n);
+        }
+    if (r == SCPE_OK)
+        done += n;
+    }
+if (sectsread)
+    *sectsread = done;
+return r;
+}
+
+static t_stat _sim_disk_ovl_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_overlay *ovl = ctx->overlay;
+t_seccnt done = 0, n, off;
+uint32 blk;
+uint8 *src;
+t_stat r = SCPE_OK;
+
+if (sectswritten)
+    *sectswritten = 0;
+while ((r == SCPE_OK) && (done < sects)) {
+    blk = (lba + done) / ovl->spb;
+    off = (lba + done) % ovl->spb;
+    n = ovl->spb - off;
+    if (n > sects - done)
+        n = sects - done;
+    if (blk >= ovl->block_count)                        /* beyond the drive */
+        return SCPE_IOERR;
+    if (!OVL_PRESENT (ovl, blk) && (n < ovl->spb)) {    /* partial block: copy up from the base */
+        r = _sim_disk_rdsect_base (uptr, blk * ovl->spb, ovl->scratch, NULL, ovl->spb);
+        if (r != SCPE_OK)
+            break;
+        memcpy (ovl->scratch + off * ctx->sector_size, buf + done * ctx->sector_size, n * ctx->sector_size);
+        sim_buf_swap_data (ovl->scratch, ctx->xfer_element_size, ovl->block_size / ctx->xfer_element_size);
+        r = _sim_disk_ovl_io (ovl, TRUE, ovl->scratch, ovl->block_size, ovl->data_offset + ((t_offset)blk) * ovl->block_size);
+        }
+    else {
+        src = buf + done * ctx->sector_size;
+        if ((!sim_end) && (ctx->xfer_element_size != sizeof (char))) {
+            sim_buf_copy_swapped (ovl->scratch, src, ctx->xfer_element_size, (n * ctx->sector_size) / ctx->xfer_element_size);
+            src = ovl->scratch;
+            }
+        r = _sim_disk_ovl_io (ovl, TRUE, src, n * ctx->sector_size, ovl->data_offset + ((t_offset)(lba + done)) * ctx->sector_size);
+        }
+    if ((r == SCPE_OK) && !OVL_PRESENT (ovl, blk))
+        _sim_disk_ovl_set (ovl, blk);
+    if (r == SCPE_OK)
+        done += n;
+    }
+if (sectswritten)
+    *sectswritten = done;
+return r;
+}
+
+/* Write every block present in the overlay back into the attached base */
+static t_stat _sim_disk_ovl_merge (UNIT *uptr, struct disk_overlay *ovl)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_lba total = (t_lba)((((t_offset)uptr->capac)*ctx->capac_factor*((ctx->dptr->flags & DEV_SECTORS) ? 512 : 1))/ctx->sector_size);
+uint32 blk, merged = 0;
+t_seccnt n;
+t_stat r = SCPE_OK;
+
+for (blk = 0; (r == SCPE_OK) && (blk < ovl->block_count); blk++) {
+    if (!OVL_PRESENT (ovl, blk) || (blk * ovl->spb >= total))
+        continue;
+    n = ((blk + 1) * ovl->spb <= total) ? ovl->spb : (t_seccnt)(total - blk * ovl->spb);
+    r = _sim_disk_ovl_io (ovl, FALSE, ovl->scratch, n * ctx->sector_size, ovl->data_offset + ((t_offset)blk) * ovl->block_size);
+    if (r == SCPE_OK) {
+        sim_buf_swap_data (ovl->scratch, ctx->xfer_element_size, (n * ctx->sector_size) / ctx->xfer_element_size);
+        r = sim_disk_wrsect (uptr, blk * ovl->spb, ovl->scratch, NULL, n);
+        }
+    ++merged;
+    }
+if (r == SCPE_OK)                                       /* base on disk before the overlay goes */
+    switch (DK_GET_FMT (uptr)) {
+        case DKUF_F_STD:
+            r = _sim_disk_sync_file (uptr->fileref);
+            break;
+        case DKUF_F_VHD:
+            sim_vhd_disk_flush (uptr->fileref);
+            break;
+        case DKUF_F_RAW:
+            sim_os_disk_flush_raw (uptr->fileref);
+            break;
+        }
+if (r == SCPE_OK)
+    sim_messagef (SCPE_OK, "%s: Merged %u blocks of %u bytes into %s\n", sim_uname (uptr), merged, ovl->block_size, uptr->filename);
+return r;
+}
+
 t_stat sim_disk_unload (UNIT *uptr)
 {
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
@@ -845,14 +1804,23 @@ switch (DK_GET_FMT (uptr)) {                            /* case on format */
 static void _sim_disk_io_flush (UNIT *uptr)
 {
 uint32 f = DK_GET_FMT (uptr);
-
-#if defined (SIM_ASYNCH_IO)
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
-sim_disk_clr_async (uptr);
-if (sim_asynch_enabled)
-    sim_disk_set_async (uptr, ctx->asynch_io_latency);
+#if defined (SIM_ASYNCH_IO)
+if (ctx->asynch_io && sim_asynch_enabled)
+    _disk_aio_drain (ctx);                              /* writes are in the container */
+else {
+    sim_disk_clr_async (uptr);
+    if (sim_asynch_enabled)
+        sim_disk_set_async (uptr, ctx->asynch_io_latency);
+    }
 #endif
+#if defined (SIM_DISK_PIO)
+if (ctx->map && !(uptr->flags & UNIT_RO))
+    msync (ctx->map, (size_t)ctx->map_size, MS_SYNC);   /* write back mapped sectors */
+#endif
+if (ctx->overlay && !(uptr->flags & UNIT_RO))
+    _sim_disk_ovl_flush (ctx->overlay);
 switch (f) {                                            /* case on format */
     case DKUF_F_STD:                                    /* Simh */
         fflush (uptr->fileref);
@@ -1322,6 +2290,106 @@ for (i = 0; checks[i] != NULL; i++) {
 return ret_val;
 }
 
+static t_bool _sim_disk_is_overlay (const char *cptr)
+{
+char gbuf[CBUFSIZE], magic[sizeof (DISK_OVERLAY_MAGIC) - 1];
+FILE *f;
+t_bool r = FALSE;
+
+get_glyph_nc (cptr, gbuf, 0);                           /* get spec */
+f = sim_fopen (gbuf, "rb");
+if (f) {
+    r = (fread (magic, sizeof (magic), 1, f) == 1) && (memcmp (magic, DISK_OVERLAY_MAGIC, sizeof (magic)) == 0);
+    fclose (f);
+    }
+return r;
+}
+
+/* Attach a sparse overlay: "overlay {base}".  The base is attached read
+   only, then the overlay is opened (or created) on top of it. */
+
+static t_stat _sim_disk_attach_overlay (UNIT *uptr, const char *cptr, size_t sector_size, size_t xfer_element_size, t_bool dontautosize,
+                                        uint32 dbit, const char *dtype, uint32 pdp11tracksize, int completion_delay)
+{
+char name[CBUFSIZE], base[CBUFSIZE];
+struct disk_overlay_header hdr;
+struct disk_overlay *ovl = NULL;
+struct disk_context *ctx;
+int32 saved_switches = sim_switches;
+int32 saved_quiet = sim_quiet;
+t_bool merge = ((sim_switches & SWMASK ('M')) != 0);
+t_bool read_only = ((sim_switches & SWMASK ('R')) != 0) && !merge;
+t_offset size;
+FILE *f;
+t_stat r;
+
+cptr = get_glyph_nc (cptr, name, 0);                    /* overlay name */
+get_glyph_nc (cptr, base, 0);                           /* optional base container */
+f = sim_fopen (name, "rb");
+if (f) {                                                /* existing overlay? */
+    fclose (f);
+    r = _sim_disk_ovl_open (name, read_only ? "rb" : "rb+", &ovl, &hdr);
+    if (r != SCPE_OK)
+        return sim_messagef (r, "%s: %s is not a usable disk overlay\n", sim_uname (uptr), name);
+    if (base[0] == '\0')
+        strcpy (base, hdr.base);
+    }
+else {
+    if (merge || (sim_switches & SWMASK ('E')))         /* must exist? */
+        return SCPE_OPENERR;
+    if (base[0] == '\0')
+        return SCPE_2FARG;
+    }
+if (_sim_disk_is_overlay (base)) {
+    if (ovl)
+        _sim_disk_ovl_free (ovl);
+    return sim_messagef (SCPE_ARG, "%s: the base of an overlay can't be an overlay\n", sim_uname (uptr));
+    }
+sim_switches &= ~(SWMASK ('S') | SWMASK ('M') | SWMASK ('P') | SWMASK ('D') | SWMASK ('C'));
+sim_switches |= SWMASK ('E');                           /* base must exist */
+if (!merge)
+    sim_switches |= SWMASK ('R');                       /* and is never written */
+sim_quiet = 1;
+r = sim_disk_attach (uptr, base, sector_size, xfer_element_size, dontautosize, dbit, dtype, pdp11tracksize, completion_delay);
+sim_quiet = saved_quiet;
+sim_switches = saved_switches;
+if (r != SCPE_OK) {
+    if (ovl)
+        _sim_disk_ovl_free (ovl);
+    return sim_messagef (r, "%s: can't attach overlay base %s\n", sim_uname (uptr), base);
+    }
+ctx = (struct disk_context *)uptr->disk_ctx;
+size = ((t_offset)uptr->capac)*ctx->capac_factor*((ctx->dptr->flags & DEV_SECTORS) ? 512 : 1);
+if (ovl == NULL) {
+    r = _sim_disk_ovl_create (name, base, ctx->sector_size, size);
+    if (r == SCPE_OK)
+        r = _sim_disk_ovl_open (name, "rb+", &ovl, &hdr);
+    if (r != SCPE_OK) {
+        sim_disk_detach (uptr);
+        return sim_messagef (r, "%s: can't create overlay %s\n", sim_uname (uptr), name);
+        }
+    sim_messagef (SCPE_OK, "%s: creating new overlay on %s\n", sim_uname (uptr), base);
+    }
+if ((hdr.sector_size != ctx->sector_size) ||
+    (size != ((((t_offset)hdr.size_hi) << 32) | hdr.size_lo))) {
+    _sim_disk_ovl_free (ovl);
+    sim_disk_detach (uptr);
+    return sim_messagef (SCPE_INCOMP, "%s: overlay %s doesn't match the drive size of %s\n", sim_uname (uptr), name, base);
+    }
+if (merge) {                                            /* write back and drop the overlay */
+    r = _sim_disk_ovl_merge (uptr, ovl);
+    _sim_disk_ovl_free (ovl);
+    if (r == SCPE_OK)
+        (void)remove (name);
+    return r;
+    }
+ctx->overlay = ovl;
+strlcpy (uptr->filename, name, CBUFSIZE);               /* reattach (RESTORE) by overlay name */
+if (!read_only)
+    uptr->flags &= ~UNIT_RO;                            /* writes go to the overlay */
+return SCPE_OK;
+}
+
 t_stat sim_disk_attach (UNIT *uptr, const char *cptr, size_t sector_size, size_t xfer_element_size, t_bool dontautosize,
                         uint32 dbit, const char *dtype, uint32 pdp11tracksize, int completion_delay)
 {
@@ -1334,6 +2402,7 @@ t_offset (*size_function)(FILE *file);
 t_stat (*storage_function)(FILE *file, uint32 *sector_size, uint32 *removable, uint32 *is_cdrom) = NULL;
 t_bool created = FALSE, copied = FALSE;
 t_bool auto_format = FALSE;
+t_bool map_container;
 t_offset capac, filesystem_capac;
 
 if (uptr->flags & UNIT_DIS)                             /* disabled? */
@@ -1352,6 +2421,9 @@ if (sim_switches & SWMASK ('F')) {                      /* format spec? */
     sim_switches = sim_switches & ~(SWMASK ('F'));      /* Record Format specifier already processed */
     auto_format = TRUE;
     }
+if ((sim_switches & SWMASK ('S')) ||                    /* sparse overlay? */
+    _sim_disk_is_overlay (cptr))
+    return _sim_disk_attach_overlay (uptr, cptr, sector_size, xfer_element_size, dontautosize, dbit, dtype, pdp11tracksize, completion_delay);
 if (sim_switches & SWMASK ('D')) {                      /* create difference disk? */
     char gbuf[CBUFSIZE];
     FILE *vhd;
@@ -1514,6 +2586,7 @@ else
             }
         return SCPE_ARG;
         }
+map_container = ((sim_switches & SWMASK ('P')) != 0);  /* memory map container? */
 
 switch (DK_GET_FMT (uptr)) {                            /* case on format */
     case DKUF_F_STD:                                    /* SIMH format */
@@ -1769,6 +2842,8 @@ if (capac && (capac != (t_offset)-1)) {
         }
     }
 
+if (map_container)
+    _sim_disk_map (uptr);                               /* stays unmapped if that fails */
 #if defined (SIM_ASYNCH_IO)
 sim_disk_set_async (uptr, completion_delay);
 #endif
@@ -1817,6 +2892,11 @@ if (uptr->io_flush)
     uptr->io_flush (uptr);                              /* flush buffered data */
 
 sim_disk_clr_async (uptr);
+_sim_disk_unmap (uptr);
+if (ctx->overlay) {
+    _sim_disk_ovl_free (ctx->overlay);
+    ctx->overlay = NULL;
+    }
 
 uptr->flags &= ~(UNIT_ATT | UNIT_RO);
 uptr->dynflags &= ~(UNIT_NO_FIO | UNIT_DISK_CHK);
@@ -1890,7 +2970,18 @@ fprintf (st, "    -X          When creating a VHD, create a fixed sized VHD (vs
 fprintf (st, "                expanding one).\n");
 fprintf (st, "    -D          Create a Differencing VHD (relative to an already existing VHD\n");
 fprintf (st, "                disk)\n");
-fprintf (st, "    -M          Merge a Differencing VHD into its parent VHD disk\n");
+fprintf (st, "    -M          Merge a Differencing VHD into its parent VHD disk.  On a\n");
+fprintf (st, "                sparse overlay, write the overlay's sectors back to its base\n");
+fprintf (st, "                and delete the overlay.\n");
+fprintf (st, "    -P          Memory map a SIMH or RAW container: sector transfers are\n");
+fprintf (st, "                copied to and from the mapping and written data is synced\n");
+fprintf (st, "                to the container when the simulator stops or the disk is\n");
+fprintf (st, "                detached.  Only the container's size at attach time is\n");
+fprintf (st, "                mapped, the container isn't resized.\n");
+fprintf (st, "    -S          Attach a sparse copy-on-write overlay on a base container\n");
+fprintf (st, "                (ATTACH -S DK0 overlay base).  The base is only read; writes\n");
+fprintf (st, "                go to the overlay, which is created if it doesn't exist.  An\n");
+fprintf (st, "                existing overlay can be attached by name alone.\n");
 fprintf (st, "    -O          Override consistency checks when attaching differencing disks\n");
 fprintf (st, "                which have unexpected parent disk GUID or timestamps\n\n");
 fprintf (st, "    -U          Fix inconsistencies which are overridden by the -O switch\n");
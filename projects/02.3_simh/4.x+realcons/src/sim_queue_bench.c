@@ -0,0 +1,387 @@
+/* sim_queue_bench.c: event queue micro-benchmark
+
+   Copyright (c) 2026, agent
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+   THE AUTHOR BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+   IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+   Except as contained in this notice, the name of the author shall not be
+   used in advertising or otherwise to promote the sale, use or other dealings
+   in this Software without prior written authorization from the author.
+
+   17-Oct-26    agent   created
+
+   Schedules, cancels and processes events with the heap of scp.c and with
+   a copy of the former delta time linked list ("list" below), driven by
+   the same pseudo random operations:
+
+        activate_abs    42%
+        activate        12%     mostly within 0..2 instructions: equal times
+        cancel          12%
+        activate_time   12%
+        none            22%
+
+   Between operations the instruction counter runs down by 0..39.
+   Fired actions reschedule their unit in 3 of 4 cases.
+   Both queues must fire the same units at the same sim_grtime() and report
+   the same activation times: a hash over this trace is compared.
+   The run time of both is printed for 50, 500 and 5000 active units.
+
+   Built from scp.c and the other simh core files, with a machine of its
+   own below (no CPU, one device).  SIM_QUEUE_BENCH leaves out the main()
+   of scp.c:
+
+        make queue_bench
+
+   call: sim_queue_bench [operations] [seed]
+   Exit code 0 if heap and list traces are equal.
+*/
+
+#include "sim_defs.h"
+#include <time.h>
+
+#define QB_MAX_UNITS    5000
+#define QB_MAX_DELAY    50000
+
+/* the machine scp.c needs: nothing runs, only the event queue is used */
+
+char sim_name[] = "QUEUE BENCH";
+int32 sim_emax = 1;
+static t_value qb_pc;
+static REG qb_reg[] = { { ORDATA (PC, qb_pc, 16) }, { NULL } };
+static UNIT qb_cpu_unit = { UDATA (NULL, 0, 0) };
+static DEVICE qb_cpu_dev = {
+    "CPU", &qb_cpu_unit, qb_reg, NULL,
+    1, 8, 16, 1, 8, 16,
+    NULL, NULL, NULL,
+    NULL, NULL, NULL
+    };
+REG *sim_PC = &qb_reg[0];
+DEVICE *sim_devices[] = { &qb_cpu_dev, NULL };
+const char *sim_stop_messages[SCPE_BASE] = { "Unknown error" };
+
+t_stat sim_instr (void)
+{
+return SCPE_STOP;
+}
+
+t_stat sim_load (FILE *fileref, CONST char *cptr, CONST char *fnam, int flag)
+{
+return SCPE_NOFNC;
+}
+
+t_stat fprint_sym (FILE *ofile, t_addr addr, t_value *val, UNIT *uptr, int32 sw)
+{
+return SCPE_ARG;
+}
+
+t_stat parse_sym (CONST char *cptr, t_addr addr, UNIT *uptr, t_value *val, int32 sw)
+{
+return SCPE_ARG;
+}
+
+/* former delta time list, as in scp.c up to 2018 */
+
+typedef struct list_unit LIST_UNIT;
+struct list_unit {
+    LIST_UNIT           *next;                          /* NULL if inactive */
+    int32               time;                           /* delta to predecessor */
+    };
+
+#define LIST_END        ((LIST_UNIT *) 1)
+
+static LIST_UNIT *list_queue = LIST_END;
+static int32 list_interval;
+static int32 list_noqueue_time;
+static uint32 list_rtime;
+
+/* the heap side uses the real scp state */
+
+static UNIT qb_units[QB_MAX_UNITS];
+static LIST_UNIT qb_list_units[QB_MAX_UNITS];
+static uint32 qb_random;
+static uint32 qb_trace;
+static uint32 qb_rtime_base;                            /* sim_grtime() at start */
+static t_uint64 qb_fired;
+
+static uint32 qb_rnd (void)
+{
+qb_random ^= qb_random << 13;
+qb_random ^= qb_random >> 17;
+qb_random ^= qb_random << 5;
+return qb_random;
+}
+
+static void qb_mix (uint32 v)
+{
+qb_trace = (qb_trace ^ v) * 16777619u;
+}
+
+static double qb_now (void)
+{
+struct timespec ts;
+
+clock_gettime (CLOCK_MONOTONIC, &ts);
+return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void list_update_time (void)
+{
+int32 x;
+
+x = (list_queue == LIST_END) ? list_noqueue_time : list_queue->time;
+list_rtime = list_rtime + ((uint32) (x - list_interval));
+if (list_queue == LIST_END)
+    list_noqueue_time = list_interval;
+else
+    list_queue->time = list_interval;
+}
+
+static uint32 list_grtime (void)
+{
+list_update_time ();
+return list_rtime;
+}
+
+static void list_activate (LIST_UNIT *uptr, int32 event_time)
+{
+LIST_UNIT *cptr, *prvptr;
+int32 accum;
+
+if (uptr->next)                                         /* already active? */
+    return;
+list_update_time ();
+prvptr = NULL;
+accum = 0;
+for (cptr = list_queue; cptr != LIST_END; cptr = cptr->next) {
+    if (event_time < (accum + cptr->time))
+        break;
+    accum = accum + cptr->time;
+    prvptr = cptr;
+    }
+if (prvptr == NULL) {                                   /* insert at head */
+    cptr = uptr->next = list_queue;
+    list_queue = uptr;
+    }
+else {
+    cptr = uptr->next = prvptr->next;                   /* insert at prvptr */
+    prvptr->next = uptr;
+    }
+uptr->time = event_time - accum;
+if (cptr != LIST_END)
+    cptr->time = cptr->time - uptr->time;
+list_interval = list_queue->time;
+}
+
+static void list_cancel (LIST_UNIT *uptr)
+{
+LIST_UNIT *cptr, *nptr;
+
+if (list_queue == LIST_END)
+    return;
+list_update_time ();
+if (!uptr->next)
+    return;
+nptr = LIST_END;
+if (list_queue == uptr)
+    nptr = list_queue = uptr->next;
+else {
+    for (cptr = list_queue; cptr != LIST_END; cptr = cptr->next) {
+        if (cptr->next == uptr) {
+            nptr = cptr->next = uptr->next;
+            break;
+            }
+        }
+    }
+if (nptr != LIST_END)
+    nptr->time += uptr->time;
+uptr->next = NULL;
+uptr->time = 0;
+if (list_queue != LIST_END)
+    list_interval = list_queue->time;
+else list_interval = list_noqueue_time = NOQUEUE_WAIT;
+}
+
+static int32 list_activate_time (LIST_UNIT *uptr)
+{
+LIST_UNIT *cptr;
+int32 accum;
+
+accum = 0;
+for (cptr = list_queue; cptr != LIST_END; cptr = cptr->next) {
+    if (cptr == list_queue) {
+        if (list_interval > 0)
+            accum = accum + list_interval;
+        }
+    else
+        accum = accum + cptr->time;
+    if (cptr == uptr)
+        return accum + 1;
+    }
+return 0;
+}
+
+static void list_action (LIST_UNIT *uptr);
+
+static void list_process_event (void)
+{
+LIST_UNIT *uptr;
+
+list_update_time ();
+if (list_queue == LIST_END) {
+    list_interval = list_noqueue_time = NOQUEUE_WAIT;
+    return;
+    }
+do {
+    uptr = list_queue;
+    list_queue = uptr->next;
+    uptr->next = NULL;
+    uptr->time = 0;
+    if (list_queue != LIST_END)
+        list_interval = list_queue->time;
+    else
+        list_interval = list_noqueue_time = NOQUEUE_WAIT;
+    list_action (uptr);
+    } while ((list_interval <= 0) && (list_queue != LIST_END));
+if (list_queue == LIST_END)
+    list_interval = list_noqueue_time = NOQUEUE_WAIT;
+}
+
+/* unit actions: record, reschedule in 3 of 4 cases */
+
+static void list_action (LIST_UNIT *uptr)
+{
+qb_fired++;
+qb_mix ((uint32) (uptr - qb_list_units));
+qb_mix (list_grtime ());
+if (qb_rnd () % 4)
+    list_activate (uptr, qb_rnd () % QB_MAX_DELAY);
+}
+
+static t_stat heap_action (UNIT *uptr)
+{
+qb_fired++;
+qb_mix ((uint32) (uptr - qb_units));
+qb_mix (sim_grtime () - qb_rtime_base);
+if (qb_rnd () % 4)
+    sim_activate (uptr, qb_rnd () % QB_MAX_DELAY);
+return SCPE_OK;
+}
+
+/* one run. use_list: former list, else scp.c. Result: seconds */
+
+static double qb_run (t_bool use_list, uint32 units_count, uint32 ops, uint32 seed)
+{
+uint32 i, k;
+double start;
+
+qb_random = seed;
+qb_trace = 2166136261u;
+qb_fired = 0;
+list_queue = LIST_END;
+list_interval = list_noqueue_time = NOQUEUE_WAIT;
+list_rtime = 0;
+for (i = 0; i < QB_MAX_UNITS; i++) {
+    sim_cancel (&qb_units[i]);
+    qb_units[i].action = &heap_action;
+    qb_list_units[i].next = NULL;
+    qb_list_units[i].time = 0;
+    }
+sim_interval = 0;
+sim_process_event ();                                   /* empty queue: time base stands still */
+qb_rtime_base = sim_grtime ();
+for (i = 0; i < units_count; i++) {
+    if (use_list)
+        list_activate (&qb_list_units[i], qb_rnd () % QB_MAX_DELAY);
+    else
+        sim_activate (&qb_units[i], qb_rnd () % QB_MAX_DELAY);
+    }
+start = qb_now ();
+for (i = 0; i < ops; i++) {
+    k = qb_rnd () % units_count;
+    switch (qb_rnd () % 8) {
+        case 0: case 1: case 2:
+            if (use_list) {
+                list_cancel (&qb_list_units[k]);
+                list_activate (&qb_list_units[k], qb_rnd () % QB_MAX_DELAY);
+                }
+            else
+                sim_activate_abs (&qb_units[k], qb_rnd () % QB_MAX_DELAY);
+            break;
+        case 3:                                         /* many equal times */
+            if (use_list)
+                list_activate (&qb_list_units[k], qb_rnd () % 3);
+            else
+                sim_activate (&qb_units[k], qb_rnd () % 3);
+            break;
+        case 4:
+            if (use_list)
+                list_cancel (&qb_list_units[k]);
+            else
+                sim_cancel (&qb_units[k]);
+            break;
+        case 5:
+            qb_mix (use_list ? list_activate_time (&qb_list_units[k]) :
+                               sim_activate_time (&qb_units[k]));
+            break;
+        default:
+            break;
+        }
+    k = qb_rnd () % 40;
+    if (use_list) {
+        list_interval -= k;
+        if (list_interval <= 0)
+            list_process_event ();
+        }
+    else {
+        sim_interval -= k;
+        if (sim_interval <= 0)
+            sim_process_event ();
+        }
+    }
+return qb_now () - start;
+}
+
+int main (int argc, char *argv[])
+{
+static const uint32 units_counts[] = { 50, 500, 5000 };
+uint32 ops = 200000, seed = 12345, i, heap_trace, list_trace;
+t_uint64 heap_fired, list_fired;
+double heap_sec, list_sec;
+int errors = 0;
+
+if (argc > 1)
+    ops = (uint32) atol (argv[1]);
+if (argc > 2)
+    seed = (uint32) atol (argv[2]);
+printf ("%u operations, seed %u\n", ops, seed);
+for (i = 0; i < sizeof (units_counts) / sizeof (units_counts[0]); i++) {
+    heap_sec = qb_run (FALSE, units_counts[i], ops, seed);
+    heap_trace = qb_trace;
+    heap_fired = qb_fired;
+    list_sec = qb_run (TRUE, units_counts[i], ops, seed);
+    list_trace = qb_trace;
+    list_fired = qb_fired;
+    printf ("%5u units: heap %.3f s, list %.3f s, %" LL_FMT "u events, trace %s\n",
+            units_counts[i], heap_sec, list_sec, (LL_TYPE) heap_fired,
+            ((heap_trace == list_trace) && (heap_fired == list_fired)) ? "equal" : "DIFFERENT");
+    if ((heap_trace != list_trace) || (heap_fired != list_fired))
+        errors++;
+    }
+printf (errors ? "FAILED\n" : "OK\n");
+return errors ? 1 : 0;
+}
@@ -21,6 +21,14 @@
    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 
+   17-Oct-2026  agent   client_id: server keeps the delta sequence per client
+   17-Oct-2026  agent   SET/GET/EXCHANGE into value buffers per panel, in place XDR: no malloc() per call
+   17-Oct-2026  agent   get_panels_and_controls(): GETSCHEMA and on-disk schema cache
+   17-Oct-2026  agent   test_data_to/from_server(), "tcp" transport selectable
+   17-Oct-2026  agent   shared memory transport
+   17-Oct-2026  agent   wait_inputcontrols_values(): input change subscription
+   17-Oct-2026  agent   exchange_controls_values(): delta encoded outputs
+   17-Oct-2026  agent   exchange_controls_values(): multi panel GET/SET in one round trip
    16-Feb-2012  JH      created
 
 
@@ -32,9 +40,19 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <assert.h>
+#include <ctype.h>
 
 #include <rpc/rpc.h> /* always needed */
+#ifdef WIN32
+#include <direct.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #include "rpc_blinkenlight_api.h" /* need this too: will be generated by rpcgen */
 
@@ -42,6 +60,43 @@
 
 #include "blinkenlight_panels.h" /* internal panels&controls data base */
 #include "blinkenlight_api_client.h"
+#ifndef WIN32
+#include "blinkenlight_api_shm.h"
+#endif
+
+// server is considered dead, if its shared memory heartbeat stops that long
+#define BLINKENLIGHT_API_SHM_HEARTBEAT_TIMEOUT_SEC	3
+
+// GETSCHEMA result must fit into one UDP datagram (UDPMSGSIZE 8800), with RPC header
+#define BLINKENLIGHT_API_SCHEMA_MAX_UDP_BYTECOUNT	8000
+
+// as in the rpcgen client stubs
+static struct timeval rpc_call_timeout = { 25, 0 };
+
+/*
+ * default directory for the schema cache:
+ * $BLINKENLIGHT_API_CACHE, empty = no cache. Else in the user's home.
+ */
+static char *schema_cache_default_dir(void)
+{
+	char *dir;
+	char buffer[1024];
+	dir = getenv("BLINKENLIGHT_API_CACHE");
+	if (dir)
+		return strlen(dir) ? strdup(dir) : NULL;
+#ifdef WIN32
+	dir = getenv("LOCALAPPDATA");
+	if (!dir)
+		return NULL;
+	snprintf(buffer, sizeof(buffer), "%s\\blinkenlight", dir);
+#else
+	dir = getenv("HOME");
+	if (!dir)
+		return NULL;
+	snprintf(buffer, sizeof(buffer), "%s/.blinkenlight", dir);
+#endif
+	return strdup(buffer);
+}
 
 /*
  *  constructor for client object
@@ -55,9 +110,21 @@ blinkenlight_api_client_t *blinkenlight_api_client_constructor(void)
 	_this->connected = 0;
 	_this->rpc_server_hostname = NULL;
 	_this->rpc_client = NULL;
+	_this->rpc_protocol = "udp";
 	_this->panel_list = blinkenlight_panels_constructor();
+	_this->value_buffers_block = NULL;
 	strcpy(_this->error_text, "");
 	_this->error_file = NULL;
+	_this->exchange_unavailable = 0;
+	_this->rpc_client_wait = NULL;
+	_this->wait_unavailable = 0;
+	_this->shm = NULL;
+	_this->schema_unavailable = 0;
+	_this->schema_cache_dir = schema_cache_default_dir();
+	// identifies our delta encoded outputs at the server. Not 0.
+	_this->client_id = ((unsigned) time(NULL) * 2654435761u) ^ (unsigned) (size_t) _this;
+	if (_this->client_id == 0)
+		_this->client_id = 1;
 	return _this;
 }
 
@@ -69,7 +136,9 @@ void blinkenlight_api_client_destructor(blinkenlight_api_client_t *_this)
 	if (_this->connected)
 		blinkenlight_api_client_disconnect(_this);
 	blinkenlight_panels_destructor(_this->panel_list);
+	free(_this->value_buffers_block);
 	free(_this->rpc_server_hostname);
+	free(_this->schema_cache_dir);
 	free(_this);
 }
 
@@ -108,8 +177,7 @@ blinkenlight_api_status_t blinkenlight_api_client_connect(blinkenlight_api_clien
 	 * to use the "tcp" protocol when contacting the server.
 	 */
 	_this->rpc_client = clnt_create(_this->rpc_server_hostname, BLINKENLIGHTD, BLINKENLIGHTD_VERS,
-			"udp");
-	//"tcp");
+			(char *) _this->rpc_protocol);
 	if (_this->rpc_client == NULL)
 	{
 		/*
@@ -124,6 +192,11 @@ blinkenlight_api_status_t blinkenlight_api_client_connect(blinkenlight_api_clien
 
 	blinkenlight_panels_clear(_this->panel_list);
 
+	// new server: may know the multi panel exchange procedure
+	_this->exchange_unavailable = 0;
+	_this->wait_unavailable = 0;
+	_this->schema_unavailable = 0;
+
 	_this->connected = 1;
 	return 0; // OK
 }
@@ -138,6 +211,7 @@ blinkenlight_api_status_t blinkenlight_api_client_disconnect(blinkenlight_api_cl
 		return 1; // error
 	}
 
+	blinkenlight_api_client_shm_detach(_this);
 	_this->connected = 0;
 #ifdef WIN32
 	rpc_nt_exit();
@@ -145,6 +219,9 @@ blinkenlight_api_status_t blinkenlight_api_client_disconnect(blinkenlight_api_cl
 	free(_this->rpc_server_hostname);
 	_this->rpc_server_hostname = NULL;
 	clnt_destroy( (CLIENT *)_this->rpc_client) ;
+	if (_this->rpc_client_wait)
+		clnt_destroy((CLIENT *) _this->rpc_client_wait);
+	_this->rpc_client_wait = NULL;
 	return 0; // OK
 }
 
@@ -223,7 +300,11 @@ blinkenlight_api_status_t blinkenlight_api_client_get_controls(blinkenlight_api_
 
 }
 
-blinkenlight_api_status_t blinkenlight_api_client_get_panels_and_controls(
+/*
+ * read panels and controls with GETPANELINFO/GETCONTROLINFO,
+ * one call per panel and per control
+ */
+static blinkenlight_api_status_t get_panels_and_controls_by_handles(
 		blinkenlight_api_client_t *_this)
 {
 	unsigned i_panel;
@@ -273,21 +354,581 @@ blinkenlight_api_status_t blinkenlight_api_client_get_panels_and_controls(
 }
 
 /*
- *	read input control values from remote server into client input controls
+ * Schema cache: panel and control descriptors of a server, in a text file
+ * per server host. Validated by the schema hash.
+ *	schema <hash>
+ *	panel <name> <inputs count> <outputs count> <inputs bytecount> <outputs bytecount>
+ *	control <name> <is_input> <type> <radix> <value_bitlen> <value_bytelen>
  */
-blinkenlight_api_status_t blinkenlight_api_client_get_inputcontrols_values(
-		blinkenlight_api_client_t *_this, blinkenlight_panel_t *p)
+static int schema_cache_filename(blinkenlight_api_client_t *_this, char *buffer, unsigned size)
+{
+	char *s;
+	unsigned n;
+	if (!_this->schema_cache_dir || !_this->rpc_server_hostname)
+		return 0;
+	n = snprintf(buffer, size, "%s/", _this->schema_cache_dir);
+	// host name as file name
+	for (s = _this->rpc_server_hostname; *s && n < size - 8; s++)
+		buffer[n++] = (isalnum((unsigned char)*s) || *s == '.' || *s == '-') ? *s : '_';
+	strcpy(buffer + n, ".schema");
+	return 1;
+}
+
+/*
+ * load the cached schema into panel_list
+ * result: its hash, 0 if not cached or invalid
+ */
+static uint64_t schema_cache_load(blinkenlight_api_client_t *_this)
+{
+	char filename[1024];
+	char line[256];
+	char name[MAX_BLINKENLIGHT_NAME_LEN];
+	unsigned long long hash = 0;
+	unsigned v[6];
+	blinkenlight_panel_t *p = NULL;
+	blinkenlight_control_t *c;
+	int valid = 1;
+	FILE *f;
+
+	blinkenlight_panels_clear(_this->panel_list);
+	if (!schema_cache_filename(_this, filename, sizeof(filename)))
+		return 0;
+	f = fopen(filename, "r");
+	if (!f)
+		return 0;
+	if (!fgets(line, sizeof(line), f) || sscanf(line, "schema %llx", &hash) != 1)
+		valid = 0;
+	while (valid && fgets(line, sizeof(line), f)) {
+		if (sscanf(line, "panel %79s %u %u %u %u", name, &v[0], &v[1], &v[2], &v[3]) == 5
+				&& _this->panel_list->panels_count < MAX_BLINKENLIGHT_PANELS) {
+			p = blinkenlight_add_panel(_this->panel_list);
+			strcpy(p->name, name);
+			p->controls_inputs_count = v[0];
+			p->controls_outputs_count = v[1];
+			p->controls_inputs_values_bytecount = v[2];
+			p->controls_outputs_values_bytecount = v[3];
+		} else if (sscanf(line, "control %79s %u %u %u %u %u", name, &v[0], &v[1], &v[2],
+				&v[3], &v[4]) == 6 && p && p->controls_count < MAX_BLINKENLIGHT_PANEL_CONTROLS) {
+			c = blinkenlight_add_control(_this->panel_list, p);
+			strcpy(c->name, name);
+			c->is_input = v[0];
+			c->type = (blinkenlight_control_type_t) v[1];
+			c->radix = v[2];
+			c->value_bitlen = v[3];
+			c->value_bytelen = v[4];
+		} else
+			valid = 0;
+	}
+	fclose(f);
+	// names with blanks, edited or truncated files
+	if (valid && blinkenlight_panels_get_schema_hash(_this->panel_list) != hash)
+		valid = 0;
+	if (!valid) {
+		blinkenlight_panels_clear(_this->panel_list);
+		return 0;
+	}
+	return hash;
+}
+
+/*
+ * save panel_list as cached schema. Errors are ignored, then there's no cache.
+ */
+static void schema_cache_save(blinkenlight_api_client_t *_this, uint64_t hash)
+{
+	char filename[1024];
+	char tmpfilename[1040];
+	unsigned i_panel, i_control;
+	FILE *f;
+
+	if (!schema_cache_filename(_this, filename, sizeof(filename)))
+		return;
+#ifdef WIN32
+	_mkdir(_this->schema_cache_dir);
+#else
+	mkdir(_this->schema_cache_dir, 0755);
+#endif
+	// write complete file, then replace the old one
+	sprintf(tmpfilename, "%s.tmp", filename);
+	f = fopen(tmpfilename, "w");
+	if (!f)
+		return;
+	fprintf(f, "schema %llx\n", (unsigned long long) hash);
+	for (i_panel = 0; i_panel < _this->panel_list->panels_count; i_panel++) {
+		blinkenlight_panel_t *p = &(_this->panel_list->panels[i_panel]);
+		fprintf(f, "panel %s %u %u %u %u\n", p->name, p->controls_inputs_count,
+				p->controls_outputs_count, p->controls_inputs_values_bytecount,
+				p->controls_outputs_values_bytecount);
+		for (i_control = 0; i_control < p->controls_count; i_control++) {
+			blinkenlight_control_t *c = &(p->controls[i_control]);
+			fprintf(f, "control %s %u %u %u %u %u\n", c->name, (unsigned) c->is_input,
+					(unsigned) c->type, c->radix, c->value_bitlen, c->value_bytelen);
+		}
+	}
+	if (fclose(f) != 0) {
+		remove(tmpfilename);
+		return;
+	}
+#ifdef WIN32
+	remove(filename); // rename() does not overwrite
+#endif
+	if (rename(tmpfilename, filename) != 0)
+		remove(tmpfilename);
+}
+
+/*
+ * fill panel_list from a GETSCHEMA result
+ */
+static void decode_schema(blinkenlight_api_client_t *_this,
+		rpc_blinkenlight_api_getschema_res *result)
+{
+	unsigned i_panel, i_control;
+	blinkenlight_panels_clear(_this->panel_list);
+	for (i_panel = 0;
+			i_panel < result->panels.panels_len && i_panel < MAX_BLINKENLIGHT_PANELS; i_panel++) {
+		rpc_blinkenlight_api_schema_panel_struct *rp = &result->panels.panels_val[i_panel];
+		blinkenlight_panel_t *p = blinkenlight_add_panel(_this->panel_list);
+		strncpy(p->name, rp->panel.name, sizeof(p->name) - 1);
+		p->name[sizeof(p->name) - 1] = 0;
+		p->controls_outputs_count = rp->panel.controls_outputs_count;
+		p->controls_inputs_count = rp->panel.controls_inputs_count;
+		p->controls_inputs_values_bytecount = rp->panel.controls_inputs_values_bytecount;
+		p->controls_outputs_values_bytecount = rp->panel.controls_outputs_values_bytecount;
+		for (i_control = 0;
+				i_control < rp->controls.controls_len
+						&& i_control < MAX_BLINKENLIGHT_PANEL_CONTROLS; i_control++) {
+			rpc_blinkenlight_api_control_struct *rc = &rp->controls.controls_val[i_control];
+			blinkenlight_control_t *c = blinkenlight_add_control(_this->panel_list, p);
+			strncpy(c->name, rc->name, sizeof(c->name) - 1);
+			c->name[sizeof(c->name) - 1] = 0;
+			c->type = (blinkenlight_control_type_t) rc->type;
+			c->is_input = rc->is_input;
+			c->radix = rc->radix;
+			c->value_bitlen = rc->value_bitlen;
+			c->value_bytelen = rc->value_bytelen;
+		}
+	}
+}
+
+/*
+ * read all panels and controls with one GETSCHEMA call.
+ * If the cached schema is still valid, the server sends only the hash.
+ * A schema too large for an UDP datagram is fetched over a temporary TCP connection.
+ * *unavailable = 1: server has no GETSCHEMA, use GETPANELINFO/GETCONTROLINFO
+ */
+static blinkenlight_api_status_t get_panels_and_controls_schema(
+		blinkenlight_api_client_t *_this, int *unavailable)
+{
+	rpc_blinkenlight_api_getschema_cmd cmd;
+	rpc_blinkenlight_api_getschema_res *result;
+	struct rpc_err rpc_error;
+	CLIENT *rpc_client = (CLIENT *) _this->rpc_client;
+	CLIENT *rpc_client_tcp = NULL;
+	int error_code;
+
+	*unavailable = 0;
+	cmd.known_hash = schema_cache_load(_this);
+	cmd.max_bytecount = strcmp(_this->rpc_protocol, "udp") ?
+			0 : BLINKENLIGHT_API_SCHEMA_MAX_UDP_BYTECOUNT;
+	for (;;)
+	{
+		result = rpc_blinkenlight_api_getschema_1(cmd, rpc_client);
+		if (result == NULL)
+		{
+			clnt_geterr(rpc_client, &rpc_error);
+			if (rpc_error.re_status == RPC_PROCUNAVAIL)
+			{
+				_this->schema_unavailable = 1;
+				*unavailable = 1;
+				break;
+			}
+			// An error occurred while calling the server: Get rpc error message and die.
+			strcpy(_this->error_text, clnt_sperror(rpc_client, _this->rpc_server_hostname));
+			_this->error_file = __FILE__;
+			_this->error_line = __LINE__;
+			break;
+		}
+		error_code = result->error_code;
+		if (error_code == RPC_BLINKENLIGHT_API_ERR_TOO_BIG && rpc_client_tcp == NULL)
+		{
+			// again over TCP, no size limit
+			xdr_free((xdrproc_t) xdr_rpc_blinkenlight_api_getschema_res, (char *) result);
+			rpc_client_tcp = clnt_create(_this->rpc_server_hostname, BLINKENLIGHTD,
+					BLINKENLIGHTD_VERS, "tcp");
+			if (rpc_client_tcp == NULL)
+			{
+				*unavailable = 1; // then item by item over UDP
+				break;
+			}
+			rpc_client = rpc_client_tcp;
+			cmd.max_bytecount = 0;
+			continue;
+		}
+		if (error_code != 0)
+		{
+			sprintf(_this->error_text, "GETSCHEMA failed with error code %d", error_code);
+			_this->error_file = __FILE__;
+			_this->error_line = __LINE__;
+			xdr_free((xdrproc_t) xdr_rpc_blinkenlight_api_getschema_res, (char *) result);
+			result = NULL;
+			break;
+		}
+		if (result->panels.panels_len == 0 && cmd.known_hash && result->hash == cmd.known_hash)
+			; // cached schema in panel_list is valid
+		else
+		{
+			decode_schema(_this, result);
+			schema_cache_save(_this, result->hash);
+		}
+		xdr_free((xdrproc_t) xdr_rpc_blinkenlight_api_getschema_res, (char *) result);
+		if (rpc_client_tcp)
+			clnt_destroy(rpc_client_tcp);
+		return 0; // OK
+	}
+	if (rpc_client_tcp)
+		clnt_destroy(rpc_client_tcp);
+	blinkenlight_panels_clear(_this->panel_list);
+	return *unavailable ? 0 : 1;
+}
+
+/*
+ * (re)create the value buffers for the panels in panel_list
+ */
+static void value_buffers_create(blinkenlight_api_client_t *_this)
+{
+	blinkenlight_panel_t *p;
+	unsigned i_panel, bytecount;
+	unsigned char *buffer;
+
+	bytecount = 0;
+	for (i_panel = 0; i_panel < _this->panel_list->panels_count; i_panel++)
+	{
+		p = &(_this->panel_list->panels[i_panel]);
+		bytecount += (p->controls_outputs_count + 7) / 8 + p->controls_outputs_values_bytecount
+				+ p->controls_inputs_values_bytecount;
+	}
+	free(_this->value_buffers_block);
+	buffer = _this->value_buffers_block = (unsigned char *) calloc(bytecount + 1, 1);
+	assert(buffer);
+	for (i_panel = 0; i_panel < _this->panel_list->panels_count; i_panel++)
+	{
+		p = &(_this->panel_list->panels[i_panel]);
+		_this->value_buffers[i_panel].outputs_changed_bitmap = buffer;
+		buffer += (p->controls_outputs_count + 7) / 8;
+		_this->value_buffers[i_panel].outputs_value_bytes = buffer;
+		buffer += p->controls_outputs_values_bytecount;
+		_this->value_buffers[i_panel].inputs_value_bytes = buffer;
+		buffer += p->controls_inputs_values_bytecount;
+	}
+}
+
+/*
+ * read all panels and controls of the server into panel_list
+ */
+blinkenlight_api_status_t blinkenlight_api_client_get_panels_and_controls(
+		blinkenlight_api_client_t *_this)
+{
+	int unavailable = 1;
+	if (!_this->schema_unavailable
+			&& get_panels_and_controls_schema(_this, &unavailable) != 0)
+		return 1; // error
+	if (unavailable
+			// older server (blinkenlightd, Java panelsim)
+			&& get_panels_and_controls_by_handles(_this) != 0)
+		return 1; // error
+	value_buffers_create(_this);
+	return 0; // OK
+}
+
+/*
+ * directory for the on-disk schema cache, NULL = no cache
+ */
+void blinkenlight_api_client_set_schema_cache_dir(blinkenlight_api_client_t *_this,
+		const char *dir)
+{
+	free(_this->schema_cache_dir);
+	_this->schema_cache_dir = dir ? strdup(dir) : NULL;
+}
+
+/*
+ * XDR for value transfers, without allocation.
+ * Arguments are encoded from the value buffers of the panels,
+ * replies decoded into them. Nothing to free.
+ */
+
+// reply of GETPANEL_CONTROLVALUES or EXCHANGE_PANELS_CONTROLVALUES
+typedef struct
+{
+	blinkenlight_api_client_t *client;
+	unsigned i_panel; // GETPANEL_CONTROLVALUES
+	union
+	{
+		rpc_blinkenlight_api_controlvalues_struct controlvalues;
+		rpc_blinkenlight_api_panels_controlvalues_struct panels_controlvalues;
+	} res;
+	rpc_blinkenlight_api_panel_controlvalues_struct panels[MAX_BLINKENLIGHT_PANELS]; // EXCHANGE
+} values_reply_t;
+
+/*
+ * XDR of a value byte array ("unsigned char x<>", each byte in an XDR unit)
+ * in a buffer of the caller, like xdr_array() of u_char.
+ * Same as in blinkenlight_api_server_procs.c.
+ * Decoding never allocates: values go into "buffer". A longer array
+ * is skipped, then *val is NULL and *len tells the received length.
+ */
+static bool_t xdr_value_bytes_inplace(XDR *xdrs, u_char **val, u_int *len, u_char *buffer,
+		u_int capacity)
+{
+	int32_t *buf;
+	u_char skipped;
+	u_int i;
+
+	if (xdrs->x_op == XDR_FREE)
+		return TRUE;
+	if (!xdr_u_int(xdrs, len))
+		return FALSE;
+	if (xdrs->x_op == XDR_DECODE)
+		*val = (*len <= capacity) ? buffer : NULL;
+	if (*val == NULL)
+	{
+		for (i = 0; i < *len; i++)
+			if (!xdr_u_char(xdrs, &skipped))
+				return FALSE;
+		return TRUE;
+	}
+	// whole array in the stream buffer: no call per byte
+	buf = XDR_INLINE(xdrs, (int) (*len * BYTES_PER_XDR_UNIT));
+	if (buf != NULL)
+	{
+		if (xdrs->x_op == XDR_ENCODE)
+			for (i = 0; i < *len; i++)
+				IXDR_PUT_U_LONG(buf, (*val)[i]);
+		else
+			for (i = 0; i < *len; i++)
+				(*val)[i] = (u_char) IXDR_GET_U_LONG(buf);
+		return TRUE;
+	}
+	for (i = 0; i < *len; i++)
+		if (!xdr_u_char(xdrs, &(*val)[i]))
+			return FALSE;
+	return TRUE;
+}
+
+static bool_t xdr_setpanel_controlvalues_argument_inplace(XDR *xdrs,
+		rpc_blinkenlight_api_setpanel_controlvalues_1_argument *objp)
+{
+	return xdr_u_int(xdrs, &objp->arg1) && xdr_int(xdrs, &objp->valuelist.error_code)
+			&& xdr_value_bytes_inplace(xdrs, &objp->valuelist.value_bytes.value_bytes_val,
+					&objp->valuelist.value_bytes.value_bytes_len, NULL, 0);
+}
+
+// decodes values into the input buffer of panel "i_panel"
+static bool_t xdr_controlvalues_reply(XDR *xdrs, values_reply_t *objp)
+{
+	blinkenlight_panel_list_t *panel_list = objp->client->panel_list;
+	rpc_blinkenlight_api_controlvalues_struct *res = &objp->res.controlvalues;
+
+	return xdr_int(xdrs, &res->error_code)
+			&& xdr_value_bytes_inplace(xdrs, &res->value_bytes.value_bytes_val,
+					&res->value_bytes.value_bytes_len,
+					objp->client->value_buffers[objp->i_panel].inputs_value_bytes,
+					panel_list->panels[objp->i_panel].controls_inputs_values_bytecount);
+}
+
+// EXCHANGE argument, encode only
+static bool_t xdr_panels_controlvalues_argument_inplace(XDR *xdrs,
+		rpc_blinkenlight_api_panels_controlvalues_struct *objp)
+{
+	rpc_blinkenlight_api_panel_controlvalues_struct *po;
+	unsigned i;
+
+	if (!xdr_int(xdrs, &objp->error_code) || !xdr_u_int(xdrs, &objp->client_id)
+			|| !xdr_u_int(xdrs, &objp->panels.panels_len))
+		return FALSE;
+	for (i = 0; i < objp->panels.panels_len; i++)
+	{
+		po = &objp->panels.panels_val[i];
+		if (!xdr_u_int(xdrs, &po->i_panel) || !xdr_u_int(xdrs, &po->sequence)
+				|| !xdr_value_bytes_inplace(xdrs, &po->changed_bitmap.changed_bitmap_val,
+						&po->changed_bitmap.changed_bitmap_len, NULL, 0)
+				|| !xdr_value_bytes_inplace(xdrs, &po->value_bytes.value_bytes_val,
+						&po->value_bytes.value_bytes_len, NULL, 0))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+// EXCHANGE reply: entries into "panels", values into the input buffers of their panels
+static bool_t xdr_panels_controlvalues_reply(XDR *xdrs, values_reply_t *objp)
+{
+	blinkenlight_panel_list_t *panel_list = objp->client->panel_list;
+	rpc_blinkenlight_api_panels_controlvalues_struct *res = &objp->res.panels_controlvalues;
+	rpc_blinkenlight_api_panel_controlvalues_struct *pr;
+	u_char *buffer;
+	u_int capacity;
+	unsigned i;
+
+	if (xdrs->x_op == XDR_FREE)
+		return TRUE;
+	if (!xdr_int(xdrs, &res->error_code) || !xdr_u_int(xdrs, &res->client_id)
+			|| !xdr_u_int(xdrs, &res->panels.panels_len)
+			|| res->panels.panels_len > MAX_BLINKENLIGHT_PANELS)
+		return FALSE;
+	res->panels.panels_val = objp->panels;
+	for (i = 0; i < res->panels.panels_len; i++)
+	{
+		pr = &res->panels.panels_val[i];
+		if (!xdr_u_int(xdrs, &pr->i_panel) || !xdr_u_int(xdrs, &pr->sequence)
+				|| !xdr_value_bytes_inplace(xdrs, &pr->changed_bitmap.changed_bitmap_val,
+						&pr->changed_bitmap.changed_bitmap_len, NULL, 0))
+			return FALSE;
+		buffer = NULL;
+		capacity = 0;
+		if (pr->i_panel < panel_list->panels_count)
+		{
+			buffer = objp->client->value_buffers[pr->i_panel].inputs_value_bytes;
+			capacity = panel_list->panels[pr->i_panel].controls_inputs_values_bytecount;
+		}
+		if (!xdr_value_bytes_inplace(xdrs, &pr->value_bytes.value_bytes_val,
+				&pr->value_bytes.value_bytes_len, buffer, capacity))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/*
+ *	decode a received input value byte stream into the panel's input controls
+ *	value_previous := value, value := received value
+ */
+static blinkenlight_api_status_t decode_inputcontrols_values(blinkenlight_api_client_t *_this,
+		blinkenlight_panel_t *p, unsigned char *value_bytes, unsigned value_bytes_len)
 {
-	rpc_blinkenlight_api_controlvalues_struct *result_valuelist;
-	int	error_code ;
 	blinkenlight_control_t *c;
 	unsigned i_control;
 	unsigned char *value_byte_ptr; // index in received value byte stream
 	uint64_t value;
 
-	result_valuelist = rpc_blinkenlight_api_getpanel_controlvalues_1(p->index,
-			(CLIENT *) _this->rpc_client);
-	if (result_valuelist == NULL)
+	// check: exakt amount of values provided?
+	// "Sum of bytes" must be "sum(all controls) of value_bytelen
+	if (p->controls_inputs_values_bytecount != value_bytes_len)
+	{
+		sprintf(_this->error_text,
+				"Error in blinkenlight_api_getpanel_controlvalues():\n"
+						"Sum (Panel[%s].inputcontrols.value_bytelen) is %d, but %d values were received.",
+				p->name, p->controls_inputs_values_bytecount, value_bytes_len);
+		_this->error_file = __FILE__;
+		_this->error_line = __LINE__;
+		return 1;
+	}
+	/* go through all input controls, assign value to each
+	 * decode control value from the right amount of bytes
+	 * */
+	value_byte_ptr = value_bytes;
+	for (i_control = 0; i_control < p->controls_count; i_control++)
+	{
+		c = &(p->controls[i_control]);
+		if (c->is_input)
+		{
+			assert(value_byte_ptr < (value_bytes + value_bytes_len));
+			value = decode_uint64_from_bytes(value_byte_ptr, c->value_bytelen);
+			c->value_previous = c->value;
+			c->value = value;
+			value_byte_ptr += c->value_bytelen;
+		}
+	}
+	return 0;
+}
+
+/*
+ *	encode the panel's output control values into a byte stream
+ *	value_bytes must have room for p->controls_outputs_values_bytecount bytes
+ */
+static void encode_outputcontrols_values(blinkenlight_panel_t *p, unsigned char *value_bytes)
+{
+	blinkenlight_control_t *c;
+	unsigned i_control;
+	unsigned char *value_byte_ptr; // index in result value byte stream
+
+	/* go through all output controls, assign value from each into result stream
+	 * each output control puts "value_bytelen" bytes into char stream, lsb first */
+	value_byte_ptr = value_bytes;
+	for (i_control = 0; i_control < p->controls_count; i_control++)
+	{
+		c = &(p->controls[i_control]);
+		if (!c->is_input)
+		{
+			assert(value_byte_ptr < (value_bytes + p->controls_outputs_values_bytecount));
+			encode_uint64_to_bytes(value_byte_ptr, c->value, c->value_bytelen);
+			value_byte_ptr += c->value_bytelen; // next pos in buffer
+		}
+	}
+}
+
+/*
+ *	encode only the changed output control values (value != value_previous)
+ *	into a byte stream, and mark them in changed_bitmap.
+ *	bit n in the bitmap is the n'th output control.
+ *	changed_bitmap must have room for (controls_outputs_count+7)/8 bytes,
+ *	value_bytes for p->controls_outputs_values_bytecount bytes.
+ *	result: count of value bytes
+ */
+static unsigned encode_outputcontrols_delta(blinkenlight_panel_t *p,
+		unsigned char *changed_bitmap, unsigned char *value_bytes)
+{
+	blinkenlight_control_t *c;
+	unsigned i_control, i_output;
+	unsigned char *value_byte_ptr; // index in result value byte stream
+
+	memset(changed_bitmap, 0, (p->controls_outputs_count + 7) / 8);
+	value_byte_ptr = value_bytes;
+	for (i_output = i_control = 0; i_control < p->controls_count; i_control++)
+	{
+		c = &(p->controls[i_control]);
+		if (!c->is_input)
+		{
+			if (c->value != c->value_previous)
+			{
+				changed_bitmap[i_output / 8] |= 1 << (i_output % 8);
+				encode_uint64_to_bytes(value_byte_ptr, c->value, c->value_bytelen);
+				value_byte_ptr += c->value_bytelen; // next pos in buffer
+			}
+			i_output++;
+		}
+	}
+	return value_byte_ptr - value_bytes;
+}
+
+/*
+ *	output successful: set value_previous" to value
+ */
+static void outputcontrols_values_sent(blinkenlight_panel_t *p)
+{
+	blinkenlight_control_t *c;
+	unsigned i_control;
+
+	for (i_control = 0; i_control < p->controls_count; i_control++)
+	{
+		c = &(p->controls[i_control]);
+		if (!c->is_input)
+			c->value_previous = c->value;
+	}
+}
+
+/*
+ *	read input control values from remote server into client input controls
+ */
+blinkenlight_api_status_t blinkenlight_api_client_get_inputcontrols_values(
+		blinkenlight_api_client_t *_this, blinkenlight_panel_t *p)
+{
+	values_reply_t reply;
+	rpc_blinkenlight_api_controlvalues_struct *result_valuelist = &reply.res.controlvalues;
+	u_int i_panel = p->index;
+	int	error_code ;
+
+	reply.client = _this;
+	reply.i_panel = p->index;
+	if (clnt_call((CLIENT *) _this->rpc_client, RPC_BLINKENLIGHT_API_GETPANEL_CONTROLVALUES,
+			(xdrproc_t) xdr_u_int, (caddr_t) &i_panel, (xdrproc_t) xdr_controlvalues_reply,
+			(caddr_t) &reply, rpc_call_timeout) != RPC_SUCCESS)
 	{
 		// An error occurred while calling the server: Get rpc error message and die.
 		strcpy(_this->error_text,
@@ -301,100 +942,539 @@ blinkenlight_api_status_t blinkenlight_api_client_get_inputcontrols_values(
 	if (error_code == 0)
 	{
 		/* go through all input controls, assign value for each */
-		// check: exakt amount of values provided?
-		// "Sum of bytes" must be "sum(all controls) of value_bytelen
-		if (p->controls_inputs_values_bytecount != result_valuelist->value_bytes.value_bytes_len)
+		if (decode_inputcontrols_values(_this, p, result_valuelist->value_bytes.value_bytes_val,
+				result_valuelist->value_bytes.value_bytes_len))
+			return 1;
+	}
+	return 0; // OK
+}
+
+/*
+ *	write values from client outputs controls to server control's
+ *      on success: value_previous := value
+ */
+blinkenlight_api_status_t blinkenlight_api_client_set_outputcontrols_values(
+		blinkenlight_api_client_t *_this, blinkenlight_panel_t *p)
+{
+	rpc_blinkenlight_api_setpanel_controlvalues_1_argument argument;
+	rpc_blinkenlight_api_setpanel_controlvalues_res result;
+
+	// 1) fill valuelist with values of output controls
+	argument.arg1 = p->index;
+	argument.valuelist.error_code = 0;
+	argument.valuelist.value_bytes.value_bytes_len = p->controls_outputs_values_bytecount;
+	argument.valuelist.value_bytes.value_bytes_val = _this->value_buffers[p->index].outputs_value_bytes;
+	encode_outputcontrols_values(p, argument.valuelist.value_bytes.value_bytes_val);
+
+	// 2) list filled, call server proc
+	if (clnt_call((CLIENT *) _this->rpc_client, RPC_BLINKENLIGHT_API_SETPANEL_CONTROLVALUES,
+			(xdrproc_t) xdr_setpanel_controlvalues_argument_inplace, (caddr_t) &argument,
+			(xdrproc_t) xdr_rpc_blinkenlight_api_setpanel_controlvalues_res, (caddr_t) &result,
+			rpc_call_timeout) != RPC_SUCCESS)
+	{
+		// An error occurred while calling the server: Get rpc error message and die.
+		strcpy(_this->error_text,
+				clnt_sperror((CLIENT *) _this->rpc_client, _this->rpc_server_hostname));
+		_this->error_file = __FILE__;
+		_this->error_line = __LINE__;
+		return 1; // error
+	}
+	assert(result.error_code == 0);
+
+	// 3) output successful: set value_previous" to value
+	outputcontrols_values_sent(p);
+	return 0; // OK
+}
+
+/*
+ *	fill the request list entry for one panel in an exchange.
+ *	If the server has our last output values, only changed controls are
+ *	sent as delta. If a delta is not shorter than the complete value list,
+ *	or after a resync, all output values are sent.
+ */
+static void exchange_encode_outputs(blinkenlight_api_client_t *_this, blinkenlight_panel_t *p,
+		rpc_blinkenlight_api_panel_controlvalues_struct *po)
+{
+	unsigned changes;
+	unsigned bitmap_len;
+
+	po->value_bytes.value_bytes_val = _this->value_buffers[p->index].outputs_value_bytes;
+	if (p->outputs_delta_valid)
+	{
+		changes = blinkenlight_panels_get_control_value_changes(_this->panel_list, p,
+				/*is_input*/0);
+		if (changes == 0)
+			return; // nothing to send
+		bitmap_len = (p->controls_outputs_count + 7) / 8;
+		po->changed_bitmap.changed_bitmap_len = bitmap_len;
+		po->changed_bitmap.changed_bitmap_val = _this->value_buffers[p->index].outputs_changed_bitmap;
+		po->value_bytes.value_bytes_len = encode_outputcontrols_delta(p,
+				po->changed_bitmap.changed_bitmap_val, po->value_bytes.value_bytes_val);
+		if (bitmap_len + po->value_bytes.value_bytes_len < p->controls_outputs_values_bytecount)
 		{
-			sprintf(_this->error_text,
-					"Error in blinkenlight_api_getpanel_controlvalues():\n"
-							"Sum (Panel[%s].inputcontrols.value_bytelen) is %d, but %d values were received.",
-					p->name, p->controls_inputs_values_bytecount,
-					result_valuelist->value_bytes.value_bytes_len);
+			po->sequence = ++p->outputs_delta_sequence;
+			return; // delta is shorter
+		}
+		// delta not worth it: send complete
+		po->changed_bitmap.changed_bitmap_val = NULL;
+		po->changed_bitmap.changed_bitmap_len = 0;
+	}
+	po->value_bytes.value_bytes_len = p->controls_outputs_values_bytecount;
+	encode_outputcontrols_values(p, po->value_bytes.value_bytes_val);
+	po->sequence = ++p->outputs_delta_sequence;
+}
+
+/*
+ *	Shared memory transport
+ *	Server creates a memory image of control values, see blinkenlight_api_shm.h
+ *	Must be called after get_panels_and_controls(): the image is checked against
+ *	the panel list. The current output values are published at once.
+ */
+blinkenlight_api_status_t blinkenlight_api_client_shm_attach(blinkenlight_api_client_t *_this)
+{
+#ifdef WIN32
+	sprintf(_this->error_text, "Shared memory transport not supported under Windows");
+	_this->error_file = __FILE__;
+	_this->error_line = __LINE__;
+	return 1;
+#else
+	blinkenlight_api_shm_t *shm;
+	blinkenlight_panel_t *p;
+	unsigned i_panel, i_control;
+	int fd;
+
+	fd = shm_open(BLINKENLIGHT_API_SHM_NAME, O_RDWR, 0);
+	if (fd < 0)
+	{
+		sprintf(_this->error_text, "No shared memory image %s, server not on this host? %s",
+				BLINKENLIGHT_API_SHM_NAME, strerror(errno));
+		_this->error_file = __FILE__;
+		_this->error_line = __LINE__;
+		return 1;
+	}
+	shm = (blinkenlight_api_shm_t *) mmap(NULL, sizeof(blinkenlight_api_shm_t),
+			PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (shm == MAP_FAILED)
+	{
+		sprintf(_this->error_text, "mmap(%s) failed: %s", BLINKENLIGHT_API_SHM_NAME,
+				strerror(errno));
+		_this->error_file = __FILE__;
+		_this->error_line = __LINE__;
+		return 1;
+	}
+	// same panels and controls as published over RPC?
+	if (shm->magic != BLINKENLIGHT_API_SHM_MAGIC || shm->version != BLINKENLIGHT_API_SHM_VERSION
+			|| shm->panels_count != _this->panel_list->panels_count)
+	{
+		sprintf(_this->error_text, "Shared memory image %s invalid or of other server",
+				BLINKENLIGHT_API_SHM_NAME);
+		munmap(shm, sizeof(blinkenlight_api_shm_t));
+		_this->error_file = __FILE__;
+		_this->error_line = __LINE__;
+		return 1;
+	}
+	for (i_panel = 0; i_panel < shm->panels_count; i_panel++)
+	{
+		p = &(_this->panel_list->panels[i_panel]);
+		if (strcmp(shm->panels[i_panel].name, p->name)
+				|| shm->panels[i_panel].controls_count != p->controls_count)
+		{
+			sprintf(_this->error_text, "Panel %s in shared memory image %s differs from server's",
+					p->name, BLINKENLIGHT_API_SHM_NAME);
+			munmap(shm, sizeof(blinkenlight_api_shm_t));
 			_this->error_file = __FILE__;
 			_this->error_line = __LINE__;
 			return 1;
 		}
-		/* go through all input controls, assign value to each
-		 * decode control value from the right amount of bytes
-		 * */
-		value_byte_ptr = result_valuelist->value_bytes.value_bytes_val;
+	}
+	// publish outputs: server starts servicing the panels
+	for (i_panel = 0; i_panel < shm->panels_count; i_panel++)
+	{
+		p = &(_this->panel_list->panels[i_panel]);
+		blinkenlight_api_shm_write_begin(&shm->panels[i_panel].outputs);
+		for (i_control = 0; i_control < p->controls_count; i_control++)
+			if (!p->controls[i_control].is_input)
+				shm->panels[i_panel].outputs.values[i_control] = p->controls[i_control].value;
+		blinkenlight_api_shm_write_end(&shm->panels[i_panel].outputs);
+	}
+	_this->shm = shm;
+	_this->shm_heartbeat = shm->heartbeat;
+	_this->shm_heartbeat_time = time(NULL);
+	return 0;
+#endif
+}
+
+void blinkenlight_api_client_shm_detach(blinkenlight_api_client_t *_this)
+{
+#ifndef WIN32
+	if (_this->shm)
+		munmap(_this->shm, sizeof(blinkenlight_api_shm_t));
+#endif
+	_this->shm = NULL;
+}
+
+/*
+ *	exchange_controls_values() over shared memory
+ *	Outputs are written into the image, inputs copied from it.
+ *	A torn input image is read again.
+ */
+static blinkenlight_api_status_t exchange_controls_values_shm(blinkenlight_api_client_t *_this,
+		blinkenlight_panel_t **panels, int *set_outputs, unsigned panels_count)
+{
+#ifdef WIN32
+	return 1; // never attached
+#else
+	blinkenlight_api_shm_t *shm = (blinkenlight_api_shm_t *) _this->shm;
+	blinkenlight_api_shm_values_t *sv;
+	uint64_t values[MAX_BLINKENLIGHT_PANEL_CONTROLS];
+	blinkenlight_panel_t *p;
+	blinkenlight_control_t *c;
+	unsigned i, i_control, sequence;
+	time_t now = time(NULL);
+
+	// server still alive?
+	if (shm->magic != BLINKENLIGHT_API_SHM_MAGIC)
+	{
+		sprintf(_this->error_text, "Server closed shared memory image %s",
+				BLINKENLIGHT_API_SHM_NAME);
+		_this->error_file = __FILE__;
+		_this->error_line = __LINE__;
+		return 1;
+	}
+	if (shm->heartbeat != _this->shm_heartbeat)
+	{
+		_this->shm_heartbeat = shm->heartbeat;
+		_this->shm_heartbeat_time = now;
+	} else if (now - _this->shm_heartbeat_time > BLINKENLIGHT_API_SHM_HEARTBEAT_TIMEOUT_SEC)
+	{
+		sprintf(_this->error_text, "Server not responding on shared memory image %s",
+				BLINKENLIGHT_API_SHM_NAME);
+		_this->error_file = __FILE__;
+		_this->error_line = __LINE__;
+		return 1;
+	}
+
+	for (i = 0; i < panels_count; i++)
+	{
+		p = panels[i];
+		// 1) outputs
+		if (set_outputs == NULL || set_outputs[i])
+		{
+			sv = &shm->panels[p->index].outputs;
+			blinkenlight_api_shm_write_begin(sv);
+			for (i_control = 0; i_control < p->controls_count; i_control++)
+				if (!p->controls[i_control].is_input)
+					sv->values[i_control] = p->controls[i_control].value;
+			blinkenlight_api_shm_write_end(sv);
+			outputcontrols_values_sent(p);
+		}
+		// 2) inputs. server writes them for microseconds only
+		sv = &shm->panels[p->index].inputs;
+		do
+		{
+			sequence = blinkenlight_api_shm_read_begin(sv);
+			for (i_control = 0; i_control < p->controls_count; i_control++)
+				values[i_control] = sv->values[i_control];
+		} while (blinkenlight_api_shm_read_retry(sv, sequence));
 		for (i_control = 0; i_control < p->controls_count; i_control++)
 		{
 			c = &(p->controls[i_control]);
 			if (c->is_input)
 			{
-				assert(
-						value_byte_ptr  < (result_valuelist->value_bytes.value_bytes_val + result_valuelist->value_bytes.value_bytes_len) );
-				value = decode_uint64_from_bytes(value_byte_ptr, c->value_bytelen);
 				c->value_previous = c->value;
-				c->value = value;
-				value_byte_ptr += c->value_bytelen;
+				c->value = values[i_control];
 			}
 		}
 	}
-	xdr_free((xdrproc_t)xdr_rpc_blinkenlight_api_controlvalues_struct, (char*)result_valuelist) ;
+	return 0;
+#endif
+}
+
+/*
+ *	write output controls and read input controls of several panels
+ *	in a single RPC round trip.
+ *	set_outputs[i] != 0: outputs of panels[i] are written, else only inputs are read.
+ *	set_outputs == NULL: write outputs of all panels.
+ *	Outputs are sent delta encoded, if the server has the previous values.
+ *	A panel may be listed only once.
+ *	Servers without the EXCHANGE procedure (older blinkenlightd, Java panelsim)
+ *	are served with separate SET/GET calls per panel.
+ */
+blinkenlight_api_status_t blinkenlight_api_client_exchange_controls_values(
+		blinkenlight_api_client_t *_this, blinkenlight_panel_t **panels, int *set_outputs,
+		unsigned panels_count)
+{
+	rpc_blinkenlight_api_panel_controlvalues_struct outputs_panels[MAX_BLINKENLIGHT_PANELS];
+	rpc_blinkenlight_api_panels_controlvalues_struct outputs;
+	values_reply_t reply;
+	rpc_blinkenlight_api_panels_controlvalues_struct *result = &reply.res.panels_controlvalues;
+	rpc_blinkenlight_api_panel_controlvalues_struct *pr;
+	unsigned char listed[MAX_BLINKENLIGHT_PANELS];
+	struct rpc_err rpc_error;
+	blinkenlight_panel_t *p;
+	unsigned i;
+	int error_code;
+	int resync_retry = 1;
+
+	if (_this->shm)
+		return exchange_controls_values_shm(_this, panels, set_outputs, panels_count);
+
+	// values of a panel are encoded and decoded in the panel's buffers
+	memset(listed, 0, sizeof(listed));
+	for (i = 0; i < panels_count; i++)
+		if (listed[panels[i]->index]++)
+		{
+			sprintf(_this->error_text,
+					"Error in blinkenlight_api_exchange_panels_controlvalues():\n"
+							"panel %s listed twice.", panels[i]->name);
+			_this->error_file = __FILE__;
+			_this->error_line = __LINE__;
+			return 1; // error
+		}
+
+	while (!_this->exchange_unavailable)
+	{
+		// 1) one list entry per panel, with output values if requested
+		outputs.error_code = 0;
+		outputs.client_id = _this->client_id;
+		outputs.panels.panels_len = panels_count;
+		outputs.panels.panels_val = outputs_panels;
+		memset(outputs_panels, 0, sizeof(outputs_panels));
+		for (i = 0; i < panels_count; i++)
+		{
+			p = panels[i];
+			outputs.panels.panels_val[i].i_panel = p->index;
+			if (set_outputs == NULL || set_outputs[i])
+				exchange_encode_outputs(_this, p, &outputs.panels.panels_val[i]);
+		}
+
+		// 2) list filled, call server proc
+		reply.client = _this;
+		if (clnt_call((CLIENT *) _this->rpc_client,
+				RPC_BLINKENLIGHT_API_EXCHANGE_PANELS_CONTROLVALUES,
+				(xdrproc_t) xdr_panels_controlvalues_argument_inplace, (caddr_t) &outputs,
+				(xdrproc_t) xdr_panels_controlvalues_reply, (caddr_t) &reply,
+				rpc_call_timeout) != RPC_SUCCESS)
+		{
+			clnt_geterr((CLIENT *) _this->rpc_client, &rpc_error);
+			if (rpc_error.re_status != RPC_PROCUNAVAIL)
+			{
+				// An error occurred while calling the server: Get rpc error message and die.
+				strcpy(_this->error_text,
+						clnt_sperror((CLIENT *) _this->rpc_client, _this->rpc_server_hostname));
+				_this->error_file = __FILE__;
+				_this->error_line = __LINE__;
+				return 1; // error
+			}
+			// server does not know EXCHANGE: fall back to SET/GET from now on
+			_this->exchange_unavailable = 1;
+			break;
+		}
+
+		error_code = result->error_code;
+		if (error_code == RPC_BLINKENLIGHT_API_ERR_RESYNC && resync_retry)
+		{
+			// server lost our output state: send complete values once more
+			for (i = 0; i < panels_count; i++)
+				panels[i]->outputs_delta_valid = 0;
+			resync_retry = 0;
+			continue;
+		}
+
+		// 4) decode input values, mark outputs as sent
+		if (error_code == 0 && result->panels.panels_len != panels_count)
+		{
+			sprintf(_this->error_text,
+					"Error in blinkenlight_api_exchange_panels_controlvalues():\n"
+							"%d panels requested, but %d received.", panels_count,
+					result->panels.panels_len);
+			error_code = 1;
+		} else if (error_code)
+			sprintf(_this->error_text,
+					"Error in blinkenlight_api_exchange_panels_controlvalues(): server error %d",
+					error_code);
+		for (i = 0; error_code == 0 && i < panels_count; i++)
+		{
+			p = panels[i];
+			pr = &result->panels.panels_val[i];
+			if (set_outputs == NULL || set_outputs[i])
+			{
+				outputcontrols_values_sent(p);
+				p->outputs_delta_valid = 1;
+			}
+			if (pr->i_panel != p->index)
+			{
+				sprintf(_this->error_text,
+						"Error in blinkenlight_api_exchange_panels_controlvalues():\n"
+								"panel %d requested, but %d received.", p->index, pr->i_panel);
+				error_code = 1;
+			} else if (decode_inputcontrols_values(_this, p, pr->value_bytes.value_bytes_val,
+					pr->value_bytes.value_bytes_len))
+				error_code = 1;
+		}
+		if (error_code)
+		{
+			_this->error_file = __FILE__;
+			_this->error_line = __LINE__;
+			return 1; // error
+		}
+		return 0; // OK
+	}
+
+	// fall back: separate calls per panel
+	for (i = 0; i < panels_count; i++)
+	{
+		p = panels[i];
+		if (set_outputs == NULL || set_outputs[i])
+			if (blinkenlight_api_client_set_outputcontrols_values(_this, p))
+				return 1;
+		if (blinkenlight_api_client_get_inputcontrols_values(_this, p))
+			return 1;
+	}
 	return 0; // OK
 }
 
+
 /*
- *	write values from client outputs controls to server control's
- *      on success: value_previous := value
+ *	Wait until input controls change on the server, or timeout_ms is over.
+ *	The server holds back the answer of a WAIT call, until it has changes
+ *	(long poll), so there's no steady state polling.
+ *	WAIT calls are made over a separate TCP connection, so the long poll
+ *	does not block other calls. Only the changed controls are transmitted.
+ *	*changed: 1 = new input values in p, value_previous := old value
+ *	If the server has no WAIT procedure, wait_unavailable is set and
+ *	an error returned: caller must then poll with get_inputcontrols_values().
  */
-blinkenlight_api_status_t blinkenlight_api_client_set_outputcontrols_values(
-		blinkenlight_api_client_t *_this, blinkenlight_panel_t *p)
+blinkenlight_api_status_t blinkenlight_api_client_wait_inputcontrols_values(
+		blinkenlight_api_client_t *_this, blinkenlight_panel_t *p, unsigned timeout_ms,
+		int *changed)
 {
-	rpc_blinkenlight_api_controlvalues_struct valuelist;
+	rpc_blinkenlight_api_wait_inputs_struct wait;
+	rpc_blinkenlight_api_inputs_changes_struct *result;
+	struct rpc_err rpc_error;
+	struct timeval tv;
 	blinkenlight_control_t *c;
-	unsigned i_control;
-	unsigned char *value_byte_ptr; // index in result value byte stream
-	rpc_blinkenlight_api_setpanel_controlvalues_res *result;
-
-	// 1) fill valuelist with values of output controls
-	valuelist.error_code = 0;
-	valuelist.value_bytes.value_bytes_len = p->controls_outputs_values_bytecount;
-	valuelist.value_bytes.value_bytes_val = (u_char *) calloc(p->controls_outputs_values_bytecount,
-			sizeof(u_char));
-	assert(valuelist.value_bytes.value_bytes_val);
+	unsigned i_control, i_input;
+	unsigned char *value_byte_ptr; // index in received value byte stream
+	unsigned value_bytecount;
 
-	/* go through all output controls, assign value from each into result stream
-	 * each output control puts "value_bytelen" bytes into char stream, lsb first */
-	value_byte_ptr = valuelist.value_bytes.value_bytes_val;
-	for (i_control = 0; i_control < p->controls_count; i_control++)
+	*changed = 0;
+	if (_this->wait_unavailable)
 	{
-		c = &(p->controls[i_control]);
-		if (!c->is_input)
+		sprintf(_this->error_text, "Server has no WAIT_PANEL_INPUTCONTROLS procedure");
+		_this->error_file = __FILE__;
+		_this->error_line = __LINE__;
+		return 1;
+	}
+	if (_this->rpc_client_wait == NULL)
+	{
+		_this->rpc_client_wait = clnt_create(_this->rpc_server_hostname, BLINKENLIGHTD,
+				BLINKENLIGHTD_VERS, "tcp");
+		if (_this->rpc_client_wait == NULL)
 		{
-			assert(
-					value_byte_ptr < (valuelist.value_bytes.value_bytes_val + valuelist.value_bytes.value_bytes_len));
-			encode_uint64_to_bytes(value_byte_ptr, c->value, c->value_bytelen);
-			value_byte_ptr += c->value_bytelen; // next pos in buffer
+			strcpy(_this->error_text, clnt_spcreateerror(_this->rpc_server_hostname));
+			_this->error_file = __FILE__;
+			_this->error_line = __LINE__;
+			return 1; // error
 		}
 	}
-	// 2) list filled, call server proc
-	result = rpc_blinkenlight_api_setpanel_controlvalues_1(p->index, valuelist,
-			(CLIENT *) _this->rpc_client);
+	// server answers after timeout_ms latest
+	tv.tv_sec = (timeout_ms + 5000) / 1000;
+	tv.tv_usec = ((timeout_ms + 5000) % 1000) * 1000;
+	clnt_control((CLIENT *) _this->rpc_client_wait, CLSET_TIMEOUT, (char *) &tv);
+
+	wait.i_panel = p->index;
+	wait.sequence = p->inputs_sequence;
+	wait.timeout_ms = timeout_ms;
+	result = rpc_blinkenlight_api_wait_panel_inputcontrols_1(wait,
+			(CLIENT *) _this->rpc_client_wait);
 	if (result == NULL)
 	{
+		clnt_geterr((CLIENT *) _this->rpc_client_wait, &rpc_error);
+		if (rpc_error.re_status == RPC_PROCUNAVAIL)
+			_this->wait_unavailable = 1;
 		// An error occurred while calling the server: Get rpc error message and die.
 		strcpy(_this->error_text,
-				clnt_sperror((CLIENT *) _this->rpc_client, _this->rpc_server_hostname));
+				clnt_sperror((CLIENT *) _this->rpc_client_wait, _this->rpc_server_hostname));
 		_this->error_file = __FILE__;
 		_this->error_line = __LINE__;
 		return 1; // error
 	}
-	assert(result->error_code == 0);
-
-	// 3) free list
-	free(valuelist.value_bytes.value_bytes_val);
+	if (result->error_code)
+	{
+		sprintf(_this->error_text,
+				"Error in blinkenlight_api_wait_panel_inputcontrols(): server error %d",
+				result->error_code);
+		xdr_free((xdrproc_t) xdr_rpc_blinkenlight_api_inputs_changes_struct, (char *) result);
+		_this->error_file = __FILE__;
+		_this->error_line = __LINE__;
+		return 1;
+	}
+	if (result->sequence == p->inputs_sequence)
+	{
+		// timeout, no change
+		xdr_free((xdrproc_t) xdr_rpc_blinkenlight_api_inputs_changes_struct, (char *) result);
+		return 0;
+	}
 
-	// 4) output successful: set value_previous" to value
-	for (i_control = 0; i_control < p->controls_count; i_control++)
+	if (result->changed_bitmap.changed_bitmap_len == 0)
 	{
-		c = &(p->controls[i_control]);
-		if (!c->is_input)
-			c->value_previous = c->value;
+		// all inputs
+		if (decode_inputcontrols_values(_this, p, result->value_bytes.value_bytes_val,
+				result->value_bytes.value_bytes_len))
+		{
+			xdr_free((xdrproc_t) xdr_rpc_blinkenlight_api_inputs_changes_struct, (char *) result);
+			return 1;
+		}
+	} else
+	{
+		// only changed inputs. check bitmap and value count first
+		value_bytecount = 0;
+		for (i_input = i_control = 0; i_control < p->controls_count; i_control++)
+		{
+			c = &(p->controls[i_control]);
+			if (c->is_input)
+			{
+				if (i_input / 8 < result->changed_bitmap.changed_bitmap_len
+						&& (result->changed_bitmap.changed_bitmap_val[i_input / 8]
+								& (1 << (i_input % 8))))
+					value_bytecount += c->value_bytelen;
+				i_input++;
+			}
+		}
+		if (result->changed_bitmap.changed_bitmap_len != (p->controls_inputs_count + 7) / 8
+				|| result->value_bytes.value_bytes_len != value_bytecount)
+		{
+			sprintf(_this->error_text,
+					"Error in blinkenlight_api_wait_panel_inputcontrols():\n"
+							"Panel[%s]: %d changed value bytes expected, but %d received.",
+					p->name, value_bytecount, result->value_bytes.value_bytes_len);
+			xdr_free((xdrproc_t) xdr_rpc_blinkenlight_api_inputs_changes_struct, (char *) result);
+			_this->error_file = __FILE__;
+			_this->error_line = __LINE__;
+			return 1;
+		}
+		value_byte_ptr = result->value_bytes.value_bytes_val;
+		for (i_input = i_control = 0; i_control < p->controls_count; i_control++)
+		{
+			c = &(p->controls[i_control]);
+			if (c->is_input)
+			{
+				c->value_previous = c->value;
+				if (result->changed_bitmap.changed_bitmap_val[i_input / 8] & (1 << (i_input % 8)))
+				{
+					c->value = decode_uint64_from_bytes(value_byte_ptr, c->value_bytelen);
+					value_byte_ptr += c->value_bytelen;
+				}
+				i_input++;
+			}
+		}
 	}
-	xdr_free((xdrproc_t)xdr_rpc_blinkenlight_api_setpanel_controlvalues_res, (char *)result) ;
+	p->inputs_sequence = result->sequence;
+	p->inputs_timestamp_us = result->timestamp_us;
+	*changed = 1;
+	xdr_free((xdrproc_t) xdr_rpc_blinkenlight_api_inputs_changes_struct, (char *) result);
 	return 0; // OK
 }
 
@@ -462,3 +1542,94 @@ blinkenlight_api_status_t blinkenlight_api_client_set_object_param(blinkenlight_
 	return error_code;
 }
 
+/*
+ * Performance tests
+ * test_data_to_server(): send "bytecount" bytes, server must have received all.
+ */
+blinkenlight_api_status_t blinkenlight_api_client_test_data_to_server(
+		blinkenlight_api_client_t *_this, unsigned bytecount)
+{
+	static unsigned char *data_buffer = NULL;
+	static unsigned data_buffer_size = 0;
+	rpc_test_cmdstatus_struct *result;
+	rpc_test_data_struct data;
+	int received_bytecount;
+
+	if (bytecount > data_buffer_size) {
+		data_buffer = (unsigned char *) realloc(data_buffer, bytecount);
+		assert(data_buffer);
+		memset(data_buffer, 0x55, bytecount);
+		data_buffer_size = bytecount;
+	}
+	data.fixdata1 = data.fixdata2 = 0;
+	data.vardata.vardata_len = bytecount;
+	data.vardata.vardata_val = data_buffer;
+
+	result = rpc_test_data_to_server_1(data, (CLIENT *) _this->rpc_client);
+	if (result == NULL)
+	{
+		// An error occurred while calling the server: Get rpc error message and die.
+		strcpy(_this->error_text,
+				clnt_sperror((CLIENT *) _this->rpc_client, _this->rpc_server_hostname));
+		_this->error_file = __FILE__;
+		_this->error_line = __LINE__;
+		return 1; // error
+	}
+	received_bytecount = result->bytecount;
+	xdr_free((xdrproc_t) xdr_rpc_test_cmdstatus_struct, (char *) result);
+	if (received_bytecount != (int) bytecount)
+	{
+		sprintf(_this->error_text, "Server received %d bytes, %u were sent",
+				received_bytecount, bytecount);
+		_this->error_file = __FILE__;
+		_this->error_line = __LINE__;
+		return 1; // error
+	}
+	return 0; // OK
+}
+
+/*
+ * test_data_from_server(): request "bytecount" bytes and verify the test pattern.
+ * *server_cpu_us: CPU time used by the server process until now, if not NULL.
+ */
+blinkenlight_api_status_t blinkenlight_api_client_test_data_from_server(
+		blinkenlight_api_client_t *_this, unsigned bytecount, uint64_t *server_cpu_us)
+{
+	rpc_test_data_struct *result;
+	rpc_test_cmdstatus_struct cmd;
+	unsigned i;
+
+	cmd.bytecount = bytecount;
+	result = rpc_test_data_from_server_1(cmd, (CLIENT *) _this->rpc_client);
+	if (result == NULL)
+	{
+		// An error occurred while calling the server: Get rpc error message and die.
+		strcpy(_this->error_text,
+				clnt_sperror((CLIENT *) _this->rpc_client, _this->rpc_server_hostname));
+		_this->error_file = __FILE__;
+		_this->error_line = __LINE__;
+		return 1; // error
+	}
+	if (result->vardata.vardata_len != bytecount)
+	{
+		sprintf(_this->error_text, "Server sent %u bytes, %u were requested",
+				result->vardata.vardata_len, bytecount);
+		_this->error_file = __FILE__;
+		_this->error_line = __LINE__;
+		xdr_free((xdrproc_t) xdr_rpc_test_data_struct, (char *) result);
+		return 1; // error
+	}
+	for (i = 0; i < bytecount; i++)
+		if (result->vardata.vardata_val[i] != (unsigned char) i)
+		{
+			sprintf(_this->error_text, "Server data corrupt at byte %u", i);
+			_this->error_file = __FILE__;
+			_this->error_line = __LINE__;
+			xdr_free((xdrproc_t) xdr_rpc_test_data_struct, (char *) result);
+			return 1; // error
+		}
+	if (server_cpu_us)
+		*server_cpu_us = (uint64_t) result->fixdata1 * 1000000 + (unsigned) result->fixdata2;
+	xdr_free((xdrproc_t) xdr_rpc_test_data_struct, (char *) result);
+	return 0; // OK
+}
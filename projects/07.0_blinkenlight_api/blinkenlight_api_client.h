@@ -21,6 +21,13 @@
    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 
+   17-Oct-2026  agent   client_id for delta encoded outputs
+   17-Oct-2026  agent   GETSCHEMA with on-disk schema cache
+   17-Oct-2026  agent   value buffers per panel
+   17-Oct-2026  agent   test_data_to/from_server(), rpc_protocol
+   17-Oct-2026  agent   shared memory transport: shm_attach()/shm_detach()
+   17-Oct-2026  agent   wait_inputcontrols_values(): input change subscription
+   17-Oct-2026  agent   exchange_controls_values(): multi panel GET/SET in one round trip
    16-Feb-2012  JH      created
  */
 
@@ -30,6 +37,8 @@
 
 //#include <rpc/rpc.h> /*  needed for CLIENT, but collision beteeen windows.h and SimH */
 
+#include <time.h>
+
 // compile with -DBLINKENLIGHT_CLIENT, for "panels"
 #include "blinkenlight_panels.h"
 
@@ -52,14 +61,42 @@ typedef struct
 	// client context for RPC. actual type is CLIENT.
 	// untyped, because can not include rpc/rcp.h -> Collision SimH/<windows.h>
 	void *rpc_client;
+	// "udp" (default) or "tcp", set before connect()
+	const char *rpc_protocol;
 
 	// list of all panels published by server
 	blinkenlight_panel_list_t *panel_list;
 
+	// value buffers of every panel, sized from its value bytecounts,
+	// in one block. Values are transferred without allocation.
+	unsigned char *value_buffers_block;
+	struct
+	{
+		unsigned char *outputs_changed_bitmap; // (controls_outputs_count + 7) / 8
+		unsigned char *outputs_value_bytes; // controls_outputs_values_bytecount
+		unsigned char *inputs_value_bytes; // controls_inputs_values_bytecount
+	} value_buffers[MAX_BLINKENLIGHT_PANELS];
+
 	char error_text[1024];
 	char *error_file;
 	int error_line;
 	int connected; // 1 between connect() and disconnect()
+	int exchange_unavailable; // 1: server has no EXCHANGE procedure, use SET/GET
+	unsigned client_id; // server keeps the sequence of our output deltas under this id
+
+	// separate TCP connection for WAIT long polls. actual type is CLIENT.
+	void *rpc_client_wait;
+	int wait_unavailable; // 1: server has no WAIT procedure, poll inputs
+
+	int schema_unavailable; // 1: server has no GETSCHEMA procedure, query item by item
+	// panel and control descriptors are cached here between connects. NULL = no cache
+	char *schema_cache_dir;
+
+	// shared memory image of the server, if attached. actual type is blinkenlight_api_shm_t.
+	// then exchange_controls_values() goes over shared memory.
+	void *shm;
+	unsigned shm_heartbeat; // last seen server heartbeat
+	time_t shm_heartbeat_time; // when it last changed
 } blinkenlight_api_client_t;
 
 // create and destroy a client object.
@@ -81,6 +118,10 @@ blinkenlight_api_status_t blinkenlight_api_client_get_controls(blinkenlight_api_
 		blinkenlight_panel_t *p);
 blinkenlight_api_status_t blinkenlight_api_client_get_panels_and_controls(
 		blinkenlight_api_client_t *_this);
+// on-disk cache for get_panels_and_controls(), NULL = off.
+// default: $BLINKENLIGHT_API_CACHE, or ~/.blinkenlight
+void blinkenlight_api_client_set_schema_cache_dir(blinkenlight_api_client_t *_this,
+		const char *dir);
 
 // read new values for input controls from server
 blinkenlight_api_status_t blinkenlight_api_client_get_inputcontrols_values(
@@ -88,6 +129,19 @@ blinkenlight_api_status_t blinkenlight_api_client_get_inputcontrols_values(
 // write changed values for output controls to the server
 blinkenlight_api_status_t blinkenlight_api_client_set_outputcontrols_values(
 		blinkenlight_api_client_t *_this, blinkenlight_panel_t *p);
+// write outputs and read inputs of several panels in one round trip
+blinkenlight_api_status_t blinkenlight_api_client_exchange_controls_values(
+		blinkenlight_api_client_t *_this, blinkenlight_panel_t **panels, int *set_outputs,
+		unsigned panels_count);
+// wait max timeout_ms until input controls change on the server.
+// *changed = 1: new input values in p
+blinkenlight_api_status_t blinkenlight_api_client_wait_inputcontrols_values(
+		blinkenlight_api_client_t *_this, blinkenlight_panel_t *p, unsigned timeout_ms,
+		int *changed);
+
+// exchange control values over shared memory, if server runs on the same host
+blinkenlight_api_status_t blinkenlight_api_client_shm_attach(blinkenlight_api_client_t *_this);
+void blinkenlight_api_client_shm_detach(blinkenlight_api_client_t *_this);
 
 // get a param of a bus, panel, control
 blinkenlight_api_status_t blinkenlight_api_client_get_object_param(blinkenlight_api_client_t *_this,
@@ -97,4 +151,10 @@ blinkenlight_api_status_t blinkenlight_api_client_set_object_param(blinkenlight_
 		unsigned object_class, unsigned object_handle, unsigned param_handle,
 		unsigned param_value);
 
+// performance tests: transfer test data of "bytecount" bytes
+blinkenlight_api_status_t blinkenlight_api_client_test_data_to_server(
+		blinkenlight_api_client_t *_this, unsigned bytecount);
+blinkenlight_api_status_t blinkenlight_api_client_test_data_from_server(
+		blinkenlight_api_client_t *_this, unsigned bytecount, uint64_t *server_cpu_us);
+
 #endif /* BLINKENLIGHT_API_CLIENT_H_ */
@@ -20,6 +20,19 @@
  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+ 17-Oct-2026  agent   RPC_PROC() initializes all fields
+ 17-Oct-2026  agent   no worker for a request followed by more in the same record stream
+ 17-Oct-2026  agent   delta sequence per client: a delta of one client is never taken for another's
+ 17-Oct-2026  agent   request pool, value buffers per request, in place XDR: no malloc() per call
+ 17-Oct-2026  agent   own dispatcher, results per request, worker threads, panel locks
+ 17-Oct-2026  agent   shm_service() reports client activity, subscriptions_count()
+ 17-Oct-2026  agent   RPC_PARAM_CLASS_BUS: runtime metrics
+ 17-Oct-2026  agent   getschema(): all panel and control descriptors in one call
+ 17-Oct-2026  agent   test_data_to_server()/test_data_from_server() for benchmarks
+ 17-Oct-2026  agent   shared memory image for clients on the same host
+ 17-Oct-2026  agent   wait_panel_inputcontrols(): input change subscription
+ 17-Oct-2026  agent   exchange_panels_controlvalues(): delta encoded outputs
+ 17-Oct-2026  agent   exchange_panels_controlvalues(): multi panel GET/SET in one call
  04-Aug-2016  JH      activated bitwise input lowpass for pin debouncing (c->fmax)
  08-May-2016  JH      new event "set_controlvalue"
  22-Feb-2016  JH	  added panel mode set/get callbacks
@@ -29,6 +42,21 @@
  To get a template file generated by rpcgen,
  do "make demo" in the blinkenlight_api directory
 
+ The rpcgen dispatcher blinkenlightd_1() is not used: its server procedures
+ return static results, freed on the next call. Here every request has its
+ own argument and result storage, so requests on different TCP connections
+ are served in parallel by the worker threads of the reactor.
+ Requests which park the connection or call server events with static
+ data (info, params) are served in the RPC thread.
+ A panel is locked for reading while inputs are queried,
+ and for writing while outputs or panel state are set.
+
+ Requests are recycled over a free list. Each request has value buffers
+ for every panel, sized from the panel's value bytecounts. Value byte arrays
+ of SET, GET, EXCHANGE and WAIT are decoded into and encoded from these
+ buffers by the xdr_*_inplace() routines, and names in panel and control info
+ point into the panel list. So in steady state no memory is allocated per call.
+
  Calls of RPC procedures are implemented with blinkenbus_* functions
  (if interfacing to physical panel)
  OR
@@ -38,7 +66,20 @@
 
 #define BLINKENLIGHT_API_SERVER_PROCS_C_
 #include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
 #include <assert.h>
+#ifndef WIN32
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <time.h>
+#endif
 
 #include "print.h"
 
@@ -49,6 +90,10 @@
 
 // callbacks
 #include "blinkenlight_api_server_procs.h"
+#ifndef WIN32
+#include "blinkenlight_api_shm.h"
+#include "blinkenlight_api_server_reactor.h"
+#endif
 
 #include "bitcalc.h"
 
@@ -69,6 +114,554 @@ blinkenlight_api_panel_get_mode_evt_t blinkenlight_api_panel_get_mode_evt = NULL
 blinkenlight_api_panel_set_mode_evt_t blinkenlight_api_panel_set_mode_evt = NULL;
 // get api info
 blinkenlight_api_get_info_evt_t blinkenlight_api_get_info_evt;
+// server specific metrics
+blinkenlight_api_bus_get_param_evt_t blinkenlight_api_bus_get_param_evt = NULL;
+
+#ifndef WIN32
+rtsched_t *blinkenlight_api_metrics_mux_sched = NULL;
+pthread_t *blinkenlight_api_metrics_update_thread = NULL;
+#endif
+
+/*** panel locks ***/
+#ifndef WIN32
+// rwlock: output values and panel state, many readers or one writer.
+// inputs: sampling the inputs runs the get_controlvalues event and
+// updates the change marks. Always locked inside rwlock.
+typedef struct {
+	pthread_rwlock_t rwlock;
+	pthread_mutex_t inputs;
+} panel_lock_t;
+
+static panel_lock_t panel_locks[MAX_BLINKENLIGHT_PANELS];
+static pthread_once_t panel_locks_once = PTHREAD_ONCE_INIT;
+
+static void panel_locks_init(void)
+{
+	unsigned i;
+	for (i = 0; i < MAX_BLINKENLIGHT_PANELS; i++) {
+		pthread_rwlock_init(&panel_locks[i].rwlock, NULL);
+		pthread_mutex_init(&panel_locks[i].inputs, NULL);
+	}
+}
+
+static void panel_read_lock(blinkenlight_panel_t *p)
+{
+	pthread_once(&panel_locks_once, panel_locks_init);
+	pthread_rwlock_rdlock(&panel_locks[p->index].rwlock);
+}
+
+static void panel_write_lock(blinkenlight_panel_t *p)
+{
+	pthread_once(&panel_locks_once, panel_locks_init);
+	pthread_rwlock_wrlock(&panel_locks[p->index].rwlock);
+}
+
+static void panel_unlock(blinkenlight_panel_t *p)
+{
+	pthread_rwlock_unlock(&panel_locks[p->index].rwlock);
+}
+
+// caller holds the read or write lock
+static void panel_inputs_lock(blinkenlight_panel_t *p)
+{
+	pthread_mutex_lock(&panel_locks[p->index].inputs);
+}
+
+static void panel_inputs_unlock(blinkenlight_panel_t *p)
+{
+	pthread_mutex_unlock(&panel_locks[p->index].inputs);
+}
+#else
+#define panel_read_lock(p)
+#define panel_write_lock(p)
+#define panel_unlock(p)
+#define panel_inputs_lock(p)
+#define panel_inputs_unlock(p)
+#endif
+
+/*** RPC procedures ***/
+
+// server procedure: evaluates argument into result.
+// result: 1 = send reply, 0 = reply deferred
+typedef int (*rpc_proc_func_t)(void *argument, void *result, struct svc_req *rqstp);
+
+static int rpc_null_proc(void *argument, void *result, struct svc_req *rqstp);
+static int rpc_blinkenlight_api_getinfo_proc(void *argument,
+		rpc_blinkenlight_api_getinfo_res *result, struct svc_req *rqstp);
+static int rpc_blinkenlight_api_getpanelinfo_proc(u_int *i_panel,
+		rpc_blinkenlight_api_getpanelinfo_res *result, struct svc_req *rqstp);
+static int rpc_blinkenlight_api_getcontrolinfo_proc(
+		rpc_blinkenlight_api_getcontrolinfo_1_argument *argument,
+		rpc_blinkenlight_api_getcontrolinfo_res *result, struct svc_req *rqstp);
+static int rpc_blinkenlight_api_setpanel_controlvalues_proc(
+		rpc_blinkenlight_api_setpanel_controlvalues_1_argument *argument,
+		rpc_blinkenlight_api_setpanel_controlvalues_res *result, struct svc_req *rqstp);
+static int rpc_blinkenlight_api_getpanel_controlvalues_proc(u_int *i_panel,
+		rpc_blinkenlight_api_controlvalues_struct *result, struct svc_req *rqstp);
+static int rpc_blinkenlight_api_exchange_panels_controlvalues_proc(
+		rpc_blinkenlight_api_panels_controlvalues_struct *outputs,
+		rpc_blinkenlight_api_panels_controlvalues_struct *result, struct svc_req *rqstp);
+static int rpc_blinkenlight_api_wait_panel_inputcontrols_proc(
+		rpc_blinkenlight_api_wait_inputs_struct *wait,
+		rpc_blinkenlight_api_inputs_changes_struct *result, struct svc_req *rqstp);
+static int rpc_blinkenlight_api_getschema_proc(rpc_blinkenlight_api_getschema_cmd *cmd,
+		rpc_blinkenlight_api_getschema_res *result, struct svc_req *rqstp);
+static int rpc_param_get_proc(rpc_param_cmd_get_struct *cmd_get, rpc_param_result_struct *result,
+		struct svc_req *rqstp);
+static int rpc_param_set_proc(rpc_param_cmd_set_struct *cmd_set, rpc_param_result_struct *result,
+		struct svc_req *rqstp);
+static int rpc_test_data_to_server_proc(rpc_test_data_struct *data,
+		rpc_test_cmdstatus_struct *result, struct svc_req *rqstp);
+static int rpc_test_data_from_server_proc(rpc_test_cmdstatus_struct *cmd,
+		rpc_test_data_struct *result, struct svc_req *rqstp);
+
+// XDR for value transfers, without allocation
+static bool_t xdr_getpanelinfo_res_borrowed(XDR *xdrs,
+		rpc_blinkenlight_api_getpanelinfo_res *objp);
+static bool_t xdr_getcontrolinfo_res_borrowed(XDR *xdrs,
+		rpc_blinkenlight_api_getcontrolinfo_res *objp);
+static bool_t xdr_setpanel_controlvalues_argument_inplace(XDR *xdrs,
+		rpc_blinkenlight_api_setpanel_controlvalues_1_argument *objp);
+static bool_t xdr_controlvalues_inplace(XDR *xdrs,
+		rpc_blinkenlight_api_controlvalues_struct *objp);
+static bool_t xdr_panels_controlvalues_inplace(XDR *xdrs,
+		rpc_blinkenlight_api_panels_controlvalues_struct *objp);
+static bool_t xdr_inputs_changes_inplace(XDR *xdrs,
+		rpc_blinkenlight_api_inputs_changes_struct *objp);
+
+typedef struct {
+	unsigned procnum;
+	xdrproc_t xdr_argument;
+	xdrproc_t xdr_result;
+	rpc_proc_func_t func;
+	int in_rpc_thread; // never in a worker: parks the connection, or uses server events
+
+	// metrics, under rpc_proc_metrics_mutex
+	volatile uint32_t calls;
+	volatile uint32_t time_us; // sum, wraps
+	volatile uint32_t time_max_us;
+} rpc_proc_t;
+
+// all fields given: no missing-initializer warnings, metrics start at 0
+#define RPC_PROC(procnum, xdr_argument, xdr_result, func, in_rpc_thread) \
+	{ procnum, (xdrproc_t) xdr_argument, (xdrproc_t) xdr_result, (rpc_proc_func_t) func, in_rpc_thread, \
+			0, 0, 0 }
+
+static rpc_proc_t rpc_procs[] = {
+		RPC_PROC(NULLPROC, xdr_void, xdr_void, rpc_null_proc, 0),
+		RPC_PROC(RPC_BLINKENLIGHT_API_GETINFO, xdr_void, xdr_rpc_blinkenlight_api_getinfo_res,
+				rpc_blinkenlight_api_getinfo_proc, 1),
+		RPC_PROC(RPC_BLINKENLIGHT_API_GETPANELINFO, xdr_u_int, xdr_getpanelinfo_res_borrowed,
+				rpc_blinkenlight_api_getpanelinfo_proc, 0),
+		RPC_PROC(RPC_BLINKENLIGHT_API_GETCONTROLINFO,
+				xdr_rpc_blinkenlight_api_getcontrolinfo_1_argument, xdr_getcontrolinfo_res_borrowed,
+				rpc_blinkenlight_api_getcontrolinfo_proc, 0),
+		RPC_PROC(RPC_BLINKENLIGHT_API_SETPANEL_CONTROLVALUES,
+				xdr_setpanel_controlvalues_argument_inplace,
+				xdr_rpc_blinkenlight_api_setpanel_controlvalues_res,
+				rpc_blinkenlight_api_setpanel_controlvalues_proc, 0),
+		RPC_PROC(RPC_BLINKENLIGHT_API_GETPANEL_CONTROLVALUES, xdr_u_int, xdr_controlvalues_inplace,
+				rpc_blinkenlight_api_getpanel_controlvalues_proc, 0),
+		RPC_PROC(RPC_BLINKENLIGHT_API_EXCHANGE_PANELS_CONTROLVALUES,
+				xdr_panels_controlvalues_inplace, xdr_panels_controlvalues_inplace,
+				rpc_blinkenlight_api_exchange_panels_controlvalues_proc, 0),
+		RPC_PROC(RPC_BLINKENLIGHT_API_WAIT_PANEL_INPUTCONTROLS,
+				xdr_rpc_blinkenlight_api_wait_inputs_struct, xdr_inputs_changes_inplace,
+				rpc_blinkenlight_api_wait_panel_inputcontrols_proc, 1),
+		RPC_PROC(RPC_BLINKENLIGHT_API_GETSCHEMA, xdr_rpc_blinkenlight_api_getschema_cmd,
+				xdr_rpc_blinkenlight_api_getschema_res, rpc_blinkenlight_api_getschema_proc, 0),
+		RPC_PROC(RPC_PARAM_GET, xdr_rpc_param_cmd_get_struct, xdr_rpc_param_result_struct,
+				rpc_param_get_proc, 1),
+		RPC_PROC(RPC_PARAM_SET, xdr_rpc_param_cmd_set_struct, xdr_rpc_param_result_struct,
+				rpc_param_set_proc, 1),
+		RPC_PROC(RPC_TEST_DATA_TO_SERVER, xdr_rpc_test_data_struct, xdr_rpc_test_cmdstatus_struct,
+				rpc_test_data_to_server_proc, 0),
+		RPC_PROC(RPC_TEST_DATA_FROM_SERVER, xdr_rpc_test_cmdstatus_struct, xdr_rpc_test_data_struct,
+				rpc_test_data_from_server_proc, 0) };
+#define RPC_PROCS_COUNT	(sizeof(rpc_procs) / sizeof(rpc_procs[0]))
+
+#ifndef WIN32
+static pthread_mutex_t rpc_proc_metrics_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+// value buffers of one panel, sized from its value bytecounts
+typedef struct {
+	u_char *outputs_changed_bitmap; // (controls_outputs_count + 7) / 8
+	u_char *outputs_value_bytes; // controls_outputs_values_bytecount
+	u_char *inputs_changed_bitmap; // (controls_inputs_count + 7) / 8
+	u_char *inputs_value_bytes; // controls_inputs_values_bytecount
+} rpc_panel_buffers_t;
+
+// one call in progress, with its own argument and result
+typedef struct rpc_request_struct {
+#ifndef WIN32
+	blinkenlight_api_reactor_job_t job; // first: a job pointer is a request pointer
+#endif
+	struct rpc_request_struct *next_free;
+	// value byte arrays of argument and result point here. Allocated once.
+	rpc_panel_buffers_t panel_buffers[MAX_BLINKENLIGHT_PANELS];
+	// entries of EXCHANGE argument and result
+	rpc_blinkenlight_api_panel_controlvalues_struct panels_argument[MAX_BLINKENLIGHT_PANELS];
+	rpc_blinkenlight_api_panel_controlvalues_struct panels_result[MAX_BLINKENLIGHT_PANELS];
+
+	rpc_proc_t *proc;
+	SVCXPRT *transp;
+	struct svc_req rq; // copy, valid while the transport is not read again
+	uint64_t start_us;
+	union {
+		u_int i_panel;
+		rpc_blinkenlight_api_getcontrolinfo_1_argument getcontrolinfo;
+		rpc_blinkenlight_api_setpanel_controlvalues_1_argument setpanel_controlvalues;
+		rpc_blinkenlight_api_panels_controlvalues_struct panels_controlvalues;
+		rpc_blinkenlight_api_wait_inputs_struct wait_inputs;
+		rpc_blinkenlight_api_getschema_cmd getschema;
+		rpc_param_cmd_get_struct param_get;
+		rpc_param_cmd_set_struct param_set;
+		rpc_test_data_struct test_data;
+		rpc_test_cmdstatus_struct test_cmdstatus;
+	} argument;
+	union {
+		rpc_blinkenlight_api_getinfo_res getinfo;
+		rpc_blinkenlight_api_getpanelinfo_res getpanelinfo;
+		rpc_blinkenlight_api_getcontrolinfo_res getcontrolinfo;
+		rpc_blinkenlight_api_setpanel_controlvalues_res setpanel_controlvalues;
+		rpc_blinkenlight_api_controlvalues_struct controlvalues;
+		rpc_blinkenlight_api_panels_controlvalues_struct panels_controlvalues;
+		rpc_blinkenlight_api_inputs_changes_struct inputs_changes;
+		rpc_blinkenlight_api_getschema_res getschema;
+		rpc_param_result_struct param;
+		rpc_test_cmdstatus_struct test_cmdstatus;
+		rpc_test_data_struct test_data;
+	} result;
+} rpc_request_t;
+
+// request of a decoded argument, handler argument or result
+#define RPC_REQUEST_OF_ARGUMENT(argp)	\
+	((rpc_request_t *) ((char *) (argp) - offsetof(rpc_request_t, argument)))
+
+// recycled requests. Requests are never freed.
+static rpc_request_t *rpc_request_free_list = NULL;
+#ifndef WIN32
+static pthread_mutex_t rpc_request_free_list_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/*
+ * get a request from the free list, or create one with buffers for all panels.
+ * The panel list must be complete.
+ */
+static rpc_request_t *rpc_request_alloc(void)
+{
+	rpc_request_t *req;
+	blinkenlight_panel_t *p;
+	rpc_panel_buffers_t *b;
+	unsigned i_panel, bytecount;
+	u_char *buffer;
+
+#ifndef WIN32
+	pthread_mutex_lock(&rpc_request_free_list_mutex);
+#endif
+	req = rpc_request_free_list;
+	if (req)
+		rpc_request_free_list = req->next_free;
+#ifndef WIN32
+	pthread_mutex_unlock(&rpc_request_free_list_mutex);
+#endif
+	if (req == NULL) {
+		req = (rpc_request_t *) calloc(1, sizeof(rpc_request_t));
+		assert(req);
+		bytecount = 0;
+		for (i_panel = 0; i_panel < blinkenlight_panel_list->panels_count; i_panel++) {
+			p = &(blinkenlight_panel_list->panels[i_panel]);
+			bytecount += (p->controls_outputs_count + 7) / 8 + p->controls_outputs_values_bytecount
+					+ (p->controls_inputs_count + 7) / 8 + p->controls_inputs_values_bytecount;
+		}
+		buffer = (u_char *) calloc(bytecount + 1, sizeof(u_char)); // not NULL for 0 bytes
+		assert(buffer);
+		for (i_panel = 0; i_panel < blinkenlight_panel_list->panels_count; i_panel++) {
+			p = &(blinkenlight_panel_list->panels[i_panel]);
+			b = &req->panel_buffers[i_panel];
+			b->outputs_changed_bitmap = buffer;
+			buffer += (p->controls_outputs_count + 7) / 8;
+			b->outputs_value_bytes = buffer;
+			buffer += p->controls_outputs_values_bytecount;
+			b->inputs_changed_bitmap = buffer;
+			buffer += (p->controls_inputs_count + 7) / 8;
+			b->inputs_value_bytes = buffer;
+			buffer += p->controls_inputs_values_bytecount;
+		}
+	}
+	memset(&req->argument, 0, sizeof(req->argument));
+	memset(&req->result, 0, sizeof(req->result));
+	return req;
+}
+
+static void rpc_request_free(rpc_request_t *req)
+{
+#ifndef WIN32
+	pthread_mutex_lock(&rpc_request_free_list_mutex);
+#endif
+	req->next_free = rpc_request_free_list;
+	rpc_request_free_list = req;
+#ifndef WIN32
+	pthread_mutex_unlock(&rpc_request_free_list_mutex);
+#endif
+}
+
+/*
+ * XDR of a value byte array ("unsigned char x<>", each byte in an XDR unit)
+ * in a buffer of the caller, like xdr_array() of u_char.
+ * Decoding never allocates: values go into "buffer". A longer array
+ * is skipped, then *val is NULL and *len tells the received length.
+ * Nothing to free.
+ */
+static bool_t xdr_value_bytes_inplace(XDR *xdrs, u_char **val, u_int *len, u_char *buffer,
+		u_int capacity)
+{
+	int32_t *buf;
+	u_char skipped;
+	u_int i;
+
+	if (xdrs->x_op == XDR_FREE)
+		return TRUE;
+	if (!xdr_u_int(xdrs, len))
+		return FALSE;
+	if (xdrs->x_op == XDR_DECODE)
+		*val = (*len <= capacity) ? buffer : NULL;
+	if (*val == NULL) {
+		for (i = 0; i < *len; i++)
+			if (!xdr_u_char(xdrs, &skipped))
+				return FALSE;
+		return TRUE;
+	}
+	// whole array in the stream buffer: no call per byte
+	buf = XDR_INLINE(xdrs, (int) (*len * BYTES_PER_XDR_UNIT));
+	if (buf != NULL) {
+		if (xdrs->x_op == XDR_ENCODE)
+			for (i = 0; i < *len; i++)
+				IXDR_PUT_U_LONG(buf, (*val)[i]);
+		else
+			for (i = 0; i < *len; i++)
+				(*val)[i] = (u_char) IXDR_GET_U_LONG(buf);
+		return TRUE;
+	}
+	for (i = 0; i < *len; i++)
+		if (!xdr_u_char(xdrs, &(*val)[i]))
+			return FALSE;
+	return TRUE;
+}
+
+// names point into the panel list: nothing to free
+static bool_t xdr_getpanelinfo_res_borrowed(XDR *xdrs,
+		rpc_blinkenlight_api_getpanelinfo_res *objp)
+{
+	if (xdrs->x_op == XDR_FREE)
+		return TRUE;
+	return xdr_rpc_blinkenlight_api_getpanelinfo_res(xdrs, objp);
+}
+
+static bool_t xdr_getcontrolinfo_res_borrowed(XDR *xdrs,
+		rpc_blinkenlight_api_getcontrolinfo_res *objp)
+{
+	if (xdrs->x_op == XDR_FREE)
+		return TRUE;
+	return xdr_rpc_blinkenlight_api_getcontrolinfo_res(xdrs, objp);
+}
+
+// decodes only into rpc_request_t.argument: values into the output buffer of the panel
+static bool_t xdr_setpanel_controlvalues_argument_inplace(XDR *xdrs,
+		rpc_blinkenlight_api_setpanel_controlvalues_1_argument *objp)
+{
+	rpc_blinkenlight_api_controlvalues_struct *valuelist = &objp->valuelist;
+	u_char *buffer = NULL;
+	u_int capacity = 0;
+
+	if (!xdr_u_int(xdrs, &objp->arg1) || !xdr_int(xdrs, &valuelist->error_code))
+		return FALSE;
+	if (xdrs->x_op == XDR_DECODE && objp->arg1 < blinkenlight_panel_list->panels_count) {
+		buffer = RPC_REQUEST_OF_ARGUMENT(objp)->panel_buffers[objp->arg1].outputs_value_bytes;
+		capacity = blinkenlight_panel_list->panels[objp->arg1].controls_outputs_values_bytecount;
+	}
+	return xdr_value_bytes_inplace(xdrs, &valuelist->value_bytes.value_bytes_val,
+			&valuelist->value_bytes.value_bytes_len, buffer, capacity);
+}
+
+// result of GETPANEL_CONTROLVALUES
+static bool_t xdr_controlvalues_inplace(XDR *xdrs, rpc_blinkenlight_api_controlvalues_struct *objp)
+{
+	if (!xdr_int(xdrs, &objp->error_code))
+		return FALSE;
+	return xdr_value_bytes_inplace(xdrs, &objp->value_bytes.value_bytes_val,
+			&objp->value_bytes.value_bytes_len, NULL, 0);
+}
+
+/*
+ * EXCHANGE argument and result.
+ * Decodes only into rpc_request_t.argument: entries into panels_argument[],
+ * output values into the buffers of their panels.
+ */
+static bool_t xdr_panels_controlvalues_inplace(XDR *xdrs,
+		rpc_blinkenlight_api_panels_controlvalues_struct *objp)
+{
+	rpc_blinkenlight_api_panel_controlvalues_struct *po;
+	rpc_request_t *req = NULL;
+	rpc_panel_buffers_t *b;
+	blinkenlight_panel_t *p;
+	unsigned i;
+
+	if (xdrs->x_op == XDR_FREE)
+		return TRUE;
+	if (!xdr_int(xdrs, &objp->error_code) || !xdr_u_int(xdrs, &objp->client_id)
+			|| !xdr_u_int(xdrs, &objp->panels.panels_len))
+		return FALSE;
+	if (xdrs->x_op == XDR_DECODE) {
+		if (objp->panels.panels_len > MAX_BLINKENLIGHT_PANELS)
+			return FALSE; // a panel may be listed only once
+		req = RPC_REQUEST_OF_ARGUMENT(objp);
+		objp->panels.panels_val = req->panels_argument;
+	}
+	for (i = 0; i < objp->panels.panels_len; i++) {
+		po = &objp->panels.panels_val[i];
+		if (!xdr_u_int(xdrs, &po->i_panel) || !xdr_u_int(xdrs, &po->sequence))
+			return FALSE;
+		if (req && po->i_panel < blinkenlight_panel_list->panels_count) {
+			p = &(blinkenlight_panel_list->panels[po->i_panel]);
+			b = &req->panel_buffers[po->i_panel];
+			if (!xdr_value_bytes_inplace(xdrs, &po->changed_bitmap.changed_bitmap_val,
+					&po->changed_bitmap.changed_bitmap_len, b->outputs_changed_bitmap,
+					(p->controls_outputs_count + 7) / 8)
+					|| !xdr_value_bytes_inplace(xdrs, &po->value_bytes.value_bytes_val,
+							&po->value_bytes.value_bytes_len, b->outputs_value_bytes,
+							p->controls_outputs_values_bytecount))
+				return FALSE;
+		} else if (!xdr_value_bytes_inplace(xdrs, &po->changed_bitmap.changed_bitmap_val,
+				&po->changed_bitmap.changed_bitmap_len, NULL, 0)
+				|| !xdr_value_bytes_inplace(xdrs, &po->value_bytes.value_bytes_val,
+						&po->value_bytes.value_bytes_len, NULL, 0))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+// WAIT result, encode only
+static bool_t xdr_inputs_changes_inplace(XDR *xdrs,
+		rpc_blinkenlight_api_inputs_changes_struct *objp)
+{
+	if (!xdr_int(xdrs, &objp->error_code) || !xdr_u_int(xdrs, &objp->sequence)
+			|| !xdr_u_quad_t(xdrs, &objp->timestamp_us))
+		return FALSE;
+	return xdr_value_bytes_inplace(xdrs, &objp->changed_bitmap.changed_bitmap_val,
+			&objp->changed_bitmap.changed_bitmap_len, NULL, 0)
+			&& xdr_value_bytes_inplace(xdrs, &objp->value_bytes.value_bytes_val,
+					&objp->value_bytes.value_bytes_len, NULL, 0);
+}
+
+static rpc_proc_t *rpc_proc_find(unsigned procnum)
+{
+	unsigned i;
+	for (i = 0; i < RPC_PROCS_COUNT; i++)
+		if (rpc_procs[i].procnum == procnum)
+			return &rpc_procs[i];
+	return NULL;
+}
+
+/*
+ * execute a request, send the reply, free the request.
+ * Measured time includes decoding arguments, waiting for a worker,
+ * execution and sending the reply.
+ */
+static void rpc_request_serve(rpc_request_t *req)
+{
+	rpc_proc_t *proc = req->proc;
+	uint32_t time_us;
+
+	if (proc->func(&req->argument, &req->result, &req->rq)
+			&& !svc_sendreply(req->transp, proc->xdr_result, (caddr_t) &req->result))
+		svcerr_systemerr(req->transp);
+	xdr_free(proc->xdr_result, (char *) &req->result);
+	xdr_free(proc->xdr_argument, (char *) &req->argument);
+
+	time_us = (uint32_t) (historybuffer_now_us() - req->start_us);
+#ifndef WIN32
+	pthread_mutex_lock(&rpc_proc_metrics_mutex);
+#endif
+	proc->calls++;
+	proc->time_us += time_us;
+	if (time_us > proc->time_max_us)
+		proc->time_max_us = time_us;
+#ifndef WIN32
+	pthread_mutex_unlock(&rpc_proc_metrics_mutex);
+#endif
+	rpc_request_free(req);
+}
+
+// only stream connections can be served by a worker, or hold a deferred reply
+static int transp_is_stream(SVCXPRT *transp)
+{
+	int sock_type = 0;
+	socklen_t optlen = sizeof(sock_type);
+	if (getsockopt(transp->xp_sock, SOL_SOCKET, SO_TYPE, (char *) &sock_type, &optlen) != 0)
+		return 0;
+	return sock_type == SOCK_STREAM;
+}
+
+#ifndef WIN32
+// reactor job of a request, in a worker thread
+static void rpc_request_job(blinkenlight_api_reactor_job_t *job)
+{
+	rpc_request_t *req = (rpc_request_t *) job;
+	if (job->cancelled) {
+		xdr_free(req->proc->xdr_argument, (char *) &req->argument);
+		rpc_request_free(req);
+	} else
+		rpc_request_serve(req);
+}
+#endif
+
+/*
+ * Dispatcher for all procedures of BLINKENLIGHTD, register with svc_register().
+ * Decodes the arguments, then serves the request at once or in a worker.
+ * UDP requests share one transport, which is overwritten by the next
+ * datagram: they are always served here.
+ * The reply takes its xid from the transport, which is overwritten by the
+ * next request of the same record stream (XPRT_MOREREQS): only the last
+ * request read from a connection is given to a worker.
+ */
+void blinkenlight_api_server_dispatch(struct svc_req *rqstp, SVCXPRT *transp)
+{
+	rpc_proc_t *proc;
+	rpc_request_t *req;
+
+	proc = rpc_proc_find(rqstp->rq_proc);
+	if (proc == NULL) {
+		svcerr_noproc(transp);
+		return;
+	}
+	req = rpc_request_alloc();
+	req->start_us = historybuffer_now_us();
+	if (!svc_getargs(transp, proc->xdr_argument, (caddr_t) &req->argument)) {
+		svcerr_decode(transp);
+		rpc_request_free(req);
+		return;
+	}
+	req->proc = proc;
+	req->transp = transp;
+	req->rq = *rqstp;
+#ifndef WIN32
+	if (!proc->in_rpc_thread && blinkenlight_api_reactor_workers > 0 && transp_is_stream(transp)
+			&& SVC_STAT(transp) != XPRT_MOREREQS) {
+		req->job.fd = transp->xp_sock;
+		req->job.func = rpc_request_job;
+		blinkenlight_api_reactor_submit(&req->job);
+		return;
+	}
+#endif
+	rpc_request_serve(req);
+}
+
+static int rpc_null_proc(void *argument, void *result, struct svc_req *rqstp)
+{
+	return 1;
+}
 
 // global flags
 char blinkenlight_api_program_info[1024]; // argv[0]
@@ -82,27 +675,20 @@ char blinkenlight_api_program_options[1024]; // argv[1..arc-1]
  * 	- compile date
  */
 
-rpc_blinkenlight_api_getinfo_res*
-rpc_blinkenlight_api_getinfo_1_svc(struct svc_req *rqstp)
+static int rpc_blinkenlight_api_getinfo_proc(void *argument,
+		rpc_blinkenlight_api_getinfo_res *result, struct svc_req *rqstp)
 {
-	static rpc_blinkenlight_api_getinfo_res result;
 	char buffer[1024];
 
-	/*
-	 * insert server code here
-	 */
-
-	// free previous result
-	xdr_free((xdrproc_t) xdr_rpc_blinkenlight_api_getinfo_res, (char *) &result);
 	buffer[0] = 0;
 
 	if (blinkenlight_api_get_info_evt)
 		strcat(buffer, blinkenlight_api_get_info_evt());
 
 	// allocate new result
-	result.error_code = 0;
-	result.info = strdup(buffer);
-	return &result;
+	result->error_code = 0;
+	result->info = strdup(buffer);
+	return 1;
 }
 
 /*
@@ -111,37 +697,29 @@ rpc_blinkenlight_api_getinfo_1_svc(struct svc_req *rqstp)
  * i_panel is just the index in blinkenlight_panel_list.panels[]
  * if invalid index: result.errno=1, else errno=0
  */
-rpc_blinkenlight_api_getpanelinfo_res *
-rpc_blinkenlight_api_getpanelinfo_1_svc(u_int i_panel, struct svc_req *rqstp)
+static int rpc_blinkenlight_api_getpanelinfo_proc(u_int *i_panel,
+		rpc_blinkenlight_api_getpanelinfo_res *result, struct svc_req *rqstp)
 {
-	static rpc_blinkenlight_api_getpanelinfo_res result;
 	blinkenlight_panel_t *p;
 
-	print(LOG_DEBUG, "blinkenlight_api_getpanelinfo(i_panel=%d)\n", i_panel);
-	if (i_panel >= blinkenlight_panel_list->panels_count) {
+	print(LOG_DEBUG, "blinkenlight_api_getpanelinfo(i_panel=%d)\n", *i_panel);
+	if (*i_panel >= blinkenlight_panel_list->panels_count) {
 		print(LOG_DEBUG, "  i_panel > panels_count\n");
-		result.error_code = 1;
+		result->error_code = 1;
 	} else {
-		p = &(blinkenlight_panel_list->panels[i_panel]);
+		p = &(blinkenlight_panel_list->panels[*i_panel]);
 
-		// free previous result
-		xdr_free((xdrproc_t) xdr_rpc_blinkenlight_api_getpanelinfo_res, (char *) &result);
+		// the panel list does not change while the server runs
+		result->panel.name = p->name;
+		result->panel.controls_outputs_count = p->controls_outputs_count;
+		result->panel.controls_inputs_count = p->controls_inputs_count;
+		result->panel.controls_inputs_values_bytecount = p->controls_inputs_values_bytecount;
+		result->panel.controls_outputs_values_bytecount = p->controls_outputs_values_bytecount;
 
-		// allocate new result
-		result.panel.name = strdup(p->name);
-		//result.panel.info = strdup(p->info);
-		result.panel.controls_outputs_count = p->controls_outputs_count;
-		result.panel.controls_inputs_count = p->controls_inputs_count;
-		result.panel.controls_inputs_values_bytecount = p->controls_inputs_values_bytecount;
-		result.panel.controls_outputs_values_bytecount = p->controls_outputs_values_bytecount;
-
-		// return panel from definition to result. Its ust the name for the moment
-		//strncpy(result.blinkenlight_api_getpanelinfo_res_u.panel.name, p->name,
-		//		sizeof(result.blinkenlight_api_getpanelinfo_res_u.panel.name));
-		result.error_code = 0;
-		print(LOG_DEBUG, "  result.name=%s, ...\n", result.panel.name);
+		result->error_code = 0;
+		print(LOG_DEBUG, "  result.name=%s, ...\n", result->panel.name);
 	}
-	return &result;
+	return 1;
 }
 
 /*
@@ -150,10 +728,12 @@ rpc_blinkenlight_api_getpanelinfo_1_svc(u_int i_panel, struct svc_req *rqstp)
  * i_control is the index in blinkenlight_panel_list.panels[i_panel].controls[]
  * if invalid index: result.errno=1, else errno=0
  */
-rpc_blinkenlight_api_getcontrolinfo_res *
-rpc_blinkenlight_api_getcontrolinfo_1_svc(u_int i_panel, u_int i_control, struct svc_req *rqstp)
+static int rpc_blinkenlight_api_getcontrolinfo_proc(
+		rpc_blinkenlight_api_getcontrolinfo_1_argument *argument,
+		rpc_blinkenlight_api_getcontrolinfo_res *result, struct svc_req *rqstp)
 {
-	static rpc_blinkenlight_api_getcontrolinfo_res result;
+	unsigned i_panel = argument->arg1;
+	unsigned i_control = argument->arg2;
 	blinkenlight_panel_t *p;
 	blinkenlight_control_t *c;
 
@@ -162,33 +742,281 @@ rpc_blinkenlight_api_getcontrolinfo_1_svc(u_int i_panel, u_int i_control, struct
 
 	if (i_panel >= blinkenlight_panel_list->panels_count) {
 		print(LOG_DEBUG, "  i_panel > panels_count\n");
-		result.error_code = 1; // invalid panel
+		result->error_code = 1; // invalid panel
 	} else {
 		p = &(blinkenlight_panel_list->panels[i_panel]);
 		if (i_control >= p->controls_count) {
 			print(LOG_DEBUG, "  i_control > controls_count\n");
-			result.error_code = 1; // invalid control
+			result->error_code = 1; // invalid control
 		} else {
 			c = &(p->controls[i_control]);
-			// free previous result
-			xdr_free((xdrproc_t) xdr_rpc_blinkenlight_api_getcontrolinfo_res, (char *) &result);
-
-			// allocate new result
-			result.control.name = strdup(c->name);
-			result.control.is_input = c->is_input;
-			result.control.type = c->type;
-			result.control.radix = c->radix;
-			result.control.value_bitlen = c->value_bitlen;
-			result.control.value_bytelen = c->value_bytelen;
-
-			//strncpy(result.blinkenlight_api_getcontrolinfo_res_u.control.name, c->name,
-			//		sizeof(result.blinkenlight_api_getcontrolinfo_res_u.control.name));
-			result.error_code = 0;
-			print(LOG_DEBUG, "  result.name=%s, ...\n", result.control.name);
+
+			result->control.name = c->name;
+			result->control.is_input = c->is_input;
+			result->control.type = c->type;
+			result->control.radix = c->radix;
+			result->control.value_bitlen = c->value_bitlen;
+			result->control.value_bytelen = c->value_bytelen;
+
+			result->error_code = 0;
+			print(LOG_DEBUG, "  result.name=%s, ...\n", result->control.name);
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * getschema()
+ * all panels and controls, like getpanelinfo() and getcontrolinfo() for every
+ * handle. The schema does not change while the server runs. Its hash is
+ * cheap against the encoding, so it is calculated on every call
+ * and needs no lock.
+ * Nothing is sent, if the client knows the schema already, or if the result
+ * is larger than the client can receive.
+ */
+static int rpc_blinkenlight_api_getschema_proc(rpc_blinkenlight_api_getschema_cmd *cmd,
+		rpc_blinkenlight_api_getschema_res *result, struct svc_req *rqstp)
+{
+	uint64_t schema_hash;
+	unsigned i_panel, i_control;
+
+	schema_hash = blinkenlight_panels_get_schema_hash(blinkenlight_panel_list);
+	print(LOG_DEBUG, "blinkenlight_api_getschema(known_hash=%llx, max_bytecount=%u)\n",
+			(unsigned long long) cmd->known_hash, cmd->max_bytecount);
+
+	result->error_code = 0;
+	result->hash = schema_hash;
+	if (cmd->known_hash == schema_hash)
+		return 1; // client has it cached
+
+	result->panels.panels_len = blinkenlight_panel_list->panels_count;
+	result->panels.panels_val = (rpc_blinkenlight_api_schema_panel_struct *) calloc(
+			blinkenlight_panel_list->panels_count + 1,
+			sizeof(rpc_blinkenlight_api_schema_panel_struct));
+	assert(result->panels.panels_val);
+	for (i_panel = 0; i_panel < blinkenlight_panel_list->panels_count; i_panel++) {
+		blinkenlight_panel_t *p = &(blinkenlight_panel_list->panels[i_panel]);
+		rpc_blinkenlight_api_schema_panel_struct *rp = &result->panels.panels_val[i_panel];
+
+		rp->panel.name = strdup(p->name);
+		rp->panel.controls_outputs_count = p->controls_outputs_count;
+		rp->panel.controls_inputs_count = p->controls_inputs_count;
+		rp->panel.controls_inputs_values_bytecount = p->controls_inputs_values_bytecount;
+		rp->panel.controls_outputs_values_bytecount = p->controls_outputs_values_bytecount;
+		rp->controls.controls_len = p->controls_count;
+		rp->controls.controls_val = (rpc_blinkenlight_api_control_struct *) calloc(
+				p->controls_count + 1, sizeof(rpc_blinkenlight_api_control_struct));
+		assert(rp->controls.controls_val);
+		for (i_control = 0; i_control < p->controls_count; i_control++) {
+			blinkenlight_control_t *c = &(p->controls[i_control]);
+			rpc_blinkenlight_api_control_struct *rc = &rp->controls.controls_val[i_control];
+			rc->name = strdup(c->name);
+			rc->is_input = c->is_input;
+			rc->type = c->type;
+			rc->radix = c->radix;
+			rc->value_bitlen = c->value_bitlen;
+			rc->value_bytelen = c->value_bytelen;
+		}
+	}
+
+	if (cmd->max_bytecount
+			&& xdr_sizeof((xdrproc_t) xdr_rpc_blinkenlight_api_getschema_res, result)
+					> cmd->max_bytecount) {
+		print(LOG_DEBUG, "  schema larger than %u bytes\n", cmd->max_bytecount);
+		// xdr_free() leaves the array lengths
+		xdr_free((xdrproc_t) xdr_rpc_blinkenlight_api_getschema_res, (char *) result);
+		memset(result, 0, sizeof(*result));
+		result->error_code = RPC_BLINKENLIGHT_API_ERR_TOO_BIG;
+		result->hash = schema_hash;
+	}
+	return 1;
+}
+
+/*
+ * assign a received value to an output control
+ */
+static void setpanel_controlvalue(blinkenlight_panel_t *p, blinkenlight_control_t *c,
+		uint64_t value, uint64_t now_us)
+{
+	c->value = value;
+    // trunc to valid bits
+    c->value &= BitmaskFromLen64[c->value_bitlen];
+
+    // callback before lowpass
+    if (blinkenlight_api_panel_set_controlvalue_evt)
+        blinkenlight_api_panel_set_controlvalue_evt(p, c);
+
+    if (c->fmax > 0) {
+        // low pass requested.
+        // If fmax == 0: fast processing without ring buffer and averaging logic
+        // TODO: local lamp test should be feed changed values here, so
+        //          lamptest appearance is low passed
+        historybuffer_set_val(c->history, now_us, c->value) ;
+    }
+	print(LOG_DEBUG, "   control[%d].value = 0x%llx (%d bytes)\n", c->index, c->value,
+			c->value_bytelen);
+}
+
+/*
+ * decode the output values of a panel from a byte stream and
+ * assign them to the output controls.
+ * The value for each output control is build by combining the next "bytelen" bytes
+ * The order in the value list is the order of controls in the panels.
+ * (but indexes are not the same, output controls are mixed with input controls!)
+ * Caller must have checked the byte count.
+ */
+static void setpanel_controlvalues_from_bytes(blinkenlight_panel_t *p, unsigned char *value_bytes,
+		unsigned value_bytes_len, uint64_t now_us)
+{
+	unsigned i_control;
+	unsigned char *value_byte_ptr; // index in received value byte stream
+	blinkenlight_control_t *c;
+
+	/* go through all output controls, assign value to each
+	 * decode control value from the right amount of bytes
+	 * */
+	value_byte_ptr = value_bytes;
+	for (i_control = 0; i_control < p->controls_count; i_control++) {
+		c = &(p->controls[i_control]);
+		if (!c->is_input) {
+			assert((value_byte_ptr - value_bytes) < value_bytes_len);
+			setpanel_controlvalue(p, c, decode_uint64_from_bytes(value_byte_ptr, c->value_bytelen),
+					now_us);
+			value_byte_ptr += c->value_bytelen;
+		}
+	}
+	// signal to app: "value of output control updated"
+	if (blinkenlight_api_panel_set_controlvalues_evt)
+		blinkenlight_api_panel_set_controlvalues_evt(p, /*force_all*/0);
+}
+
+/*
+ * sum of value bytes of all output controls marked in a delta bitmap.
+ * bit n in the bitmap is the n'th output control.
+ */
+static unsigned delta_value_bytecount(blinkenlight_panel_t *p, unsigned char *changed_bitmap)
+{
+	unsigned i_control, i_output, n = 0;
+	blinkenlight_control_t *c;
+
+	for (i_output = i_control = 0; i_control < p->controls_count; i_control++) {
+		c = &(p->controls[i_control]);
+		if (!c->is_input) {
+			if (changed_bitmap[i_output / 8] & (1 << (i_output % 8)))
+				n += c->value_bytelen;
+			i_output++;
+		}
+	}
+	return n;
+}
+
+/*
+ * delta sequence of a client on a panel.
+ * NULL if the client has not sent complete outputs yet (or is anonymous),
+ * then it must resync. create: allocate a slot for a new client.
+ */
+static blinkenlight_outputs_delta_client_t *outputs_delta_client(blinkenlight_panel_t *p,
+		unsigned client_id, int create)
+{
+	blinkenlight_outputs_delta_client_t *dc;
+	unsigned i;
+
+	if (client_id == 0)
+		return NULL;
+	for (i = 0; i < MAX_BLINKENLIGHT_DELTA_CLIENTS; i++)
+		if (p->outputs_delta_clients[i].client_id == client_id)
+			return &p->outputs_delta_clients[i];
+	if (!create)
+		return NULL;
+	dc = &p->outputs_delta_clients[p->outputs_delta_clients_next];
+	p->outputs_delta_clients_next = (p->outputs_delta_clients_next + 1)
+			% MAX_BLINKENLIGHT_DELTA_CLIENTS;
+	dc->client_id = client_id;
+	dc->sequence = 0;
+	return dc;
+}
+
+/*
+ * assign the values of a delta transmission to the changed output controls.
+ * Caller must have checked the bitmap and byte count.
+ */
+static void setpanel_controlvalues_from_delta(blinkenlight_panel_t *p,
+		unsigned char *changed_bitmap, unsigned char *value_bytes, uint64_t now_us)
+{
+	unsigned i_control, i_output;
+	unsigned char *value_byte_ptr; // index in received value byte stream
+	blinkenlight_control_t *c;
+
+	value_byte_ptr = value_bytes;
+	for (i_output = i_control = 0; i_control < p->controls_count; i_control++) {
+		c = &(p->controls[i_control]);
+		if (!c->is_input) {
+			if (changed_bitmap[i_output / 8] & (1 << (i_output % 8))) {
+				setpanel_controlvalue(p, c,
+						decode_uint64_from_bytes(value_byte_ptr, c->value_bytelen), now_us);
+				value_byte_ptr += c->value_bytelen;
+			}
+			i_output++;
 		}
 	}
+	// signal to app: "value of output control updated"
+	if (blinkenlight_api_panel_set_controlvalues_evt)
+		blinkenlight_api_panel_set_controlvalues_evt(p, /*force_all*/0);
+}
+
+/*
+ * current value of an input control
+ * if fmax is set, each bit is low passed for pin debouncing
+ */
+static uint64_t getpanel_inputcontrol_value(blinkenlight_control_t *c, uint64_t now_us)
+{
+    uint64_t    val = 0 ;
+    if (c->fmax) {
+         int i_bit ;
+        // low pass each single bit of control individually!
+        // use fmax only for pin debouncing!
+         historybuffer_get_average_vals(c->history, 1000000 / c->fmax, now_us, /*bitmode*/1);
+         // re-assemble value from low-passed bits
+         for (i_bit = 0 ; i_bit < c->value_bitlen ; i_bit++)
+             if (c->averaged_value_bits[i_bit] > 128) // > 50% ?
+                 val |= (1 << i_bit) ;
+    }
+    else val = c->value ;
+    return val ;
+}
+
+/*
+ * encode the values of all input controls of a panel into a byte stream.
+ * each input control puts "value_bytelen" bytes into char stream, lsb first.
+ * value_bytes must have room for p->controls_inputs_values_bytecount bytes.
+ * Caller must hold the panel's inputs lock.
+ */
+static void getpanel_controlvalues_to_bytes(blinkenlight_panel_t *p, unsigned char *value_bytes,
+		uint64_t now_us)
+{
+	unsigned i_control;
+	unsigned char *value_byte_ptr; // index in result value byte stream
+	blinkenlight_control_t *c;
 
-	return &result;
+	// signal to app: "value of input control requested"
+	if (blinkenlight_api_panel_get_controlvalues_evt)
+		blinkenlight_api_panel_get_controlvalues_evt(p);
+
+	/* go through all input controls, assign value from each into result stream */
+	value_byte_ptr = value_bytes;
+	for (i_control = 0; i_control < p->controls_count; i_control++) {
+		c = &(p->controls[i_control]);
+		if (c->is_input) {
+		    uint64_t    val ;
+			assert((value_byte_ptr - value_bytes) < p->controls_inputs_values_bytecount);
+			val = getpanel_inputcontrol_value(c, now_us) ;
+			encode_uint64_to_bytes(value_byte_ptr, val, c->value_bytelen);
+			print(LOG_DEBUG, "  result.values[] += control[%d].value = 0x%llx (%d bytes)\n",
+					i_control, val, c->value_bytelen);
+			value_byte_ptr += c->value_bytelen; // next pos in buffer
+		}
+	}
 }
 
 /*
@@ -199,16 +1027,14 @@ rpc_blinkenlight_api_getcontrolinfo_1_svc(u_int i_panel, u_int i_control, struct
  * The order in the value list is the order of controls in the panels.
  * (but indexes are not the same, output controls are mixed with input controls!)
  */
-rpc_blinkenlight_api_setpanel_controlvalues_res *
-rpc_blinkenlight_api_setpanel_controlvalues_1_svc(u_int i_panel,
-		rpc_blinkenlight_api_controlvalues_struct valuelist, struct svc_req *rqstp)
+static int rpc_blinkenlight_api_setpanel_controlvalues_proc(
+		rpc_blinkenlight_api_setpanel_controlvalues_1_argument *argument,
+		rpc_blinkenlight_api_setpanel_controlvalues_res *result, struct svc_req *rqstp)
 {
 	uint64_t	now_us ; // system ticks in microseconds
-	static rpc_blinkenlight_api_setpanel_controlvalues_res result;
+	unsigned i_panel = argument->arg1;
+	rpc_blinkenlight_api_controlvalues_struct *valuelist = &argument->valuelist;
 	blinkenlight_panel_t *p;
-	unsigned i_control;
-	unsigned char *value_byte_ptr; // index in received value byte stream
-	blinkenlight_control_t *c;
 
 	print(LOG_DEBUG, "blinkenlight_api_setpanel_controlvalues(i_panel=%d)\n", i_panel);
 
@@ -216,57 +1042,29 @@ rpc_blinkenlight_api_setpanel_controlvalues_1_svc(u_int i_panel,
 
 	if (i_panel >= blinkenlight_panel_list->panels_count) {
 		print(LOG_ERR, "i_panel > panels_count\n");
-		result.error_code = 1; // invalid panel
+		result->error_code = 1; // invalid panel
 	} else {
 		p = &(blinkenlight_panel_list->panels[i_panel]);
 		// check: exakt amount of values provided?
 		// "Sum of bytes" must be "sum(all controls) of value_bytelen
-		if (p->controls_outputs_values_bytecount != valuelist.value_bytes.value_bytes_len) {
+		if (p->controls_outputs_values_bytecount != valuelist->value_bytes.value_bytes_len) {
 			print(LOG_ERR, "Error in blinkenlight_api_setpanel_controlvalues():\n");
 			print(LOG_ERR,
 					"Sum (Panel[%s].outputcontrols.value_bytelen) is %d, but %d values were transmitted.\n",
 					p->name, p->controls_outputs_values_bytecount,
-					valuelist.value_bytes.value_bytes_len);
+					valuelist->value_bytes.value_bytes_len);
 			exit(1);
 		}
-
-		/* go through all output controls, assign value to each
-		 * decode control value from the right amount of bytes
-		 * */
-		value_byte_ptr = valuelist.value_bytes.value_bytes_val;
-		for (i_control = 0; i_control < p->controls_count; i_control++) {
-			c = &(p->controls[i_control]);
-			if (!c->is_input) {
-				assert(
-						(value_byte_ptr - valuelist.value_bytes.value_bytes_val)
-								< valuelist.value_bytes.value_bytes_len);
-				c->value = decode_uint64_from_bytes(value_byte_ptr, c->value_bytelen);
-                // trunc to valid bits
-                c->value &= BitmaskFromLen64[c->value_bitlen];
-
-                // callback before lowpass
-                if (blinkenlight_api_panel_set_controlvalue_evt)
-                    blinkenlight_api_panel_set_controlvalue_evt(p, c);
-
-                if (c->fmax > 0) {
-                    // low pass requested.
-                    // If fmax == 0: fast processing without ring buffer and averaging logic
-                    // TODO: local lamp test should be feed changed values here, so
-                    //          lamptest appearance is low passed
-                    historybuffer_set_val(c->history, now_us, c->value) ;
-                }
-				print(LOG_DEBUG, "   control[%d].value = 0x%llx (%d bytes)\n", i_control, c->value,
-						c->value_bytelen);
-				value_byte_ptr += c->value_bytelen;
-			}
-		}
-		// signal to app: "value of output control updated"
-		if (blinkenlight_api_panel_set_controlvalues_evt)
-			blinkenlight_api_panel_set_controlvalues_evt(p, /*force_all*/0);
-
-		result.error_code = 0;
+		panel_write_lock(p);
+		setpanel_controlvalues_from_bytes(p, valuelist->value_bytes.value_bytes_val,
+				valuelist->value_bytes.value_bytes_len, now_us);
+		// outputs set outside the delta sequence: delta clients must resync
+		memset(p->outputs_delta_clients, 0, sizeof(p->outputs_delta_clients));
+		panel_unlock(p);
+
+		result->error_code = 0;
 	}
-	return &result;
+	return 1;
 }
 
 /*
@@ -278,71 +1076,540 @@ rpc_blinkenlight_api_setpanel_controlvalues_1_svc(u_int i_panel,
  * (but indexes are not the same, output controls are mixed with input controls!)
  */
 
-rpc_blinkenlight_api_controlvalues_struct *
-rpc_blinkenlight_api_getpanel_controlvalues_1_svc(u_int i_panel, struct svc_req *rqstp)
+static int rpc_blinkenlight_api_getpanel_controlvalues_proc(u_int *i_panel,
+		rpc_blinkenlight_api_controlvalues_struct *result, struct svc_req *rqstp)
 {
     uint64_t    now_us ; // system ticks in microseconds
-	static rpc_blinkenlight_api_controlvalues_struct result;
 	blinkenlight_panel_t *p;
-	unsigned i_control;
-	unsigned char *value_byte_ptr; // index in result value byte stream
-	blinkenlight_control_t *c;
 
-	print(LOG_DEBUG, "blinkenlight_api_getpanel_controlvalues(i_panel=%d)\n", i_panel);
+	print(LOG_DEBUG, "blinkenlight_api_getpanel_controlvalues(i_panel=%d)\n", *i_panel);
 
 	now_us = historybuffer_now_us();
 
-	if (i_panel >= blinkenlight_panel_list->panels_count)
-		result.error_code = 1; // invalid panel
+	if (*i_panel >= blinkenlight_panel_list->panels_count)
+		result->error_code = 1; // invalid panel
 	else {
+		p = &(blinkenlight_panel_list->panels[*i_panel]);
+
+		result->value_bytes.value_bytes_len = p->controls_inputs_values_bytecount;
+		result->value_bytes.value_bytes_val =
+				RPC_REQUEST_OF_ARGUMENT(i_panel)->panel_buffers[*i_panel].inputs_value_bytes;
+
+		panel_read_lock(p);
+		panel_inputs_lock(p);
+		getpanel_controlvalues_to_bytes(p, result->value_bytes.value_bytes_val, now_us);
+		panel_inputs_unlock(p);
+		panel_unlock(p);
+		result->error_code = 0;
+	}
+
+	return 1;
+}
+
+/*
+ * exchange_panels_controlvalues()
+ * SET outputs and GET inputs of several panels in one call.
+ * For each listed panel: if output values are transmitted, they are
+ * set like in setpanel_controlvalues(), either complete or as delta
+ * (see rpc_blinkenlight_api.x). Then the input values are queried
+ * like in getpanel_controlvalues().
+ * Result has the input values for all listed panels, in the same order.
+ * A bad or repeated panel handle, a wrong output byte count or a gap in the delta
+ * sequence fails the whole call, before anything is set.
+ * All listed panels are locked during the call, in index order.
+ */
+#define PANEL_LOCK_NONE	0
+#define PANEL_LOCK_READ	1
+#define PANEL_LOCK_WRITE	2
+static int rpc_blinkenlight_api_exchange_panels_controlvalues_proc(
+		rpc_blinkenlight_api_panels_controlvalues_struct *outputs,
+		rpc_blinkenlight_api_panels_controlvalues_struct *result, struct svc_req *rqstp)
+{
+	uint64_t now_us; // system ticks in microseconds
+	rpc_request_t *req = RPC_REQUEST_OF_ARGUMENT(outputs);
+	unsigned char lock_mode[MAX_BLINKENLIGHT_PANELS];
+	unsigned char listed[MAX_BLINKENLIGHT_PANELS];
+	rpc_blinkenlight_api_panel_controlvalues_struct *po; // panel in argument
+	rpc_blinkenlight_api_panel_controlvalues_struct *pr; // panel in result
+	blinkenlight_outputs_delta_client_t *dc;
+	blinkenlight_panel_t *p;
+	unsigned i, i_panel;
+	unsigned value_bytecount;
+
+	print(LOG_DEBUG, "blinkenlight_api_exchange_panels_controlvalues(panels_len=%d)\n",
+			outputs->panels.panels_len);
+
+	now_us = historybuffer_now_us();
+	result->client_id = outputs->client_id;
+
+	// panels with outputs (complete or delta) are written
+	memset(lock_mode, PANEL_LOCK_NONE, sizeof(lock_mode));
+	memset(listed, 0, sizeof(listed));
+	for (i = 0; i < outputs->panels.panels_len; i++) {
+		po = &outputs->panels.panels_val[i];
+		if (po->i_panel >= blinkenlight_panel_list->panels_count) {
+			print(LOG_ERR, "i_panel > panels_count\n");
+			result->error_code = RPC_BLINKENLIGHT_API_ERR_ILL_PANEL;
+			return 1;
+		}
+		// values of a panel are decoded into the panel's buffers
+		if (listed[po->i_panel]++) {
+			print(LOG_ERR, "panel %d listed twice\n", po->i_panel);
+			result->error_code = RPC_BLINKENLIGHT_API_ERR_ILL_PANEL;
+			return 1;
+		}
+		if (po->changed_bitmap.changed_bitmap_len || po->value_bytes.value_bytes_len)
+			lock_mode[po->i_panel] = PANEL_LOCK_WRITE;
+		else if (lock_mode[po->i_panel] == PANEL_LOCK_NONE)
+			lock_mode[po->i_panel] = PANEL_LOCK_READ;
+	}
+	for (i_panel = 0; i_panel < blinkenlight_panel_list->panels_count; i_panel++) {
 		p = &(blinkenlight_panel_list->panels[i_panel]);
+		if (lock_mode[i_panel] == PANEL_LOCK_WRITE)
+			panel_write_lock(p);
+		else if (lock_mode[i_panel] == PANEL_LOCK_READ)
+			panel_read_lock(p);
+	}
 
-		// free previous result
-		xdr_free((xdrproc_t) xdr_rpc_blinkenlight_api_controlvalues_struct, (char *) &result);
+	// verify all panels first, so nothing is set on error
+	result->error_code = 0;
+	for (i = 0; !result->error_code && i < outputs->panels.panels_len; i++) {
+		po = &outputs->panels.panels_val[i];
+		p = &(blinkenlight_panel_list->panels[po->i_panel]);
+		if (po->changed_bitmap.changed_bitmap_len == 0) {
+			// complete or no outputs
+			value_bytecount = p->controls_outputs_values_bytecount;
+			if (po->value_bytes.value_bytes_len == 0)
+				continue; // no outputs
+		} else {
+			// delta
+			if (po->changed_bitmap.changed_bitmap_len != (p->controls_outputs_count + 7) / 8) {
+				print(LOG_ERR, "Panel[%s]: delta bitmap has %d bytes, expected %d.\n", p->name,
+						po->changed_bitmap.changed_bitmap_len, (p->controls_outputs_count + 7) / 8);
+				result->error_code = RPC_BLINKENLIGHT_API_ERR_ILL_VALUES;
+				continue;
+			}
+			// apply a delta only if it follows the last outputs of the same client.
+			// same sequence again = UDP retransmission of that client, already applied.
+			dc = outputs_delta_client(p, outputs->client_id, /*create*/0);
+			if (dc == NULL
+					|| (po->sequence != dc->sequence + 1 && po->sequence != dc->sequence)) {
+				print(LOG_DEBUG, "Panel[%s]: client %x delta sequence %u after %u, resync\n",
+						p->name, outputs->client_id, po->sequence, dc ? dc->sequence : 0);
+				result->error_code = RPC_BLINKENLIGHT_API_ERR_RESYNC;
+				continue;
+			}
+			value_bytecount = delta_value_bytecount(p, po->changed_bitmap.changed_bitmap_val);
+		}
+		if (po->value_bytes.value_bytes_len != value_bytecount) {
+			print(LOG_ERR, "Error in blinkenlight_api_exchange_panels_controlvalues():\n");
+			print(LOG_ERR,
+					"Panel[%s] needs %d output value bytes, but %d values were transmitted.\n",
+					p->name, value_bytecount, po->value_bytes.value_bytes_len);
+			result->error_code = RPC_BLINKENLIGHT_API_ERR_ILL_VALUES;
+		}
+	}
 
-		// signal to app: "value of input control requested"
-		if (blinkenlight_api_panel_get_controlvalues_evt)
-			blinkenlight_api_panel_get_controlvalues_evt(p);
+	if (!result->error_code) {
+		result->panels.panels_len = outputs->panels.panels_len;
+		result->panels.panels_val = req->panels_result;
+	}
+	for (i = 0; !result->error_code && i < outputs->panels.panels_len; i++) {
+		po = &outputs->panels.panels_val[i];
+		pr = &result->panels.panels_val[i];
+		p = &(blinkenlight_panel_list->panels[po->i_panel]);
+
+		if (po->changed_bitmap.changed_bitmap_len) {
+			dc = outputs_delta_client(p, outputs->client_id, /*create*/0); // verified above
+			if (po->sequence != dc->sequence)
+				setpanel_controlvalues_from_delta(p, po->changed_bitmap.changed_bitmap_val,
+						po->value_bytes.value_bytes_val, now_us);
+			dc->sequence = po->sequence;
+		} else if (po->value_bytes.value_bytes_len) {
+			setpanel_controlvalues_from_bytes(p, po->value_bytes.value_bytes_val,
+					po->value_bytes.value_bytes_len, now_us);
+			// complete outputs (re)start the delta sequence of the client
+			dc = outputs_delta_client(p, outputs->client_id, /*create*/1);
+			if (dc)
+				dc->sequence = po->sequence;
+		}
 
-		result.value_bytes.value_bytes_len = p->controls_inputs_values_bytecount;
-		result.value_bytes.value_bytes_val = (u_char *) calloc(p->controls_inputs_values_bytecount,
-				sizeof(u_char));
-		assert(result.value_bytes.value_bytes_val);
+		pr->i_panel = po->i_panel;
+		pr->sequence = po->sequence;
+		pr->changed_bitmap.changed_bitmap_len = 0;
+		pr->value_bytes.value_bytes_len = p->controls_inputs_values_bytecount;
+		pr->value_bytes.value_bytes_val = req->panel_buffers[po->i_panel].inputs_value_bytes;
+		panel_inputs_lock(p);
+		getpanel_controlvalues_to_bytes(p, pr->value_bytes.value_bytes_val, now_us);
+		panel_inputs_unlock(p);
+	}
 
+	for (i_panel = 0; i_panel < blinkenlight_panel_list->panels_count; i_panel++)
+		if (lock_mode[i_panel] != PANEL_LOCK_NONE)
+			panel_unlock(&(blinkenlight_panel_list->panels[i_panel]));
+	return 1;
+}
 
-		/* go through all input controls, assign value from each into result stream
-		 * each input control puts "value_bytelen" bytes into char stream, lsb first */
-		value_byte_ptr = result.value_bytes.value_bytes_val;
-		for (i_control = 0; i_control < p->controls_count; i_control++) {
-			c = &(p->controls[i_control]);
-			if (c->is_input) {
-			    uint64_t    val = 0 ;
-				assert(
-						(value_byte_ptr - result.value_bytes.value_bytes_val)
-								< result.value_bytes.value_bytes_len);
-                if (c->fmax) {
-                     int i_bit ;
-                    // low pass each single bit of control individually!
-                    // use fmax only for pin debouncing!
-                     historybuffer_get_average_vals(c->history, 1000000 / c->fmax, now_us, /*bitmode*/1);
-                     // re-assemble value from low-passed bits
-                     for (i_bit = 0 ; i_bit < c->value_bitlen ; i_bit++)
-                         if (c->averaged_value_bits[i_bit] > 128) // > 50% ?
-                             val |= (1 << i_bit) ;
-                }
-                else val = c->value ;
-
-				encode_uint64_to_bytes(value_byte_ptr, val, c->value_bytelen);
-				print(LOG_DEBUG, "  result.values[] += control[%d].value = 0x%llx (%d bytes)\n",
-						i_control, val, c->value_bytelen);
-				value_byte_ptr += c->value_bytelen; // next pos in buffer
+/*
+ * Input change subscription.
+ * A client calls WAIT_PANEL_INPUTCONTROLS with the sequence number of the
+ * input values it has. If nothing changed since, the reply is deferred:
+ * the request is parked here and answered from
+ * blinkenlight_api_server_service_subscriptions(), which the server's main
+ * loop calls on RPC traffic and periodically, while requests are parked.
+ * Works only over TCP, where each client has its own SVCXPRT.
+ */
+#define BLINKENLIGHT_API_MAX_SUBSCRIPTIONS	16
+typedef struct {
+	SVCXPRT *transp; // connection, reply is sent over it
+	unsigned i_panel;
+	unsigned sequence; // client has input values up to this
+	uint64_t deadline_us; // answer "no change" then
+} blinkenlight_api_subscription_t;
+
+static blinkenlight_api_subscription_t subscriptions[BLINKENLIGHT_API_MAX_SUBSCRIPTIONS];
+static unsigned subscriptions_count = 0;
+
+/*
+ * read input values of a panel and compare them with the values reported last.
+ * On change, the panel's inputs_sequence is incremented and
+ * the changed controls are marked with it.
+ * Caller must hold the panel's inputs lock.
+ * result: 1 if inputs changed
+ */
+static int panel_inputs_update(blinkenlight_panel_t *p, uint64_t now_us)
+{
+	unsigned i_control;
+	blinkenlight_control_t *c;
+	uint64_t val;
+	unsigned next_sequence;
+	int changed = 0;
+
+	// signal to app: "value of input control requested"
+	if (blinkenlight_api_panel_get_controlvalues_evt)
+		blinkenlight_api_panel_get_controlvalues_evt(p);
+
+	next_sequence = p->inputs_sequence + 1;
+	if (next_sequence == 0)
+		next_sequence = 1; // 0 = "unknown" for clients
+	for (i_control = 0; i_control < p->controls_count; i_control++) {
+		c = &(p->controls[i_control]);
+		if (c->is_input) {
+			val = getpanel_inputcontrol_value(c, now_us);
+			if (val != c->value_reported || p->inputs_sequence == 0) {
+				c->value_reported = val;
+				c->value_reported_sequence = next_sequence;
+				changed = 1;
+			}
+		}
+	}
+	if (changed) {
+		p->inputs_sequence = next_sequence;
+		p->inputs_timestamp_us = now_us;
+	}
+	return changed;
+}
+
+/*
+ * encode the input values changed after "since_sequence" into result.
+ * If the client has no valid sequence, all input values are encoded.
+ * Bitmap and values are put into the panel's buffers of a request.
+ * Caller must hold the panel's inputs lock.
+ */
+static void panel_inputs_changes_encode(blinkenlight_panel_t *p, unsigned since_sequence,
+		rpc_blinkenlight_api_inputs_changes_struct *result, rpc_panel_buffers_t *buffers)
+{
+	unsigned i_control, i_input;
+	blinkenlight_control_t *c;
+	unsigned char *value_byte_ptr;
+	int all;
+
+	// client older than any change marks (or from a previous server run): send all
+	all = (since_sequence == 0 || since_sequence > p->inputs_sequence);
+
+	result->sequence = p->inputs_sequence;
+	result->timestamp_us = p->inputs_timestamp_us;
+	result->changed_bitmap.changed_bitmap_len = all ? 0 : (p->controls_inputs_count + 7) / 8;
+	result->changed_bitmap.changed_bitmap_val = buffers->inputs_changed_bitmap;
+	memset(buffers->inputs_changed_bitmap, 0, result->changed_bitmap.changed_bitmap_len);
+	result->value_bytes.value_bytes_val = buffers->inputs_value_bytes;
+
+	value_byte_ptr = result->value_bytes.value_bytes_val;
+	for (i_input = i_control = 0; i_control < p->controls_count; i_control++) {
+		c = &(p->controls[i_control]);
+		if (c->is_input) {
+			if (all || c->value_reported_sequence > since_sequence) {
+				if (!all)
+					result->changed_bitmap.changed_bitmap_val[i_input / 8] |= 1 << (i_input % 8);
+				encode_uint64_to_bytes(value_byte_ptr, c->value_reported, c->value_bytelen);
+				value_byte_ptr += c->value_bytelen;
 			}
+			i_input++;
+		}
+	}
+	result->value_bytes.value_bytes_len = value_byte_ptr - result->value_bytes.value_bytes_val;
+}
+
+/*
+ * wait_panel_inputcontrols()
+ * Return input value changes since the client's sequence.
+ * If there are none, over TCP the reply is deferred until inputs change
+ * or timeout_ms is over.
+ */
+static int rpc_blinkenlight_api_wait_panel_inputcontrols_proc(
+		rpc_blinkenlight_api_wait_inputs_struct *wait,
+		rpc_blinkenlight_api_inputs_changes_struct *result, struct svc_req *rqstp)
+{
+	uint64_t now_us; // system ticks in microseconds
+	blinkenlight_api_subscription_t *s;
+	blinkenlight_panel_t *p;
+	unsigned i;
+
+	print(LOG_DEBUG, "blinkenlight_api_wait_panel_inputcontrols(i_panel=%d, sequence=%u)\n",
+			wait->i_panel, wait->sequence);
+
+	now_us = historybuffer_now_us();
+
+	if (wait->i_panel >= blinkenlight_panel_list->panels_count) {
+		print(LOG_ERR, "i_panel > panels_count\n");
+		result->error_code = RPC_BLINKENLIGHT_API_ERR_ILL_PANEL;
+		return 1;
+	}
+	p = &(blinkenlight_panel_list->panels[wait->i_panel]);
+	panel_read_lock(p);
+	panel_inputs_lock(p);
+	panel_inputs_update(p, now_us);
+
+	if (wait->sequence == p->inputs_sequence && wait->timeout_ms > 0
+			&& transp_is_stream(rqstp->rq_xprt)) {
+		// nothing new: park request. Replaces an older one on the same connection.
+		for (i = 0; i < subscriptions_count && subscriptions[i].transp != rqstp->rq_xprt; i++)
+			;
+		if (i < BLINKENLIGHT_API_MAX_SUBSCRIPTIONS) {
+			s = &subscriptions[i];
+			if (i == subscriptions_count)
+				subscriptions_count++;
+			s->transp = rqstp->rq_xprt;
+			s->i_panel = wait->i_panel;
+			s->sequence = wait->sequence;
+			s->deadline_us = now_us + 1000LL * wait->timeout_ms;
+			panel_inputs_unlock(p);
+			panel_unlock(p);
+			return 0; // no reply now
 		}
+		// too many subscribers: answer "no change" at once
+	}
+	panel_inputs_changes_encode(p, wait->sequence, result,
+			&RPC_REQUEST_OF_ARGUMENT(wait)->panel_buffers[wait->i_panel]);
+	panel_inputs_unlock(p);
+	panel_unlock(p);
+	result->error_code = 0;
+	return 1;
+}
+
+// count of parked WAIT requests
+unsigned blinkenlight_api_server_subscriptions_count(void)
+{
+	return subscriptions_count;
+}
+
+/*
+ * Answer parked WAIT requests, whose panel inputs changed or whose timeout is over.
+ * To be called by the server main loop on RPC traffic BEFORE svc_getreqset(),
+ * and periodically.
+ * readfds: readable RPC sockets, or NULL on timeout.
+ * Traffic on a parked connection can only be a close (or a client which gave up
+ * waiting): the request is dropped, as svc_getreqset() may destroy the transport.
+ * Subscriptions are only touched by the RPC thread.
+ */
+void blinkenlight_api_server_service_subscriptions(fd_set *readfds)
+{
+	uint64_t now_us; // system ticks in microseconds
+	rpc_blinkenlight_api_inputs_changes_struct result;
+	rpc_request_t *req; // only for its buffers
+	unsigned char panel_updated[MAX_BLINKENLIGHT_PANELS];
+	blinkenlight_api_subscription_t *s;
+	blinkenlight_panel_t *p;
+	unsigned i;
+
+	if (subscriptions_count == 0)
+		return;
+	now_us = historybuffer_now_us();
+	memset(panel_updated, 0, sizeof(panel_updated));
+	req = rpc_request_alloc();
+
+	i = 0;
+	while (i < subscriptions_count) {
+		s = &subscriptions[i];
+		p = &(blinkenlight_panel_list->panels[s->i_panel]);
+		if (readfds && FD_ISSET(s->transp->xp_sock, readfds)) {
+			// drop
+			subscriptions[i] = subscriptions[--subscriptions_count];
+			continue;
+		}
+		panel_read_lock(p);
+		panel_inputs_lock(p);
+		// sample panel inputs only once per call
+		if (!panel_updated[s->i_panel]) {
+			panel_inputs_update(p, now_us);
+			panel_updated[s->i_panel] = 1;
+		}
+		if (p->inputs_sequence == s->sequence && now_us < s->deadline_us) {
+			panel_inputs_unlock(p);
+			panel_unlock(p);
+			i++; // wait on
+			continue;
+		}
+		memset(&result, 0, sizeof(result));
+		panel_inputs_changes_encode(p, s->sequence, &result, &req->panel_buffers[s->i_panel]);
+		panel_inputs_unlock(p);
+		panel_unlock(p);
 		result.error_code = 0;
+		if (!svc_sendreply(s->transp, (xdrproc_t) xdr_inputs_changes_inplace, (char *) &result))
+			print(LOG_ERR, "blinkenlight_api_server_service_subscriptions(): svc_sendreply() failed\n");
+		subscriptions[i] = subscriptions[--subscriptions_count];
+	}
+	rpc_request_free(req);
+}
+
+#ifndef WIN32
+/*
+ * Shared memory image of control values, for a client on the same host.
+ * See blinkenlight_api_shm.h
+ */
+static blinkenlight_api_shm_t *shm = NULL;
+static unsigned shm_outputs_sequence[MAX_BLINKENLIGHT_PANELS]; // last applied client outputs
+
+/*
+ * create the image after the panels are defined.
+ * result: 0 = OK, else error, no shared memory clients possible.
+ */
+int blinkenlight_api_server_shm_create(void)
+{
+	blinkenlight_api_shm_panel_t *sp;
+	blinkenlight_panel_t *p;
+	unsigned i_panel, i_control;
+	int fd;
+
+	shm_unlink(BLINKENLIGHT_API_SHM_NAME); // stale image of previous run
+	fd = shm_open(BLINKENLIGHT_API_SHM_NAME, O_CREAT | O_RDWR, 0666);
+	if (fd < 0) {
+		print(LOG_ERR, "shm_open(%s) failed: %s\n", BLINKENLIGHT_API_SHM_NAME, strerror(errno));
+		return 1;
+	}
+	fchmod(fd, 0666); // clients need not run as the same user, umask may interfere
+	if (ftruncate(fd, sizeof(blinkenlight_api_shm_t)) != 0) {
+		print(LOG_ERR, "ftruncate(%s) failed: %s\n", BLINKENLIGHT_API_SHM_NAME, strerror(errno));
+		close(fd);
+		return 1;
 	}
+	shm = (blinkenlight_api_shm_t *) mmap(NULL, sizeof(blinkenlight_api_shm_t),
+			PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (shm == MAP_FAILED) {
+		print(LOG_ERR, "mmap(%s) failed: %s\n", BLINKENLIGHT_API_SHM_NAME, strerror(errno));
+		shm = NULL;
+		return 1;
+	}
+	memset(shm, 0, sizeof(blinkenlight_api_shm_t));
+	shm->version = BLINKENLIGHT_API_SHM_VERSION;
+	shm->panels_count = blinkenlight_panel_list->panels_count;
+	for (i_panel = 0; i_panel < blinkenlight_panel_list->panels_count; i_panel++) {
+		p = &(blinkenlight_panel_list->panels[i_panel]);
+		sp = &(shm->panels[i_panel]);
+		strncpy(sp->name, p->name, sizeof(sp->name) - 1);
+		sp->controls_count = p->controls_count;
+		for (i_control = 0; i_control < p->controls_count; i_control++)
+			sp->outputs.values[i_control] = p->controls[i_control].value;
+		shm_outputs_sequence[i_panel] = 0;
+	}
+	BLINKENLIGHT_API_SHM_BARRIER();
+	shm->magic = BLINKENLIGHT_API_SHM_MAGIC; // valid for clients
+	print(LOG_INFO, "Shared memory image %s created for %d panels.\n", BLINKENLIGHT_API_SHM_NAME,
+			shm->panels_count);
+	return 0;
+}
+
+void blinkenlight_api_server_shm_destroy(void)
+{
+	if (!shm)
+		return;
+	shm->magic = 0; // clients see server gone
+	munmap(shm, sizeof(blinkenlight_api_shm_t));
+	shm_unlink(BLINKENLIGHT_API_SHM_NAME);
+	shm = NULL;
+}
+
+/*
+ * Apply outputs written by a shared memory client,
+ * publish changed inputs to it.
+ * To be called periodically by the server main loop.
+ * Panels are only serviced after a client wrote outputs once.
+ * result: 1 if a client wrote new outputs
+ */
+int blinkenlight_api_server_shm_service(void)
+{
+	uint64_t now_us; // system ticks in microseconds
+	uint64_t values[MAX_BLINKENLIGHT_PANEL_CONTROLS];
+	blinkenlight_api_shm_panel_t *sp;
+	blinkenlight_panel_t *p;
+	blinkenlight_control_t *c;
+	unsigned i_panel, i_control;
+	unsigned sequence;
+	int changed;
+	int active = 0;
 
-	return &result;
+	if (!shm)
+		return 0;
+	now_us = historybuffer_now_us();
+	shm->heartbeat++; // clients can detect a dead server
+	for (i_panel = 0; i_panel < shm->panels_count; i_panel++) {
+		p = &(blinkenlight_panel_list->panels[i_panel]);
+		sp = &(shm->panels[i_panel]);
+		// 1) new outputs from client?
+		sequence = blinkenlight_api_shm_read_begin(&sp->outputs);
+		if (sequence == 0)
+			continue; // no client for this panel
+		if (sequence != shm_outputs_sequence[i_panel]) {
+			for (i_control = 0; i_control < p->controls_count; i_control++)
+				values[i_control] = sp->outputs.values[i_control];
+			if (!blinkenlight_api_shm_read_retry(&sp->outputs, sequence)) {
+				// consistent: set only changed controls. Else try next time
+				shm_outputs_sequence[i_panel] = sequence;
+				active = 1;
+				changed = 0;
+				panel_write_lock(p);
+				for (i_control = 0; i_control < p->controls_count; i_control++) {
+					c = &(p->controls[i_control]);
+					if (!c->is_input && c->value != values[i_control]) {
+						setpanel_controlvalue(p, c, values[i_control], now_us);
+						changed = 1;
+					}
+				}
+				// signal to app: "value of output control updated"
+				if (changed && blinkenlight_api_panel_set_controlvalues_evt)
+					blinkenlight_api_panel_set_controlvalues_evt(p, /*force_all*/0);
+				panel_unlock(p);
+			}
+		}
+		// 2) publish changed inputs
+		panel_read_lock(p);
+		panel_inputs_lock(p);
+		if (panel_inputs_update(p, now_us)) {
+			blinkenlight_api_shm_write_begin(&sp->inputs);
+			for (i_control = 0; i_control < p->controls_count; i_control++) {
+				c = &(p->controls[i_control]);
+				if (c->is_input)
+					sp->inputs.values[i_control] = c->value_reported;
+			}
+			blinkenlight_api_shm_write_end(&sp->inputs);
+		}
+		panel_inputs_unlock(p);
+		panel_unlock(p);
+	}
+	return active;
 }
+#endif
 
 /*
  * rpc_param_get()
@@ -352,6 +1619,95 @@ rpc_blinkenlight_api_getpanel_controlvalues_1_svc(u_int i_panel, struct svc_req
  *  for control??? there is no global control list -> panel_handle * 0x1000 + control index?
  */
 
+/*
+ * RPC_PARAM_CLASS_BUS: runtime metrics of the server.
+ * Generic metrics are evaluated here, the rest is asked from the server.
+ */
+static void rpc_param_get_bus(rpc_param_result_struct * result, rpc_param_cmd_get_struct *cmd_get)
+{
+	unsigned object_handle = cmd_get->object_handle;
+	rpc_proc_t *m;
+	blinkenlight_panel_t *p;
+	unsigned i_control;
+#ifndef WIN32
+	rtsched_t *sched = blinkenlight_api_metrics_mux_sched;
+	clockid_t clock_id;
+	struct timespec ts;
+#endif
+
+	result->error_code = RPC_ERR_OK;
+	switch (cmd_get->param_handle) {
+	case RPC_PARAM_HANDLE_BUS_RPC_CALLS:
+	case RPC_PARAM_HANDLE_BUS_RPC_TIME_US:
+	case RPC_PARAM_HANDLE_BUS_RPC_TIME_MAX_US:
+		m = rpc_proc_find(object_handle);
+		if (m == NULL)
+			result->error_code = RPC_ERR_PARAM_ILL_OBJECT;
+		else if (cmd_get->param_handle == RPC_PARAM_HANDLE_BUS_RPC_CALLS)
+			result->param_value = m->calls;
+		else if (cmd_get->param_handle == RPC_PARAM_HANDLE_BUS_RPC_TIME_US)
+			result->param_value = m->time_us;
+		else
+			result->param_value = m->time_max_us;
+		break;
+	case RPC_PARAM_HANDLE_BUS_HISTORY_FILL:
+	case RPC_PARAM_HANDLE_BUS_HISTORY_OVERFLOWS:
+		if (object_handle >= blinkenlight_panel_list->panels_count) {
+			result->error_code = RPC_ERR_PARAM_ILL_OBJECT;
+			break;
+		}
+		p = &(blinkenlight_panel_list->panels[object_handle]);
+		for (i_control = 0; i_control < p->controls_count; i_control++) {
+			historybuffer_t *hb = p->controls[i_control].history;
+			unsigned fill;
+			if (hb == NULL)
+				continue;
+			if (cmd_get->param_handle == RPC_PARAM_HANDLE_BUS_HISTORY_OVERFLOWS)
+				result->param_value += hb->overflows;
+			else if ((fill = historybuffer_fill(hb)) > result->param_value)
+				result->param_value = fill;
+		}
+		break;
+#ifndef WIN32
+	case RPC_PARAM_HANDLE_BUS_MUX_PHASES:
+	case RPC_PARAM_HANDLE_BUS_MUX_OVERRUNS:
+	case RPC_PARAM_HANDLE_BUS_MUX_JITTER_MAX_US:
+	case RPC_PARAM_HANDLE_BUS_MUX_JITTER_HISTOGRAM:
+		if (sched == NULL)
+			result->error_code = RPC_ERR_PARAM_ILL_PARAM;
+		else if (cmd_get->param_handle == RPC_PARAM_HANDLE_BUS_MUX_JITTER_HISTOGRAM) {
+			if (object_handle >= RTSCHED_HISTOGRAM_BUCKETS)
+				result->error_code = RPC_ERR_PARAM_ILL_OBJECT;
+			else
+				result->param_value = sched->histogram[object_handle];
+		} else if (object_handle != 0)
+			result->error_code = RPC_ERR_PARAM_ILL_OBJECT;
+		else if (cmd_get->param_handle == RPC_PARAM_HANDLE_BUS_MUX_PHASES)
+			result->param_value = sched->phases;
+		else if (cmd_get->param_handle == RPC_PARAM_HANDLE_BUS_MUX_OVERRUNS)
+			result->param_value = sched->overruns;
+		else
+			result->param_value = sched->jitter_max_ns / 1000;
+		break;
+	case RPC_PARAM_HANDLE_BUS_UPDATE_CPU_MS:
+		if (blinkenlight_api_metrics_update_thread == NULL
+				|| pthread_getcpuclockid(*blinkenlight_api_metrics_update_thread, &clock_id)
+				|| clock_gettime(clock_id, &ts))
+			result->error_code = RPC_ERR_PARAM_ILL_PARAM;
+		else
+			result->param_value = (unsigned) ((uint64_t) ts.tv_sec * 1000
+					+ ts.tv_nsec / 1000000);
+		break;
+#endif
+	default:
+		if (blinkenlight_api_bus_get_param_evt)
+			result->error_code = blinkenlight_api_bus_get_param_evt(object_handle,
+					cmd_get->param_handle, &result->param_value);
+		else
+			result->error_code = RPC_ERR_PARAM_ILL_PARAM;
+	}
+}
+
 static void rpc_param_get_intern(rpc_param_result_struct * result,
 		rpc_param_cmd_get_struct *cmd_get)
 {
@@ -363,12 +1719,15 @@ static void rpc_param_get_intern(rpc_param_result_struct * result,
 	result->param_handle = cmd_get->param_handle;
 	result->param_value = 0;
 	switch (cmd_get->object_class) {
-	//case RPC_PARAM_CLASS_BUS: 	break;
+	case RPC_PARAM_CLASS_BUS:
+		rpc_param_get_bus(result, cmd_get);
+		break;
 	case RPC_PARAM_CLASS_PANEL:
 		result->error_code = RPC_ERR_PARAM_ILL_OBJECT;
 		if (cmd_get->object_handle < blinkenlight_panel_list->panels_count) {
 			p = &(blinkenlight_panel_list->panels[cmd_get->object_handle]); // valid panel
 			result->error_code = RPC_ERR_PARAM_ILL_PARAM;
+			panel_read_lock(p);
 			switch (cmd_get->param_handle) {
 			case RPC_PARAM_HANDLE_PANEL_BLINKENBOARDS_STATE:
 				// set tristate of all BlinkenBoards of this panel.
@@ -386,6 +1745,7 @@ static void rpc_param_get_intern(rpc_param_result_struct * result,
 					result->param_value = p->mode;
 				result->error_code = RPC_ERR_OK;
 			}
+			panel_unlock(p);
 
 		}
 		break;
@@ -395,12 +1755,11 @@ static void rpc_param_get_intern(rpc_param_result_struct * result,
 
 }
 
-rpc_param_result_struct *
-rpc_param_get_1_svc(rpc_param_cmd_get_struct cmd_get, struct svc_req *rqstp)
+static int rpc_param_get_proc(rpc_param_cmd_get_struct *cmd_get, rpc_param_result_struct *result,
+		struct svc_req *rqstp)
 {
-	static rpc_param_result_struct result;
-	rpc_param_get_intern(&result, &cmd_get); // just do it by "intern" funktion
-	return &result;
+	rpc_param_get_intern(result, cmd_get); // just do it by "intern" funktion
+	return 1;
 }
 
 /*
@@ -408,10 +1767,9 @@ rpc_param_get_1_svc(rpc_param_cmd_get_struct cmd_get, struct svc_req *rqstp)
  * Set a parameter for an object
  * result: param value
  */
-rpc_param_result_struct *
-rpc_param_set_1_svc(rpc_param_cmd_set_struct cmd_set, struct svc_req *rqstp)
+static int rpc_param_set_proc(rpc_param_cmd_set_struct *cmd_set, rpc_param_result_struct *result,
+		struct svc_req *rqstp)
 {
-	static rpc_param_result_struct result;
 	rpc_param_cmd_get_struct cmd_get;
 
 	blinkenlight_panel_t *p;
@@ -419,30 +1777,31 @@ rpc_param_set_1_svc(rpc_param_cmd_set_struct cmd_set, struct svc_req *rqstp)
 	//unsigned i_control;
 
 	// only 1 thing implemented
-	result.error_code = RPC_ERR_PARAM_ILL_CLASS; // default: error
-	switch (cmd_set.object_class) {
+	result->error_code = RPC_ERR_PARAM_ILL_CLASS; // default: error
+	switch (cmd_set->object_class) {
 	//case RPC_PARAM_CLASS_BUS: 	break;
 	case RPC_PARAM_CLASS_PANEL:
-		result.error_code = RPC_ERR_PARAM_ILL_OBJECT;
-		if (cmd_set.object_handle < blinkenlight_panel_list->panels_count) {
-			p = &(blinkenlight_panel_list->panels[cmd_set.object_handle]); // valid panel
-			result.error_code = RPC_ERR_PARAM_ILL_PARAM;
-			switch (cmd_set.param_handle) {
+		result->error_code = RPC_ERR_PARAM_ILL_OBJECT;
+		if (cmd_set->object_handle < blinkenlight_panel_list->panels_count) {
+			p = &(blinkenlight_panel_list->panels[cmd_set->object_handle]); // valid panel
+			result->error_code = RPC_ERR_PARAM_ILL_PARAM;
+			panel_write_lock(p);
+			switch (cmd_set->param_handle) {
 			case RPC_PARAM_HANDLE_PANEL_BLINKENBOARDS_STATE:
 
 				// set tristate of all BlinkenBoards of this panel.
 				// side effect to other panels on the same boards!
 				if (blinkenlight_api_panel_set_state_evt)
-					blinkenlight_api_panel_set_state_evt(p, cmd_set.param_value);
+					blinkenlight_api_panel_set_state_evt(p, cmd_set->param_value);
 
-				result.error_code = RPC_ERR_OK;
+				result->error_code = RPC_ERR_OK;
 				break;
 			case RPC_PARAM_HANDLE_PANEL_MODE:
 				// set self test/power mode for every controls
 
-				p->mode = cmd_set.param_value;
+				p->mode = cmd_set->param_value;
 				if (blinkenlight_api_panel_set_mode_evt)
-					blinkenlight_api_panel_set_mode_evt(p, cmd_set.param_value);
+					blinkenlight_api_panel_set_mode_evt(p, cmd_set->param_value);
 
 				/// this server can not selftest the input controls,
 				// it is controlling REAL hardware
@@ -452,44 +1811,67 @@ rpc_param_set_1_svc(rpc_param_cmd_set_struct cmd_set, struct svc_req *rqstp)
 					blinkenlight_api_panel_set_controlvalues_evt(p, /*force_all*/1);
 				break;
 			}
-
+			panel_unlock(p);
 		}
 		break;
 //	case RPC_PARAM_CLASS_CONTROL: break;
 	}
 	// error code only 0 if class, object and param ok
 
-	if (result.error_code)
-		return &result;
-	else {
+	if (!result->error_code) {
 		// result: query the same parameter
-		cmd_get.object_class = cmd_set.object_class;
-		cmd_get.object_handle = cmd_set.object_handle;
-		cmd_get.param_handle = cmd_set.param_handle;
-		rpc_param_get_intern(&result, &cmd_get);
-
-		return &result;
+		cmd_get.object_class = cmd_set->object_class;
+		cmd_get.object_handle = cmd_set->object_handle;
+		cmd_get.param_handle = cmd_set->param_handle;
+		rpc_param_get_intern(result, &cmd_get);
 	}
+	return 1;
 }
 
-rpc_test_cmdstatus_struct *
-rpc_test_data_to_server_1_svc(rpc_test_data_struct data, struct svc_req *rqstp)
-{
-	static rpc_test_cmdstatus_struct result;
-	// query all BlinkenBoards. not enabled, if one of these are is not enabled
+/*
+ * Performance tests.
+ * test_data_to_server(): data is only counted, result is the received byte count.
+ * test_data_from_server(): returns "bytecount" bytes of test pattern,
+ * fixdata1/fixdata2 = CPU time used by the server process until now,
+ * in seconds and microseconds. A benchmark client calculates the
+ * server load from the difference.
+ */
 
-	return &result;
-}
+// max transfer size. UDP limits this further (UDPMSGSIZE)
+#define RPC_TEST_DATA_MAX_BYTECOUNT	0x10000
 
-rpc_test_data_struct *
-rpc_test_data_from_server_1_svc(rpc_test_cmdstatus_struct data, struct svc_req *rqstp)
+static int rpc_test_data_to_server_proc(rpc_test_data_struct *data,
+		rpc_test_cmdstatus_struct *result, struct svc_req *rqstp)
 {
-	static rpc_test_data_struct result;
-
-	/*
-	 * insert server code here
-	 */
-
-	return &result;
+	print(LOG_DEBUG, "test_data_to_server(%u bytes)\n", data->vardata.vardata_len);
+	result->bytecount = data->vardata.vardata_len;
+	return 1;
 }
 
+static int rpc_test_data_from_server_proc(rpc_test_cmdstatus_struct *cmd,
+		rpc_test_data_struct *result, struct svc_req *rqstp)
+{
+	struct rusage usage;
+	unsigned bytecount, i;
+
+	print(LOG_DEBUG, "test_data_from_server(%d bytes)\n", cmd->bytecount);
+
+	if (cmd->bytecount < 0)
+		bytecount = 0;
+	else if (cmd->bytecount > RPC_TEST_DATA_MAX_BYTECOUNT)
+		bytecount = RPC_TEST_DATA_MAX_BYTECOUNT;
+	else
+		bytecount = cmd->bytecount;
+	result->vardata.vardata_len = bytecount;
+	result->vardata.vardata_val = (u_char *) malloc(bytecount + 1); // not NULL for 0 bytes
+	assert(result->vardata.vardata_val);
+	// pattern the client can verify
+	for (i = 0; i < bytecount; i++)
+		result->vardata.vardata_val[i] = (u_char) i;
+
+	getrusage(RUSAGE_SELF, &usage);
+	timeradd(&usage.ru_utime, &usage.ru_stime, &usage.ru_utime);
+	result->fixdata1 = usage.ru_utime.tv_sec;
+	result->fixdata2 = usage.ru_utime.tv_usec;
+	return 1;
+}
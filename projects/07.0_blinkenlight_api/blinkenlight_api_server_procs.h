@@ -20,6 +20,11 @@
    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+   17-Oct-2026  agent   blinkenlight_api_server_dispatch() replaces blinkenlightd_1()
+   17-Oct-2026  agent   shm_service() result, subscriptions_count()
+   17-Oct-2026  agent   runtime metrics: blinkenlight_api_server_dispatch(), bus param event
+   17-Oct-2026  agent   shared memory image: blinkenlight_api_server_shm_*()
+   17-Oct-2026  agent   blinkenlight_api_server_service_subscriptions()
    08-May-2016  JH      new event "set_controlvalue"
    22-Feb-2016	JH		added panel mode set/get callbacks
    13-Nov-2015  JH      created
@@ -28,6 +33,12 @@
 #ifndef BLINKENLIGHT_API_SERVER_PROCS_H_
 #define BLINKENLIGHT_API_SERVER_PROCS_H_
 
+#ifndef WIN32
+#include <sys/select.h>	// fd_set
+#include <pthread.h>
+#include "rtsched.h"
+#endif
+#include "rpc_blinkenlight_api.h"
 #include "blinkenlight_panels.h"
 
 
@@ -40,6 +51,23 @@ typedef void (*blinkenlight_api_panel_set_state_evt_t) (blinkenlight_panel_t *,
 typedef int (*blinkenlight_api_panel_get_mode_evt_t) (blinkenlight_panel_t *) ;
 typedef void (*blinkenlight_api_panel_set_mode_evt_t) (blinkenlight_panel_t *, int) ;
 typedef char *(*blinkenlight_api_get_info_evt_t) (void) ;
+// server specific RPC_PARAM_CLASS_BUS parameters. result: RPC_ERR_*
+typedef int (*blinkenlight_api_bus_get_param_evt_t) (unsigned object_handle, unsigned param_handle, unsigned *param_value) ;
+
+// register with svc_register(). Serves requests in the RPC thread or in reactor workers
+void blinkenlight_api_server_dispatch(struct svc_req *rqstp, SVCXPRT *transp) ;
+
+// answer input change subscriptions. Call on RPC traffic before svc_getreqset(), and periodically
+void blinkenlight_api_server_service_subscriptions(fd_set *readfds) ;
+unsigned blinkenlight_api_server_subscriptions_count(void) ;
+
+#ifndef WIN32
+// shared memory image for clients on the same host
+int blinkenlight_api_server_shm_create(void) ;
+void blinkenlight_api_server_shm_destroy(void) ;
+// call periodically from main loop. result: 1 = client is writing
+int blinkenlight_api_server_shm_service(void) ;
+#endif
 
 #ifndef BLINKENLIGHT_API_SERVER_PROCS_C_
 
@@ -56,6 +84,13 @@ extern blinkenlight_api_panel_set_state_evt_t blinkenlight_api_panel_set_state_e
 extern blinkenlight_api_panel_get_mode_evt_t blinkenlight_api_panel_get_mode_evt ;
 extern blinkenlight_api_panel_set_mode_evt_t blinkenlight_api_panel_set_mode_evt ;
 extern blinkenlight_api_get_info_evt_t blinkenlight_api_get_info_evt ;
+extern blinkenlight_api_bus_get_param_evt_t blinkenlight_api_bus_get_param_evt ;
+
+#ifndef WIN32
+// sources of runtime metrics, set by the server. NULL = not available
+extern rtsched_t *blinkenlight_api_metrics_mux_sched ;
+extern pthread_t *blinkenlight_api_metrics_update_thread ;
+#endif
 #endif
 
 #endif /* BLINKENLIGHT_API_SERVER_PROCS_H_ */
@@ -0,0 +1,480 @@
+/* blinkenlight_api_server_reactor.c: event loop of a Blinkenlight API server
+
+ Copyright (c) 2026, agent
+ j_hoppe@t-online.de, www.retrocmp.com
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ THE AUTHOR BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ 17-Oct-2026  agent   one pending job per connection, no early serve with a stale xid
+ 17-Oct-2026  agent   worker pool for RPC requests
+ 17-Oct-2026  agent   created
+
+
+ Replaces svc_run() and the select() loop with 2 ms timeout.
+ The thread sleeps in epoll_wait() until an RPC socket is readable
+ or a timerfd expires, so RPC requests are served at once and an idle
+ server does not wake up 500 times per second.
+
+ Periodic work runs on timers with their own rates:
+ - shared memory clients: fast while a client writes, slow else.
+ - parked WAIT requests: only while there are some.
+ - MUX health: warn about overrun multiplexing phases.
+ - more timers from the server, like the panel simulation.
+
+ The RPC library changes svc_fdset when it accepts or closes TCP connections.
+ After each svc_getreqset() the epoll set is synchronized with it.
+ A closed socket leaves the epoll set by itself; its fd number may be reused
+ by a connection accepted in the same svc_getreqset(). So whenever a listening
+ socket was readable, all sockets in svc_fdset are registered again.
+
+ RPC requests on TCP connections may be served by a pool of worker threads.
+ The RPC thread decodes the request in svc_getreqset() and submits a job.
+ Jobs are handed to the workers only after svc_getreqset() returned,
+ as the RPC library still inspects the connection after dispatch.
+ The reply xid is kept in the transport: a request followed by more
+ requests in the same record stream is served at once in the RPC thread,
+ only the last one of a connection may become a job.
+ A single job while all workers are idle is served at once in the RPC
+ thread: handing it over would only add two thread wake ups.
+ While a job is queued or running, its connection is removed from the
+ epoll set, so only the worker uses the transport. After the reply the
+ worker signals the RPC thread over an eventfd, which registers the
+ connection again.
+ Default worker count is one less than the CPUs: a single core machine
+ serves everything in the RPC thread.
+ */
+#ifndef WIN32
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <pthread.h>
+
+#include "print.h"
+#include "rpc_blinkenlight_api.h"
+#include "blinkenlight_api_server_procs.h"
+#include "blinkenlight_api_server_reactor.h"
+
+#define REACTOR_MAX_EVENTS	32
+// epoll_event.data of timers, sockets have their fd there
+#define REACTOR_TIMER_TAG	0x100000000ULL
+#define REACTOR_WAKEUP_TAG	0x200000000ULL
+
+typedef struct {
+	char *name;
+	int fd; // timerfd
+	unsigned period_us; // 0 = stopped
+	blinkenlight_api_reactor_timer_func_t func;
+} blinkenlight_api_reactor_timer_t;
+
+static int reactor_epoll_fd = -1;
+static blinkenlight_api_reactor_timer_t reactor_timers[BLINKENLIGHT_API_REACTOR_MAX_TIMERS];
+static unsigned reactor_timers_count = 0;
+
+static fd_set reactor_fds; // sockets of svc_fdset in the epoll set
+static fd_set reactor_listen_fds; // subset: accepting TCP connections
+static fd_set reactor_busy_fds; // connections with a job in a worker, not in the epoll set
+
+int blinkenlight_api_reactor_workers = -1;
+static pthread_t reactor_worker_threads[BLINKENLIGHT_API_REACTOR_MAX_WORKERS];
+static blinkenlight_api_reactor_job_t *reactor_pending; // submitted in current svc_getreqset()
+// shared with the workers
+static pthread_mutex_t reactor_queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t reactor_queue_cond = PTHREAD_COND_INITIALIZER;
+static blinkenlight_api_reactor_job_t *reactor_queue_head, *reactor_queue_tail;
+static unsigned reactor_jobs_active; // queued or running
+static fd_set reactor_done_fds; // jobs finished, connection to be registered again
+static int reactor_wakeup_fd = -1; // eventfd, workers wake the RPC thread
+
+// built-in timers
+static int shm_timer;
+static uint64_t shm_active_us; // last time a shared memory client wrote
+static int subscriptions_timer;
+static int mux_health_timer;
+static uint32_t mux_health_overruns;
+
+static void reactor_timer_arm(blinkenlight_api_reactor_timer_t *t)
+{
+	struct itimerspec its;
+	its.it_interval.tv_sec = t->period_us / 1000000;
+	its.it_interval.tv_nsec = (t->period_us % 1000000) * 1000;
+	its.it_value = its.it_interval; // 0 = disarm
+	timerfd_settime(t->fd, 0, &its, NULL);
+}
+
+int blinkenlight_api_reactor_add_timer(char *name, unsigned period_us,
+		blinkenlight_api_reactor_timer_func_t func)
+{
+	blinkenlight_api_reactor_timer_t *t;
+	struct epoll_event ev;
+
+	if (reactor_timers_count >= BLINKENLIGHT_API_REACTOR_MAX_TIMERS) {
+		print(LOG_ERR, "Too many reactor timers, \"%s\" not added\n", name);
+		return -1;
+	}
+	t = &reactor_timers[reactor_timers_count];
+	t->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (t->fd < 0) {
+		print(LOG_ERR, "timerfd_create() for \"%s\" failed: %s\n", name, strerror(errno));
+		return -1;
+	}
+	ev.events = EPOLLIN;
+	ev.data.u64 = REACTOR_TIMER_TAG | reactor_timers_count;
+	if (epoll_ctl(reactor_epoll_fd, EPOLL_CTL_ADD, t->fd, &ev) < 0) {
+		print(LOG_ERR, "epoll_ctl() for timer \"%s\" failed: %s\n", name, strerror(errno));
+		close(t->fd);
+		return -1;
+	}
+	t->name = name;
+	t->func = func;
+	t->period_us = period_us;
+	reactor_timer_arm(t);
+	return reactor_timers_count++;
+}
+
+void blinkenlight_api_reactor_set_timer(int timer, unsigned period_us)
+{
+	blinkenlight_api_reactor_timer_t *t;
+	if (timer < 0 || (unsigned) timer >= reactor_timers_count)
+		return;
+	t = &reactor_timers[timer];
+	if (t->period_us == period_us)
+		return;
+	t->period_us = period_us;
+	reactor_timer_arm(t);
+}
+
+// serve shared memory clients, with high rate only while one is writing
+static void on_shm_timer(void)
+{
+	uint64_t now_us = historybuffer_now_us();
+	if (blinkenlight_api_server_shm_service())
+		shm_active_us = now_us;
+	if (now_us - shm_active_us < 1000000)
+		blinkenlight_api_reactor_set_timer(shm_timer, BLINKENLIGHT_API_REACTOR_SHM_ACTIVE_US);
+	else
+		blinkenlight_api_reactor_set_timer(shm_timer, BLINKENLIGHT_API_REACTOR_SHM_IDLE_US);
+}
+
+static void on_subscriptions_timer(void)
+{
+	blinkenlight_api_server_service_subscriptions(NULL);
+	if (blinkenlight_api_server_subscriptions_count() == 0)
+		blinkenlight_api_reactor_set_timer(subscriptions_timer, 0);
+}
+
+static void on_mux_health_timer(void)
+{
+	rtsched_t *sched = blinkenlight_api_metrics_mux_sched;
+	uint32_t overruns;
+
+	if (sched == NULL)
+		return;
+	overruns = sched->overruns;
+	if (overruns != mux_health_overruns)
+		print(LOG_WARNING, "%s thread: %u phases overrun in the last %u ms, max jitter %u us\n",
+				sched->name ? sched->name : "MUX", overruns - mux_health_overruns,
+				BLINKENLIGHT_API_REACTOR_MUX_HEALTH_US / 1000, sched->jitter_max_ns / 1000);
+	mux_health_overruns = overruns;
+}
+
+/*
+ * register the sockets of svc_fdset in the epoll set.
+ * force: register also sockets seen before, their fd may have been reused.
+ */
+static void reactor_sync_svc_fds(int force)
+{
+	struct epoll_event ev;
+	int fd;
+	int listening;
+	socklen_t optlen;
+
+	if (!force && !memcmp(&reactor_fds, &svc_fdset, sizeof(fd_set)))
+		return;
+	for (fd = 0; fd < FD_SETSIZE; fd++) {
+		if (FD_ISSET(fd, &svc_fdset)) {
+			if (FD_ISSET(fd, &reactor_busy_fds)
+					|| (FD_ISSET(fd, &reactor_fds) && !force))
+				continue;
+			ev.events = EPOLLIN;
+			ev.data.u64 = (unsigned) fd;
+			if (epoll_ctl(reactor_epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0 && errno != EEXIST) {
+				print(LOG_ERR, "epoll_ctl(%d) failed: %s\n", fd, strerror(errno));
+				continue;
+			}
+			FD_SET(fd, &reactor_fds);
+			listening = 0;
+			optlen = sizeof(listening);
+			if (getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &listening, &optlen) == 0 && listening)
+				FD_SET(fd, &reactor_listen_fds);
+			else
+				FD_CLR(fd, &reactor_listen_fds);
+		} else if (FD_ISSET(fd, &reactor_fds)) {
+			// closed sockets are already removed, error ignored
+			epoll_ctl(reactor_epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+			FD_CLR(fd, &reactor_fds);
+			FD_CLR(fd, &reactor_listen_fds);
+		}
+	}
+}
+
+/*
+ * queue a job for the workers.
+ * Called in svc_getreqset(), so only the RPC thread touches "reactor_pending".
+ * The caller submits only the last request read from a connection (no
+ * XPRT_MOREREQS), and the connection is not read again before the job is
+ * done: a connection has at most one job, replies stay in order and are
+ * sent with the xid of their request.
+ */
+void blinkenlight_api_reactor_submit(blinkenlight_api_reactor_job_t *job)
+{
+	blinkenlight_api_reactor_job_t **pj;
+
+	job->cancelled = 0;
+	if (blinkenlight_api_reactor_workers <= 0) {
+		job->func(job);
+		return;
+	}
+	for (pj = &reactor_pending; *pj; pj = &(*pj)->next)
+		;
+	job->next = NULL;
+	*pj = job;
+}
+
+// after svc_getreqset(): hand submitted jobs to the workers
+static void reactor_release_pending(void)
+{
+	blinkenlight_api_reactor_job_t *job, *next;
+
+	if (reactor_pending == NULL)
+		return;
+	pthread_mutex_lock(&reactor_queue_mutex);
+	if (reactor_pending->next == NULL && reactor_jobs_active == 0) {
+		// only one, and workers idle
+		pthread_mutex_unlock(&reactor_queue_mutex);
+		job = reactor_pending;
+		reactor_pending = NULL;
+		job->cancelled = !FD_ISSET(job->fd, &svc_fdset);
+		job->func(job);
+		return;
+	}
+	for (job = reactor_pending; job; job = next) {
+		next = job->next;
+		job->next = NULL;
+		if (!FD_ISSET(job->fd, &svc_fdset)) {
+			// connection closed in the same svc_getreqset(): transport is gone
+			job->cancelled = 1;
+			job->func(job);
+			continue;
+		}
+		// connection is not read until the worker is done
+		if (FD_ISSET(job->fd, &reactor_fds)) {
+			epoll_ctl(reactor_epoll_fd, EPOLL_CTL_DEL, job->fd, NULL);
+			FD_CLR(job->fd, &reactor_fds);
+		}
+		FD_SET(job->fd, &reactor_busy_fds);
+		reactor_jobs_active++;
+		if (reactor_queue_tail)
+			reactor_queue_tail->next = job;
+		else
+			reactor_queue_head = job;
+		reactor_queue_tail = job;
+	}
+	pthread_cond_broadcast(&reactor_queue_cond);
+	pthread_mutex_unlock(&reactor_queue_mutex);
+	reactor_pending = NULL;
+}
+
+static void *reactor_worker(void *arg)
+{
+	blinkenlight_api_reactor_job_t *job;
+	uint64_t one = 1;
+	int fd;
+
+	for (;;) {
+		pthread_mutex_lock(&reactor_queue_mutex);
+		while (reactor_queue_head == NULL)
+			pthread_cond_wait(&reactor_queue_cond, &reactor_queue_mutex);
+		job = reactor_queue_head;
+		reactor_queue_head = job->next;
+		if (reactor_queue_head == NULL)
+			reactor_queue_tail = NULL;
+		pthread_mutex_unlock(&reactor_queue_mutex);
+
+		fd = job->fd;
+		job->func(job); // job is gone now
+
+		pthread_mutex_lock(&reactor_queue_mutex);
+		FD_SET(fd, &reactor_done_fds);
+		reactor_jobs_active--;
+		pthread_mutex_unlock(&reactor_queue_mutex);
+		if (write(reactor_wakeup_fd, &one, sizeof(one)) != sizeof(one))
+			print(LOG_ERR, "reactor_worker(): eventfd write failed: %s\n", strerror(errno));
+	}
+	return NULL;
+}
+
+// RPC thread: connections of finished jobs are read again
+static void reactor_jobs_done(void)
+{
+	uint64_t count;
+	fd_set done;
+	int fd;
+
+	if (read(reactor_wakeup_fd, &count, sizeof(count)) != sizeof(count))
+		return;
+	pthread_mutex_lock(&reactor_queue_mutex);
+	done = reactor_done_fds;
+	FD_ZERO(&reactor_done_fds);
+	pthread_mutex_unlock(&reactor_queue_mutex);
+	for (fd = 0; fd < FD_SETSIZE; fd++)
+		if (FD_ISSET(fd, &done))
+			FD_CLR(fd, &reactor_busy_fds);
+	reactor_sync_svc_fds(0);
+}
+
+static int reactor_workers_start(void)
+{
+	struct epoll_event ev;
+	int i;
+	int res;
+
+	if (blinkenlight_api_reactor_workers < 0) {
+		blinkenlight_api_reactor_workers = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+		if (blinkenlight_api_reactor_workers > BLINKENLIGHT_API_REACTOR_DEFAULT_MAX_WORKERS)
+			blinkenlight_api_reactor_workers = BLINKENLIGHT_API_REACTOR_DEFAULT_MAX_WORKERS;
+	}
+	if (blinkenlight_api_reactor_workers > BLINKENLIGHT_API_REACTOR_MAX_WORKERS)
+		blinkenlight_api_reactor_workers = BLINKENLIGHT_API_REACTOR_MAX_WORKERS;
+	if (blinkenlight_api_reactor_workers <= 0) {
+		blinkenlight_api_reactor_workers = 0;
+		return 0;
+	}
+	reactor_wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (reactor_wakeup_fd < 0) {
+		print(LOG_ERR, "eventfd() failed: %s\n", strerror(errno));
+		return 1;
+	}
+	ev.events = EPOLLIN;
+	ev.data.u64 = REACTOR_WAKEUP_TAG;
+	if (epoll_ctl(reactor_epoll_fd, EPOLL_CTL_ADD, reactor_wakeup_fd, &ev) < 0) {
+		print(LOG_ERR, "epoll_ctl() for eventfd failed: %s\n", strerror(errno));
+		return 1;
+	}
+	for (i = 0; i < blinkenlight_api_reactor_workers; i++) {
+		res = pthread_create(&reactor_worker_threads[i], NULL, reactor_worker, NULL);
+		if (res) {
+			print(LOG_ERR, "Creating RPC worker thread failed, error %d\n", res);
+			if (i == 0)
+				return 1;
+			break;
+		}
+	}
+	blinkenlight_api_reactor_workers = i;
+	print(LOG_INFO, "%d RPC worker threads started.\n", i);
+	return 0;
+}
+
+/*
+ * result: 0 = OK
+ */
+int blinkenlight_api_reactor_init(void)
+{
+	reactor_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (reactor_epoll_fd < 0) {
+		print(LOG_ERR, "epoll_create1() failed: %s\n", strerror(errno));
+		return 1;
+	}
+	FD_ZERO(&reactor_fds);
+	FD_ZERO(&reactor_listen_fds);
+	FD_ZERO(&reactor_busy_fds);
+	FD_ZERO(&reactor_done_fds);
+	reactor_pending = NULL;
+	reactor_jobs_active = 0;
+	reactor_sync_svc_fds(1);
+
+	shm_active_us = 0;
+	mux_health_overruns = 0;
+	shm_timer = blinkenlight_api_reactor_add_timer("shared memory",
+			BLINKENLIGHT_API_REACTOR_SHM_IDLE_US, on_shm_timer);
+	subscriptions_timer = blinkenlight_api_reactor_add_timer("subscriptions", 0,
+			on_subscriptions_timer);
+	mux_health_timer = blinkenlight_api_reactor_add_timer("MUX health",
+			BLINKENLIGHT_API_REACTOR_MUX_HEALTH_US, on_mux_health_timer);
+	if (shm_timer < 0 || subscriptions_timer < 0 || mux_health_timer < 0)
+		return 1;
+	return reactor_workers_start();
+}
+
+void blinkenlight_api_reactor_run(void)
+{
+	struct epoll_event events[REACTOR_MAX_EVENTS];
+	blinkenlight_api_reactor_timer_t *t;
+	fd_set readfds;
+	uint64_t expirations;
+	int n, i, fd;
+	int rpc_readable, listen_readable;
+
+	for (;;) {
+		n = epoll_wait(reactor_epoll_fd, events, REACTOR_MAX_EVENTS, -1);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			print(LOG_ERR, "epoll_wait() failed: %s\n", strerror(errno));
+			return;
+		}
+		FD_ZERO(&readfds);
+		rpc_readable = listen_readable = 0;
+		for (i = 0; i < n; i++) {
+			if (events[i].data.u64 & REACTOR_WAKEUP_TAG) {
+				reactor_jobs_done();
+			} else if (events[i].data.u64 & REACTOR_TIMER_TAG) {
+				t = &reactor_timers[events[i].data.u64 & ~REACTOR_TIMER_TAG];
+				// clear expiration count. Missed periods are not caught up.
+				if (read(t->fd, &expirations, sizeof(expirations)) == sizeof(expirations)
+						&& t->period_us)
+					t->func();
+			} else {
+				fd = (int) events[i].data.u64;
+				FD_SET(fd, &readfds);
+				rpc_readable = 1;
+				if (FD_ISSET(fd, &reactor_listen_fds))
+					listen_readable = 1;
+			}
+		}
+		if (rpc_readable) {
+			blinkenlight_api_server_service_subscriptions(&readfds);
+			svc_getreqset(&readfds);
+			reactor_sync_svc_fds(listen_readable);
+			reactor_release_pending();
+			// a WAIT request may have been parked
+			if (blinkenlight_api_server_subscriptions_count())
+				blinkenlight_api_reactor_set_timer(subscriptions_timer,
+						BLINKENLIGHT_API_REACTOR_SUBSCRIPTIONS_US);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,67 @@
+/* blinkenlight_api_server_reactor.h: event loop of a Blinkenlight API server
+
+   Copyright (c) 2026, agent
+   j_hoppe@t-online.de, www.retrocmp.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+   THE AUTHOR BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+   IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+   17-Oct-2026  agent   worker pool for RPC requests
+   17-Oct-2026  agent   created
+*/
+
+#ifndef BLINKENLIGHT_API_SERVER_REACTOR_H_
+#define BLINKENLIGHT_API_SERVER_REACTOR_H_
+
+#define BLINKENLIGHT_API_REACTOR_MAX_TIMERS	8
+#define BLINKENLIGHT_API_REACTOR_MAX_WORKERS	16
+#define BLINKENLIGHT_API_REACTOR_DEFAULT_MAX_WORKERS	4	// if set from CPU count
+
+// periods of the built-in timers
+#define BLINKENLIGHT_API_REACTOR_SHM_ACTIVE_US	1000	// shared memory client is writing
+#define BLINKENLIGHT_API_REACTOR_SHM_IDLE_US	20000	// no client, or client quiet for 1 sec
+#define BLINKENLIGHT_API_REACTOR_SUBSCRIPTIONS_US	5000	// while WAIT requests are parked
+#define BLINKENLIGHT_API_REACTOR_MUX_HEALTH_US	1000000
+
+typedef void (*blinkenlight_api_reactor_timer_func_t)(void) ;
+
+// a request served by a worker thread, embedded in the caller's request data
+typedef struct blinkenlight_api_reactor_job_struct {
+	int fd; // connection, not read while the job is queued or running
+	int cancelled; // connection closed before the job ran: func must only clean up
+	void (*func)(struct blinkenlight_api_reactor_job_struct *job) ;
+	struct blinkenlight_api_reactor_job_struct *next;
+} blinkenlight_api_reactor_job_t;
+
+// count of worker threads, set before init().
+// 0 = serve everything in the RPC thread, -1 = CPU count - 1
+extern int blinkenlight_api_reactor_workers ;
+
+// after the RPC transports are registered and the shared memory image is created
+int blinkenlight_api_reactor_init(void) ;
+// result: timer handle, < 0 on error
+int blinkenlight_api_reactor_add_timer(char *name, unsigned period_us,
+		blinkenlight_api_reactor_timer_func_t func) ;
+// change period of a timer, 0 = stop
+void blinkenlight_api_reactor_set_timer(int timer, unsigned period_us) ;
+// from RPC dispatch: run job in a worker, after the current svc_getreqset()
+void blinkenlight_api_reactor_submit(blinkenlight_api_reactor_job_t *job) ;
+// serve RPC and timers. Returns only on error
+void blinkenlight_api_reactor_run(void) ;
+
+#endif /* BLINKENLIGHT_API_SERVER_REACTOR_H_ */
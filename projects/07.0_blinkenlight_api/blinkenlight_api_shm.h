@@ -0,0 +1,109 @@
+/* blinkenlight_api_shm.h: shared memory image of panel control values
+
+ Copyright (c) 2026, agent
+ j_hoppe@t-online.de, www.retrocmp.com
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ THE AUTHOR BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+ 17-Oct-2026	agent   created
+
+
+ If simulator and Blinkenlight API server run on the same host,
+ control values can be exchanged over a POSIX shared memory image
+ instead of RPC over loopback.
+ Panel and control definitions are still queried over RPC.
+
+ - The server creates the image at startup and mirrors its panels into it.
+ - "outputs" section of a panel: written by the client,
+   polled and applied by the server main loop.
+ - "inputs" section: written by the server, read by the client.
+ - Each section is protected by a "seqlock" sequence counter:
+   odd while the writer changes values. A reader must retry or
+   ignore the values, if the counter was odd or changed while reading.
+ - Only one writer per section: only one shm client per panel.
+ - Remote clients are still served over RPC from the same panel state.
+ */
+
+#ifndef BLINKENLIGHT_API_SHM_H_
+#define BLINKENLIGHT_API_SHM_H_
+
+#include <stdint.h>
+#include "blinkenlight_panels.h"
+
+#define BLINKENLIGHT_API_SHM_NAME	"/blinkenlight_api"
+#define BLINKENLIGHT_API_SHM_MAGIC	0x424c4b31	// "BLK1"
+#define BLINKENLIGHT_API_SHM_VERSION	1
+
+// orders data access against the sequence counter, also between processes
+#define BLINKENLIGHT_API_SHM_BARRIER()	__sync_synchronize()
+
+// values of all controls of a panel, indexed like panel->controls[]
+typedef struct
+{
+	volatile unsigned sequence; // odd while writer updates values[]
+	volatile uint64_t values[MAX_BLINKENLIGHT_PANEL_CONTROLS];
+} blinkenlight_api_shm_values_t;
+
+typedef struct
+{
+	char name[MAX_BLINKENLIGHT_NAME_LEN]; // to verify client and server panel list
+	unsigned controls_count;
+	blinkenlight_api_shm_values_t outputs; // written by client
+	blinkenlight_api_shm_values_t inputs; // written by server
+} blinkenlight_api_shm_panel_t;
+
+typedef struct
+{
+	unsigned magic; // BLINKENLIGHT_API_SHM_MAGIC, if server initialized the image
+	unsigned version;
+	unsigned panels_count;
+	volatile unsigned heartbeat; // incremented by server main loop
+	blinkenlight_api_shm_panel_t panels[MAX_BLINKENLIGHT_PANELS];
+} blinkenlight_api_shm_t;
+
+// writer: enclose changes of values[]
+static inline void blinkenlight_api_shm_write_begin(blinkenlight_api_shm_values_t *s)
+{
+	s->sequence++; // odd: update in progress
+	BLINKENLIGHT_API_SHM_BARRIER();
+}
+
+static inline void blinkenlight_api_shm_write_end(blinkenlight_api_shm_values_t *s)
+{
+	BLINKENLIGHT_API_SHM_BARRIER();
+	s->sequence++; // even: consistent again
+}
+
+// reader: sequence before copying values[]
+static inline unsigned blinkenlight_api_shm_read_begin(blinkenlight_api_shm_values_t *s)
+{
+	unsigned sequence = s->sequence;
+	BLINKENLIGHT_API_SHM_BARRIER();
+	return sequence;
+}
+
+// reader: 1, if the values[] copied after read_begin() are torn
+static inline int blinkenlight_api_shm_read_retry(blinkenlight_api_shm_values_t *s,
+		unsigned sequence)
+{
+	BLINKENLIGHT_API_SHM_BARRIER();
+	return (sequence & 1) || s->sequence != sequence;
+}
+
+#endif /* BLINKENLIGHT_API_SHM_H_ */
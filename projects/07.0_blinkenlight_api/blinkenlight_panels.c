@@ -20,6 +20,9 @@
    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+    17-Oct-2026  agent   schema hash, for client side caching of panel descriptors
+    17-Oct-2026  agent   compile register wirings into wiring_plan
+    17-Oct-2026  agent   init of outputs delta per client and inputs sequence
     10-Sep-2016  JH      added value_raw, as stage before input filtering
     22-Mar-2016  JH      allow non-BlinkenBoard hardware registers. _fixup() moved here.
     02-Feb-2012  JH      created
@@ -141,6 +144,14 @@ blinkenlight_panel_t *blinkenlight_add_panel(blinkenlight_panel_list_t *_this)
 	p->controls_outputs_count = 0;
 	p->controls_inputs_values_bytecount = 0;
 	p->controls_outputs_values_bytecount = 0;
+	p->outputs_delta_sequence = 0;
+	p->outputs_delta_valid = 0;
+#ifdef BLINKENLIGHT_SERVER
+	memset(p->outputs_delta_clients, 0, sizeof(p->outputs_delta_clients));
+	p->outputs_delta_clients_next = 0;
+#endif
+	p->inputs_sequence = 0;
+	p->inputs_timestamp_us = 0;
 	p->default_radix = 10;
 	p->name[0] = '\0';
 	p->info[0] = '\0';
@@ -177,6 +188,8 @@ blinkenlight_control_t *blinkenlight_add_control(blinkenlight_panel_list_t *_thi
 	c->fmax = 0 ;
 	c->history = historybuffer_create(c, MAX_BLINKENLIGHT_HISTORY_ENTRIES) ;
 	c->value_raw = 0 ;
+	c->value_reported = 0 ;
+	c->value_reported_sequence = 0 ;
 #endif
 	// is not free'd! but only single data struct allocate at program start
 	return c;
@@ -304,7 +317,106 @@ unsigned blinkenlight_panels_get_max_control_name_len(blinkenlight_panel_list_t
 }
 
 
+// FNV-1a, 64 bit
+#define SCHEMA_HASH_OFFSET	0xcbf29ce484222325ULL
+#define SCHEMA_HASH_PRIME	0x100000001b3ULL
+
+static uint64_t schema_hash_bytes(uint64_t hash, const void *data, unsigned len)
+{
+	const unsigned char *b = (const unsigned char *) data;
+	while (len--) {
+		hash ^= *b++;
+		hash *= SCHEMA_HASH_PRIME;
+	}
+	return hash;
+}
+
+static uint64_t schema_hash_unsigned(uint64_t hash, unsigned val)
+{
+	unsigned char b[4]; // fixed byte order, same hash on all hosts
+	b[0] = val;
+	b[1] = val >> 8;
+	b[2] = val >> 16;
+	b[3] = val >> 24;
+	return schema_hash_bytes(hash, b, 4);
+}
+
+/*
+ * hash over all panel and control descriptors, as transmitted by
+ * GETPANELINFO/GETCONTROLINFO. Server and client calculate the same hash
+ * for the same schema, the client uses it to validate its cache.
+ * Never 0, which means "no schema".
+ */
+uint64_t blinkenlight_panels_get_schema_hash(blinkenlight_panel_list_t *_this)
+{
+	uint64_t hash = SCHEMA_HASH_OFFSET;
+	unsigned i_panel, i_control;
+
+	hash = schema_hash_unsigned(hash, _this->panels_count);
+	for (i_panel = 0; i_panel < _this->panels_count; i_panel++) {
+		blinkenlight_panel_t *p = &(_this->panels[i_panel]);
+		hash = schema_hash_bytes(hash, p->name, strlen(p->name) + 1);
+		hash = schema_hash_unsigned(hash, p->controls_inputs_count);
+		hash = schema_hash_unsigned(hash, p->controls_outputs_count);
+		hash = schema_hash_unsigned(hash, p->controls_inputs_values_bytecount);
+		hash = schema_hash_unsigned(hash, p->controls_outputs_values_bytecount);
+		hash = schema_hash_unsigned(hash, p->controls_count);
+		for (i_control = 0; i_control < p->controls_count; i_control++) {
+			blinkenlight_control_t *c = &(p->controls[i_control]);
+			hash = schema_hash_bytes(hash, c->name, strlen(c->name) + 1);
+			hash = schema_hash_unsigned(hash, c->is_input);
+			hash = schema_hash_unsigned(hash, c->type);
+			hash = schema_hash_unsigned(hash, c->radix);
+			hash = schema_hash_unsigned(hash, c->value_bitlen);
+			hash = schema_hash_unsigned(hash, c->value_bytelen);
+		}
+	}
+	if (hash == 0)
+		hash = 1;
+	return hash;
+}
+
 #ifdef BLINKENLIGHT_SERVER
+/*
+ * compile register wirings of a control into c->wiring_plan[]
+ * Only for 8 bit registers. Mirrored bit order:
+ * value bit i is wired to register field bit (bitlen-1-i), so the field
+ * of a wiring is taken from the opposite end of the value and reversed.
+ */
+static void blinkenlight_control_wiring_plan_build(blinkenlight_control_t *c)
+{
+    unsigned i_register_wiring;
+    c->wiring_plan_valid = 0;
+    for (i_register_wiring = 0; i_register_wiring < c->blinkenbus_register_wiring_count;
+            i_register_wiring++) {
+        blinkenlight_control_blinkenbus_register_wiring_t *bbrw =
+                &(c->blinkenbus_register_wiring[i_register_wiring]);
+        blinkenlight_control_wiring_plan_t *wp = &(c->wiring_plan[i_register_wiring]);
+        unsigned offset = bbrw->control_value_bit_offset;
+        unsigned len = bbrw->blinkenbus_bitmask_len;
+
+        if (bbrw->blinkenbus_msb > 7 || len > 8)
+            return; // no BlinkenBus register
+        if (c->mirrored_bit_order && offset + len > c->value_bitlen)
+            return;
+        wp->register_address = bbrw->blinkenbus_register_address;
+        wp->field_mask = BitmaskFromLen8[len];
+        wp->register_mask = bbrw->blinkenbus_bitmask;
+        wp->lsb = bbrw->blinkenbus_lsb;
+        wp->invert = bbrw->blinkenbus_levels_active_low ? 0xff : 0;
+        if (c->mirrored_bit_order) {
+            wp->value_shift = c->value_bitlen - offset - len;
+            wp->mirrored = 1;
+            wp->mirror_shift = 8 - len;
+        } else {
+            wp->value_shift = offset;
+            wp->mirrored = 0;
+            wp->mirror_shift = 0;
+        }
+    }
+    c->wiring_plan_valid = 1;
+}
+
 /*
  * Post processing after panels/controls have been defined
  * (either by read of config file, or by program code)
@@ -369,6 +481,7 @@ void blinkenlight_panels_config_fixup(blinkenlight_panel_list_t *_this)
                 }
                 c->value_bitlen = get_msb_index64(all_value_bits) + 1;
             }
+            blinkenlight_control_wiring_plan_build(c);
             // round bitlen up to bytes
             c->value_bytelen = (c->value_bitlen + 7) / 8; // 0-> 0, 1->1 8->1, 9->2, ...
         }
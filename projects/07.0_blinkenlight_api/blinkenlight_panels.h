@@ -20,6 +20,10 @@
  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+ 17-Oct-2026  agent   blinkenlight_panels_get_schema_hash()
+ 17-Oct-2026  agent   added precompiled register wiring plan
+ 17-Oct-2026  agent   added inputs_sequence/timestamp for input change subscription
+ 17-Oct-2026  agent   added outputs delta sequence per client for delta encoded transfers
  10-Sep-2016  JH      added value_raw, as stage before input filtering
  25-May-2016  JH      added mux_code to register_wiring (control slice)
  22-Mar-2016  JH      allow non-BlinkenBoard hardware registers
@@ -57,6 +61,7 @@
 #define MAX_BLINKENLIGHT_PANELS	3
 #define MAX_BLINKENLIGHT_PANEL_CONTROLS	200	// the PDP-10 KI10 has > 100 !
 #define MAX_BLINKENLIGHT_REGISTERS_PER_CONTROL 8 //on panel control maybe spread accross max 8 BLINKENBUS registers
+#define MAX_BLINKENLIGHT_DELTA_CLIENTS	8 // clients sending delta encoded outputs to a panel
 #define MAX_BLINKENLIGHT_HISTORY_ENTRIES	256 // worst case: 1ms update from client, 1/4 sec low pass -> must hold 250 entries
 //#define MAX_BLINKENLIGHT_HISTORY_ENTRIES	16 // test
 
@@ -147,6 +152,21 @@ typedef struct blinkenlight_control_blinkenbus_register_wiring_struct
 
 } blinkenlight_control_blinkenbus_register_wiring_t;
 
+// A register wiring compiled for fast table driven access to 8 bit BlinkenBus registers.
+// Built by blinkenlight_panels_config_fixup(), "mirrored_bit_order" is folded in.
+// register bits = ((value >> value_shift) & field_mask) [mirrored] ^ invert) << lsb
+typedef struct blinkenlight_control_wiring_plan_struct
+{
+	unsigned register_address;// absolute register address in blinkenbus space
+	unsigned char value_shift;// lowest value bit in the register field
+	unsigned char field_mask;// bitmask_len bits, right aligned
+	unsigned char register_mask;// field_mask << lsb
+	unsigned char lsb;
+	unsigned char invert;// 0xff, if levels active low
+	unsigned char mirrored;// 1: reverse field with BitsMirrored[] >> mirror_shift
+	unsigned char mirror_shift;// 8 - bitmask_len
+} blinkenlight_control_wiring_plan_t;
+
 typedef enum blinkenlight_control_value_encoding_enum
 {
 	// "binary": bit pattern from BlinkenBus is interpreted as binary number
@@ -193,6 +213,11 @@ typedef struct blinkenlight_control_struct
 	// bit [0] -> bit[bitlen-1], bit [1] -> bit[bitlen-2], ...
 	unsigned mirrored_bit_order;
 
+	// register wirings compiled for 8 bit BlinkenBus registers.
+	// 0 if not possible (wider registers), then the wiring must be interpreted.
+	unsigned wiring_plan_valid;
+	blinkenlight_control_wiring_plan_t wiring_plan[MAX_BLINKENLIGHT_REGISTERS_PER_CONTROL];
+
 	unsigned	fmax ; // control can change max with that frequency, 0 = undefd.
 	// Used in call of historybuffer_get_average_vals(..., 1000000/fmax,..)
 
@@ -204,9 +229,22 @@ typedef struct blinkenlight_control_struct
 	// calculated by historybuffer_get_average_vals(...bitmode=0)
 	uint64_t averaged_value;
 
+	// input value last reported to clients, and panel inputs_sequence when it changed
+	uint64_t value_reported;
+	unsigned value_reported_sequence;
+
 #endif
 } blinkenlight_control_t;
 
+#ifdef BLINKENLIGHT_SERVER
+// sequence of delta encoded outputs, received from one client
+typedef struct blinkenlight_outputs_delta_client_struct
+{
+	unsigned client_id; // 0 = unused
+	unsigned sequence; // of last received outputs
+} blinkenlight_outputs_delta_client_t;
+#endif
+
 // a blinkenlight panel is a set of controls
 typedef struct blinkenlight_panel_struct
 {
@@ -225,6 +263,22 @@ typedef struct blinkenlight_panel_struct
 	unsigned controls_inputs_values_bytecount;
 	unsigned controls_outputs_values_bytecount;
 
+	// delta encoded transmission of output values (EXCHANGE procedure)
+	// client: sequence no of last sent outputs
+	unsigned outputs_delta_sequence;
+	// client: 1, if the server has our output values, so deltas can be applied
+	int outputs_delta_valid;
+#ifdef BLINKENLIGHT_SERVER
+	// server: every client counts its own sequence. Slots are reused round robin.
+	blinkenlight_outputs_delta_client_t outputs_delta_clients[MAX_BLINKENLIGHT_DELTA_CLIENTS];
+	unsigned outputs_delta_clients_next;
+#endif
+
+	// input change subscription (WAIT procedure)
+	// incremented by the server on every change of input values. 0 = unknown
+	unsigned inputs_sequence;
+	uint64_t inputs_timestamp_us; // server time of last input change
+
 	// working mode
 	// 0 = normal (RPC_PARAM_VALUE_PANEL_MODE_NORMAL)
 	// 0x01 = historic accurate lamp test (RPC_PARAM_VALUE_PANEL_MODE_LAMPTEST)
@@ -261,6 +315,7 @@ unsigned blinkenlight_panels_get_control_value_changes(blinkenlight_panel_list_t
 		blinkenlight_panel_t *p, int is_input);
 unsigned blinkenlight_panels_get_max_control_name_len(blinkenlight_panel_list_t *_this,
 		blinkenlight_panel_t *p);
+uint64_t blinkenlight_panels_get_schema_hash(blinkenlight_panel_list_t *_this);
 #ifdef BLINKENLIGHT_SERVER
 void blinkenlight_panels_config_fixup(blinkenlight_panel_list_t *_this) ;
 #endif
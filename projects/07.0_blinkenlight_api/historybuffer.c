@@ -20,6 +20,9 @@
  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+ 17-Oct-2026	agent	overflow counter for metrics
+ 17-Oct-2026	agent	incremental averaging of bits
+ 17-Oct-2026	agent	lock free: single writer, readers take snapshots
  03-FEB-2019	JH		mutex to make read and write to buffer atomic (PiDP11 server crashes)
  12-Mar-2016	JH      created
  */
@@ -36,16 +39,25 @@
 #include "historybuffer.h"
 #include "blinkenlight_panels.h"
 
-#define ISEMPTY(this)  ((this)->readidx == (this)->writeidx)
+/*
+ * Writer and readers synchronize over startseq and endseq only.
+ * Writer: fills an entry, then publishes it by incrementing endseq.
+ *   Before an old entry is overwritten, startseq is moved over it.
+ * Reader: loads endseq, copies entries, then checks startseq:
+ *   if it passed a copied entry, that one may be torn -> copy again.
+ */
+#ifdef WIN32
+// simulating server: single threaded
+#define HISTORYBUFFER_LOAD_ACQUIRE(v)	(v)
+#define HISTORYBUFFER_STORE_RELEASE(v,x)	((v) = (x))
+#define HISTORYBUFFER_FENCE()
+#else
+#define HISTORYBUFFER_LOAD_ACQUIRE(v)	__atomic_load_n(&(v), __ATOMIC_ACQUIRE)
+#define HISTORYBUFFER_STORE_RELEASE(v,x)	__atomic_store_n(&(v), (x), __ATOMIC_RELEASE)
+#define HISTORYBUFFER_FENCE()	__atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
 
-// need it here
-static uint64_t maxu64(uint64_t a, uint64_t b)
-{
-    if (a > b)
-        return a;
-    else
-        return b;
-}
+#define HISTORYBUFFER_ENTRY(this,seq)	(&(this)->buffer[(seq) & ((this)->capacity - 1)])
 
 // needed for debugging the "server11 crash"
 #define DBG_ASSERT(cond)	do{	\
@@ -102,31 +114,29 @@ static char *historybuffer_entry_as_text(historybuffer_entry_t *hbe)
  * create(), destroy()
  * buffer is for one value, bitlen is const.
  * 0: is no bit vector, see historybuffer_get_average_vals()
+ * capacity is rounded up to a power of 2.
  */
 historybuffer_t *historybuffer_create(struct blinkenlight_control_struct *c, unsigned capacity)
 {
     historybuffer_t *_this;
     _this = (historybuffer_t *) malloc(sizeof(historybuffer_t));
     _this->control = c;
-    _this->capacity = (int) capacity;
-    assert(_this->capacity > 0);
-    _this->buffer = (historybuffer_entry_t *) calloc(capacity, sizeof(historybuffer_entry_t));
-    _this->startpos = _this->endpos = 0;
-#ifdef USE_MUTEX
-    if (pthread_mutex_init(&_this->mutex, NULL) != 0)  { 
-        fprintf(stderr, "\n mutex_init() has failed\n"); 
-		exit(1) ;
-    } 		
-#endif
-	
+    assert(capacity > 0);
+    _this->capacity = 1;
+    while (_this->capacity < capacity)
+        _this->capacity <<= 1;
+    _this->buffer = (historybuffer_entry_t *) calloc(_this->capacity, sizeof(historybuffer_entry_t));
+    _this->startseq = _this->endseq = 0;
+    _this->overflows = 0;
+    _this->avg_valid = 0;
+    _this->avg_buffer = NULL;
     return _this;
 }
 
 void historybuffer_destroy(historybuffer_t *_this)
 {
-#ifdef USE_MUTEX
-    pthread_mutex_destroy(&_this->mutex) ;
-#endif
+    if (_this->avg_buffer)
+        free(_this->avg_buffer);
     free(_this->buffer);
     free(_this);
 }
@@ -134,35 +144,7 @@ void historybuffer_destroy(historybuffer_t *_this)
 // get number of items in buffer
 unsigned historybuffer_fill(historybuffer_t *_this)
 {
-    if (_this->startpos == _this->endpos)
-        return 0;
-    else if (_this->endpos > _this->startpos)
-        return _this->endpos - _this->startpos;
-    else
-        // end rolled around
-        return _this->capacity - _this->startpos + _this->endpos;
-}
-
-// internal: translate an item index into buffer position.
-// idx < fill() !
-static unsigned historybuffer_idx2pos(historybuffer_t *_this, unsigned idx)
-{
-    int pos;
-    assert(_this->startpos != _this->endpos); // not empty
-    if (_this->endpos > _this->startpos) {
-        assert(idx < _this->endpos);
-        pos = _this->startpos + idx;
-    } else { // end rolled around
-        if (idx < _this->capacity - _this->startpos)
-            // idx not rolled around
-            pos = _this->startpos + idx;
-        else {
-            // start at ring end, end and idx rolled around
-            pos = idx - (_this->capacity - _this->startpos); // index now from buffer[0]
-            assert(pos < _this->endpos); // not behind end ptr
-        }
-    }
-    return pos;
+    return _this->endseq - _this->startseq;
 }
 
 // get item over linear index. [0] = oldest, [fill()-1] = newest, NULL if not found
@@ -170,83 +152,197 @@ historybuffer_entry_t *historybuffer_get(historybuffer_t *_this, unsigned idx)
 {
     if (idx >= historybuffer_fill(_this))
         return NULL;
-    else {
-        unsigned pos = historybuffer_idx2pos(_this, idx);
-        return &(_this->buffer[pos]);
-    }
+    else
+        return HISTORYBUFFER_ENTRY(_this, _this->startseq + idx);
 }
 
 /* get oldest entry.
  */
 historybuffer_entry_t * historybuffer_peek_first(historybuffer_t *_this)
 {
-    if (_this->startpos == _this->endpos)
+    if (_this->startseq == _this->endseq)
         return NULL; // empty ;
-    return &_this->buffer[_this->startpos];
+    return HISTORYBUFFER_ENTRY(_this, _this->startseq);
 }
 
 historybuffer_entry_t * historybuffer_peek_last(historybuffer_t *_this)
 {
-    int pos;
-    if (_this->startpos == _this->endpos)
+    if (_this->startseq == _this->endseq)
         return NULL; // empty ;
-    pos = _this->endpos - 1; // point to last written
-    if (pos < 0)
-        pos = _this->capacity - 1;
-    return &_this->buffer[pos];
-}
-
-// remove oldest item from start of buffer
-historybuffer_entry_t * historybuffer_poll(historybuffer_t *_this)
-{
-    historybuffer_entry_t *entry;
-    if (_this->startpos == _this->endpos)
-        return NULL; // empty ;
-    entry = &_this->buffer[_this->startpos];
-    _this->startpos++;
-    if (_this->startpos >= _this->capacity)
-        _this->startpos = 0;
-    return entry; // valid until next push()
+    return HISTORYBUFFER_ENTRY(_this, _this->endseq - 1);
 }
 
 /* append new value at end of buffer
  * oldest entries get pushed out
- * the end timestamp of the current value (last set) is udpated ti now
+ * the end timestamp of the current value (last set) is the begin of the new one.
  * See Java code at blinkenbone.panelsim.ControlSliceVisualization.setStateAveraging()
  */
 void historybuffer_set_val(historybuffer_t *_this, uint64_t now_us, uint64_t value)
 {
     historybuffer_entry_t *hbe;
-#ifdef USE_MUTEX
-	pthread_mutex_lock(&_this->mutex) ; // inhinit concurrent reads
-#endif
-
-    if (historybuffer_fill(_this) + 1 >= _this->capacity)
-        // overflow: remove oldest
-        historybuffer_poll(_this);
+    unsigned endseq = _this->endseq; // only we change it
 
     hbe = historybuffer_peek_last(_this);
-    if (hbe == NULL || hbe->value != value) {
-        // add new entry only if state changed!
-        if (hbe != NULL)
-            // terminate current state, if queue not empty
-            hbe->timestamp_end_us = now_us;
-        // append new state
-        hbe = &_this->buffer[_this->endpos];
-        // advance to next free buffer entry
-        _this->endpos++;
-        if (_this->endpos >= _this->capacity) {
-            _this->endpos = 0;
+    if (hbe != NULL && hbe->value == value)
+        return; // add new entry only if state changed!
+
+    if (endseq - _this->startseq >= _this->capacity) {
+        // overflow: remove oldest. Readers must see this before the entry is overwritten.
+        HISTORYBUFFER_STORE_RELEASE(_this->startseq, _this->startseq + 1);
+        HISTORYBUFFER_FENCE();
+        _this->overflows++;
+    }
+    // fill data
+    hbe = HISTORYBUFFER_ENTRY(_this, endseq);
+    hbe->timestamp_begin_us = now_us;
+    hbe->timestamp_end_us = 0; // currently valid.
+    hbe->value = value;
+    // publish
+    HISTORYBUFFER_STORE_RELEASE(_this->endseq, endseq + 1);
+}
+
+/*
+ * Copy all entries valid between since_us and now_us into "entries[]", oldest first.
+ * Result: count of entries.
+ * Timestamps are clipped to [since_us, now_us], end timestamps are filled in.
+ * If more than entries_size entries are in the interval, only the newest are returned.
+ * Runs concurrently with historybuffer_set_val() and never blocks it.
+ */
+unsigned historybuffer_snapshot(historybuffer_t *_this, uint64_t since_us, uint64_t now_us,
+        historybuffer_entry_t *entries, unsigned entries_size)
+{
+    unsigned startseq, endseq, seq;
+    unsigned n, i;
+    historybuffer_entry_t tmp;
+    uint64_t end_us;
+
+    do {
+        // copy from newest backwards, until an entry starts before since_us
+        endseq = HISTORYBUFFER_LOAD_ACQUIRE(_this->endseq);
+        startseq = HISTORYBUFFER_LOAD_ACQUIRE(_this->startseq);
+        for (seq = endseq, n = 0; seq != startseq && n < entries_size;) {
+            seq--;
+            entries[n] = *HISTORYBUFFER_ENTRY(_this, seq);
+            n++;
+            if (entries[n - 1].timestamp_begin_us <= since_us)
+                break;
         }
-        // fill data
-        hbe->timestamp_begin_us = now_us;
-        hbe->timestamp_end_us = 0; // currently valid.
-        hbe->value = value;
+        HISTORYBUFFER_FENCE();
+        // writer overwrote entries "seq" and later while we copied?
+        startseq = HISTORYBUFFER_LOAD_ACQUIRE(_this->startseq);
+    } while ((int) (seq - startseq) < 0);
+
+    // oldest first, each entry ends where its successor begins
+    for (i = 0; i < n / 2; i++) {
+        tmp = entries[i];
+        entries[i] = entries[n - 1 - i];
+        entries[n - 1 - i] = tmp;
+    }
+    for (i = 0; i < n; i++) {
+        end_us = (i + 1 < n) ? entries[i + 1].timestamp_begin_us : now_us;
+        if (end_us > now_us)
+            end_us = now_us; // set_val() after caller sampled now_us
+        if (entries[i].timestamp_begin_us < since_us)
+            entries[i].timestamp_begin_us = since_us;
+        if (entries[i].timestamp_begin_us > end_us)
+            entries[i].timestamp_begin_us = end_us;
+        entries[i].timestamp_end_us = end_us;
     }
-	
-#ifdef USE_MUTEX
-	pthread_mutex_unlock(&_this->mutex) ; // allow read
-#endif	
+    return n;
+}
+
+/*
+ * Incremental bit averaging.
+ * For a sliding window the ON time of each bit is kept as a running sum:
+ * entries are added when they get a successor (then their duration is known)
+ * and subtracted when they drop out of the window.
+ * So each entry is processed twice in its life, and only its set bits.
+ * A call costs O(value_bitlen), instead of O(entries * value_bitlen).
+ *
+ * Accounted entries are copied to "avg_buffer", so the writer may overwrite
+ * them before they expire. At most "capacity" entries are held, like "buffer".
+ * Like the original mutex version, entries before the window are discarded
+ * for good, so the window must not grow between calls (it is 1/fmax anyway).
+ */
+
+// copy entry from ring. 0: writer has overwritten it meanwhile
+static int historybuffer_read_entry(historybuffer_t *_this, unsigned seq,
+        historybuffer_entry_t *entry)
+{
+    *entry = *HISTORYBUFFER_ENTRY(_this, seq);
+    HISTORYBUFFER_FENCE();
+    return (int) (seq - HISTORYBUFFER_LOAD_ACQUIRE(_this->startseq)) >= 0;
+}
+
+#define HISTORYBUFFER_AVG_ENTRY(this,seq)	(&(this)->avg_buffer[(seq) & ((this)->capacity - 1)])
+
+// add or subtract the ON time of an entry to/from the running sums.
+// only set bits are visited.
+static void historybuffer_avg_account(historybuffer_t *_this, uint64_t value,
+        uint64_t duration_us)
+{
+    unsigned bitlen = _this->control->value_bitlen;
+    if (bitlen < 64)
+        value &= ((uint64_t) 1 << bitlen) - 1;
+    while (value) {
+        unsigned bitidx = __builtin_ctzll(value);
+        _this->avg_on_us[bitidx] += duration_us; // modulo 2^64: "negative" durations subtract
+        value &= value - 1;
+    }
+}
+
+// remove oldest accounted entry
+static void historybuffer_avg_expire(historybuffer_t *_this)
+{
+    historybuffer_entry_t *first = HISTORYBUFFER_AVG_ENTRY(_this, _this->avg_firstseq);
+    historybuffer_entry_t *next = HISTORYBUFFER_AVG_ENTRY(_this, _this->avg_firstseq + 1);
+    historybuffer_avg_account(_this, first->value,
+            first->timestamp_begin_us - next->timestamp_begin_us);
+    _this->avg_firstseq++;
+}
+
+/*
+ * bring running sums up to date for interval [interval_start_us, now_us]
+ * result 0: writer has overwritten entries not yet accounted, or buffer empty.
+ */
+static int historybuffer_avg_update(historybuffer_t *_this, uint64_t interval_start_us,
+        uint64_t now_us)
+{
+    historybuffer_entry_t next;
+    unsigned endseq;
+
+    if (!_this->avg_valid) {
+        // start from oldest entry
+        unsigned startseq = HISTORYBUFFER_LOAD_ACQUIRE(_this->startseq);
+        if (startseq == HISTORYBUFFER_LOAD_ACQUIRE(_this->endseq))
+            return 0;
+        if (!historybuffer_read_entry(_this, startseq, HISTORYBUFFER_AVG_ENTRY(_this, startseq)))
+            return 0;
+        _this->avg_firstseq = _this->avg_openseq = startseq;
+        memset(_this->avg_on_us, 0, sizeof(_this->avg_on_us));
+        _this->avg_valid = 1;
+    }
+    // 1. account entries, which got a successor. Ignore those newer than now_us.
+    endseq = HISTORYBUFFER_LOAD_ACQUIRE(_this->endseq);
+    while (_this->avg_openseq + 1 != endseq) {
+        historybuffer_entry_t *open = HISTORYBUFFER_AVG_ENTRY(_this, _this->avg_openseq);
+        if (!historybuffer_read_entry(_this, _this->avg_openseq + 1, &next))
+            return 0;
+        if (next.timestamp_begin_us > now_us)
+            break;
+        historybuffer_avg_account(_this, open->value,
+                next.timestamp_begin_us - open->timestamp_begin_us);
+        if (_this->avg_openseq + 1 - _this->avg_firstseq >= _this->capacity)
+            historybuffer_avg_expire(_this); // overflow: remove oldest
+        _this->avg_openseq++;
+        *HISTORYBUFFER_AVG_ENTRY(_this, _this->avg_openseq) = next;
+    }
+    // 2. remove entries, which ended before the interval
+    while (_this->avg_firstseq != _this->avg_openseq
+            && HISTORYBUFFER_AVG_ENTRY(_this, _this->avg_firstseq + 1)->timestamp_begin_us
+                    <= interval_start_us)
+        historybuffer_avg_expire(_this);
+    return 1;
 }
 
 /*
@@ -271,12 +367,15 @@ void historybuffer_set_val(historybuffer_t *_this, uint64_t now_us, uint64_t val
  *
  * if averaging_interval_us == 0: return current value
  *
+ * Bit mode is calculated incrementally, value mode on a snapshot of the history.
+ * The writer is never blocked.
+ *
  * See Java code at blinkenbone.panelsim.ControlSliceVisualization.getState()
  */
 void historybuffer_get_average_vals(historybuffer_t *_this, uint64_t averaging_interval_us,
         uint64_t now_us, int bitmode)
 {
-    int last_idx; // index of newest entry in history
+    historybuffer_entry_t entries[MAX_BLINKENLIGHT_HISTORY_ENTRIES];
     unsigned fill;
     unsigned idx;
     historybuffer_entry_t *hbe;
@@ -289,47 +388,69 @@ void historybuffer_get_average_vals(historybuffer_t *_this, uint64_t averaging_i
     memset(_this->control->averaged_value_bits, 0, sizeof(_this->control->averaged_value_bits));
     _this->control->averaged_value = 0;
 
-    last_idx = historybuffer_fill(_this) - 1;
-    if (last_idx < 0)
-        return; // buffer empty, return all 0's
-#ifdef USE_MUTEX
-	pthread_mutex_lock(&_this->mutex) ; // inhibit concurrent writes
-#endif
-    hbe = historybuffer_get(_this, last_idx);
-    assert(hbe != NULL);
-
     if (averaging_interval_us == 0) {
         // just return the current value
+        if (historybuffer_snapshot(_this, now_us, now_us, entries, 1) == 0)
+            return; // buffer empty, return all 0's
+        hbe = &entries[0];
         _this->control->averaged_value = hbe->value;
         if (bitmode)
             for (bitidx = 0; bitidx < _this->control->value_bitlen; bitidx++)
                 if ((hbe->value >> bitidx) & 1)
                     _this->control->averaged_value_bits[bitidx] = 1;
-#ifdef USE_MUTEX
-		pthread_mutex_unlock(&_this->mutex) ; // allow write
-#endif
         return;
     }
 
-    // terminate current state (which has no end time yet)
-    hbe->timestamp_end_us = now_us;
-
-    // discard old history entries,
     interval_start_us = now_us - averaging_interval_us;
-    while ((hbe = historybuffer_peek_first(_this)) && hbe->timestamp_end_us <= interval_start_us)
-        historybuffer_poll(_this);
-    // update start time of first entry to start of averaging intervall (truncate partly)
-    // not necessary, see use of "max()" below. But better for debugging output.
-    if (hbe)
-        hbe->timestamp_begin_us = interval_start_us;
+    if (bitmode && _this->control->value_bitlen > 0) {
+        // ON time per bit = closed entries + open newest entry - part of oldest before interval.
+        // if history is shorter than the interval, oldest value counts from interval start:
+        // then (interval_start_us - begin) is "negative", modulo 2^64.
+        historybuffer_entry_t *first, *open;
+        uint64_t open_us, first_us;
+        if (_this->avg_buffer == NULL)
+            _this->avg_buffer = (historybuffer_entry_t *) calloc(_this->capacity,
+                    sizeof(historybuffer_entry_t));
+        while (!historybuffer_avg_update(_this, interval_start_us, now_us)) {
+            // writer overran us: start again with what's left in buffer
+            _this->avg_valid = 0;
+            if (HISTORYBUFFER_LOAD_ACQUIRE(_this->startseq)
+                    == HISTORYBUFFER_LOAD_ACQUIRE(_this->endseq))
+                return; // buffer empty, return all 0's
+        }
+        first = HISTORYBUFFER_AVG_ENTRY(_this, _this->avg_firstseq);
+        open = HISTORYBUFFER_AVG_ENTRY(_this, _this->avg_openseq);
+        open_us = now_us - open->timestamp_begin_us;
+        if (open->timestamp_begin_us > now_us)
+            open_us = 0;
+        first_us = interval_start_us - first->timestamp_begin_us;
+        for (bitidx = 0; bitidx < _this->control->value_bitlen; bitidx++) {
+            uint64_t on_us = _this->avg_on_us[bitidx];
+            if ((open->value >> bitidx) & 1)
+                on_us += open_us;
+            if ((first->value >> bitidx) & 1)
+                on_us -= first_us;
+            // falls in range 0..255
+            _this->control->averaged_value_bits[bitidx] = (255 * on_us) / averaging_interval_us;
+        }
+        return;
+    }
+
+    // value mode: entries of the averaging interval, truncated to it
+    fill = historybuffer_snapshot(_this, interval_start_us, now_us, entries,
+            MAX_BLINKENLIGHT_HISTORY_ENTRIES);
+    if (fill == 0)
+        return; // buffer empty, return all 0's
+    // history shorter than interval: oldest value counts for the whole begin
+    entries[0].timestamp_begin_us = interval_start_us;
 
     memset(sum_state_durations, 0, sizeof(sum_state_durations));
     sum_durations_us = 0;
-    fill = historybuffer_fill(_this);
     // iterate through all entries in time interval
-    for (idx = 0; (hbe = historybuffer_get(_this, idx)) != NULL; idx++) {
-        uint64_t state_starttime_us = maxu64(interval_start_us, hbe->timestamp_begin_us);
-        uint64_t state_duration_us = hbe->timestamp_end_us - state_starttime_us;
+    for (idx = 0; idx < fill; idx++) {
+        uint64_t state_duration_us;
+        hbe = &entries[idx];
+        state_duration_us = hbe->timestamp_end_us - hbe->timestamp_begin_us;
         if (!bitmode) {
             // average whole value. Overflow calculation of 64 bit arithmetic:
             // assume 256 buffer entries and a final scale of 255, so 8+8 extra bits are needed.
@@ -348,7 +469,8 @@ void historybuffer_get_average_vals(historybuffer_t *_this, uint64_t averaging_i
     // !! sumDurations_us == (now_us - intervalStart_us !!
     if (_this->control->value_bitlen == 0) {
         // average whole value
-        _this->control->averaged_value = (255 * sum_state_durations[0]) / sum_durations_us;
+        if (sum_durations_us > 0)
+            _this->control->averaged_value = (255 * sum_state_durations[0]) / sum_durations_us;
     } else
         // average every single bit
         for (bitidx = 0; bitidx < _this->control->value_bitlen; bitidx++) {
@@ -359,9 +481,6 @@ void historybuffer_get_average_vals(historybuffer_t *_this, uint64_t averaging_i
             else
                 _this->control->averaged_value_bits[bitidx] = 0;
         }
-#ifdef USE_MUTEX		
-	pthread_mutex_unlock(&_this->mutex) ; // allow write
-#endif
 }
 
 /*
@@ -377,10 +496,8 @@ void historybuffer_diagdump(historybuffer_t *_this, FILE *stream, int test_avera
 
     fprintf(stream, "Dump of historybuffer @ %p\n", _this);
     fill = historybuffer_fill(_this);
-    fprintf(stream, "  capacity=%u, startpos=%u, endpos=%u, fill=%u\n", _this->capacity,
-            _this->startpos, _this->endpos, fill);
-    fprintf(stream, "  first: capacity=%u, startpos=%u, endpos=%u, fill=%u\n", _this->capacity,
-            _this->startpos, _this->endpos, fill);
+    fprintf(stream, "  capacity=%u, startseq=%u, endseq=%u, fill=%u\n", _this->capacity,
+            _this->startseq, _this->endseq, fill);
 
     hbe = historybuffer_peek_first(_this);
     if (hbe == NULL)
@@ -395,9 +512,9 @@ void historybuffer_diagdump(historybuffer_t *_this, FILE *stream, int test_avera
         fprintf(stream, "last entry: %s\n", historybuffer_entry_as_text(hbe));
 
     for (idx = 0; idx < fill; idx++) {
-        unsigned pos = historybuffer_idx2pos(_this, idx);
-        hbe = &(_this->buffer[pos]);
-        fprintf(stream, "entry[%u]: pos=%u, %s\n", idx, pos, historybuffer_entry_as_text(hbe));
+        unsigned seq = _this->startseq + idx;
+        hbe = HISTORYBUFFER_ENTRY(_this, seq);
+        fprintf(stream, "entry[%u]: seq=%u, %s\n", idx, seq, historybuffer_entry_as_text(hbe));
     }
 
     if (test_average && fill > (_this->capacity * 2 / 3)) {
@@ -411,7 +528,8 @@ void historybuffer_diagdump(historybuffer_t *_this, FILE *stream, int test_avera
         if (hbe == NULL)
             return;
         // interval start in the middle of a value sample
-        intervall_start_us = (hbe->timestamp_end_us + hbe->timestamp_begin_us) / 2;
+        intervall_start_us = (historybuffer_get(_this, idx + 1)->timestamp_begin_us
+                + hbe->timestamp_begin_us) / 2;
         averaging_interval_us = now_us - intervall_start_us;
         historybuffer_get_average_vals(_this, averaging_interval_us, now_us, /*bitmode*/1);
         fprintf(stream,
@@ -21,6 +21,9 @@
  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 
+ 17-Oct-2026	agent	overflow counter for metrics
+ 17-Oct-2026	agent	incremental averaging of bits
+ 17-Oct-2026	agent	lock free: single writer, readers take snapshots
  03-FEB-2019	JH		mutex to make read and write to buffer atomic (PiDP11 server crashes)
  12-Mar-2016	JH      created
  */
@@ -30,34 +33,48 @@
 
 #include <stdint.h>
 #include <stdio.h>
-#ifndef WIN32
-// under Windows only simulating server and pthread not available
-#define USE_MUTEX
-#include <pthread.h>
-#endif
 
 /* single entry in history buffer */
 typedef struct
 {
 	uint64_t value;
 	uint64_t timestamp_begin_us; // value is valid after this time
-	uint64_t timestamp_end_us; // value is valid before this time, 0 = current valid
+	uint64_t timestamp_end_us; // value is valid before this time. set in snapshots, 0 in buffer
 } historybuffer_entry_t;
 
+/*
+ * Ring buffer with one writer thread (historybuffer_set_val())
+ * and any number of reader threads (historybuffer_snapshot()).
+ * No locks: readers do not modify the buffer, they copy entries and
+ * retry if the writer overwrote them meanwhile.
+ * historybuffer_get_average_vals() is no such reader: it updates the avg_*
+ * state below and the control's averaged values, so calls for one buffer
+ * must not overlap (they may run concurrent to the writer).
+ * The server averages inputs under the panel's inputs mutex, outputs
+ * in the multiplexing thread.
+ * Stored entries are not changed after they are appended:
+ * the end of an entry is the begin of its successor.
+ */
 typedef struct
 {
 	struct blinkenlight_control_struct *control; // backlink to possessing control
-	// data types internal "int" becaus of arithemtic
-	int capacity;
-
-	int startpos; // first valid item in ring
-	int endpos; // next free item to write
-	// empty: readidx == writeidx
+	unsigned capacity; // power of 2
+	// free running sequence numbers, entry "seq" is at buffer[seq & (capacity-1)].
+	// only changed by writer.
+	volatile unsigned startseq; // oldest valid entry
+	volatile unsigned endseq; // next entry to write
+	// empty: startseq == endseq
 	historybuffer_entry_t *buffer;
-#ifdef USE_MUTEX
-	pthread_mutex_t mutex; // exclusive access to either read or write functions
-#endif	
-
+	volatile unsigned overflows; // oldest entries dropped because buffer was full
+
+	// state of incremental bit averaging, changed by historybuffer_get_average_vals().
+	int avg_valid;
+	unsigned avg_firstseq; // oldest entry in averaging interval
+	unsigned avg_openseq; // newest accounted entry, its end is still open
+	// copies of entries avg_firstseq..avg_openseq, writer may overwrite "buffer".
+	// same capacity and indexing as "buffer", allocated on first use.
+	historybuffer_entry_t *avg_buffer;
+	uint64_t avg_on_us[64]; // ON time per bit of entries avg_firstseq..avg_openseq-1
 } historybuffer_t;
 
 uint64_t historybuffer_now_us(void);
@@ -65,17 +82,20 @@ uint64_t historybuffer_now_us(void);
 historybuffer_t *historybuffer_create(struct blinkenlight_control_struct *c, unsigned capacity);
 void historybuffer_destroy(historybuffer_t *_this);
 
-// append new value at end of buffer
+// append new value at end of buffer. Only one writer thread!
 void historybuffer_set_val(historybuffer_t *_this, uint64_t now_us, uint64_t value);
 
+// copy entries valid between since_us and now_us into "entries", oldest first.
+// timestamps are clipped to the interval. Never blocks the writer.
+unsigned historybuffer_snapshot(historybuffer_t *_this, uint64_t since_us, uint64_t now_us,
+		historybuffer_entry_t *entries, unsigned entries_size);
+
+// access to stored entries: only for writer thread or diagnostics
 // get oldest entry
 historybuffer_entry_t * historybuffer_peek_first(historybuffer_t *_this);
 // get newest entry
 historybuffer_entry_t * historybuffer_peek_last(historybuffer_t *_this);
 
-// remove oldest item from start of buffer
-historybuffer_entry_t * historybuffer_poll(historybuffer_t *_this);
-
 // get number # of items in buffer
 unsigned historybuffer_fill(historybuffer_t *_this);
 
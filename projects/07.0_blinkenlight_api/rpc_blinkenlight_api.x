@@ -21,6 +21,13 @@
    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 
+   17-Oct-2026  agent   RPC_PARAM_CLASS_BUS: server runtime metrics
+   17-Oct-2026  agent   added GETSCHEMA: all panels and controls in one call
+   17-Oct-2026  agent   TEST_DATA_FROM_SERVER returns server CPU time
+   17-Oct-2026  agent   added WAIT_PANEL_INPUTCONTROLS: server push of input changes
+   17-Oct-2026  agent   EXCHANGE_PANELS_CONTROLVALUES: client_id, delta sequence per client
+   17-Oct-2026  agent   EXCHANGE_PANELS_CONTROLVALUES: delta encoded outputs with sequence no
+   17-Oct-2026  agent   added EXCHANGE_PANELS_CONTROLVALUES: multi panel GET/SET in one call
    20-Feb-2016  JH      added PANEL_MODE_POWERLESS
    12-Feb-2012  JH      created
 */
@@ -77,6 +84,53 @@ struct rpc_blinkenlight_api_controlvalues_struct {
 } ;
 
 
+/* control values of one panel in a multi panel transfer
+ * Outputs are either transmitted complete (changed_bitmap<> empty)
+ * or delta encoded: bit n of changed_bitmap<> set = n'th output control
+ * has changed, value_bytes<> holds only the values of changed controls.
+ * Each output transmission increments sequence, a delta is only accepted
+ * by the server if it follows the last transmission received from the
+ * same client (client_id of the panels_controlvalues_struct).
+ */
+struct rpc_blinkenlight_api_panel_controlvalues_struct {
+	unsigned	i_panel ; /* hPanel */
+	unsigned	sequence ; /* of output transmission */
+	unsigned char	changed_bitmap<> ; /* delta: bit per output control */
+	unsigned char	value_bytes<> ; /* as in rpc_blinkenlight_api_controlvalues_struct */
+} ;
+
+/* arguments for WAIT_PANEL_INPUTCONTROLS */
+struct rpc_blinkenlight_api_wait_inputs_struct {
+	unsigned	i_panel ; /* hPanel */
+	unsigned	sequence ; /* of input values the client has. 0 = none */
+	unsigned	timeout_ms ; /* max time to wait for a change */
+} ;
+
+/* input values changed since the client's sequence
+ * changed_bitmap<> empty: value_bytes<> has all input values,
+ * else bit n set = n'th input control is in value_bytes<>
+ */
+struct rpc_blinkenlight_api_inputs_changes_struct {
+	int	error_code ;
+	unsigned	sequence ; /* of input values in this result */
+	unsigned hyper	timestamp_us ; /* server time of last input change */
+	unsigned char	changed_bitmap<> ;
+	unsigned char	value_bytes<> ;
+} ;
+
+/* error codes of multi panel transfers */
+const RPC_BLINKENLIGHT_API_ERR_ILL_PANEL = 1 ; /* invalid hPanel */
+const RPC_BLINKENLIGHT_API_ERR_ILL_VALUES = 2 ; /* value_bytes<> count mismatch */
+const RPC_BLINKENLIGHT_API_ERR_RESYNC = 3 ; /* delta sequence gap: send complete outputs */
+
+/* control values of several panels */
+struct rpc_blinkenlight_api_panels_controlvalues_struct {
+	int	error_code ; /* if used as result*/
+	unsigned	client_id ; /* sender of the outputs, != 0 for deltas */
+	rpc_blinkenlight_api_panel_controlvalues_struct panels<> ; /* dyn len */
+} ;
+
+
 /************** end duplicate definitions *************/
 
 /*
@@ -104,6 +158,32 @@ struct rpc_blinkenlight_api_getcontrolinfo_res {
 } ;
 
 
+/*
+ * GETSCHEMA: all panel and control descriptors in one call.
+ * "hash" identifies the schema content, clients cache it.
+ * If the client already knows the schema (known_hash == hash),
+ * panels<> is empty. If the result would be larger than max_bytecount
+ * (datagram size of UDP transport, 0 = no limit), error_code is
+ * RPC_BLINKENLIGHT_API_ERR_TOO_BIG and panels<> is empty.
+ */
+const RPC_BLINKENLIGHT_API_ERR_TOO_BIG = 4 ; /* result does not fit max_bytecount */
+
+struct rpc_blinkenlight_api_getschema_cmd {
+	unsigned hyper	known_hash ; /* schema the client has cached. 0 = none */
+	unsigned	max_bytecount ; /* max size of XDR encoded result, 0 = any */
+} ;
+
+struct rpc_blinkenlight_api_schema_panel_struct {
+	rpc_blinkenlight_api_panel_struct panel ;
+	rpc_blinkenlight_api_control_struct controls<> ;
+} ;
+
+struct rpc_blinkenlight_api_getschema_res {
+	int error_code ; /* 0 = OK */
+	unsigned hyper	hash ;
+	rpc_blinkenlight_api_schema_panel_struct panels<> ; /* empty, if known_hash == hash */
+} ;
+
 /*
  * The result of a SETPANEL_CONTROLVALUES operation.
  */
@@ -130,6 +210,22 @@ const RPC_PARAM_VALUE_PANEL_MODE_NORMAL	= 0 ; /* panel in normal operating mode
 const RPC_PARAM_VALUE_PANEL_MODE_LAMPTEST = 1 ; /* historic accurate, test lamps */
 const RPC_PARAM_VALUE_PANEL_MODE_ALLTEST = 2 ; /* test every control, inputs and outputs */
 const RPC_PARAM_VALUE_PANEL_MODE_POWERLESS = 3 ; /* all lamps off, power button released, pnael over PAI repsonsive */
+/* class BUS: runtime metrics of the server, read only.
+ * Counters are free running 32 bit and wrap, clients use differences.
+ * Not every server knows every metric: RPC_ERR_PARAM_ILL_PARAM */
+const RPC_PARAM_HANDLE_BUS_RPC_CALLS = 1 ; /* object = procedure number: calls served */
+const RPC_PARAM_HANDLE_BUS_RPC_TIME_US = 2 ; /* object = procedure number: sum of decode+execute+reply time */
+const RPC_PARAM_HANDLE_BUS_RPC_TIME_MAX_US = 3 ; /* object = procedure number: longest call */
+const RPC_PARAM_HANDLE_BUS_MUX_PHASES = 4 ; /* object = 0: multiplexing phases run */
+const RPC_PARAM_HANDLE_BUS_MUX_OVERRUNS = 5 ; /* object = 0: phases missed completely */
+const RPC_PARAM_HANDLE_BUS_MUX_JITTER_MAX_US = 6 ; /* object = 0: latest phase start */
+const RPC_PARAM_HANDLE_BUS_MUX_JITTER_HISTOGRAM = 7 ; /* object = bucket i: phase starts late < 2^i us */
+const RPC_PARAM_HANDLE_BUS_MUX_CYCLE_MIN_US = 8 ; /* object = 0: shortest bus I/O of a phase */
+const RPC_PARAM_HANDLE_BUS_MUX_CYCLE_MAX_US = 9 ; /* object = 0: longest bus I/O of a phase */
+const RPC_PARAM_HANDLE_BUS_HISTORY_FILL = 10 ; /* object = panel: max entries in a control's value history */
+const RPC_PARAM_HANDLE_BUS_HISTORY_OVERFLOWS = 11 ; /* object = panel: oldest entries dropped from full value histories */
+const RPC_PARAM_HANDLE_BUS_UPDATE_CPU_MS = 12 ; /* object = 0: CPU time of the output update thread */
+const RPC_PARAM_HANDLE_BUS_MAX = 12 ;
 
 /* cmd to server: get a parameter value */
 struct rpc_param_cmd_get_struct {
@@ -165,7 +261,9 @@ struct rpc_test_cmdstatus_struct {
 	int	bytecount ;
 } ;
 
-/* data to send/receive from server */
+/* data to send/receive from server.
+ * From server: vardata<> is a test pattern (byte i = i & 0xff),
+ * fixdata1/fixdata2 = server process CPU time in seconds/microseconds */
 struct rpc_test_data_struct {
 	int	fixdata1 ;
 	int	fixdata2 ;
@@ -185,6 +283,16 @@ program BLINKENLIGHTD {
     rpc_blinkenlight_api_getcontrolinfo_res RPC_BLINKENLIGHT_API_GETCONTROLINFO(unsigned /*hPanel*/, unsigned /*hControl*/) = 3;
     rpc_blinkenlight_api_setpanel_controlvalues_res RPC_BLINKENLIGHT_API_SETPANEL_CONTROLVALUES(unsigned /*hPanel*/, rpc_blinkenlight_api_controlvalues_struct valuelist) = 4;
     rpc_blinkenlight_api_controlvalues_struct RPC_BLINKENLIGHT_API_GETPANEL_CONTROLVALUES(unsigned /*hPanel*/) = 5;
+    /* SET output values and GET input values of several panels in one round trip.
+     * Outputs of a panel are only set, if its value_bytes<> is not empty.
+     * Result has the input values of all panels in the same order */
+    rpc_blinkenlight_api_panels_controlvalues_struct RPC_BLINKENLIGHT_API_EXCHANGE_PANELS_CONTROLVALUES(rpc_blinkenlight_api_panels_controlvalues_struct outputs) = 6;
+    /* Wait until input values differ from the client's sequence, then return the changes.
+     * Over TCP, the server answers only on change or after timeout_ms (long poll),
+     * over UDP it answers at once. */
+    rpc_blinkenlight_api_inputs_changes_struct RPC_BLINKENLIGHT_API_WAIT_PANEL_INPUTCONTROLS(rpc_blinkenlight_api_wait_inputs_struct wait) = 7;
+    /* all panels and controls in one call, with a hash for client side caching */
+    rpc_blinkenlight_api_getschema_res RPC_BLINKENLIGHT_API_GETSCHEMA(rpc_blinkenlight_api_getschema_cmd cmd) = 8;
     /* generic parameter get/set */
     rpc_param_result_struct RPC_PARAM_GET(rpc_param_cmd_get_struct cmd_get) = 100;
     rpc_param_result_struct RPC_PARAM_SET(rpc_param_cmd_set_struct cmd_set) = 101;
@@ -56,6 +56,55 @@ struct rpc_blinkenlight_api_controlvalues_struct {
 };
 typedef struct rpc_blinkenlight_api_controlvalues_struct rpc_blinkenlight_api_controlvalues_struct;
 
+struct rpc_blinkenlight_api_panel_controlvalues_struct {
+	u_int i_panel;
+	u_int sequence;
+	struct {
+		u_int changed_bitmap_len;
+		u_char *changed_bitmap_val;
+	} changed_bitmap;
+	struct {
+		u_int value_bytes_len;
+		u_char *value_bytes_val;
+	} value_bytes;
+};
+typedef struct rpc_blinkenlight_api_panel_controlvalues_struct rpc_blinkenlight_api_panel_controlvalues_struct;
+
+struct rpc_blinkenlight_api_wait_inputs_struct {
+	u_int i_panel;
+	u_int sequence;
+	u_int timeout_ms;
+};
+typedef struct rpc_blinkenlight_api_wait_inputs_struct rpc_blinkenlight_api_wait_inputs_struct;
+
+struct rpc_blinkenlight_api_inputs_changes_struct {
+	int error_code;
+	u_int sequence;
+	u_quad_t timestamp_us;
+	struct {
+		u_int changed_bitmap_len;
+		u_char *changed_bitmap_val;
+	} changed_bitmap;
+	struct {
+		u_int value_bytes_len;
+		u_char *value_bytes_val;
+	} value_bytes;
+};
+typedef struct rpc_blinkenlight_api_inputs_changes_struct rpc_blinkenlight_api_inputs_changes_struct;
+#define RPC_BLINKENLIGHT_API_ERR_ILL_PANEL 1
+#define RPC_BLINKENLIGHT_API_ERR_ILL_VALUES 2
+#define RPC_BLINKENLIGHT_API_ERR_RESYNC 3
+
+struct rpc_blinkenlight_api_panels_controlvalues_struct {
+	int error_code;
+	u_int client_id;
+	struct {
+		u_int panels_len;
+		rpc_blinkenlight_api_panel_controlvalues_struct *panels_val;
+	} panels;
+};
+typedef struct rpc_blinkenlight_api_panels_controlvalues_struct rpc_blinkenlight_api_panels_controlvalues_struct;
+
 struct rpc_blinkenlight_api_getinfo_res {
 	int error_code;
 	rpc_blinkenlight_api_infostringtype info;
@@ -73,6 +122,32 @@ struct rpc_blinkenlight_api_getcontrolinfo_res {
 	rpc_blinkenlight_api_control_struct control;
 };
 typedef struct rpc_blinkenlight_api_getcontrolinfo_res rpc_blinkenlight_api_getcontrolinfo_res;
+#define RPC_BLINKENLIGHT_API_ERR_TOO_BIG 4
+
+struct rpc_blinkenlight_api_getschema_cmd {
+	u_quad_t known_hash;
+	u_int max_bytecount;
+};
+typedef struct rpc_blinkenlight_api_getschema_cmd rpc_blinkenlight_api_getschema_cmd;
+
+struct rpc_blinkenlight_api_schema_panel_struct {
+	rpc_blinkenlight_api_panel_struct panel;
+	struct {
+		u_int controls_len;
+		rpc_blinkenlight_api_control_struct *controls_val;
+	} controls;
+};
+typedef struct rpc_blinkenlight_api_schema_panel_struct rpc_blinkenlight_api_schema_panel_struct;
+
+struct rpc_blinkenlight_api_getschema_res {
+	int error_code;
+	u_quad_t hash;
+	struct {
+		u_int panels_len;
+		rpc_blinkenlight_api_schema_panel_struct *panels_val;
+	} panels;
+};
+typedef struct rpc_blinkenlight_api_getschema_res rpc_blinkenlight_api_getschema_res;
 
 struct rpc_blinkenlight_api_setpanel_controlvalues_res {
 	int error_code;
@@ -94,6 +169,19 @@ typedef struct rpc_blinkenlight_api_setpanel_controlvalues_res rpc_blinkenlight_
 #define RPC_PARAM_VALUE_PANEL_MODE_LAMPTEST 1
 #define RPC_PARAM_VALUE_PANEL_MODE_ALLTEST 2
 #define RPC_PARAM_VALUE_PANEL_MODE_POWERLESS 3
+#define RPC_PARAM_HANDLE_BUS_RPC_CALLS 1
+#define RPC_PARAM_HANDLE_BUS_RPC_TIME_US 2
+#define RPC_PARAM_HANDLE_BUS_RPC_TIME_MAX_US 3
+#define RPC_PARAM_HANDLE_BUS_MUX_PHASES 4
+#define RPC_PARAM_HANDLE_BUS_MUX_OVERRUNS 5
+#define RPC_PARAM_HANDLE_BUS_MUX_JITTER_MAX_US 6
+#define RPC_PARAM_HANDLE_BUS_MUX_JITTER_HISTOGRAM 7
+#define RPC_PARAM_HANDLE_BUS_MUX_CYCLE_MIN_US 8
+#define RPC_PARAM_HANDLE_BUS_MUX_CYCLE_MAX_US 9
+#define RPC_PARAM_HANDLE_BUS_HISTORY_FILL 10
+#define RPC_PARAM_HANDLE_BUS_HISTORY_OVERFLOWS 11
+#define RPC_PARAM_HANDLE_BUS_UPDATE_CPU_MS 12
+#define RPC_PARAM_HANDLE_BUS_MAX 12
 
 struct rpc_param_cmd_get_struct {
 	u_int object_class;
@@ -165,6 +253,15 @@ extern  rpc_blinkenlight_api_setpanel_controlvalues_res * rpc_blinkenlight_api_s
 #define RPC_BLINKENLIGHT_API_GETPANEL_CONTROLVALUES 5
 extern  rpc_blinkenlight_api_controlvalues_struct * rpc_blinkenlight_api_getpanel_controlvalues_1(u_int , CLIENT *);
 extern  rpc_blinkenlight_api_controlvalues_struct * rpc_blinkenlight_api_getpanel_controlvalues_1_svc(u_int , struct svc_req *);
+#define RPC_BLINKENLIGHT_API_EXCHANGE_PANELS_CONTROLVALUES 6
+extern  rpc_blinkenlight_api_panels_controlvalues_struct * rpc_blinkenlight_api_exchange_panels_controlvalues_1(rpc_blinkenlight_api_panels_controlvalues_struct , CLIENT *);
+extern  rpc_blinkenlight_api_panels_controlvalues_struct * rpc_blinkenlight_api_exchange_panels_controlvalues_1_svc(rpc_blinkenlight_api_panels_controlvalues_struct , struct svc_req *);
+#define RPC_BLINKENLIGHT_API_WAIT_PANEL_INPUTCONTROLS 7
+extern  rpc_blinkenlight_api_inputs_changes_struct * rpc_blinkenlight_api_wait_panel_inputcontrols_1(rpc_blinkenlight_api_wait_inputs_struct , CLIENT *);
+extern  rpc_blinkenlight_api_inputs_changes_struct * rpc_blinkenlight_api_wait_panel_inputcontrols_1_svc(rpc_blinkenlight_api_wait_inputs_struct , struct svc_req *);
+#define RPC_BLINKENLIGHT_API_GETSCHEMA 8
+extern  rpc_blinkenlight_api_getschema_res * rpc_blinkenlight_api_getschema_1(rpc_blinkenlight_api_getschema_cmd , CLIENT *);
+extern  rpc_blinkenlight_api_getschema_res * rpc_blinkenlight_api_getschema_1_svc(rpc_blinkenlight_api_getschema_cmd , struct svc_req *);
 #define RPC_PARAM_GET 100
 extern  rpc_param_result_struct * rpc_param_get_1(rpc_param_cmd_get_struct , CLIENT *);
 extern  rpc_param_result_struct * rpc_param_get_1_svc(rpc_param_cmd_get_struct , struct svc_req *);
@@ -195,6 +292,15 @@ extern  rpc_blinkenlight_api_setpanel_controlvalues_res * rpc_blinkenlight_api_s
 #define RPC_BLINKENLIGHT_API_GETPANEL_CONTROLVALUES 5
 extern  rpc_blinkenlight_api_controlvalues_struct * rpc_blinkenlight_api_getpanel_controlvalues_1();
 extern  rpc_blinkenlight_api_controlvalues_struct * rpc_blinkenlight_api_getpanel_controlvalues_1_svc();
+#define RPC_BLINKENLIGHT_API_EXCHANGE_PANELS_CONTROLVALUES 6
+extern  rpc_blinkenlight_api_panels_controlvalues_struct * rpc_blinkenlight_api_exchange_panels_controlvalues_1();
+extern  rpc_blinkenlight_api_panels_controlvalues_struct * rpc_blinkenlight_api_exchange_panels_controlvalues_1_svc();
+#define RPC_BLINKENLIGHT_API_WAIT_PANEL_INPUTCONTROLS 7
+extern  rpc_blinkenlight_api_inputs_changes_struct * rpc_blinkenlight_api_wait_panel_inputcontrols_1();
+extern  rpc_blinkenlight_api_inputs_changes_struct * rpc_blinkenlight_api_wait_panel_inputcontrols_1_svc();
+#define RPC_BLINKENLIGHT_API_GETSCHEMA 8
+extern  rpc_blinkenlight_api_getschema_res * rpc_blinkenlight_api_getschema_1();
+extern  rpc_blinkenlight_api_getschema_res * rpc_blinkenlight_api_getschema_1_svc();
 #define RPC_PARAM_GET 100
 extern  rpc_param_result_struct * rpc_param_get_1();
 extern  rpc_param_result_struct * rpc_param_get_1_svc();
@@ -220,9 +326,16 @@ extern  bool_t xdr_rpc_blinkenlight_api_control_type_t (XDR *, rpc_blinkenlight_
 extern  bool_t xdr_rpc_blinkenlight_api_panel_struct (XDR *, rpc_blinkenlight_api_panel_struct*);
 extern  bool_t xdr_rpc_blinkenlight_api_control_struct (XDR *, rpc_blinkenlight_api_control_struct*);
 extern  bool_t xdr_rpc_blinkenlight_api_controlvalues_struct (XDR *, rpc_blinkenlight_api_controlvalues_struct*);
+extern  bool_t xdr_rpc_blinkenlight_api_panel_controlvalues_struct (XDR *, rpc_blinkenlight_api_panel_controlvalues_struct*);
+extern  bool_t xdr_rpc_blinkenlight_api_wait_inputs_struct (XDR *, rpc_blinkenlight_api_wait_inputs_struct*);
+extern  bool_t xdr_rpc_blinkenlight_api_inputs_changes_struct (XDR *, rpc_blinkenlight_api_inputs_changes_struct*);
+extern  bool_t xdr_rpc_blinkenlight_api_panels_controlvalues_struct (XDR *, rpc_blinkenlight_api_panels_controlvalues_struct*);
 extern  bool_t xdr_rpc_blinkenlight_api_getinfo_res (XDR *, rpc_blinkenlight_api_getinfo_res*);
 extern  bool_t xdr_rpc_blinkenlight_api_getpanelinfo_res (XDR *, rpc_blinkenlight_api_getpanelinfo_res*);
 extern  bool_t xdr_rpc_blinkenlight_api_getcontrolinfo_res (XDR *, rpc_blinkenlight_api_getcontrolinfo_res*);
+extern  bool_t xdr_rpc_blinkenlight_api_getschema_cmd (XDR *, rpc_blinkenlight_api_getschema_cmd*);
+extern  bool_t xdr_rpc_blinkenlight_api_schema_panel_struct (XDR *, rpc_blinkenlight_api_schema_panel_struct*);
+extern  bool_t xdr_rpc_blinkenlight_api_getschema_res (XDR *, rpc_blinkenlight_api_getschema_res*);
 extern  bool_t xdr_rpc_blinkenlight_api_setpanel_controlvalues_res (XDR *, rpc_blinkenlight_api_setpanel_controlvalues_res*);
 extern  bool_t xdr_rpc_param_cmd_get_struct (XDR *, rpc_param_cmd_get_struct*);
 extern  bool_t xdr_rpc_param_result_struct (XDR *, rpc_param_result_struct*);
@@ -240,9 +353,16 @@ extern bool_t xdr_rpc_blinkenlight_api_control_type_t ();
 extern bool_t xdr_rpc_blinkenlight_api_panel_struct ();
 extern bool_t xdr_rpc_blinkenlight_api_control_struct ();
 extern bool_t xdr_rpc_blinkenlight_api_controlvalues_struct ();
+extern bool_t xdr_rpc_blinkenlight_api_panel_controlvalues_struct ();
+extern bool_t xdr_rpc_blinkenlight_api_wait_inputs_struct ();
+extern bool_t xdr_rpc_blinkenlight_api_inputs_changes_struct ();
+extern bool_t xdr_rpc_blinkenlight_api_panels_controlvalues_struct ();
 extern bool_t xdr_rpc_blinkenlight_api_getinfo_res ();
 extern bool_t xdr_rpc_blinkenlight_api_getpanelinfo_res ();
 extern bool_t xdr_rpc_blinkenlight_api_getcontrolinfo_res ();
+extern bool_t xdr_rpc_blinkenlight_api_getschema_cmd ();
+extern bool_t xdr_rpc_blinkenlight_api_schema_panel_struct ();
+extern bool_t xdr_rpc_blinkenlight_api_getschema_res ();
 extern bool_t xdr_rpc_blinkenlight_api_setpanel_controlvalues_res ();
 extern bool_t xdr_rpc_param_cmd_get_struct ();
 extern bool_t xdr_rpc_param_result_struct ();
@@ -87,6 +87,51 @@ rpc_blinkenlight_api_getpanel_controlvalues_1(u_int arg1,  CLIENT *clnt)
 	return (&clnt_res);
 }
 
+rpc_blinkenlight_api_panels_controlvalues_struct *
+rpc_blinkenlight_api_exchange_panels_controlvalues_1(rpc_blinkenlight_api_panels_controlvalues_struct outputs,  CLIENT *clnt)
+{
+	static rpc_blinkenlight_api_panels_controlvalues_struct clnt_res;
+
+	memset((char *)&clnt_res, 0, sizeof(clnt_res));
+	if (clnt_call (clnt, RPC_BLINKENLIGHT_API_EXCHANGE_PANELS_CONTROLVALUES,
+		(xdrproc_t) xdr_rpc_blinkenlight_api_panels_controlvalues_struct, (caddr_t) &outputs,
+		(xdrproc_t) xdr_rpc_blinkenlight_api_panels_controlvalues_struct, (caddr_t) &clnt_res,
+		TIMEOUT) != RPC_SUCCESS) {
+		return (NULL);
+	}
+	return (&clnt_res);
+}
+
+rpc_blinkenlight_api_inputs_changes_struct *
+rpc_blinkenlight_api_wait_panel_inputcontrols_1(rpc_blinkenlight_api_wait_inputs_struct wait,  CLIENT *clnt)
+{
+	static rpc_blinkenlight_api_inputs_changes_struct clnt_res;
+
+	memset((char *)&clnt_res, 0, sizeof(clnt_res));
+	if (clnt_call (clnt, RPC_BLINKENLIGHT_API_WAIT_PANEL_INPUTCONTROLS,
+		(xdrproc_t) xdr_rpc_blinkenlight_api_wait_inputs_struct, (caddr_t) &wait,
+		(xdrproc_t) xdr_rpc_blinkenlight_api_inputs_changes_struct, (caddr_t) &clnt_res,
+		TIMEOUT) != RPC_SUCCESS) {
+		return (NULL);
+	}
+	return (&clnt_res);
+}
+
+rpc_blinkenlight_api_getschema_res *
+rpc_blinkenlight_api_getschema_1(rpc_blinkenlight_api_getschema_cmd cmd,  CLIENT *clnt)
+{
+	static rpc_blinkenlight_api_getschema_res clnt_res;
+
+	memset((char *)&clnt_res, 0, sizeof(clnt_res));
+	if (clnt_call (clnt, RPC_BLINKENLIGHT_API_GETSCHEMA,
+		(xdrproc_t) xdr_rpc_blinkenlight_api_getschema_cmd, (caddr_t) &cmd,
+		(xdrproc_t) xdr_rpc_blinkenlight_api_getschema_res, (caddr_t) &clnt_res,
+		TIMEOUT) != RPC_SUCCESS) {
+		return (NULL);
+	}
+	return (&clnt_res);
+}
+
 rpc_param_result_struct *
 rpc_param_get_1(rpc_param_cmd_get_struct cmd_get,  CLIENT *clnt)
 {
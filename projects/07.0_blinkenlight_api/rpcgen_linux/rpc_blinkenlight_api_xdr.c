@@ -139,6 +139,73 @@ xdr_rpc_blinkenlight_api_controlvalues_struct (XDR *xdrs, rpc_blinkenlight_api_c
 	return TRUE;
 }
 
+bool_t
+xdr_rpc_blinkenlight_api_panel_controlvalues_struct (XDR *xdrs, rpc_blinkenlight_api_panel_controlvalues_struct *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_u_int (xdrs, &objp->i_panel))
+		 return FALSE;
+	 if (!xdr_u_int (xdrs, &objp->sequence))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->changed_bitmap.changed_bitmap_val, (u_int *) &objp->changed_bitmap.changed_bitmap_len, ~0,
+		sizeof (u_char), (xdrproc_t) xdr_u_char))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->value_bytes.value_bytes_val, (u_int *) &objp->value_bytes.value_bytes_len, ~0,
+		sizeof (u_char), (xdrproc_t) xdr_u_char))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_rpc_blinkenlight_api_wait_inputs_struct (XDR *xdrs, rpc_blinkenlight_api_wait_inputs_struct *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_u_int (xdrs, &objp->i_panel))
+		 return FALSE;
+	 if (!xdr_u_int (xdrs, &objp->sequence))
+		 return FALSE;
+	 if (!xdr_u_int (xdrs, &objp->timeout_ms))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_rpc_blinkenlight_api_inputs_changes_struct (XDR *xdrs, rpc_blinkenlight_api_inputs_changes_struct *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_int (xdrs, &objp->error_code))
+		 return FALSE;
+	 if (!xdr_u_int (xdrs, &objp->sequence))
+		 return FALSE;
+	 if (!xdr_u_quad_t (xdrs, &objp->timestamp_us))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->changed_bitmap.changed_bitmap_val, (u_int *) &objp->changed_bitmap.changed_bitmap_len, ~0,
+		sizeof (u_char), (xdrproc_t) xdr_u_char))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->value_bytes.value_bytes_val, (u_int *) &objp->value_bytes.value_bytes_len, ~0,
+		sizeof (u_char), (xdrproc_t) xdr_u_char))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_rpc_blinkenlight_api_panels_controlvalues_struct (XDR *xdrs, rpc_blinkenlight_api_panels_controlvalues_struct *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_int (xdrs, &objp->error_code))
+		 return FALSE;
+	 if (!xdr_u_int (xdrs, &objp->client_id))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->panels.panels_val, (u_int *) &objp->panels.panels_len, ~0,
+		sizeof (rpc_blinkenlight_api_panel_controlvalues_struct), (xdrproc_t) xdr_rpc_blinkenlight_api_panel_controlvalues_struct))
+		 return FALSE;
+	return TRUE;
+}
+
 bool_t
 xdr_rpc_blinkenlight_api_getinfo_res (XDR *xdrs, rpc_blinkenlight_api_getinfo_res *objp)
 {
@@ -175,6 +242,46 @@ xdr_rpc_blinkenlight_api_getcontrolinfo_res (XDR *xdrs, rpc_blinkenlight_api_get
 	return TRUE;
 }
 
+bool_t
+xdr_rpc_blinkenlight_api_getschema_cmd (XDR *xdrs, rpc_blinkenlight_api_getschema_cmd *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_u_quad_t (xdrs, &objp->known_hash))
+		 return FALSE;
+	 if (!xdr_u_int (xdrs, &objp->max_bytecount))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_rpc_blinkenlight_api_schema_panel_struct (XDR *xdrs, rpc_blinkenlight_api_schema_panel_struct *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_rpc_blinkenlight_api_panel_struct (xdrs, &objp->panel))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->controls.controls_val, (u_int *) &objp->controls.controls_len, ~0,
+		sizeof (rpc_blinkenlight_api_control_struct), (xdrproc_t) xdr_rpc_blinkenlight_api_control_struct))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_rpc_blinkenlight_api_getschema_res (XDR *xdrs, rpc_blinkenlight_api_getschema_res *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_int (xdrs, &objp->error_code))
+		 return FALSE;
+	 if (!xdr_u_quad_t (xdrs, &objp->hash))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->panels.panels_val, (u_int *) &objp->panels.panels_len, ~0,
+		sizeof (rpc_blinkenlight_api_schema_panel_struct), (xdrproc_t) xdr_rpc_blinkenlight_api_schema_panel_struct))
+		 return FALSE;
+	return TRUE;
+}
+
 bool_t
 xdr_rpc_blinkenlight_api_setpanel_controlvalues_res (XDR *xdrs, rpc_blinkenlight_api_setpanel_controlvalues_res *objp)
 {
@@ -20,6 +20,9 @@
  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+ 17-Oct-2026    agent   pread()/pwrite() instead of lseek(), register blocks merged over gaps
+ 17-Oct-2026    agent   register access over driver or emulation (blinkenbus_emu.c)
+ 17-Oct-2026    agent   control <-> cache over precompiled wiring plans
  10-Sep-2016    JH      added "raw" in blinkenbus_cache_from_blinkenboards_inputs()
                         and blinkenbuse_outputcontrols_to_cache()
  1-Apr-2016    	JH      clean interface to blinkenbus over cache pages
@@ -46,6 +49,7 @@
 //	open,close() - just printlog()
 //	write()- just printlog() addresses and data
 //	read()- geenerate data, printlog() addresses and data
+// To run with realistic bus data and timing, use the emulation in blinkenbus_emu.c instead.
 //#define DEBUG_BLINKENBUSFILE_LOCAL
 
 #include <stdlib.h>
@@ -67,6 +71,7 @@
 
 #include "main.h" // global blinkenlight_panel_list
 #include "blinkenbus.h" // own definitions
+#include "blinkenbus_emu.h"
 int blinkenbus_fd; // file descriptor for interface to driver
 
 // mask with output registers marked as 0xff
@@ -77,6 +82,14 @@ static blinkenbus_map_t blinkenbus_map_used_input;
 // Output: cached state of registers
 static blinkenbus_map_t blinkenbus_out_cache;
 
+// Input: register blocks read in one call each, planned by blinkenbus_init()
+typedef struct {
+    unsigned short regaddr;
+    unsigned short count;
+} blinkenbus_block_t;
+static blinkenbus_block_t blinkenbus_input_blocks[BLINKENBUS_MAX_REGISTER_ADDR + 1];
+static unsigned blinkenbus_input_blocks_count;
+
 #ifdef DEBUG_BLINKENBUSFILE_LOCAL
 // simulated data for read() is incrementing sequence
 unsigned debug_blinkenbusfile_local_read_data_source;
@@ -123,12 +136,31 @@ void blinkenbus_map_dump(unsigned char *map, char *info)
  *
  */
 
+/*
+ * read/write a block of consecutive registers,
+ * over the driver file device or from the emulation.
+ * One call, no lseek() before.
+ * result: count of registers transferred, < 0 on error
+ */
+static int blinkenbus_block_read(unsigned regaddr, unsigned char *data, unsigned count)
+{
+    if (blinkenbus_emulation)
+        return blinkenbus_emu_read(regaddr, data, count);
+    return pread(blinkenbus_fd, data, count, regaddr);
+}
+
+static int blinkenbus_block_write(unsigned regaddr, unsigned char *data, unsigned count)
+{
+    if (blinkenbus_emulation)
+        return blinkenbus_emu_write(regaddr, data, count);
+    return pwrite(blinkenbus_fd, data, count, regaddr);
+}
+
 /*
  * read value of board control register
  */
 unsigned char blinkenbus_register_read(unsigned board_addr, unsigned reg_addr)
 {
-    int ret_val;
     int bytes_read;
     unsigned char regval;
 
@@ -147,12 +179,7 @@ unsigned char blinkenbus_register_read(unsigned board_addr, unsigned reg_addr)
     print(LOG_DEBUG, "  read() %d bytes: 0x%x\n", 1, regval);
 
 #else
-    ret_val = lseek(blinkenbus_fd, reg_addr, SEEK_SET);
-    if (ret_val < 0) {
-        print(LOG_ERR, "blinkenbus_register_read() - lseek() failed!\n");
-        exit(1);
-    }
-    bytes_read = read(blinkenbus_fd, &regval, sizeof(regval));
+    bytes_read = blinkenbus_block_read(reg_addr, &regval, sizeof(regval));
     if (bytes_read != 1) {
         print(LOG_ERR, "blinkenbus_register_read() - read() failed\n");
         print(LOG_ERR, "  bytes to read: %d, actual read: %d, errno %d = %s!\n", sizeof(regval),
@@ -168,7 +195,6 @@ unsigned char blinkenbus_register_read(unsigned board_addr, unsigned reg_addr)
  */
 void blinkenbus_register_write(unsigned board_addr, unsigned reg_addr, unsigned char regval)
 {
-    int ret_val;
     int bytes_written;
 
     assert(board_addr >= 0);
@@ -184,13 +210,7 @@ void blinkenbus_register_write(unsigned board_addr, unsigned reg_addr, unsigned
     bytes_written = 1;
     print(LOG_DEBUG, "  write() %d bytes: 0x%x\n", bytes_written, regval);
 #else
-
-    ret_val = lseek(blinkenbus_fd, reg_addr, SEEK_SET);
-    if (ret_val < 0) {
-        print(LOG_ERR, "blinkenbus_register_write() - lseek() failed!\n");
-        exit(1);
-    }
-    bytes_written = write(blinkenbus_fd, &regval, sizeof(regval));
+    bytes_written = blinkenbus_block_write(reg_addr, &regval, sizeof(regval));
 #endif
     if (bytes_written != 1) {
         print(LOG_ERR, "blinkenbus_register_write() - write() failed\n");
@@ -230,6 +250,21 @@ void blinkenbus_outputcontrol_to_cache(unsigned char *blinkenbus_cache, blinkenl
     unsigned i_register_wiring;
     blinkenlight_control_blinkenbus_register_wiring_t *bbrw;
 
+    if (c->wiring_plan_valid) {
+        // scatter value bits over registers, as compiled in blinkenlight_panels_config_fixup()
+        blinkenlight_control_wiring_plan_t *wp = c->wiring_plan;
+        blinkenlight_control_wiring_plan_t *wp_end = wp + c->blinkenbus_register_wiring_count;
+        for (; wp < wp_end; wp++) {
+            unsigned char bitfield = (value >> wp->value_shift) & wp->field_mask;
+            if (wp->mirrored)
+                bitfield = BitsMirrored[bitfield] >> wp->mirror_shift;
+            bitfield = ((bitfield ^ wp->invert) << wp->lsb) & wp->register_mask;
+            blinkenbus_cache[wp->register_address] =
+                    (blinkenbus_cache[wp->register_address] & ~wp->register_mask) | bitfield;
+        }
+        return;
+    }
+
     if (c->mirrored_bit_order)
         value = mirror_bits(value, c->value_bitlen);
 
@@ -271,7 +306,19 @@ void blinkenbus_inputcontrol_from_cache(unsigned char *blinkenbus_cache, blinken
     if (c->blinkenbus_register_wiring_count == 0)
         // dummy input with constant value: like POWER on 11/70
         value = c->value_default;
-    else {
+    else if (c->wiring_plan_valid) {
+        // gather value bits from registers, as compiled in blinkenlight_panels_config_fixup()
+        blinkenlight_control_wiring_plan_t *wp = c->wiring_plan;
+        blinkenlight_control_wiring_plan_t *wp_end = wp + c->blinkenbus_register_wiring_count;
+        value = 0;
+        for (; wp < wp_end; wp++) {
+            unsigned char bitfield = ((blinkenbus_cache[wp->register_address] ^ wp->invert)
+                    >> wp->lsb) & wp->field_mask;
+            if (wp->mirrored)
+                bitfield = BitsMirrored[bitfield] >> wp->mirror_shift;
+            value |= (uint64_t) bitfield << wp->value_shift;
+        }
+    } else {
         value = 0;
         for (i_register_wiring = 0; i_register_wiring < c->blinkenbus_register_wiring_count;
                 i_register_wiring++) {
@@ -375,7 +422,6 @@ void blinkenbus_cache_to_blinkenboards_outputs(unsigned char *blinkenbus_cache,
     unsigned i_control;
     unsigned regaddr, regaddr_block_start, regaddr_block_end;
 
-    int ret_val;
     int bytes_to_write, bytes_written;
     unsigned char *data_block_start;
 
@@ -385,11 +431,15 @@ void blinkenbus_cache_to_blinkenboards_outputs(unsigned char *blinkenbus_cache,
      * optimization: write neither whole blinkenbus address space
      * nor every single register, but the ranges of changed addresses,
      * - Too many data writes are slow,
-     * - and too many file io procedures (lseek for every single register) are also slow.
+     * - and too many driver calls are also slow.
      *
      * Good chance, that the controls of a panel are connected to adjacent registers!
      *
-     * write only to registers marked as used outputs
+     * write only to registers marked as used outputs.
+     * Blocks of changed registers separated by a few unchanged outputs are
+     * written as one: an unchanged output is rewritten with its current value,
+     * which is cheaper than another call.
+     * Never write unused registers, they may be inputs or board control.
      */
 
     regaddr_block_start = 0;
@@ -404,55 +454,51 @@ void blinkenbus_cache_to_blinkenboards_outputs(unsigned char *blinkenbus_cache,
         || !OUTPUT_TO_UPDATE(regaddr_block_start) // and changed
         ))
             regaddr_block_start++;
-        // find end of register block
-        regaddr_block_end = regaddr_block_start; // block_end NOT part of block
-        while (regaddr_block_end <= BLINKENBUS_MAX_REGISTER_ADDR //
-        && blinkenbus_map_used_output[regaddr_block_end] // must be valid output
-                && OUTPUT_TO_UPDATE(regaddr_block_end) // and changed
-        )
-            regaddr_block_end++;
+        if (regaddr_block_start > BLINKENBUS_MAX_REGISTER_ADDR)
+            break;
+        // find end of register block: after last changed output,
+        // which is followed by only unchanged outputs up to gap limit
+        regaddr_block_end = regaddr_block_start + 1; // block_end NOT part of block
+        for (regaddr = regaddr_block_end;
+                regaddr <= BLINKENBUS_MAX_REGISTER_ADDR && blinkenbus_map_used_output[regaddr]
+                        && regaddr - regaddr_block_end < BLINKENBUS_MERGE_GAP_MAX; regaddr++)
+            if (OUTPUT_TO_UPDATE(regaddr))
+                regaddr_block_end = regaddr + 1;
         // 2) write current block
         bytes_to_write = regaddr_block_end - regaddr_block_start;
         data_block_start = blinkenbus_cache + regaddr_block_start;
-        if (bytes_to_write > 0) {
-            print_memdump(LOG_DEBUG, "  writing output registers:", regaddr_block_start,
-                    bytes_to_write, data_block_start);
-            //print(LOG_DEBUG, "  writing output registers 0x%x .. 0x%x\n", regaddr_block_start,
-            //		regaddr_block_end - 1);
+        print_memdump(LOG_DEBUG, "  writing output registers:", regaddr_block_start,
+                bytes_to_write, data_block_start);
+        //print(LOG_DEBUG, "  writing output registers 0x%x .. 0x%x\n", regaddr_block_start,
+        //		regaddr_block_end - 1);
 
 #ifdef DEBUG_BLINKENBUSFILE_LOCAL
-            print(LOG_DEBUG, "  lseek(0x%x, SEEK_SET\n", (int) regaddr_block_start);
+        print(LOG_DEBUG, "  lseek(0x%x, SEEK_SET\n", (int) regaddr_block_start);
+        {
+            char buff[1024];
+            char buff1[40];
+            sprintf(buff, "  write() %d bytes: ", bytes_to_write);
+            for (regaddr = regaddr_block_start; regaddr < regaddr_block_end; regaddr++)
             {
-                char buff[1024];
-                char buff1[40];
-                sprintf(buff, "  write() %d bytes: ", bytes_to_write);
-                for (regaddr = regaddr_block_start; regaddr < regaddr_block_end; regaddr++)
-                {
-                    sprintf(buff1, "%02x ", (int) blinkenbus_cache[regaddr]);
-                    strcat(buff, buff1);
-                }
-                print(LOG_DEBUG, "%s\n", buff);
+                sprintf(buff1, "%02x ", (int) blinkenbus_cache[regaddr]);
+                strcat(buff, buff1);
             }
-            bytes_written = bytes_to_write;
+            print(LOG_DEBUG, "%s\n", buff);
+        }
+        bytes_written = bytes_to_write;
 #else
-
-            ret_val = lseek(blinkenbus_fd, regaddr_block_start, SEEK_SET);
-            if (ret_val < 0) {
-                print(LOG_ERR, "blinkenbus_write_panel_output_controls() - lseek() failed!\n");
-                exit(1);
-            }
-            bytes_written = write(blinkenbus_fd, data_block_start, bytes_to_write);
+        bytes_written = blinkenbus_block_write(regaddr_block_start, data_block_start,
+                bytes_to_write);
 #endif
-            if (bytes_written != bytes_to_write) {
-                print(LOG_ERR, "blinkenbus_write_panel_output_controls() - write() failed\n");
-                print(LOG_ERR, "  bytes to write: %d, written: %d, errno %d = %s!\n",
-                        bytes_to_write, bytes_written, errno, errno2txt(errno));
-                exit(1);
-            }
+        if (bytes_written != bytes_to_write) {
+            print(LOG_ERR, "blinkenbus_write_panel_output_controls() - write() failed\n");
+            print(LOG_ERR, "  bytes to write: %d, written: %d, errno %d = %s!\n",
+                    bytes_to_write, bytes_written, errno, errno2txt(errno));
+            exit(1);
         }
 
         // 3) find next block
-        regaddr_block_start = regaddr_block_end + 1;
+        regaddr_block_start = regaddr_block_end;
     }
     // update cache
     memcpy(blinkenbus_out_cache, blinkenbus_cache, sizeof(blinkenbus_map_t));
@@ -464,91 +510,81 @@ void blinkenbus_cache_to_blinkenboards_outputs(unsigned char *blinkenbus_cache,
  */
 void blinkenbus_cache_from_blinkenboards_inputs(unsigned char *blinkenbus_cache)
 {
-    unsigned regaddr;
-    //unsigned i_control;
-    //blinkenlight_control_t *c;
-    //unsigned i_register_wiring;
-    // blinkenlight_control_blinkenbus_register_wiring_t *bbrw;
-    unsigned regaddr_block_start, regaddr_block_end;
-    int ret_val;
+    unsigned i_block;
+    blinkenbus_block_t *block;
     unsigned bytes_to_read, bytes_read;
 
     print(LOG_DEBUG, "blinkenbus_read_panel_input_controls()\n");
-    /*
 
-     // 1) mark all used input registers
-     for (regaddr = 0; regaddr <= BLINKENBUS_MAX_REGISTER_ADDR; regaddr++)
-     blinkenbus_map_in_mask[regaddr] = 0;
-     for (i_control = 0; i_control < p->controls_count; i_control++) {
-     c = &(p->controls[i_control]);
-     if (c->is_input) {
-     for (i_register_wiring = 0; i_register_wiring < c->blinkenbus_register_wiring_count;
-     i_register_wiring++) {
-     // mark all registers used by control
-     bbrw = &(c->blinkenbus_register_wiring[i_register_wiring]);
-     blinkenbus_map_in_mask[bbrw->blinkenbus_register_address] = 0xff;
-     }
-     }
-
-     }
-     */
-
-    // 1) load used registers in blocks into cache
-    regaddr_block_start = 0;
-    while (regaddr_block_start <= BLINKENBUS_MAX_REGISTER_ADDR) {
-        // 1) find start of next register block to write
-        while (regaddr_block_start <= BLINKENBUS_MAX_REGISTER_ADDR //
-        && (!blinkenbus_map_used_input[regaddr_block_start] // wait for valid input
-//        || !blinkenbus_map_in_mask[regaddr_block_start] // and used by controls
-                ))
-            regaddr_block_start++;
-        // find end of register block
-        regaddr_block_end = regaddr_block_start; // block_end NOT part of block
-        while (regaddr_block_end <= BLINKENBUS_MAX_REGISTER_ADDR //
-        && blinkenbus_map_used_input[regaddr_block_end] // must be valid input
-//                && blinkenbus_map_in_mask[regaddr_block_end]
-        )// and used by controls
-            regaddr_block_end++;
-        // 2) read current block
-        bytes_to_read = regaddr_block_end - regaddr_block_start;
-        if (bytes_to_read > 0) {
-            print(LOG_DEBUG, "  reading input registers 0x%x .. 0x%x\n", regaddr_block_start,
-                    regaddr_block_end - 1);
+    // load used registers in planned blocks into cache
+    for (i_block = 0; i_block < blinkenbus_input_blocks_count; i_block++) {
+        block = &blinkenbus_input_blocks[i_block];
+        bytes_to_read = block->count;
+        print(LOG_DEBUG, "  reading input registers 0x%x .. 0x%x\n", block->regaddr,
+                block->regaddr + block->count - 1);
 #ifdef DEBUG_BLINKENBUSFILE_LOCAL
-            print(LOG_DEBUG, "  lseek(0x%x, SEEK_SET\n", (int) regaddr_block_start);
+        print(LOG_DEBUG, "  lseek(0x%x, SEEK_SET\n", (int) block->regaddr);
+        {
+            char buff[1024];
+            char buff1[40];
+            unsigned regaddr;
+            sprintf(buff, "  read() %d bytes: ", bytes_to_read);
+            for (regaddr = block->regaddr; regaddr < block->regaddr + block->count; regaddr++)
             {
-                char buff[1024];
-                char buff1[40];
-                sprintf(buff, "  read() %d bytes: ", bytes_to_read);
-                for (regaddr = regaddr_block_start; regaddr < regaddr_block_end; regaddr++)
-                {
-                    // inc values from gloabl sequence
-                    blinkenbus_cache[regaddr] = (debug_blinkenbusfile_local_read_data_source++) & 0xff;
-                    sprintf(buff1, "%02x ", (int) blinkenbus_cache[regaddr]);
-                    strcat(buff, buff1);
-                }
-                print(LOG_DEBUG, "%s\n", buff);
+                // inc values from gloabl sequence
+                blinkenbus_cache[regaddr] = (debug_blinkenbusfile_local_read_data_source++) & 0xff;
+                sprintf(buff1, "%02x ", (int) blinkenbus_cache[regaddr]);
+                strcat(buff, buff1);
             }
-            bytes_read = bytes_to_read;
+            print(LOG_DEBUG, "%s\n", buff);
+        }
+        bytes_read = bytes_to_read;
 #else
-            ret_val = lseek(blinkenbus_fd, regaddr_block_start, SEEK_SET);
-            if (ret_val < 0) {
-                print(LOG_ERR, "blinkenbus_read_panel_input_controls() - lseek() failed!\n");
-                exit(1);
-            }
-            bytes_read = read(blinkenbus_fd, blinkenbus_cache + regaddr_block_start, bytes_to_read);
+        bytes_read = blinkenbus_block_read(block->regaddr, blinkenbus_cache + block->regaddr,
+                bytes_to_read);
 #endif
-            if (bytes_read != bytes_to_read) {
-                print(LOG_ERR, "blinkenbus_read_panel_input_controls() - read() failed\n");
-                print(LOG_ERR, "  bytes to read: %d, actual read: %d, errno %d = %s!\n",
-                        bytes_to_read, bytes_read, errno, errno2txt(errno));
-                exit(1);
-            }
+        if (bytes_read != bytes_to_read) {
+            print(LOG_ERR, "blinkenbus_read_panel_input_controls() - read() failed\n");
+            print(LOG_ERR, "  bytes to read: %d, actual read: %d, errno %d = %s!\n",
+                    bytes_to_read, bytes_read, errno, errno2txt(errno));
+            exit(1);
         }
+    }
+}
+
+/*
+ * plan the blocks for blinkenbus_cache_from_blinkenboards_inputs().
+ * Blocks of used inputs separated by a few other registers are read as one:
+ * reading needless registers has no side effects and is cheaper than another call.
+ */
+static void blinkenbus_plan_input_blocks(void)
+{
+    unsigned regaddr, regaddr_block_start, regaddr_block_end;
 
+    blinkenbus_input_blocks_count = 0;
+    regaddr_block_start = 0;
+    while (regaddr_block_start <= BLINKENBUS_MAX_REGISTER_ADDR) {
+        // 1) find start of next block
+        while (regaddr_block_start <= BLINKENBUS_MAX_REGISTER_ADDR
+                && !blinkenbus_map_used_input[regaddr_block_start])
+            regaddr_block_start++;
+        if (regaddr_block_start > BLINKENBUS_MAX_REGISTER_ADDR)
+            break;
+        // 2) find end of block: after last used input, followed by a gap
+        regaddr_block_end = regaddr_block_start + 1; // block_end NOT part of block
+        for (regaddr = regaddr_block_end;
+                regaddr <= BLINKENBUS_MAX_REGISTER_ADDR
+                        && regaddr - regaddr_block_end < BLINKENBUS_MERGE_GAP_MAX; regaddr++)
+            if (blinkenbus_map_used_input[regaddr])
+                regaddr_block_end = regaddr + 1;
+        blinkenbus_input_blocks[blinkenbus_input_blocks_count].regaddr = regaddr_block_start;
+        blinkenbus_input_blocks[blinkenbus_input_blocks_count].count = regaddr_block_end
+                - regaddr_block_start;
+        blinkenbus_input_blocks_count++;
         // 3) find next block
-        regaddr_block_start = regaddr_block_end + 1;
+        regaddr_block_start = regaddr_block_end;
     }
+    print(LOG_DEBUG, "Input registers are read in %u blocks\n", blinkenbus_input_blocks_count);
 }
 
 /*
@@ -656,16 +692,23 @@ void blinkenbus_init()
     unsigned board_addr;
     unsigned char blinkenbus_used_boards[BLINKENBUS_MAX_BOARD_ADDR + 1];
 
-    sprintf(devname, "/dev/%s", DEVICE_FILE_NAME);
-    print(LOG_INFO, "Opening %s ...\n", devname);
+    if (blinkenbus_emulation) {
+        // register space in memory, no driver
+        blinkenbus_fd = blinkenbus_emu_open();
+        if (blinkenbus_fd < 0)
+            exit(1);
+    } else {
+        sprintf(devname, "/dev/%s", DEVICE_FILE_NAME);
+        print(LOG_INFO, "Opening %s ...\n", devname);
 #ifndef	DEBUG_BLINKENBUSFILE_LOCAL
-    blinkenbus_fd = open(devname, O_RDWR | O_SYNC); // SYNC: wait if read/write calls completed
+        blinkenbus_fd = open(devname, O_RDWR | O_SYNC); // SYNC: wait if read/write calls completed
 
-    if (blinkenbus_fd < 0) {
-        print(LOG_ERR, "Could not open device file %s!\n", devname);
-        exit(1);
-    }
+        if (blinkenbus_fd < 0) {
+            print(LOG_ERR, "Could not open device file %s!\n", devname);
+            exit(1);
+        }
 #endif
+    }
     for (board_addr = 0; board_addr <= BLINKENBUS_MAX_BOARD_ADDR; board_addr++)
         blinkenbus_used_boards[board_addr] = 0;
 
@@ -697,6 +740,8 @@ void blinkenbus_init()
         }
 
     }
+    blinkenbus_plan_input_blocks();
+
     // enable all blinkenbus boards
     for (board_addr = 0; board_addr <= BLINKENBUS_MAX_BOARD_ADDR; board_addr++)
         if (blinkenbus_used_boards[board_addr]) {
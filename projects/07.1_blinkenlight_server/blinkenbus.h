@@ -20,6 +20,7 @@
    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+ 17-Oct-2026    agent   BLINKENBUS_MERGE_GAP_MAX
  10-Sep-2016    JH      added "raw" in blinkenbus_cache_from_blinkenboards_inputs()
                         and blinkenbuse_outputcontrols_to_cache()
    17-Feb-2012  JH      created
@@ -43,6 +44,10 @@
 
 #define BLINKENBUS_INPUT_LOWPASS_F_CUTOFF 20000 // input filtershave low pass for 20kHz
 
+// register blocks separated by less registers are transferred in one driver call:
+// a call costs more than some needless bytes
+#define BLINKENBUS_MERGE_GAP_MAX	8
+
 
 #ifndef BLINKENBUS_C_
 extern int blinkenbus_fd; // file descriptor for interface to driver
@@ -0,0 +1,245 @@
+/* blinkenbus_emu.c: BlinkenBus register space emulated in memory
+
+ Copyright (c) 2026, agent
+ j_hoppe@t-online.de, www.retrocmp.com
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHOR BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ 17-Oct-2026    agent   created
+
+ Replaces the kblinkenbus driver, so blinkenlightd runs on any Linux box.
+ - The 512 byte register space (32 boards * 16 registers) is a shared
+ memory image: a file given on the command line, or an anonymous memfd.
+ Other processes may set "switches" by writing input registers into
+ the image, or watch the "lamps" in the output registers.
+ - Timing model: every read()/write() costs a fixed "syscall" time
+ plus a time per transferred register, like the driver bit-banging the bus.
+ Delays are busy waits, sleeping is far too coarse.
+ - Read noise: with some probability a bit of an input register is flipped.
+ - Switch bounce: after an input register changed in the image, its
+ changed bits read as random mix of old and new value for some time.
+ Noise and bounce are applied to I/O registers only, never to
+ the board control registers.
+ */
+#ifndef WIN32
+
+#define _GNU_SOURCE // memfd_create()
+#define BLINKENBUS_EMU_C_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "errno2txt.h"
+#include "print.h"
+
+#include "blinkenbus.h"
+#include "blinkenbus_emu.h" // own definitions
+
+int blinkenbus_emulation = 0;
+blinkenbus_emu_params_t blinkenbus_emu_params;
+
+#define BLINKENBUS_EMU_SIZE	(BLINKENBUS_MAX_REGISTER_ADDR + 1)
+
+static volatile unsigned char *emu_image; // the register space, shared
+
+// switch bounce state of every register
+static unsigned char emu_settled[BLINKENBUS_EMU_SIZE]; // value returned when not bouncing
+static unsigned char emu_target[BLINKENBUS_EMU_SIZE]; // last value found in the image
+static uint64_t emu_target_time_ns[BLINKENBUS_EMU_SIZE]; // when emu_target changed
+
+static uint32_t emu_random_state = 0x2545f491;
+
+static uint64_t emu_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// xorshift, fast and good enough for noise
+static uint32_t emu_random(void)
+{
+    uint32_t x = emu_random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return emu_random_state = x;
+}
+
+// busy wait until the modeled bus transfer of "count" registers is complete
+static void emu_delay(uint64_t start_ns, unsigned count)
+{
+    uint64_t end_ns = start_ns + blinkenbus_emu_params.syscall_ns
+            + (uint64_t) count * blinkenbus_emu_params.byte_ns;
+    if (end_ns == start_ns)
+        return;
+    while (emu_now_ns() < end_ns)
+        ;
+}
+
+// value of input register "regaddr", as seen over a real bus with real switches
+static unsigned char emu_read_input(unsigned regaddr, uint64_t now_ns)
+{
+    unsigned char val = emu_image[regaddr];
+
+    if (blinkenbus_emu_params.bounce_us) {
+        if (val != emu_target[regaddr]) {
+            // new switch position: bouncing starts
+            emu_target[regaddr] = val;
+            emu_target_time_ns[regaddr] = now_ns;
+        }
+        if (emu_settled[regaddr] != val) {
+            if (now_ns - emu_target_time_ns[regaddr]
+                    >= (uint64_t) blinkenbus_emu_params.bounce_us * 1000)
+                emu_settled[regaddr] = val; // contacts are stable now
+            else
+                // changed bits are randomly old or new
+                val = emu_settled[regaddr]
+                        ^ ((emu_settled[regaddr] ^ val) & (unsigned char) emu_random());
+        }
+    }
+    if (blinkenbus_emu_params.noise_ppm
+            && emu_random() % 1000000 < blinkenbus_emu_params.noise_ppm)
+        val ^= 1 << (emu_random() & 7);
+    return val;
+}
+
+/*
+ * create the register image.
+ * result: file descriptor of the image, < 0 on error
+ */
+int blinkenbus_emu_open(void)
+{
+    int fd;
+    struct stat st;
+    int new_image;
+    unsigned board_addr;
+    unsigned regaddr;
+
+    if (strlen(blinkenbus_emu_params.image_filename)) {
+        fd = open(blinkenbus_emu_params.image_filename, O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            print(LOG_ERR, "Could not open BlinkenBus image file %s, errno %d = %s!\n",
+                    blinkenbus_emu_params.image_filename, errno, errno2txt(errno));
+            return -1;
+        }
+    } else {
+#ifdef MFD_CLOEXEC
+        fd = memfd_create("blinkenbus", MFD_CLOEXEC);
+#else
+        fd = -1;
+        errno = ENOSYS;
+#endif
+        if (fd < 0) {
+            print(LOG_ERR, "Could not create BlinkenBus image memfd, errno %d = %s!\n", errno,
+                    errno2txt(errno));
+            return -1;
+        }
+    }
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return -1;
+    }
+    new_image = (st.st_size != BLINKENBUS_EMU_SIZE);
+    if (new_image && ftruncate(fd, BLINKENBUS_EMU_SIZE) < 0) {
+        print(LOG_ERR, "Could not size BlinkenBus image, errno %d = %s!\n", errno,
+                errno2txt(errno));
+        close(fd);
+        return -1;
+    }
+    emu_image = (volatile unsigned char *) mmap(NULL, BLINKENBUS_EMU_SIZE,
+    PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (emu_image == MAP_FAILED) {
+        print(LOG_ERR, "Could not map BlinkenBus image, errno %d = %s!\n", errno,
+                errno2txt(errno));
+        close(fd);
+        return -1;
+    }
+    if (new_image) {
+        // like after power up: all registers 0, boards disabled
+        for (regaddr = 0; regaddr < BLINKENBUS_EMU_SIZE; regaddr++)
+            emu_image[regaddr] = 0;
+        for (board_addr = 0; board_addr <= BLINKENBUS_MAX_BOARD_ADDR; board_addr++)
+            emu_image[BLINKENBUS_ADDRESS_CONTROL(board_addr)] = 0x01;
+    }
+    for (regaddr = 0; regaddr < BLINKENBUS_EMU_SIZE; regaddr++)
+        emu_settled[regaddr] = emu_target[regaddr] = emu_image[regaddr];
+
+    if (strlen(blinkenbus_emu_params.image_filename))
+        print(LOG_NOTICE, "Emulating BlinkenBus in image file %s\n",
+                blinkenbus_emu_params.image_filename);
+    else
+        print(LOG_NOTICE, "Emulating BlinkenBus in image /proc/%d/fd/%d\n", (int) getpid(), fd);
+    print(LOG_NOTICE,
+            "  %u ns per call, %u ns per register, noise %u ppm, switch bounce %u us\n",
+            blinkenbus_emu_params.syscall_ns, blinkenbus_emu_params.byte_ns,
+            blinkenbus_emu_params.noise_ppm, blinkenbus_emu_params.bounce_us);
+    return fd;
+}
+
+/*
+ * read "count" consecutive registers, like read() on /dev/blinkenbus
+ * result: registers read
+ */
+int blinkenbus_emu_read(unsigned regaddr, unsigned char *data, unsigned count)
+{
+    uint64_t start_ns = emu_now_ns();
+    unsigned i;
+
+    if (regaddr >= BLINKENBUS_EMU_SIZE)
+        return 0;
+    if (regaddr + count > BLINKENBUS_EMU_SIZE)
+        count = BLINKENBUS_EMU_SIZE - regaddr;
+    for (i = 0; i < count; i++, regaddr++)
+        if ((regaddr & 0xf) == 0xf) // board control
+            data[i] = emu_image[regaddr];
+        else
+            data[i] = emu_read_input(regaddr, start_ns);
+    emu_delay(start_ns, count);
+    return (int) count;
+}
+
+/*
+ * write "count" consecutive registers, like write() on /dev/blinkenbus
+ * result: registers written
+ */
+int blinkenbus_emu_write(unsigned regaddr, unsigned char *data, unsigned count)
+{
+    uint64_t start_ns = emu_now_ns();
+    unsigned i;
+
+    if (regaddr >= BLINKENBUS_EMU_SIZE)
+        return 0;
+    if (regaddr + count > BLINKENBUS_EMU_SIZE)
+        count = BLINKENBUS_EMU_SIZE - regaddr;
+    for (i = 0; i < count; i++)
+        emu_image[regaddr + i] = data[i];
+    emu_delay(start_ns, count);
+    return (int) count;
+}
+
+#endif
@@ -0,0 +1,50 @@
+/* blinkenbus_emu.h: BlinkenBus register space emulated in memory
+
+   Copyright (c) 2026, agent
+   j_hoppe@t-online.de, www.retrocmp.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+   THE AUTHOR BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+   IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+   17-Oct-2026  agent   created
+*/
+
+
+#ifndef BLINKENBUS_EMU_H_
+#define BLINKENBUS_EMU_H_
+
+#define BLINKENBUS_EMU_MAX_FILENAME_LEN	256
+
+typedef struct {
+    char image_filename[BLINKENBUS_EMU_MAX_FILENAME_LEN]; // "" = anonymous memfd
+    unsigned syscall_ns; // latency of every read()/write() on the device
+    unsigned byte_ns; // additional latency per transferred register
+    unsigned noise_ppm; // probability of a flipped bit per input register read
+    unsigned bounce_us; // input bits toggle randomly this long after a change
+} blinkenbus_emu_params_t;
+
+#ifndef BLINKENBUS_EMU_C_
+extern int blinkenbus_emulation; // 1 = emulate, do not use /dev/blinkenbus
+extern blinkenbus_emu_params_t blinkenbus_emu_params;
+#endif
+
+int blinkenbus_emu_open(void);
+int blinkenbus_emu_read(unsigned regaddr, unsigned char *data, unsigned count);
+int blinkenbus_emu_write(unsigned regaddr, unsigned char *data, unsigned count);
+
+#endif /* BLINKENBUS_EMU_H_ */
@@ -20,6 +20,8 @@
  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+ 17-Oct-2026  agent   MUX phases on absolute deadlines (rtsched.c)
+ 17-Oct-2026  agent   phase values of a control by bit plane transposition
  20-Mar-2012  JH      created
 
 
@@ -61,6 +63,8 @@
 #include <assert.h>
 
 #include "print.h"
+#include "bitcalc.h"
+#include "rtsched.h"
 #include "blinkenbus.h"
 #include "iopattern.h"
 #include "main.h"   // global blinkenlight_panel_list
@@ -83,6 +87,7 @@ int blinkenbus_mux_thread_terminate = 0;
 
 // biometrics
 unsigned blinkenbus_min_cycle_time_ns, blinkenbus_max_cycle_time_ns;
+rtsched_t blinkenbus_mux_sched; // start of MUX phases
 
 #if 0
 /*
@@ -214,6 +219,59 @@ char brightness_phase_lookup[32][32] =
 
 #endif
 
+#if IOPATTERN_OUTPUT_PHASES > 32
+#error "brightness_phase_masks[] hold max 32 phases"
+#endif
+// brightness_phase_lookup[level][] as bit mask: bit <phase> set, if lamp is ON in phase
+static uint32_t brightness_phase_masks[IOPATTERN_OUTPUT_BRIGHTNESS_LEVELS];
+
+static void brightness_phase_masks_init(void)
+{
+    unsigned level, phase;
+    for (level = 0; level < IOPATTERN_OUTPUT_BRIGHTNESS_LEVELS; level++) {
+        brightness_phase_masks[level] = 0;
+        for (phase = 0; phase < IOPATTERN_OUTPUT_PHASES; phase++)
+            if (brightness_phase_lookup[level][phase])
+                brightness_phase_masks[level] |= (uint32_t) 1 << phase;
+    }
+}
+
+/*
+ * control value for every display phase, from the low-passed bits.
+ * Bit planes: each value bit gives a row of ON phases for its brightness,
+ * transposing the bit matrix gives a row of value bits for each phase.
+ * So all phases are calculated together, 32 bits at once.
+ */
+static void iopattern_phase_values(blinkenlight_control_t *c,
+        uint64_t phase_values[IOPATTERN_OUTPUT_PHASES])
+{
+    uint32_t rows[32];
+    unsigned bitidx, phase, bitbase;
+
+    for (phase = 0; phase < IOPATTERN_OUTPUT_PHASES; phase++)
+        phase_values[phase] = 0;
+    // 36 bit PDP-10 rows: two blocks of 32 bits
+    for (bitbase = 0; bitbase < c->value_bitlen; bitbase += 32) {
+        for (bitidx = 0; bitidx < 32; bitidx++) {
+            unsigned bit_brightness;
+            if (bitbase + bitidx >= c->value_bitlen) {
+                rows[bitidx] = 0;
+                continue;
+            }
+            bit_brightness = ((unsigned) (c->averaged_value_bits[bitbase + bitidx])
+                    * (IOPATTERN_OUTPUT_BRIGHTNESS_LEVELS)) / 256; // from 0.. 255 to
+            // fixup 0/1 flicker: very low brightness rounded to 0?
+            if (bit_brightness == 0 && c->averaged_value_bits[bitbase + bitidx] > 0)
+                bit_brightness = 1;
+            assert(bit_brightness < IOPATTERN_OUTPUT_BRIGHTNESS_LEVELS);
+            rows[bitidx] = brightness_phase_masks[bit_brightness];
+        }
+        transpose_bits32(rows); // now rows[phase] = value bits
+        for (phase = 0; phase < IOPATTERN_OUTPUT_PHASES; phase++)
+            phase_values[phase] |= (uint64_t) rows[phase] << bitbase;
+    }
+}
+
 /*
  * A PWM pattern is used, because it darstically reduces switche events write cycles
  * on the BlinkenBus.
@@ -268,7 +326,7 @@ void *iopattern_update_outputs(void *arg)
 
             for (i_control = 0; i_control < p->controls_count; i_control++) {
                 blinkenlight_control_t *c = &p->controls[i_control];
-                unsigned bitidx;
+                uint64_t phase_values[IOPATTERN_OUTPUT_PHASES];
                 unsigned phase;
                 if (c->is_input)
                     continue;
@@ -297,27 +355,12 @@ void *iopattern_update_outputs(void *arg)
                      */
 
                     // build the display value from the low-passed bits.
-                    // for all display phases :
+                    // all display phases at once
+                    iopattern_phase_values(c, phase_values);
                     for (phase = 0; phase < IOPATTERN_OUTPUT_PHASES; phase++) {
-                        unsigned value = 0;
-                        // for all bits :
-                        for (bitidx = 0; bitidx < c->value_bitlen; bitidx++) {
-                            // mount phase bit
-                            unsigned bit_brightness = ((unsigned) (c->averaged_value_bits[bitidx])
-                                    * (IOPATTERN_OUTPUT_BRIGHTNESS_LEVELS)) / 256; // from 0.. 255 to
-                            // fixup 0/1 flicker: very low brightness rounded to 0?
-                            if (bit_brightness == 0 && c->averaged_value_bits[bitidx] > 0)
-                                bit_brightness = 1 ;
-//bit_brightness = 1;
-                            assert(bit_brightness < IOPATTERN_OUTPUT_BRIGHTNESS_LEVELS);
-                            if (brightness_phase_lookup[bit_brightness][phase])
-                                value |= 1 << bitidx;
-                        }
-                        // output to cache phase
-
                         // override low passed pattern by lamp test
-                        value = panel_mode_control_value(c, value);
-
+                        uint64_t value = panel_mode_control_value(c, phase_values[phase]);
+                        // output to cache phase
                         blinkenbus_outputcontrol_to_cache(blinkenbus_output_caches[phase], c,
                                 value);
                     }
@@ -339,10 +382,14 @@ void *iopattern_blinkenbus_mux(void *arg)
     int *terminate = arg;
     unsigned phase = 0;
 
+    rtsched_init(&blinkenbus_mux_sched, "MUX");
     do { // at least one cycle, for non-thread call
         struct timespec clock_start, clock_end;
         unsigned char *cur_cache;
 
+        // wait for exact start of the phase, first one starts now
+        rtsched_phase(&blinkenbus_mux_sched, 1000 * IOPATTERN_OUTPUT_MUX_PERIOD_US);
+
         // begin of I/O
         clock_gettime(CLOCK_MONOTONIC, &clock_start);
 
@@ -362,32 +409,21 @@ void *iopattern_blinkenbus_mux(void *arg)
         // end of I/O
         clock_gettime(CLOCK_MONOTONIC, &clock_end);
 
-        // calculate remaining time to wait: start + interval - end
+        // biometrics
         {
             int64_t blinkenbus_cycle_time_ns;
-            int64_t wait_ns;
 
             // elapsed time to write all bus registers
             blinkenbus_cycle_time_ns =
                     ((uint64_t) clock_end.tv_sec * 1000000000 + clock_end.tv_nsec)
                             - ((uint64_t) clock_start.tv_sec * 1000000000 + clock_start.tv_nsec);
 
-            // biometrics
             if (blinkenbus_min_cycle_time_ns == 0
                     || blinkenbus_cycle_time_ns < blinkenbus_min_cycle_time_ns)
                 blinkenbus_min_cycle_time_ns = blinkenbus_cycle_time_ns;
             if (blinkenbus_max_cycle_time_ns == 0
                     || blinkenbus_cycle_time_ns > blinkenbus_max_cycle_time_ns)
                 blinkenbus_max_cycle_time_ns = blinkenbus_cycle_time_ns;
-
-            // wait for one period
-            wait_ns = (long) 1000 * IOPATTERN_OUTPUT_MUX_PERIOD_US - blinkenbus_cycle_time_ns;
-            if (wait_ns > 0) {
-                struct timespec wait;
-                wait.tv_sec = 0;
-                wait.tv_nsec = wait_ns;
-                nanosleep(&wait, NULL);
-            }
         }
     } while (*terminate == 0) ;
 }
@@ -403,6 +439,7 @@ void iopattern_init()
     blinkenbus_min_cycle_time_ns = blinkenbus_max_cycle_time_ns = 0;
 
     blinkenbus_init(); // panel config must be known
+    brightness_phase_masks_init();
 
     // intialize all output cache phases with image of blinkenbus register space
     for (phase = 0; phase < IOPATTERN_OUTPUT_PHASES; phase++)
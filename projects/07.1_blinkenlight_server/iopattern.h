@@ -20,12 +20,16 @@
  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+ 17-Oct-2026  agent   iopattern_update_thread
+ 17-Oct-2026  agent   blinkenbus_mux_sched
  20-Mar-2012  JH      created
  */
 #ifndef IOPATTERN_H_
 #define IOPATTERN_H_
 
+#include <pthread.h>
 #include "blinkenbus.h"
+#include "rtsched.h"
 
 #define IOPATTERN_UPDATE_PERIOD_US 20000 // update frequency 50 Hz
 
@@ -42,7 +46,9 @@
 #ifndef IOPATTERN_C_
 extern blinkenbus_map_t blinkenbus_output_caches[IOPATTERN_OUTPUT_PHASES];
 extern blinkenbus_map_t blinkenbus_input_cache;
-extern unsigned long blinkenbus_min_cycle_time_ns, blinkenbus_max_cycle_time_ns ;
+extern unsigned blinkenbus_min_cycle_time_ns, blinkenbus_max_cycle_time_ns ;
+extern rtsched_t blinkenbus_mux_sched;
+extern pthread_t iopattern_update_thread;
 
 #endif
 
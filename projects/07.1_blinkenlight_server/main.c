@@ -20,6 +20,12 @@
  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+ 17-Oct-2026    agent option -rw: RPC worker threads
+ 17-Oct-2026    agent runtime metrics over RPC_PARAM_CLASS_BUS
+ 17-Oct-2026    agent options -mc, -mw: MUX thread CPU and busy wait, MUX jitter in get_info
+ 17-Oct-2026    agent option -e: BLINKENBUS emulation with timing model
+ 17-Oct-2026    agent shared memory image for clients on the same host
+ 17-Oct-2026    agent answer input change subscriptions in main loop
  1-Apr-2016    JH  V 1.10 Low pass for output controls, major changes
  16-Mar-2016    JH  V 1.09 better commandline processing with getopt2()
  20-Feb-2016    JH  V 1.08 migration to VS2015 and repair
@@ -141,6 +147,7 @@
 #include "print.h"
 #include "blinkenlight_panels.h"
 #include "blinkenlight_api_server_procs.h"
+#include "blinkenlight_api_server_reactor.h"
 #include "config.h"
 #include "panelsim.h"
 
@@ -152,6 +159,7 @@
 #include "rpc_blinkenlight_api.h"
 #include <rpc/pmap_clnt.h> // different name under "oncrpc for windows"?
 #include "blinkenbus.h"
+#include "blinkenbus_emu.h"
 #include "iopattern.h"
 #endif
 //#include <memory.h>
@@ -271,6 +279,30 @@ static int parse_commandline(int argc, char **argv)
             "show user GUI with simulated panel.\n"
                     "No operation on BLINKENBUS. Clears -b, default output is stderr.",
             NULL, NULL, NULL, NULL);
+    getopt_def(&getopt_parser, "e", "emulation", NULL, "image_file", NULL,
+            "emulate the BLINKENBUS in memory, /dev/blinkenbus is not needed.\n"
+                    "Registers are kept in <image_file>, else in an anonymous memfd.\n"
+                    "Other processes may set inputs and read outputs in the image.",
+            "/tmp/blinkenbus.img", "emulate BLINKENBUS boards in a file", NULL, NULL);
+    getopt_def(&getopt_parser, "et", "emulation_timing", "call_ns,register_ns", NULL, NULL,
+            "emulated BLINKENBUS: busy time for every read()/write() on the driver,\n"
+                    "and additional time per transferred register.",
+            "20000 1000", "20 us per call, plus 1 us per register", NULL, NULL);
+    getopt_def(&getopt_parser, "en", "emulation_noise", "noise_ppm", "bounce_us", NULL,
+            "emulated BLINKENBUS: probability of a flipped bit per input register read,\n"
+                    "and time switch contacts bounce after an input changed in the image.",
+            "10 5000", "10 flipped bits per million reads, 5 ms bounce", NULL, NULL);
+    getopt_def(&getopt_parser, "mc", "mux_cpu", "cpu", NULL, NULL,
+            "run the BLINKENBUS multiplexing thread on this CPU only",
+            "1", "keep CPU 0 for the RPC server and the system", NULL, NULL);
+    getopt_def(&getopt_parser, "mw", "mux_spin", "us", NULL, "10",
+            "the BLINKENBUS multiplexing thread sleeps until shortly before the start\n"
+                    "of the next phase, then busy waits the last <us> microseconds.",
+            "50", "compensate 50 us wake up latency", NULL, NULL);
+    getopt_def(&getopt_parser, "rw", "rpc_workers", "count", NULL, NULL,
+            "threads serving RPC requests of TCP clients in parallel.\n"
+                    "0 = serve all requests in the RPC thread. Default: CPU count - 1",
+            "0", "single core: no thread switches", NULL, NULL);
     getopt_def(&getopt_parser, "v", "verbose", NULL, NULL, NULL, "tell what I'm doing",
     NULL, NULL, NULL, NULL);
 #endif
@@ -285,6 +317,10 @@ static int parse_commandline(int argc, char **argv)
     strcpy(configfilename, "");
     mode_test = 0;
     mode_panelsim = 0;
+#ifndef WIN32
+    blinkenbus_emulation = 0;
+    memset(&blinkenbus_emu_params, 0, sizeof(blinkenbus_emu_params));
+#endif
 
     res = getopt_first(&getopt_parser, argc, argv);
     while (res > 0) {
@@ -298,6 +334,35 @@ static int parse_commandline(int argc, char **argv)
                 commandline_option_error();
         } else if (getopt_isoption(&getopt_parser, "simulation")) {
             mode_panelsim = 1;
+#ifndef WIN32
+        } else if (getopt_isoption(&getopt_parser, "emulation")) {
+            blinkenbus_emulation = 1;
+            if (getopt_arg_s(&getopt_parser, "image_file",
+                    blinkenbus_emu_params.image_filename,
+                    sizeof(blinkenbus_emu_params.image_filename)) < 0)
+                commandline_option_error();
+        } else if (getopt_isoption(&getopt_parser, "emulation_timing")) {
+            if (getopt_arg_u(&getopt_parser, "call_ns", &blinkenbus_emu_params.syscall_ns) < 0
+                    || getopt_arg_u(&getopt_parser, "register_ns",
+                            &blinkenbus_emu_params.byte_ns) < 0)
+                commandline_option_error();
+        } else if (getopt_isoption(&getopt_parser, "mux_cpu")) {
+            if (getopt_arg_i(&getopt_parser, "cpu", &rtsched_cpu) < 0)
+                commandline_option_error();
+        } else if (getopt_isoption(&getopt_parser, "mux_spin")) {
+            unsigned spin_us;
+            if (getopt_arg_u(&getopt_parser, "us", &spin_us) < 0)
+                commandline_option_error();
+            rtsched_spin_ns = 1000 * spin_us;
+        } else if (getopt_isoption(&getopt_parser, "rpc_workers")) {
+            if (getopt_arg_i(&getopt_parser, "count", &blinkenlight_api_reactor_workers) < 0)
+                commandline_option_error();
+        } else if (getopt_isoption(&getopt_parser, "emulation_noise")) {
+            if (getopt_arg_u(&getopt_parser, "noise_ppm", &blinkenbus_emu_params.noise_ppm) < 0
+                    || getopt_arg_u(&getopt_parser, "bounce_us",
+                            &blinkenbus_emu_params.bounce_us) < 0)
+                commandline_option_error();
+#endif
         } else if (getopt_isoption(&getopt_parser, "test")) {
             mode_test = 1;
         } else if (getopt_isoption(&getopt_parser, "verbose")) {
@@ -340,10 +405,6 @@ void blinkenlight_api_server(void)
 {
     register SVCXPRT *transp;
 
-// entry to server stub
-
-    void blinkenlightd_1(struct svc_req *rqstp, register SVCXPRT *transp);
-
     pmap_unset(BLINKENLIGHTD, BLINKENLIGHTD_VERS);
 
     transp = svcudp_create(RPC_ANYSOCK);
@@ -351,7 +412,8 @@ void blinkenlight_api_server(void)
         print(LOG_ERR, "%s", "cannot create udp service.");
         exit(1);
     }
-    if (!svc_register(transp, BLINKENLIGHTD, BLINKENLIGHTD_VERS, blinkenlightd_1, IPPROTO_UDP)) {
+    if (!svc_register(transp, BLINKENLIGHTD, BLINKENLIGHTD_VERS, blinkenlight_api_server_dispatch,
+            IPPROTO_UDP)) {
         print(LOG_ERR, "%s", "unable to register (BLINKENLIGHTD, BLINKENLIGHTD_VERS, udp).");
         exit(1);
     }
@@ -361,39 +423,22 @@ void blinkenlight_api_server(void)
         print(LOG_ERR, "%s", "cannot create tcp service.");
         exit(1);
     }
-    if (!svc_register(transp, BLINKENLIGHTD, BLINKENLIGHTD_VERS, blinkenlightd_1, IPPROTO_TCP)) {
+    if (!svc_register(transp, BLINKENLIGHTD, BLINKENLIGHTD_VERS, blinkenlight_api_server_dispatch,
+            IPPROTO_TCP)) {
         print(LOG_ERR, "%s", "unable to register (BLINKENLIGHTD, BLINKENLIGHTD_VERS, tcp).");
         exit(1);
     }
 
-    // svc_run();
-    // alternate implementation of svn_run() with periodically timeout and
-    // 	calling of callback
-    {
-        fd_set readfds;
-        struct timeval tv;
-        int dtbsz = getdtablesize();
-        for (;;) {
-            readfds = svc_fdset;
-            tv.tv_sec = 0;
-            tv.tv_usec = 1000 * 2; // every 10 ms*time_slice_ms;
-            switch (select(dtbsz, &readfds, NULL, NULL, &tv)) {
-            case -1:
-                if (errno == EINTR)
-                    continue;
-                perror("select");
-                return;
-            case 0: // timeout
-                    // provide the panel simulation with computing time
-                if (mode_panelsim)
-                    panelsim_service();
-                break;
-            default:
-                svc_getreqset(&readfds);
-                break;
-            }
-        }
-    }
+    // clients on the same host may exchange control values over shared memory
+    blinkenlight_api_server_shm_create();
+
+    // svc_run() replacement: serve RPC at once, periodic work on timers
+    if (blinkenlight_api_reactor_init() != 0)
+        exit(1);
+    if (mode_panelsim)
+        // provide the panel simulation with computing time
+        blinkenlight_api_reactor_add_timer("panelsim", PANELSIM_SERVICE_PERIOD_US, panelsim_service);
+    blinkenlight_api_reactor_run();
 
     print(LOG_ERR, "%s", "svc_run returned");
     exit(1);
@@ -493,7 +538,7 @@ static void on_blinkenlight_api_panel_set_state(blinkenlight_panel_t *p, int new
 
 static char *on_blinkenlight_api_get_info()
 {
-    static char buffer[1024];
+    static char buffer[2048];
 #ifdef WIN32
 	sprintf(buffer,
 		"Server info  : %s\n"
@@ -503,6 +548,7 @@ static char *on_blinkenlight_api_get_info()
 		program_info, program_name, program_options);
 #else
     struct timespec ts;
+    char jitter_text[512];
     clock_getres(CLOCK_MONOTONIC, &ts);
 
     sprintf(buffer,
@@ -512,14 +558,16 @@ static char *on_blinkenlight_api_get_info()
                     "Compile time : " __DATE__ " " __TIME__ "\n"
                     "Telemetrics  : Updater period = %u ms, MUX period = %u us;\n"
                     "               MUX pattern levels/phases = %u/%u; \n"
-                    "               MUX cycle time = %u .. %u us, max %u%% CPU load.", //
+                    "               MUX cycle time = %u .. %u us, max %u%% CPU load;\n"
+                    "               %s", //
             program_info, program_name, program_options,
             IOPATTERN_UPDATE_PERIOD_US/1000,
                  IOPATTERN_OUTPUT_MUX_PERIOD_US,
                  IOPATTERN_OUTPUT_BRIGHTNESS_LEVELS,
                  IOPATTERN_OUTPUT_PHASES,
             blinkenbus_min_cycle_time_ns/1000, blinkenbus_max_cycle_time_ns / 1000,
-           (100*blinkenbus_max_cycle_time_ns) / (1000*IOPATTERN_OUTPUT_MUX_PERIOD_US)
+           (100*blinkenbus_max_cycle_time_ns) / (1000*IOPATTERN_OUTPUT_MUX_PERIOD_US),
+            rtsched_histogram_text(&blinkenbus_mux_sched, jitter_text, sizeof(jitter_text))
             );
     blinkenbus_min_cycle_time_ns = blinkenbus_max_cycle_time_ns = 0; // new sample
 #endif
@@ -527,6 +575,24 @@ static char *on_blinkenlight_api_get_info()
     return buffer;
 }
 
+// server specific metrics: bus I/O time of the MUX thread
+static int on_blinkenlight_api_bus_get_param(unsigned object_handle, unsigned param_handle,
+        unsigned *param_value)
+{
+#ifndef WIN32
+    if (!mode_panelsim && object_handle == 0) {
+        if (param_handle == RPC_PARAM_HANDLE_BUS_MUX_CYCLE_MIN_US) {
+            *param_value = blinkenbus_min_cycle_time_ns / 1000;
+            return RPC_ERR_OK;
+        } else if (param_handle == RPC_PARAM_HANDLE_BUS_MUX_CYCLE_MAX_US) {
+            *param_value = blinkenbus_max_cycle_time_ns / 1000;
+            return RPC_ERR_OK;
+        }
+    }
+#endif
+    return RPC_ERR_PARAM_ILL_PARAM;
+}
+
 /*
  *
  */
@@ -560,6 +626,7 @@ int main(int argc, char *argv[])
     blinkenlight_api_panel_get_state_evt = on_blinkenlight_api_panel_get_state;
     blinkenlight_api_panel_set_state_evt = on_blinkenlight_api_panel_set_state;
     blinkenlight_api_get_info_evt = on_blinkenlight_api_get_info;
+    blinkenlight_api_bus_get_param_evt = on_blinkenlight_api_bus_get_param;
 
     if (mode_test) {
         blinkenlight_panels_diagprint(blinkenlight_panel_list, stderr);
@@ -575,8 +642,11 @@ int main(int argc, char *argv[])
 #else
         if (mode_panelsim)
             panelsim_init(0); // at the moment, use first panel for simulation
-        else
+        else {
             iopattern_init();
+            blinkenlight_api_metrics_mux_sched = &blinkenbus_mux_sched;
+            blinkenlight_api_metrics_update_thread = &iopattern_update_thread;
+        }
 
         if (!blinkenlight_panels_config_check()) {
             print(LOG_ERR, "Terminated with error.\n");
@@ -29,7 +29,7 @@
  Entry points:
  - the RPC server calls panelsim_read_panel_input_controls()
  and panelsim_write_panel_output_controls()
- - on idle, periodically panelsim_service() is called
+ - periodically panelsim_service() is called by a server timer
  - user interface over command line
 
  Internals:
@@ -21,6 +21,7 @@
    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 
+   17-Oct-2026  agent   PANELSIM_SERVICE_PERIOD_US
    17-Mar-2012  JH      created
 */
 
@@ -31,6 +32,8 @@
 #include <stdio.h>
 #include "blinkenlight_panels.h"
 
+#define PANELSIM_SERVICE_PERIOD_US	10000 // keyboard polling and display update check
+
 void panelsim_init(int i_panel);
 void panelsim_service(void);
 
@@ -0,0 +1,38 @@
+/* alloc_count.h: count heap allocations of a test program
+
+ Copyright (c) 2026, agent
+ j_hoppe@t-online.de, www.retrocmp.com
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ THE AUTHOR BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+ 17-Oct-2026  agent   created
+
+
+ Linking alloc_count.c replaces malloc(), calloc() and realloc()
+ of the C library by versions which count the calls.
+ glibc only: the originals are called over __libc_malloc() etc.
+ */
+
+#ifndef ALLOC_COUNT_H_
+#define ALLOC_COUNT_H_
+
+// calls of malloc(), calloc() and realloc() since program start
+extern volatile unsigned long alloc_count;
+
+#endif /* ALLOC_COUNT_H_ */
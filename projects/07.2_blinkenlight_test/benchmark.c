@@ -0,0 +1,380 @@
+/* benchmark.c: load generator and latency measurement for a Blinkenlight API server
+
+ Copyright (c) 2026, agent
+ j_hoppe@t-online.de, www.retrocmp.com
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ THE AUTHOR BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+ 17-Oct-2026  agent   created
+
+
+ Drives a server with a stream of calls, like a simulator does:
+ - TO_SERVER/FROM_SERVER: test procedures with a payload of n bytes
+ - PANELS: all outputs of the server's panels are changed and sent,
+	inputs are read back, in one EXCHANGE round trip.
+	The panel shape is the one configured on the server.
+ Calls are sent back to back, or paced to a fixed rate.
+ Reported are the round trip latency percentiles, the achieved calls per
+ second and the CPU time the server process used meanwhile.
+
+ benchmark_metrics() dumps the runtime metrics a server collects
+ itself (RPC_PARAM_CLASS_BUS), for monitoring without a debugger.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef WIN32
+#include <windows.h>
+#define strcasecmp _stricmp	// grmbl
+#else
+#include <unistd.h>
+#include <time.h>
+#endif
+
+#include "bitcalc.h"
+#include "rpc_blinkenlight_api.h"
+#include "blinkenlight_api_client.h"
+#include "blinkenlight_panels.h"
+#include "benchmark.h"
+
+/* from main */
+extern blinkenlight_api_client_t *blinkenlight_api_client;
+
+// monotonic time in microseconds
+static uint64_t benchmark_now_us(void)
+{
+#ifdef WIN32
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER count;
+	if (freq.QuadPart == 0)
+		QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (uint64_t) (count.QuadPart / (double) freq.QuadPart * 1000000.0);
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+static void benchmark_sleep_us(uint64_t us)
+{
+#ifdef WIN32
+	Sleep((DWORD) (us / 1000));
+#else
+	usleep((useconds_t) us);
+#endif
+}
+
+static int compare_latency(const void *a, const void *b)
+{
+	unsigned la = *(const unsigned *) a;
+	unsigned lb = *(const unsigned *) b;
+	return (la > lb) - (la < lb);
+}
+
+// percentile of sorted list, per mill
+static unsigned latency_percentile(unsigned *latencies, unsigned count, unsigned permill)
+{
+	unsigned idx = (unsigned) (((uint64_t) count * permill) / 1000);
+	if (idx >= count)
+		idx = count - 1;
+	return latencies[idx];
+}
+
+/*
+ * change all output values of the panels, so every call transmits data
+ */
+static void benchmark_change_outputs(blinkenlight_panel_t **panels, unsigned panels_count)
+{
+	unsigned i_panel, i_control;
+	for (i_panel = 0; i_panel < panels_count; i_panel++) {
+		blinkenlight_panel_t *p = panels[i_panel];
+		for (i_control = 0; i_control < p->controls_count; i_control++) {
+			blinkenlight_control_t *c = &p->controls[i_control];
+			if (!c->is_input)
+				c->value = (c->value + 1) & BitmaskFromLen64[c->value_bitlen];
+		}
+	}
+}
+
+/*
+ * run the benchmark against the server on "hostname".
+ * result: 0 = OK, 1 = error
+ */
+int benchmark(char *hostname, benchmark_params_t *params)
+{
+	blinkenlight_panel_t **panels = NULL;
+	unsigned panels_count = 0;
+	unsigned *latencies; // round trip time of each call in us
+	unsigned latencies_size, count;
+	uint64_t start_us, end_us, next_us, call_start_us;
+	uint64_t server_cpu_start_us, server_cpu_end_us;
+	unsigned panel_bytecount = 0;
+	unsigned i;
+	int error = 0;
+
+	blinkenlight_api_client = blinkenlight_api_client_constructor();
+	if (!strcasecmp(params->transport, "tcp"))
+		blinkenlight_api_client->rpc_protocol = "tcp";
+	printf("Connecting to %s ...\n", hostname);
+	if (blinkenlight_api_client_connect(blinkenlight_api_client, hostname) != 0
+			|| blinkenlight_api_client_get_panels_and_controls(blinkenlight_api_client) != 0) {
+		fputs(blinkenlight_api_client_get_error_text(blinkenlight_api_client), stderr);
+		blinkenlight_api_client_destructor(blinkenlight_api_client);
+		return 1;
+	}
+
+	if (params->mode == BENCHMARK_MODE_PANELS) {
+		blinkenlight_panel_list_t *pl = blinkenlight_api_client->panel_list;
+		panels = (blinkenlight_panel_t **) malloc((pl->panels_count + 1) * sizeof(*panels));
+		for (i = 0; i < pl->panels_count; i++)
+			if (!strlen(params->panelname)
+					|| !strcasecmp(params->panelname, pl->panels[i].name)) {
+				panels[panels_count++] = &pl->panels[i];
+				panel_bytecount += pl->panels[i].controls_outputs_values_bytecount
+						+ pl->panels[i].controls_inputs_values_bytecount;
+			}
+		if (panels_count == 0) {
+			fprintf(stderr, "No panel \"%s\" on server.\n", params->panelname);
+			error = 1;
+		}
+		if (!error && !strcasecmp(params->transport, "shm")
+				&& blinkenlight_api_client_shm_attach(blinkenlight_api_client) != 0) {
+			fputs(blinkenlight_api_client_get_error_text(blinkenlight_api_client), stderr);
+			error = 1;
+		}
+	} else if (!strcasecmp(params->transport, "shm")) {
+		fprintf(stderr, "Shared memory transport only for panel benchmark.\n");
+		error = 1;
+	}
+
+	// server load is measured over RPC, also if panels go over shared memory
+	if (!error
+			&& blinkenlight_api_client_test_data_from_server(blinkenlight_api_client, 0,
+					&server_cpu_start_us) != 0) {
+		fputs(blinkenlight_api_client_get_error_text(blinkenlight_api_client), stderr);
+		error = 1;
+	}
+	if (error) {
+		free(panels);
+		blinkenlight_api_client_destructor(blinkenlight_api_client);
+		return 1;
+	}
+
+	switch (params->mode) {
+	case BENCHMARK_MODE_TO_SERVER:
+		printf("Sending %u bytes to server", params->bytecount);
+		break;
+	case BENCHMARK_MODE_FROM_SERVER:
+		printf("Requesting %u bytes from server", params->bytecount);
+		break;
+	case BENCHMARK_MODE_PANELS:
+		printf("Exchanging control values of %u panel(s), %u bytes", panels_count,
+				panel_bytecount);
+		break;
+	}
+	printf(" over %s, ", params->transport);
+	if (params->rate)
+		printf("%u calls/sec, ", params->rate);
+	else
+		printf("max speed, ");
+	printf("for %u seconds ...\n", params->duration_sec);
+
+	latencies_size = 10000;
+	latencies = (unsigned *) malloc(latencies_size * sizeof(unsigned));
+	count = 0;
+	start_us = next_us = benchmark_now_us();
+	end_us = start_us + (uint64_t) params->duration_sec * 1000000;
+	do {
+		blinkenlight_api_status_t status = 0;
+		if (params->rate) {
+			// absolute schedule: a late call does not shift the following ones
+			uint64_t now_us = benchmark_now_us();
+			if (next_us > now_us)
+				benchmark_sleep_us(next_us - now_us);
+			next_us += 1000000 / params->rate;
+		}
+		call_start_us = benchmark_now_us();
+		switch (params->mode) {
+		case BENCHMARK_MODE_TO_SERVER:
+			status = blinkenlight_api_client_test_data_to_server(blinkenlight_api_client,
+					params->bytecount);
+			break;
+		case BENCHMARK_MODE_FROM_SERVER:
+			status = blinkenlight_api_client_test_data_from_server(blinkenlight_api_client,
+					params->bytecount, NULL);
+			break;
+		case BENCHMARK_MODE_PANELS:
+			benchmark_change_outputs(panels, panels_count);
+			status = blinkenlight_api_client_exchange_controls_values(blinkenlight_api_client,
+					panels, NULL, panels_count);
+			break;
+		}
+		if (status != 0) {
+			fputs(blinkenlight_api_client_get_error_text(blinkenlight_api_client), stderr);
+			error = 1;
+			break;
+		}
+		if (count == latencies_size) {
+			latencies_size *= 2;
+			latencies = (unsigned *) realloc(latencies, latencies_size * sizeof(unsigned));
+		}
+		latencies[count++] = (unsigned) (benchmark_now_us() - call_start_us);
+	} while (benchmark_now_us() < end_us);
+	end_us = benchmark_now_us();
+
+	if (!error
+			&& blinkenlight_api_client_test_data_from_server(blinkenlight_api_client, 0,
+					&server_cpu_end_us) != 0) {
+		fputs(blinkenlight_api_client_get_error_text(blinkenlight_api_client), stderr);
+		error = 1;
+	}
+
+	if (!error && count > 0) {
+		double seconds = (end_us - start_us) / 1000000.0;
+		qsort(latencies, count, sizeof(unsigned), compare_latency);
+		printf("%u calls in %0.3f sec = %0.1f calls/sec\n", count, seconds, count / seconds);
+		printf("Round trip latency [us]: min %u, 50%% %u, 90%% %u, 99%% %u, 99.9%% %u, max %u\n",
+				latencies[0], latency_percentile(latencies, count, 500),
+				latency_percentile(latencies, count, 900),
+				latency_percentile(latencies, count, 990),
+				latency_percentile(latencies, count, 999), latencies[count - 1]);
+		printf("Server CPU time: %0.3f sec = %0.1f%% load, %0.1f us per call\n",
+				(server_cpu_end_us - server_cpu_start_us) / 1000000.0,
+				100.0 * (server_cpu_end_us - server_cpu_start_us) / (end_us - start_us),
+				(double) (server_cpu_end_us - server_cpu_start_us) / count);
+	}
+
+	free(latencies);
+	free(panels);
+	blinkenlight_api_client_disconnect(blinkenlight_api_client);
+	blinkenlight_api_client_destructor(blinkenlight_api_client);
+	return error;
+}
+
+/*
+ * runtime metrics of the server
+ */
+
+static struct {
+	unsigned procnum;
+	char *name;
+} metrics_procs[] = { { 0, "NULLPROC (ping)" }, { RPC_BLINKENLIGHT_API_GETINFO, "GETINFO" }, {
+		RPC_BLINKENLIGHT_API_GETPANELINFO, "GETPANELINFO" }, {
+		RPC_BLINKENLIGHT_API_GETCONTROLINFO, "GETCONTROLINFO" }, {
+		RPC_BLINKENLIGHT_API_SETPANEL_CONTROLVALUES, "SETPANEL_CONTROLVALUES" }, {
+		RPC_BLINKENLIGHT_API_GETPANEL_CONTROLVALUES, "GETPANEL_CONTROLVALUES" }, {
+		RPC_BLINKENLIGHT_API_EXCHANGE_PANELS_CONTROLVALUES, "EXCHANGE_PANELS_CONTROLVALUES" }, {
+		RPC_BLINKENLIGHT_API_WAIT_PANEL_INPUTCONTROLS, "WAIT_PANEL_INPUTCONTROLS" }, {
+		RPC_BLINKENLIGHT_API_GETSCHEMA, "GETSCHEMA" }, { RPC_PARAM_GET, "PARAM_GET" }, {
+		RPC_PARAM_SET, "PARAM_SET" }, { RPC_TEST_DATA_TO_SERVER, "TEST_DATA_TO_SERVER" }, {
+		RPC_TEST_DATA_FROM_SERVER, "TEST_DATA_FROM_SERVER" }, { 0, NULL } };
+
+// get one metric. result: 0 = OK, else server does not know it
+static int metrics_get(unsigned param_handle, unsigned object_handle, unsigned *value)
+{
+	return blinkenlight_api_client_get_object_param(blinkenlight_api_client, value,
+			RPC_PARAM_CLASS_BUS, object_handle, param_handle) != RPC_ERR_OK;
+}
+
+static void metrics_print(void)
+{
+	blinkenlight_panel_list_t *pl = blinkenlight_api_client->panel_list;
+	unsigned i, n, calls, time_us, time_max_us, value, value2;
+	unsigned histogram[32];
+
+	printf("RPC procedure                     calls   avg [us]   max [us]\n");
+	for (i = 0; metrics_procs[i].name; i++) {
+		if (metrics_get(RPC_PARAM_HANDLE_BUS_RPC_CALLS, metrics_procs[i].procnum, &calls)
+				|| metrics_get(RPC_PARAM_HANDLE_BUS_RPC_TIME_US, metrics_procs[i].procnum,
+						&time_us)
+				|| metrics_get(RPC_PARAM_HANDLE_BUS_RPC_TIME_MAX_US, metrics_procs[i].procnum,
+						&time_max_us) || calls == 0)
+			continue;
+		printf("  %-30s %8u %10.1f %10u\n", metrics_procs[i].name, calls,
+				(double) time_us / calls, time_max_us);
+	}
+
+	if (!metrics_get(RPC_PARAM_HANDLE_BUS_MUX_PHASES, 0, &value)
+			&& !metrics_get(RPC_PARAM_HANDLE_BUS_MUX_OVERRUNS, 0, &value2)) {
+		printf("MUX phases: %u, overruns: %u", value, value2);
+		if (!metrics_get(RPC_PARAM_HANDLE_BUS_MUX_JITTER_MAX_US, 0, &value))
+			printf(", max jitter %u us", value);
+		printf("\n  jitter histogram [us]:");
+		// last bucket counts all later phase starts
+		for (n = 0; n < 32 && !metrics_get(RPC_PARAM_HANDLE_BUS_MUX_JITTER_HISTOGRAM, n, &histogram[n]);
+				n++)
+			;
+		for (i = 0; i < n; i++)
+			if (histogram[i] && i < n - 1)
+				printf(" <%u:%u", 1u << i, histogram[i]);
+			else if (histogram[i])
+				printf(" >=%u:%u", 1u << (i - 1), histogram[i]);
+		printf("\n");
+	}
+	if (!metrics_get(RPC_PARAM_HANDLE_BUS_MUX_CYCLE_MIN_US, 0, &value)
+			&& !metrics_get(RPC_PARAM_HANDLE_BUS_MUX_CYCLE_MAX_US, 0, &value2))
+		printf("MUX bus I/O per phase: %u .. %u us\n", value, value2);
+	if (!metrics_get(RPC_PARAM_HANDLE_BUS_UPDATE_CPU_MS, 0, &value))
+		printf("Update thread CPU time: %0.3f sec\n", value / 1000.0);
+	for (i = 0; i < pl->panels_count; i++)
+		if (!metrics_get(RPC_PARAM_HANDLE_BUS_HISTORY_FILL, i, &value)
+				&& !metrics_get(RPC_PARAM_HANDLE_BUS_HISTORY_OVERFLOWS, i, &value2))
+			printf("Panel %s: value history max fill %u, %u entries dropped\n",
+					pl->panels[i].name, value, value2);
+}
+
+/*
+ * Dump the metrics of the server on "hostname".
+ * interval_sec > 0: repeat forever
+ * result: 0 = OK, 1 = error
+ */
+int benchmark_metrics(char *hostname, unsigned interval_sec)
+{
+	unsigned value;
+	int error = 0;
+
+	blinkenlight_api_client = blinkenlight_api_client_constructor();
+	printf("Connecting to %s ...\n", hostname);
+	if (blinkenlight_api_client_connect(blinkenlight_api_client, hostname) != 0
+			|| blinkenlight_api_client_get_panels_and_controls(blinkenlight_api_client) != 0) {
+		fputs(blinkenlight_api_client_get_error_text(blinkenlight_api_client), stderr);
+		blinkenlight_api_client_destructor(blinkenlight_api_client);
+		return 1;
+	}
+	// older servers answer RPC_ERR_PARAM_ILL_CLASS
+	if (metrics_get(RPC_PARAM_HANDLE_BUS_RPC_CALLS, RPC_PARAM_GET, &value)) {
+		fprintf(stderr, "Server on %s has no runtime metrics.\n", hostname);
+		error = 1;
+	} else
+		do {
+			metrics_print();
+			if (interval_sec) {
+				benchmark_sleep_us((uint64_t) interval_sec * 1000000);
+				printf("\n");
+			}
+		} while (interval_sec);
+
+	blinkenlight_api_client_disconnect(blinkenlight_api_client);
+	blinkenlight_api_client_destructor(blinkenlight_api_client);
+	return error;
+}
@@ -0,0 +1,47 @@
+/* benchmark.h: load generator and latency measurement for a Blinkenlight API server
+
+   Copyright (c) 2026, agent
+   j_hoppe@t-online.de, www.retrocmp.com
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in
+   all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+   THE AUTHOR BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+   IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+   17-Oct-2026  agent   created
+*/
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+// what is transferred in each call
+#define BENCHMARK_MODE_TO_SERVER	0	// test data to server
+#define BENCHMARK_MODE_FROM_SERVER	1	// test data from server
+#define BENCHMARK_MODE_PANELS	2	// SET outputs/GET inputs of the server's panels
+
+typedef struct {
+	int mode; // BENCHMARK_MODE_*
+	char transport[8]; // "udp", "tcp", "shm"
+	unsigned bytecount; // payload for TO/FROM_SERVER
+	unsigned rate; // calls per second, 0 = as fast as possible
+	unsigned duration_sec;
+	char panelname[256]; // PANELS: only this panel, "" = all
+} benchmark_params_t;
+
+int benchmark(char *hostname, benchmark_params_t *params) ;
+int benchmark_metrics(char *hostname, unsigned interval_sec) ;
+
+#endif
@@ -0,0 +1,389 @@
+/* historybuffer_stress.c: stress test of the lock free history buffer
+
+ Copyright (c) 2026, agent
+ j_hoppe@t-online.de, www.retrocmp.com
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ THE AUTHOR BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+ 17-Oct-2026  agent   created
+
+
+ Tests the lock free historybuffer of the server against the former
+ mutex protected ring ("reference" below, as in the 2019 version):
+ 1. compare: one thread sets random values at random times and averages.
+	Both buffers must deliver the same averaged bits.
+ 2. snapshots: a writer thread sets values as fast as possible into a
+	small ring, the main thread takes snapshots. Every entry must carry
+	the value of its timestamp, entries must be contiguous.
+ 3. averaging: a writer thread sets a fixed duty cycle pattern, the main
+	thread averages concurrently. The result must be the duty cycle.
+ 4. throughput: averaging calls per second of a reader while a writer
+	runs, lock free vs. mutex. Only reported, no pass/fail.
+ Exit code 0 if all checks passed.
+
+ Linux only, needs pthreads.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "blinkenlight_panels.h"
+#include "historybuffer.h"
+
+/*
+ * reference: ring of entries under a mutex.
+ * Reader and writer exclude each other, the reader terminates the
+ * current entry and drops entries before the averaging interval.
+ */
+typedef struct
+{
+	blinkenlight_control_t *control;
+	int capacity;
+	int startpos; // first valid item in ring
+	int endpos; // next free item to write
+	historybuffer_entry_t *buffer;
+	pthread_mutex_t mutex;
+} reference_historybuffer_t;
+
+static reference_historybuffer_t *reference_create(blinkenlight_control_t *c, unsigned capacity)
+{
+	reference_historybuffer_t *_this;
+	_this = (reference_historybuffer_t *) calloc(1, sizeof(reference_historybuffer_t));
+	_this->control = c;
+	_this->capacity = (int) capacity;
+	_this->buffer = (historybuffer_entry_t *) calloc(capacity, sizeof(historybuffer_entry_t));
+	pthread_mutex_init(&_this->mutex, NULL);
+	return _this;
+}
+
+static void reference_destroy(reference_historybuffer_t *_this)
+{
+	pthread_mutex_destroy(&_this->mutex);
+	free(_this->buffer);
+	free(_this);
+}
+
+static int reference_fill(reference_historybuffer_t *_this)
+{
+	int fill = _this->endpos - _this->startpos;
+	return fill < 0 ? fill + _this->capacity : fill;
+}
+
+// entry over index. 0 = oldest
+static historybuffer_entry_t *reference_get(reference_historybuffer_t *_this, int idx)
+{
+	if (idx < 0 || idx >= reference_fill(_this))
+		return NULL;
+	return &_this->buffer[(_this->startpos + idx) % _this->capacity];
+}
+
+static void reference_set_val(reference_historybuffer_t *_this, uint64_t now_us, uint64_t value)
+{
+	historybuffer_entry_t *hbe;
+	pthread_mutex_lock(&_this->mutex);
+	if (reference_fill(_this) + 1 >= _this->capacity)
+		_this->startpos = (_this->startpos + 1) % _this->capacity; // overflow: drop oldest
+	hbe = reference_get(_this, reference_fill(_this) - 1);
+	if (hbe == NULL || hbe->value != value) {
+		if (hbe != NULL)
+			hbe->timestamp_end_us = now_us;
+		hbe = &_this->buffer[_this->endpos];
+		_this->endpos = (_this->endpos + 1) % _this->capacity;
+		hbe->timestamp_begin_us = now_us;
+		hbe->timestamp_end_us = 0;
+		hbe->value = value;
+	}
+	pthread_mutex_unlock(&_this->mutex);
+}
+
+// bit mode only
+static void reference_get_average_vals(reference_historybuffer_t *_this,
+		uint64_t averaging_interval_us, uint64_t now_us)
+{
+	historybuffer_entry_t *hbe;
+	uint64_t interval_start_us = now_us - averaging_interval_us;
+	uint64_t sum_state_durations[64];
+	uint64_t sum_durations_us = 0;
+	unsigned bitidx;
+	int idx;
+
+	memset(_this->control->averaged_value_bits, 0, sizeof(_this->control->averaged_value_bits));
+	memset(sum_state_durations, 0, sizeof(sum_state_durations));
+	pthread_mutex_lock(&_this->mutex);
+	if (reference_fill(_this) == 0) {
+		pthread_mutex_unlock(&_this->mutex);
+		return;
+	}
+	reference_get(_this, reference_fill(_this) - 1)->timestamp_end_us = now_us;
+	while ((hbe = reference_get(_this, 0)) && hbe->timestamp_end_us <= interval_start_us)
+		_this->startpos = (_this->startpos + 1) % _this->capacity;
+	// history shorter than interval: oldest value counts from interval start
+	if (hbe)
+		hbe->timestamp_begin_us = interval_start_us;
+	for (idx = 0; (hbe = reference_get(_this, idx)) != NULL; idx++) {
+		uint64_t state_starttime_us =
+				hbe->timestamp_begin_us > interval_start_us ?
+						hbe->timestamp_begin_us : interval_start_us;
+		uint64_t state_duration_us = hbe->timestamp_end_us - state_starttime_us;
+		for (bitidx = 0; bitidx < _this->control->value_bitlen; bitidx++)
+			if ((hbe->value >> bitidx) & 1)
+				sum_state_durations[bitidx] += state_duration_us;
+		sum_durations_us += state_duration_us;
+	}
+	// the reader changed the end of the current entry: reopen it
+	reference_get(_this, reference_fill(_this) - 1)->timestamp_end_us = 0;
+	pthread_mutex_unlock(&_this->mutex);
+	if (sum_durations_us > 0)
+		for (bitidx = 0; bitidx < _this->control->value_bitlen; bitidx++)
+			_this->control->averaged_value_bits[bitidx] = (255 * sum_state_durations[bitidx])
+					/ sum_durations_us;
+}
+
+static double now_sec(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// value stored for a timestamp in the snapshot test
+static uint64_t snapshot_value(uint64_t timestamp_us)
+{
+	return (timestamp_us * 0x9E3779B97F4A7C15ULL) >> 28;
+}
+
+/*** state shared with the writer threads ***/
+static historybuffer_t *writer_buffer;
+static reference_historybuffer_t *writer_reference;
+static volatile int writer_stop;
+static volatile uint64_t writer_clock_us; // last timestamp written
+
+// as fast as possible, value derived from timestamp
+static void *snapshot_writer(void *arg)
+{
+	uint64_t t = 1000;
+	unsigned r = 1;
+	while (!writer_stop) {
+		r = r * 1103515245 + 12345;
+		t += 1 + ((r >> 16) & 7);
+		historybuffer_set_val(writer_buffer, t, snapshot_value(t));
+	}
+	return NULL;
+}
+
+// every 10 us of simulated time: bit 0 on 1/4 of the time, bit 1 on 1/2.
+// paced at ~2 us real time, so the reader sees a ring which is
+// overwritten, but not outrun completely in one averaging call.
+static void *dutycycle_writer(void *arg)
+{
+	uint64_t t = 0;
+	uint64_t value;
+	double until;
+	while (!writer_stop) {
+		until = now_sec() + 2e-6;
+		while (now_sec() < until)
+			;
+		t++;
+		value = (t & 3) == 0 ? 3 : ((t & 3) == 1 ? 2 : 0);
+		if (writer_reference)
+			reference_set_val(writer_reference, t * 10, value);
+		else
+			historybuffer_set_val(writer_buffer, t * 10, value);
+		__atomic_store_n(&writer_clock_us, t * 10, __ATOMIC_RELEASE);
+	}
+	return NULL;
+}
+
+static void writer_start(pthread_t *thread, void *(*func)(void *))
+{
+	writer_stop = 0;
+	writer_clock_us = 0;
+	pthread_create(thread, NULL, func, NULL);
+}
+
+static void writer_join(pthread_t thread)
+{
+	writer_stop = 1;
+	pthread_join(thread, NULL);
+}
+
+// 1. same averages as the reference, single thread
+static unsigned test_compare(unsigned loops)
+{
+	blinkenlight_control_t c1, c2;
+	historybuffer_t *hb;
+	reference_historybuffer_t *ref;
+	uint64_t t = 1000000, v;
+	unsigned i, bitidx, errors = 0;
+
+	memset(&c1, 0, sizeof(c1));
+	memset(&c2, 0, sizeof(c2));
+	c1.value_bitlen = c2.value_bitlen = 36;
+	hb = historybuffer_create(&c1, 256);
+	ref = reference_create(&c2, 256);
+	srand(1);
+	for (i = 0; i < loops; i++) {
+		v = ((uint64_t) (rand() & 0xf) << 32) | (rand() & 0xff);
+		t += 10 + rand() % 500;
+		if (rand() % 3) {
+			historybuffer_set_val(hb, t, v);
+			reference_set_val(ref, t, v);
+		}
+		if (rand() % 4 == 0) {
+			historybuffer_get_average_vals(hb, 12345, t, 1);
+			reference_get_average_vals(ref, 12345, t);
+			if (memcmp(c1.averaged_value_bits, c2.averaged_value_bits, 36)) {
+				if (errors++ < 3) {
+					printf("  loop %u, t=%llu:", i, (unsigned long long) t);
+					for (bitidx = 0; bitidx < 36; bitidx++)
+						if (c1.averaged_value_bits[bitidx] != c2.averaged_value_bits[bitidx])
+							printf(" bit %u: %d != %d", bitidx, c1.averaged_value_bits[bitidx],
+									c2.averaged_value_bits[bitidx]);
+					printf("\n");
+				}
+			}
+		}
+	}
+	historybuffer_destroy(hb);
+	reference_destroy(ref);
+	printf("compare with reference: %u loops, %u different averages\n", loops, errors);
+	return errors;
+}
+
+// 2. snapshots consistent while the writer overwrites the ring
+static unsigned test_snapshots(double seconds)
+{
+	blinkenlight_control_t c;
+	historybuffer_entry_t entries[16];
+	pthread_t thread;
+	unsigned long long snapshots = 0, entries_count = 0;
+	unsigned i, k, n, errors = 0;
+	double end = now_sec() + seconds;
+
+	memset(&c, 0, sizeof(c));
+	writer_buffer = historybuffer_create(&c, 16);
+	writer_start(&thread, snapshot_writer);
+	while (now_sec() < end) {
+		for (k = 0; k < 10000; k++) {
+			n = historybuffer_snapshot(writer_buffer, 0, ~0ULL >> 1, entries, 16);
+			snapshots++;
+			entries_count += n;
+			for (i = 0; i < n; i++) {
+				if (entries[i].value != snapshot_value(entries[i].timestamp_begin_us))
+					errors++;
+				if (i && entries[i].timestamp_begin_us != entries[i - 1].timestamp_end_us)
+					errors++;
+			}
+		}
+	}
+	writer_join(thread);
+	historybuffer_destroy(writer_buffer);
+	printf("snapshots: %llu snapshots, %llu entries, %u inconsistent\n", snapshots, entries_count,
+			errors);
+	return errors;
+}
+
+// 3. averaging with a concurrent writer delivers the duty cycle.
+// If the reader was descheduled and the writer ran through the ring,
+// the interval is not in the buffer anymore: such calls are not checked.
+static unsigned test_averaging(double seconds)
+{
+	blinkenlight_control_t c;
+	pthread_t thread;
+	unsigned long calls = 0, overrun = 0;
+	unsigned errors = 0;
+	uint64_t now_us;
+	double end = now_sec() + seconds;
+
+	memset(&c, 0, sizeof(c));
+	c.value_bitlen = 2;
+	writer_buffer = historybuffer_create(&c, 256);
+	writer_reference = NULL;
+	writer_start(&thread, dutycycle_writer);
+	while (__atomic_load_n(&writer_clock_us, __ATOMIC_ACQUIRE) < 100000)
+		;
+	while (now_sec() < end) {
+		now_us = __atomic_load_n(&writer_clock_us, __ATOMIC_ACQUIRE);
+		historybuffer_get_average_vals(writer_buffer, 1000, now_us, 1);
+		calls++;
+		// 256 entries hold ~3400 us of the pattern
+		if (__atomic_load_n(&writer_clock_us, __ATOMIC_ACQUIRE) - now_us > 2000) {
+			overrun++;
+			continue;
+		}
+		// 1/4 = 64/255, 1/2 = 127/255
+		if (abs(c.averaged_value_bits[0] - 64) > 3 || abs(c.averaged_value_bits[1] - 127) > 3)
+			if (errors++ < 3)
+				printf("  averages %d %d\n", c.averaged_value_bits[0], c.averaged_value_bits[1]);
+	}
+	writer_join(thread);
+	historybuffer_destroy(writer_buffer);
+	printf("averaging: %lu calls, %lu overrun by writer, %u wrong\n", calls, overrun, errors);
+	return errors;
+}
+
+// 4. reader throughput with concurrent writer. is_reference: mutex version
+static double throughput(int is_reference, double seconds)
+{
+	blinkenlight_control_t c;
+	pthread_t thread;
+	unsigned long calls = 0;
+	double start = now_sec(), end = start + seconds;
+
+	memset(&c, 0, sizeof(c));
+	c.value_bitlen = 36;
+	writer_buffer = historybuffer_create(&c, 256);
+	writer_reference = is_reference ? reference_create(&c, 256) : NULL;
+	writer_start(&thread, dutycycle_writer);
+	while (__atomic_load_n(&writer_clock_us, __ATOMIC_ACQUIRE) < 100000)
+		;
+	while (now_sec() < end) {
+		uint64_t now_us = __atomic_load_n(&writer_clock_us, __ATOMIC_ACQUIRE);
+		if (is_reference)
+			reference_get_average_vals(writer_reference, 1000, now_us);
+		else
+			historybuffer_get_average_vals(writer_buffer, 1000, now_us, 1);
+		calls++;
+	}
+	writer_join(thread);
+	historybuffer_destroy(writer_buffer);
+	if (writer_reference)
+		reference_destroy(writer_reference);
+	writer_reference = NULL;
+	return calls / (now_sec() - start);
+}
+
+int main(int argc, char **argv)
+{
+	double seconds = 2; // per concurrent test
+	unsigned errors = 0;
+
+	if (argc > 1)
+		seconds = atof(argv[1]);
+	errors += test_compare(1000000);
+	errors += test_snapshots(seconds);
+	errors += test_averaging(seconds);
+	printf("throughput with concurrent writer: lock free %.0f, mutex %.0f averages/sec\n",
+			throughput(0, seconds), throughput(1, seconds));
+	printf(errors ? "FAILED\n" : "OK\n");
+	return errors ? 1 : 0;
+}
@@ -20,6 +20,8 @@
    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+   17-Oct-2026  agent   V 1.11  dump server runtime metrics: -m
+   17-Oct-2026  agent   V 1.10  benchmark mode: -bm, -bb, -br, -tr
    12-Mar-2016  JH      V 1.09  new C-like menu operators: ~, +, -, <, >
    08-Mar-2016  JH      V 1.08  better commandline processing with getopt2()
    01-Feb-2016  JH      V 1.07
@@ -38,8 +40,8 @@
 
 
 
-#define VERSION	"v1.09"
-#define COPYRIGHT_YEAR	2016
+#define VERSION	"v1.11"
+#define COPYRIGHT_YEAR	2026
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -60,6 +62,7 @@
 #endif
 
 #include "actions.h"
+#include "benchmark.h"
 #include "menus.h"
 #include "main.h"
 
@@ -70,6 +73,10 @@ blinkenlight_api_client_t *blinkenlight_api_client;
 getopt_t	getopt_parser;
 
 int arg_ping_repeat = 0;
+int arg_benchmark = 0;
+benchmark_params_t arg_benchmark_params;
+int arg_metrics = 0;
+unsigned arg_metrics_interval_sec = 0;
 char arg_cmdfilename[256];
 char arg_hostname[256];
 
@@ -115,6 +122,12 @@ static void parse_commandline(int argc, char **argv)
 	getopt_init(&getopt_parser, /*ignore_case*/1);
 	arg_cmdfilename[0] = 0;
 	arg_hostname[0] = 0;
+	arg_benchmark_params.mode = BENCHMARK_MODE_PANELS;
+	strcpy(arg_benchmark_params.transport, "udp");
+	arg_benchmark_params.bytecount = 64;
+	arg_benchmark_params.rate = 0;
+	arg_benchmark_params.duration_sec = 10;
+	arg_benchmark_params.panelname[0] = 0;
 
 	getopt_def(&getopt_parser, NULL, NULL, "hostname", NULL, NULL, "Connect to the Blinkenlight API server on <hostname>\n"
 		"<hostname> may be numerical or ar DNS name",
@@ -127,6 +140,25 @@ static void parse_commandline(int argc, char **argv)
 	getopt_def(&getopt_parser, "p", "ping", "pingcount", NULL, NULL, "Ping server on <hostname> wether he is alife.\n"
 		"There are <pingcount> tries. On error, exit status 1 is returned.",
 		"20", "Ping for 20 seconds.", NULL, NULL);
+	getopt_def(&getopt_parser, "bm", "benchmark", "mode", "seconds,panel", "10", "Run a benchmark against the server on <hostname>, then exit.\n"
+		"<mode> is \"to\": send test data, \"from\": receive test data, \"panels\": SET outputs\n"
+		"and GET inputs of all panels, or only of <panel>, in the shape configured on the server.\n"
+		"Prints round trip latency percentiles, calls per second and server CPU load.",
+		"panels 30", "Exchange control values of all panels for 30 seconds.",
+		"from", "Receive test data for 10 seconds.");
+	getopt_def(&getopt_parser, "bb", "bytecount", "bytecount", NULL, "64", "Payload size for benchmark modes \"to\" and \"from\".\n"
+		"Max 65536, over UDP the RPC library allows 8800 or less.",
+		"1024", "send 1 KByte per call", NULL, NULL);
+	getopt_def(&getopt_parser, "br", "rate", "calls_per_sec", NULL, "0", "Pace the benchmark to this much calls per second.\n"
+		"0 = send the next call as soon as the last one is answered.",
+		"50", "like a simulator updating the panel with 50 Hz", NULL, NULL);
+	getopt_def(&getopt_parser, "tr", "transport", "transport", NULL, "udp", "Transport used by the benchmark: \"udp\", \"tcp\" or\n"
+		"\"shm\" (shared memory, only for mode \"panels\" on the server host).",
+		"tcp", "use RPC over TCP", NULL, NULL);
+	getopt_def(&getopt_parser, "m", "metrics", NULL, "seconds", NULL, "Dump runtime metrics of the server on <hostname>, then exit.\n"
+		"RPC calls and times per procedure, multiplexing jitter, value history fill levels.\n"
+		"With <seconds>: dump again every <seconds>, until terminated.",
+		"5", "monitor the server every 5 seconds", NULL, NULL);
 	getopt_def(&getopt_parser, "w", "width", "columns", NULL, "132", "set screen width for display.\n"
 		"Panel controls are displayed in a table, which uses this much char columns.\n"
 		"Should be less or equal to terminal window width. Minimum 80.",
@@ -147,6 +179,54 @@ static void parse_commandline(int argc, char **argv)
 			if (getopt_arg_i(&getopt_parser, "pingcount", &arg_ping_repeat) < 0)
 				commandline_option_error();
 		}
+		else if (getopt_isoption(&getopt_parser, "benchmark")) {
+			char buff[80];
+			int n;
+			arg_benchmark = 1;
+			if (getopt_arg_s(&getopt_parser, "mode", buff, sizeof(buff)) < 0)
+				commandline_option_error();
+			if (!strcasecmp(buff, "to"))
+				arg_benchmark_params.mode = BENCHMARK_MODE_TO_SERVER;
+			else if (!strcasecmp(buff, "from"))
+				arg_benchmark_params.mode = BENCHMARK_MODE_FROM_SERVER;
+			else if (!strcasecmp(buff, "panels"))
+				arg_benchmark_params.mode = BENCHMARK_MODE_PANELS;
+			else {
+				sprintf(getopt_parser.curerrortext, "Illegal benchmark mode \"%s\"", buff);
+				commandline_option_error();
+			}
+			n = getopt_arg_i(&getopt_parser, "seconds", (int *)&arg_benchmark_params.duration_sec);
+			if (n < 0)
+				commandline_option_error();
+			if (getopt_arg_s(&getopt_parser, "panel", arg_benchmark_params.panelname,
+					sizeof(arg_benchmark_params.panelname)) < 0)
+				commandline_option_error();
+		}
+		else if (getopt_isoption(&getopt_parser, "metrics")) {
+			arg_metrics = 1;
+			if (getopt_arg_u(&getopt_parser, "seconds", &arg_metrics_interval_sec) < 0)
+				commandline_option_error();
+		}
+		else if (getopt_isoption(&getopt_parser, "bytecount")) {
+			if (getopt_arg_u(&getopt_parser, "bytecount", &arg_benchmark_params.bytecount) < 0)
+				commandline_option_error();
+		}
+		else if (getopt_isoption(&getopt_parser, "rate")) {
+			if (getopt_arg_u(&getopt_parser, "calls_per_sec", &arg_benchmark_params.rate) < 0)
+				commandline_option_error();
+		}
+		else if (getopt_isoption(&getopt_parser, "transport")) {
+			if (getopt_arg_s(&getopt_parser, "transport", arg_benchmark_params.transport,
+					sizeof(arg_benchmark_params.transport)) < 0)
+				commandline_option_error();
+			if (strcasecmp(arg_benchmark_params.transport, "udp")
+					&& strcasecmp(arg_benchmark_params.transport, "tcp")
+					&& strcasecmp(arg_benchmark_params.transport, "shm")) {
+				sprintf(getopt_parser.curerrortext, "Illegal transport \"%s\"",
+						arg_benchmark_params.transport);
+				commandline_option_error();
+			}
+		}
 		else if (getopt_isoption(&getopt_parser, "width")) {
 			if (getopt_arg_i(&getopt_parser, "columns", &arg_menu_linewidth) < 0)
 				commandline_option_error();
@@ -197,6 +277,12 @@ int main(int argc, char *argv[])
 			exit(1);
 	}
 
+	if (arg_benchmark)
+		exit(benchmark(arg_hostname, &arg_benchmark_params));
+
+	if (arg_metrics)
+		exit(benchmark_metrics(arg_hostname, arg_metrics_interval_sec));
+
 	menu_linewidth = arg_menu_linewidth;
 	inputline_init();
 	if (strlen(arg_cmdfilename) )
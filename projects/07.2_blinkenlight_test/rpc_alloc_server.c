@@ -0,0 +1,115 @@
+/* rpc_alloc_server.c: minimal Blinkenlight API server for rpc_alloc_test
+
+ Copyright (c) 2026, agent
+ j_hoppe@t-online.de, www.retrocmp.com
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ THE AUTHOR BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+ 17-Oct-2026  agent   created
+
+
+ Serves one panel "ALLOC" with 32 controls, every 4th is an input,
+ over UDP and TCP, with the dispatcher of the real server.
+ Transports are not registered with the portmapper.
+ Output on start: "<udp port> <tcp port>".
+ Every line read from stdin is answered with the count of heap
+ allocations of this process. End of stdin terminates.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <rpc/rpc.h>
+
+#include "rpc_blinkenlight_api.h"
+#include "blinkenlight_panels.h"
+#include "blinkenlight_api_server_procs.h"
+#include "blinkenlight_api_server_reactor.h"
+#include "alloc_count.h"
+
+#define CONTROLS_COUNT	32
+
+// referenced by blinkenlight_api_server_procs.c, usually from print.c
+int print_level = 0;
+
+void print(int level, const char *format, ...)
+{
+}
+
+static void panel_create(void)
+{
+	blinkenlight_panel_t *p;
+	blinkenlight_control_t *c;
+	unsigned i;
+
+	blinkenlight_panel_list = blinkenlight_panels_constructor();
+	p = blinkenlight_add_panel(blinkenlight_panel_list);
+	strcpy(p->name, "ALLOC");
+	for (i = 0; i < CONTROLS_COUNT; i++) {
+		c = blinkenlight_add_control(blinkenlight_panel_list, p);
+		sprintf(c->name, "CONTROL_%02u", i);
+		c->type = (i % 4 == 0) ? input_switch : output_lamp;
+		c->value_bitlen = 16;
+		c->value = 0x100 + i;
+	}
+	blinkenlight_panels_config_fixup(blinkenlight_panel_list);
+}
+
+int main(int argc, char **argv)
+{
+	SVCXPRT *udp_transp, *tcp_transp;
+	fd_set readfds;
+	char line[80];
+
+	panel_create();
+	udp_transp = svcudp_create(RPC_ANYSOCK);
+	tcp_transp = svctcp_create(RPC_ANYSOCK, 0, 0);
+	if (udp_transp == NULL || tcp_transp == NULL) {
+		fprintf(stderr, "cannot create transports\n");
+		return 1;
+	}
+	svc_register(udp_transp, BLINKENLIGHTD, BLINKENLIGHTD_VERS, blinkenlight_api_server_dispatch, 0);
+	svc_register(tcp_transp, BLINKENLIGHTD, BLINKENLIGHTD_VERS, blinkenlight_api_server_dispatch, 0);
+	// every request is served in this thread
+	blinkenlight_api_reactor_workers = 0;
+	printf("%u %u\n", udp_transp->xp_port, tcp_transp->xp_port);
+	fflush(stdout);
+
+	for (;;) {
+		readfds = svc_fdset;
+		FD_SET(STDIN_FILENO, &readfds);
+		if (select(FD_SETSIZE, &readfds, NULL, NULL, NULL) < 0) {
+			if (errno == EINTR)
+				continue;
+			perror("select");
+			return 1;
+		}
+		if (FD_ISSET(STDIN_FILENO, &readfds)) {
+			FD_CLR(STDIN_FILENO, &readfds);
+			if (fgets(line, sizeof(line), stdin) == NULL)
+				return 0; // test client terminated
+			printf("%lu\n", alloc_count);
+			fflush(stdout);
+		}
+		svc_getreqset(&readfds);
+	}
+}
@@ -0,0 +1,200 @@
+/* rpc_alloc_test.c: heap allocations per value transfer of client and server
+
+ Copyright (c) 2026, agent
+ j_hoppe@t-online.de, www.retrocmp.com
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ THE AUTHOR BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+ 17-Oct-2026  agent   created
+
+
+ Value transfers between a simulator and the server run at frame rate
+ and must not allocate heap memory, neither in the client nor in the
+ server. This test starts rpc_alloc_server as child process, then
+ over UDP and over TCP:
+ - warm up: panels are queried, 1000 transfer cycles
+ - 10000 transfer cycles, allocations counted in both processes.
+ A cycle is an EXCHANGE with a changed output (delta), every 7th
+ cycle with complete outputs, every 10th cycle followed by separate
+ GET and SET calls.
+ Exit code 0 if no cycle allocated memory.
+
+ Linux/glibc only.
+ call: rpc_alloc_test <path of rpc_alloc_server>
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <arpa/inet.h>
+#include <rpc/rpc.h>
+
+#include "rpc_blinkenlight_api.h"
+#include "blinkenlight_panels.h"
+#include "blinkenlight_api_client.h"
+#include "alloc_count.h"
+
+#define WARMUP_CYCLES	1000
+#define TEST_CYCLES	10000
+
+static FILE *server_in, *server_out; // pipes to child
+
+// start server, result: its ports
+static int server_start(char *path, pid_t *pid, unsigned *udp_port, unsigned *tcp_port)
+{
+	int to_server[2], from_server[2];
+
+	if (pipe(to_server) || pipe(from_server))
+		return -1;
+	*pid = fork();
+	if (*pid < 0)
+		return -1;
+	if (*pid == 0) {
+		dup2(to_server[0], STDIN_FILENO);
+		dup2(from_server[1], STDOUT_FILENO);
+		close(to_server[1]);
+		close(from_server[0]);
+		execl(path, path, (char *) NULL);
+		perror(path);
+		_exit(1);
+	}
+	close(to_server[0]);
+	close(from_server[1]);
+	server_in = fdopen(to_server[1], "w");
+	server_out = fdopen(from_server[0], "r");
+	if (fscanf(server_out, "%u %u", udp_port, tcp_port) != 2)
+		return -1;
+	return 0;
+}
+
+// allocations of the server process so far
+static unsigned long server_alloc_count(void)
+{
+	unsigned long count = 0;
+	fputs("count\n", server_in);
+	fflush(server_in);
+	if (fscanf(server_out, "%lu", &count) != 1)
+		fprintf(stderr, "server does not answer\n");
+	return count;
+}
+
+// connect without portmapper. is_tcp: 0 = UDP, 1 = TCP
+static blinkenlight_api_client_t *client_connect(unsigned port, int is_tcp)
+{
+	blinkenlight_api_client_t *c;
+	struct sockaddr_in addr;
+	struct timeval timeout = { 1, 0 };
+	int sock = RPC_ANYSOCK;
+
+	c = blinkenlight_api_client_constructor();
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+	addr.sin_port = htons(port);
+	if (is_tcp)
+		c->rpc_client = clnttcp_create(&addr, BLINKENLIGHTD, BLINKENLIGHTD_VERS, &sock, 0, 0);
+	else
+		c->rpc_client = clntudp_create(&addr, BLINKENLIGHTD, BLINKENLIGHTD_VERS, timeout, &sock);
+	if (c->rpc_client == NULL) {
+		clnt_pcreateerror("127.0.0.1");
+		return NULL;
+	}
+	c->rpc_server_hostname = strdup("127.0.0.1");
+	c->rpc_protocol = is_tcp ? "tcp" : "udp";
+	c->connected = 1;
+	if (blinkenlight_api_client_get_panels_and_controls(c)) {
+		fprintf(stderr, "%s\n", blinkenlight_api_client_get_error_text(c));
+		return NULL;
+	}
+	return c;
+}
+
+static int transfer_cycle(blinkenlight_api_client_t *c, blinkenlight_panel_t *p, unsigned n)
+{
+	int set_outputs = 1;
+
+	p->controls[1].value = n & 0xff;
+	if (n % 7 == 0)
+		p->outputs_delta_valid = 0; // send complete outputs
+	if (blinkenlight_api_client_exchange_controls_values(c, &p, &set_outputs, 1))
+		return -1;
+	if (n % 10 == 0)
+		if (blinkenlight_api_client_get_inputcontrols_values(c, p)
+				|| blinkenlight_api_client_set_outputcontrols_values(c, p))
+			return -1;
+	return 0;
+}
+
+// result: 0 = no allocations
+static int test_transport(unsigned port, int is_tcp)
+{
+	char *name = is_tcp ? "TCP" : "UDP";
+	blinkenlight_api_client_t *c;
+	blinkenlight_panel_t *p;
+	unsigned long client_allocs, server_allocs;
+	unsigned n;
+
+	c = client_connect(port, is_tcp);
+	if (c == NULL)
+		return -1;
+	p = &c->panel_list->panels[0];
+	for (n = 0; n < WARMUP_CYCLES; n++)
+		if (transfer_cycle(c, p, n))
+			goto error;
+	server_allocs = server_alloc_count();
+	client_allocs = alloc_count;
+	for (n = 0; n < TEST_CYCLES; n++)
+		if (transfer_cycle(c, p, n))
+			goto error;
+	client_allocs = alloc_count - client_allocs;
+	server_allocs = server_alloc_count() - server_allocs;
+	printf("%s: %lu client and %lu server allocations in %u cycles\n", name, client_allocs,
+			server_allocs, TEST_CYCLES);
+	return (client_allocs || server_allocs) ? -1 : 0;
+error:
+	fprintf(stderr, "%s: %s\n", name, blinkenlight_api_client_get_error_text(c));
+	return -1;
+}
+
+int main(int argc, char **argv)
+{
+	pid_t pid;
+	unsigned udp_port, tcp_port;
+	int errors = 0;
+
+	if (argc < 2) {
+		fprintf(stderr, "call: %s <path of rpc_alloc_server>\n", argv[0]);
+		return 2;
+	}
+	if (server_start(argv[1], &pid, &udp_port, &tcp_port)) {
+		fprintf(stderr, "cannot start %s\n", argv[1]);
+		return 1;
+	}
+	if (test_transport(udp_port, 0))
+		errors++;
+	if (test_transport(tcp_port, 1))
+		errors++;
+	fclose(server_in); // server terminates
+	waitpid(pid, NULL, 0);
+	printf(errors ? "FAILED\n" : "OK\n");
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+/* wiring_plan_bench.c: BlinkenBus wiring plans against interpreted wirings
+
+ Copyright (c) 2026, agent
+ j_hoppe@t-online.de, www.retrocmp.com
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ THE AUTHOR BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+ 17-Oct-2026  agent   created
+
+
+ blinkenlight_panels_config_fixup() compiles the register wirings of
+ a control into a "wiring plan". blinkenbus.c uses the plan to scatter
+ output values into the register cache and to gather input values,
+ and falls back to interpreting the wirings if there is no plan.
+ This test builds random controls: 1..6 registers per control, partial
+ register bit fields, gaps, active low levels and mirrored bit order.
+ For random values, both ways must produce the same register cache and
+ the same input values. Then the time per control is measured for both
+ ways, for mixed and for only mirrored controls.
+ Exit code 0 if plan and interpreter agree.
+
+ Links blinkenbus.c of the server, the register cache is never written
+ to the bus.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "bitcalc.h"
+#include "blinkenlight_panels.h"
+#include "blinkenbus.h"
+
+#define CONTROLS_COUNT	60
+#define COMPARE_LOOPS	200000
+#define BENCH_LOOPS	1000000
+
+// globals of the server's main.c, referenced by blinkenbus.c
+blinkenlight_panel_list_t *blinkenlight_panel_list;
+int mode_test;
+int mode_panelsim;
+
+static blinkenbus_map_t cache_plan, cache_interpreted;
+
+static double now_sec(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t random_value(void)
+{
+	return ((uint64_t) rand() << 33) ^ ((uint64_t) rand() << 10) ^ rand();
+}
+
+// panel with random controls. all_mirrored: 0 = 1/3 of the controls mirrored
+static blinkenlight_panel_t *panel_create(blinkenlight_panel_list_t *pl, int all_mirrored)
+{
+	blinkenlight_panel_t *p;
+	blinkenlight_control_t *c;
+	blinkenlight_control_blinkenbus_register_wiring_t *bbrw;
+	unsigned i, i_register_wiring, offset, lsb;
+
+	p = blinkenlight_add_panel(pl);
+	for (i = 0; i < CONTROLS_COUNT; i++) {
+		c = blinkenlight_add_control(pl, p);
+		sprintf(c->name, "CONTROL_%02u", i);
+		c->type = output_lamp;
+		c->mirrored_bit_order = all_mirrored || (rand() % 3 == 0);
+		c->blinkenbus_register_wiring_count = 1 + rand() % 6;
+		offset = 0;
+		for (i_register_wiring = 0; i_register_wiring < c->blinkenbus_register_wiring_count;
+				i_register_wiring++) {
+			bbrw = &c->blinkenbus_register_wiring[i_register_wiring];
+			lsb = rand() % 8;
+			bbrw->blinkenbus_lsb = lsb;
+			bbrw->blinkenbus_msb = lsb + rand() % (8 - lsb);
+			bbrw->control_value_bit_offset = offset;
+			offset += bbrw->blinkenbus_msb - lsb + 1 + (rand() % 4 == 0); // some gaps
+			bbrw->blinkenbus_board_address = rand() % 30;
+			bbrw->board_register_address = rand() % 16;
+			bbrw->blinkenbus_levels_active_low = rand() & 1;
+		}
+	}
+	blinkenlight_panels_config_fixup(pl);
+	return p;
+}
+
+// same results with and without plan. result: count of differences
+static unsigned compare(blinkenlight_panel_t *p)
+{
+	blinkenlight_control_t *c;
+	uint64_t value, value_plan;
+	unsigned i, errors = 0;
+
+	for (i = 0; i < p->controls_count; i++)
+		if (!p->controls[i].wiring_plan_valid) {
+			printf("  control %u: no wiring plan\n", i);
+			errors++;
+		}
+	memcpy(cache_interpreted, cache_plan, sizeof(cache_plan));
+	for (i = 0; i < COMPARE_LOOPS; i++) {
+		c = &p->controls[i % p->controls_count];
+		value = random_value();
+		// output
+		blinkenbus_outputcontrol_to_cache(cache_plan, c, value);
+		c->wiring_plan_valid = 0;
+		blinkenbus_outputcontrol_to_cache(cache_interpreted, c, value);
+		c->wiring_plan_valid = 1;
+		if (memcmp(cache_plan, cache_interpreted, sizeof(cache_plan))) {
+			if (errors++ < 3)
+				printf("  control %u: output to cache differs\n", c->index);
+			memcpy(cache_plan, cache_interpreted, sizeof(cache_plan));
+		}
+		// input, from a cache with some random register changes
+		cache_plan[rand() % sizeof(cache_plan)] = rand();
+		blinkenbus_inputcontrol_from_cache(cache_plan, c, 0);
+		value_plan = c->value;
+		c->wiring_plan_valid = 0;
+		blinkenbus_inputcontrol_from_cache(cache_plan, c, 0);
+		c->wiring_plan_valid = 1;
+		if (value_plan != c->value)
+			if (errors++ < 3)
+				printf("  control %u: input from cache %llx != %llx\n", c->index,
+						(unsigned long long) value_plan, (unsigned long long) c->value);
+		memcpy(cache_interpreted, cache_plan, sizeof(cache_plan));
+	}
+	return errors;
+}
+
+// ns per control. use_plan: 0 = interpreted
+static void bench(blinkenlight_panel_t *p, int use_plan, double *output_ns, double *input_ns)
+{
+	unsigned i;
+	double start;
+
+	for (i = 0; i < p->controls_count; i++)
+		p->controls[i].wiring_plan_valid = use_plan;
+	start = now_sec();
+	for (i = 0; i < BENCH_LOOPS; i++)
+		blinkenbus_outputcontrol_to_cache(cache_plan, &p->controls[i % p->controls_count],
+				i * 0x123456789ULL);
+	*output_ns = (now_sec() - start) * 1e9 / BENCH_LOOPS;
+	start = now_sec();
+	for (i = 0; i < BENCH_LOOPS; i++)
+		blinkenbus_inputcontrol_from_cache(cache_plan, &p->controls[i % p->controls_count], 0);
+	*input_ns = (now_sec() - start) * 1e9 / BENCH_LOOPS;
+	for (i = 0; i < p->controls_count; i++)
+		p->controls[i].wiring_plan_valid = 1;
+}
+
+int main(void)
+{
+	blinkenlight_panel_list_t *pl;
+	blinkenlight_panel_t *p;
+	double plan_output_ns, plan_input_ns, interpreted_output_ns, interpreted_input_ns;
+	unsigned errors = 0;
+	int all_mirrored;
+
+	srand(5);
+	pl = blinkenlight_panels_constructor();
+	for (all_mirrored = 0; all_mirrored <= 1; all_mirrored++) {
+		char *name = all_mirrored ? "mirrored" : "mixed";
+		p = panel_create(pl, all_mirrored);
+		errors += compare(p);
+		bench(p, 1, &plan_output_ns, &plan_input_ns);
+		bench(p, 0, &interpreted_output_ns, &interpreted_input_ns);
+		printf("%-8s controls: output %.1f ns, input %.1f ns per control with plan,\n", name,
+				plan_output_ns, plan_input_ns);
+		printf("%-8s           output %.1f ns, input %.1f ns interpreted\n", "",
+				interpreted_output_ns, interpreted_input_ns);
+	}
+	printf("compare: %u differences\n", errors);
+	printf(errors ? "FAILED\n" : "OK\n");
+	return errors ? 1 : 0;
+}
@@ -20,6 +20,9 @@
  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+ 17-Oct-2026  agent lamp rows: write only changed row data, dark rows not selected.
+                    Switch scan rate boosted after switch activity
+ 17-Oct-2026  agent MUX rounds on absolute deadlines (rtsched.c), switch rows read one round later
  20-Sep-2016  JH    Switch polling through history-based low pass
                     Lamp flicker reduction through 50Hz low pass
  04-Aug-2016  JH    Switch polling with reduced frequency, to supress contact bounce
@@ -42,6 +45,25 @@
  indicator-MUX signal and switches 30V OFF if the MUX pattern is
  lighting a row more than 50 millisconds.
 
+ Bus load:
+ All lamp rows share the data registers OUT6, OUT8..10, so row data must be
+ rewritten when the row changes. The BlinkenBus write is the expensive part of
+ a mux round, so it is avoided where possible:
+ - iopattern.c tells per row whether its caches changed ("generation"),
+   in which brightness phases some lamp is ON, and whether all phases are equal.
+ - A row which is dark in the current phase is not selected (mux code 0),
+   the data registers keep their content.
+ - If the data registers already hold the row data, only the mux code is written.
+   Else only registers different from the last written state go over the bus.
+ - Rows without brightness detail always show phase 0, so a static display of
+   one lit row needs no data writes at all.
+ Every row keeps its fixed time slot, as the slot share is the lamp brightness.
+ The full data is rewritten every 1000 rounds.
+
+ Switches are scanned with 30 Hz, and with GPIO_SWITCH_BOOST_FACTOR times
+ that rate for GPIO_SWITCH_BOOST_MS after a switch changed, to follow
+ fast operator input.
+
  */
 
 #define _GPIO_C_
@@ -58,14 +80,15 @@
 #include "gpio.h"
 
 static blinkenbus_map_t blinkenbus_input_cache;
+// value_raw of all controls at last scan of their row, to detect switch activity
+static uint64_t switch_value_raw_prev[MAX_BLINKENLIGHT_PANEL_CONTROLS];
 
-static void microsleep(unsigned microsecs)
-{
-    struct timespec ts;
-    ts.tv_sec = 0;
-    ts.tv_nsec = 1000 * microsecs;
-    nanosleep(&ts, NULL);
-}
+rtsched_t gpio_mux_sched;
+
+// lamp row statistics, for "get_info" display
+volatile unsigned gpio_mux_rows_written; // row data written to BlinkenBoard
+volatile unsigned gpio_mux_rows_latched; // row data already in registers
+volatile unsigned gpio_mux_rows_dark; // row not selected
 
 // write mux to BlinkenBoard #0, OUT7, Bits 7:5
 static void write_indicator_mux_code(unsigned mux_code)
@@ -86,16 +109,19 @@ static void write_switch_mux_code(unsigned mux_code)
 //
 // Limitation: A control value is completely assembled from the same cache
 // and can not span several MUX rows.
+//
+// result: 1, if any raw switch value of the row changed
 
-static void inputcontrols_from_mux_row(unsigned mux_code)
+static int inputcontrols_from_mux_row(unsigned mux_code)
 {
     uint64_t now_us;
     unsigned i_control;
     blinkenlight_control_t *c;
     unsigned c_muxcode;
+    int changed = 0;
 
     if (mux_code == 0)
-        return;
+        return 0;
     now_us = historybuffer_now_us();
 
     // todo: LOCK?
@@ -172,12 +198,17 @@ static void inputcontrols_from_mux_row(unsigned mux_code)
         c_muxcode = c->blinkenbus_register_wiring[0].mux_code;
 
         if (mux_code == c_muxcode && c->is_input) {
+            if (c->value_raw != switch_value_raw_prev[i_control]) {
+                switch_value_raw_prev[i_control] = c->value_raw;
+                changed = 1;
+            }
             if (c->fmax > 0)
                 historybuffer_set_val(c->history, now_us, c->value_raw);
             else
                 c->value = c->value_raw; // no filtering
         }
     }
+    return changed;
 }
 
 /***********************************************
@@ -198,7 +229,17 @@ void gpio_mux(int * terminate)
     unsigned regaddr;
 
     unsigned switch_prescaler_val;
+    unsigned switch_boost_prescaler_val;
+    unsigned switch_boost_rounds; // boosted switch scans, counts down
+    unsigned switch_scan_rounds; // rounds since last switch scan
+    unsigned switch_scans; // switch row counter
 //    unsigned switch_prescaler = 0;
+    unsigned pending_switch_mux_code; // switch row selected last round, read now
+
+    // what the lamp data registers hold now
+    unsigned latched_mux_code; // 0 = unknown
+    unsigned latched_brightness_phase;
+    unsigned latched_generation;
 
 // default
     if (opt_mux_frequency)
@@ -218,8 +259,13 @@ void gpio_mux(int * terminate)
      switch_prescaler_val * mux_sleep_us);
      */
     switch_prescaler_val = opt_mux_frequency / 30; //  poll switches with 30 Hz
-    print(LOG_NOTICE, "Switch multiplexing period = 30 Hz = %u us.\n",
-            switch_prescaler_val * mux_sleep_us);
+    if (switch_prescaler_val == 0)
+        switch_prescaler_val = 1;
+    switch_boost_prescaler_val = switch_prescaler_val / GPIO_SWITCH_BOOST_FACTOR;
+    if (switch_boost_prescaler_val == 0)
+        switch_boost_prescaler_val = 1;
+    print(LOG_NOTICE, "Switch multiplexing period = 30 Hz = %u us, after activity %u us.\n",
+            switch_prescaler_val * mux_sleep_us, switch_boost_prescaler_val * mux_sleep_us);
 
     blinkenbus_init();
 
@@ -261,19 +307,36 @@ void gpio_mux(int * terminate)
     }
 #endif
 
+    rtsched_init(&gpio_mux_sched, "MUX");
+    pending_switch_mux_code = 0;
+    switch_boost_rounds = 0;
+    switch_scan_rounds = 0;
+    switch_scans = 0;
+    latched_mux_code = 0;
+    latched_brightness_phase = 0;
+    latched_generation = 0;
     rounds = 0;
     while (!*terminate) {
         unsigned lamp_brightness_phase;
         unsigned lamp_mux_phase;
         unsigned switch_mux_phase;
         unsigned mux_code;
+        iopattern_row_t *row;
+        unsigned row_generation;
+
+        // every round lasts exactly one mux period, independent of the work done in it.
+        // the ATmega samples the MUX signal with 10kHz,
+        // we must generated here max of that half frequency.
+        rtsched_phase(&gpio_mux_sched, 1000 * mux_sleep_us);
 
         rounds = (rounds + 1) & 0x7ffffff; // inc global clock
         // on roll around, output mux/poll order is disturbed ... so what?
 
         // 1. set board #0 control register periodically to "outputs enabled"
-        if (rounds % 1000) {
+        // and rewrite all lamp data once
+        if (rounds % 1000 == 0) {
             blinkenbus_board_control_write(0, 0);
+            latched_mux_code = 0;
         }
 
         // 2. drive lamp row. Option: distribute "ON" phases evenly
@@ -297,19 +360,50 @@ void gpio_mux(int * terminate)
             mux_code = 0; // all off
         }
 
-        write_indicator_mux_code(mux_code);
-
-        // TODO: LAMPTEST logic in iopattern.c::iopattern_update_outputs()
-        blinkenbus_cache_to_blinkenboards_outputs(
-                blinkenbus_output_caches[lamp_brightness_phase][mux_code], /* force_all*/1);
+        row = &iopattern_rows[mux_code];
+        // generation before cache: a cache changing while written is rewritten next time
+        row_generation = row->generation;
+        if (!(row->lit_phases & (1 << lamp_brightness_phase))) {
+            // no lamp ON: select no row, data registers stay as they are
+            write_indicator_mux_code(0);
+            gpio_mux_rows_dark++;
+        } else {
+            if (row->is_static)
+                lamp_brightness_phase = 0; // all phases equal: stay on one cache
+            write_indicator_mux_code(mux_code);
+            if (mux_code == latched_mux_code && lamp_brightness_phase == latched_brightness_phase
+                    && row_generation == latched_generation)
+                gpio_mux_rows_latched++;
+            else {
+                // TODO: LAMPTEST logic in iopattern.c::iopattern_update_outputs()
+                // only registers different from the last written state
+                blinkenbus_cache_to_blinkenboards_outputs(
+                        blinkenbus_output_caches[lamp_brightness_phase][mux_code],
+                        /* force_all*/latched_mux_code == 0);
+                latched_mux_code = mux_code;
+                latched_brightness_phase = lamp_brightness_phase;
+                latched_generation = row_generation;
+                gpio_mux_rows_written++;
+            }
+        }
 
         // outputcontrols_to_mux_row(mux_code);
 
-        if (rounds % switch_prescaler_val != 0) {
-            microsleep(mux_sleep_us); // do not set lamp rows too fast after another
-        } else {
-            // poll switches with reduced frequency
-            switch_mux_phase = (rounds / switch_prescaler_val) % 3;
+        if (pending_switch_mux_code) {
+            // 3.2. read the switch row selected last round, mux has settled a whole period
+            if (inputcontrols_from_mux_row(pending_switch_mux_code))
+                switch_boost_rounds = (opt_mux_frequency * GPIO_SWITCH_BOOST_MS) / 1000;
+            pending_switch_mux_code = 0;
+        }
+
+        // poll switches with reduced frequency, faster after activity
+        if (switch_boost_rounds)
+            switch_boost_rounds--;
+        switch_scan_rounds++;
+        if (switch_scan_rounds >= (switch_boost_rounds ?
+                switch_boost_prescaler_val : switch_prescaler_val)) {
+            switch_scan_rounds = 0;
+            switch_mux_phase = switch_scans++ % 3;
 //            print(LOG_NOTICE, " %d\n", switch_mux_phase) ;
 
             // poll switches for 3 phases = prescaler 2,1,0
@@ -331,17 +425,9 @@ void gpio_mux(int * terminate)
             // 3.1. assemble switch values from BlinkenBoard input registers
             // from control&wiring struct
             // muxcode = 0: no-op
-            if (mux_code)
-                write_switch_mux_code(mux_code);
-
-            // 4. thread wait 1 millisecond
-            // the ATmega samples the MUX signal with 10kHz,
-            // we must generated here max of that half frequency.
-            microsleep(mux_sleep_us);
-
             if (mux_code) {
-                // 3.2. read delayed, after mux has settled
-                inputcontrols_from_mux_row(mux_code);
+                write_switch_mux_code(mux_code);
+                pending_switch_mux_code = mux_code;
             }
         }
     }
@@ -21,6 +21,8 @@
    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 
+   17-Oct-2026  agent   switch scan boost, lamp row statistics
+   17-Oct-2026  agent   gpio_mux_sched
    25-May-2016  JH      created
 */
 
@@ -37,11 +39,17 @@
 #include <unistd.h>
 #include <fcntl.h> // extra
 
+#include "rtsched.h"
+
 #define SWITCH_LOWPASS_FREQUENCY    10
 // MAX_BLINKENLIGHT_HISTORY_ENTRIES in history buffer,
 // updated with thread polling freqency !
 // f=10Hz -> 100ms intervall -> 100 buffer entries used at 1 kHz -> OK
 
+// after a switch changed, scan switches this much faster for some time
+#define GPIO_SWITCH_BOOST_FACTOR    4
+#define GPIO_SWITCH_BOOST_MS    500
+
 // multiplexer codes
 #define MUX1    1   // gives some optical structure
 #define MUX2    2
@@ -55,6 +63,10 @@
 
 
 #ifndef _GPIO_C_
+extern rtsched_t gpio_mux_sched;
+extern volatile unsigned gpio_mux_rows_written;
+extern volatile unsigned gpio_mux_rows_latched;
+extern volatile unsigned gpio_mux_rows_dark;
 #endif
 
 
@@ -20,6 +20,7 @@
  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+ 17-Oct-2026  agent   per mux row change tracking: iopattern_rows[]
  17-Sep-2016  JH      created
 
 
@@ -34,6 +35,10 @@
  transfered to the driver in optimized way.
  For 16 brightness levels there are 16 mux phases,
  each contains one on/off state of all controls.
+
+ After each update the state of every mux row is published in iopattern_rows[]:
+ a row "generation" counter changes only if any of its phase caches changed,
+ so the mux thread knows which row data is already latched in the BlinkenBoard.
  */
 
 #define IOPATTERN_C_
@@ -42,6 +47,7 @@
 #include <time.h>
 #include <pthread.h>
 #include <assert.h>
+#include <string.h>
 
 #include "print.h"
 
@@ -57,6 +63,11 @@
 //      waste space to get speed
 blinkenbus_map_t blinkenbus_output_caches[IOPATTERN_OUTPUT_PHASES][MAX_MUX_CODE + 1];
 
+iopattern_row_t iopattern_rows[MAX_MUX_CODE + 1];
+
+// caches of the previous update, to detect changed rows
+static blinkenbus_map_t blinkenbus_output_caches_prev[IOPATTERN_OUTPUT_PHASES][MAX_MUX_CODE + 1];
+
 /*
  * low frequency thread sets brightnesses
  */
@@ -125,6 +136,40 @@ static uint64_t panel_mode_control_value(blinkenlight_control_t *c, uint64_t val
     return value; // default: unchanged
 }
 
+/*
+ * compare the new phase caches of all mux rows with the previous ones,
+ * publish changes and row properties to the mux thread.
+ * lit_phases[]: phases in which any output control of a row is not 0
+ */
+static void iopattern_rows_update(unsigned *lit_phases)
+{
+    unsigned mux_code;
+    unsigned phase;
+
+    for (mux_code = 0; mux_code <= MAX_MUX_CODE; mux_code++) {
+        iopattern_row_t *row = &iopattern_rows[mux_code];
+        int changed = 0;
+        int is_static = 1;
+
+        for (phase = 0; phase < IOPATTERN_OUTPUT_PHASES; phase++) {
+            unsigned char *cache = blinkenbus_output_caches[phase][mux_code];
+            if (memcmp(cache, blinkenbus_output_caches_prev[phase][mux_code],
+                    sizeof(blinkenbus_map_t))) {
+                memcpy(blinkenbus_output_caches_prev[phase][mux_code], cache,
+                        sizeof(blinkenbus_map_t));
+                changed = 1;
+            }
+            if (phase > 0 && memcmp(cache, blinkenbus_output_caches[0][mux_code],
+                    sizeof(blinkenbus_map_t)))
+                is_static = 0;
+        }
+        row->lit_phases = lit_phases[mux_code];
+        row->is_static = is_static;
+        if (changed)
+            row->generation++;
+    }
+}
+
 /****************************************
  * This thread calculates the blinkenbus_output_caches[phase][muxrow]
  * from averaged control values.
@@ -138,6 +183,7 @@ void *iopattern_update_outputs(void *arg)
     uint64_t now_us;
     unsigned i_panel;
     unsigned i_control;
+    unsigned lit_phases[MAX_MUX_CODE + 1];
 
     do { // at least one cycle, for non-thread call
         struct timespec wait;
@@ -151,6 +197,7 @@ void *iopattern_update_outputs(void *arg)
 
         // output mount bits for all panels, all controls and all phases
         // into phase cache page
+        memset(lit_phases, 0, sizeof(lit_phases));
 
         for (i_control = 0; i_control < p->controls_count; i_control++) {
             blinkenlight_control_t *c = &p->controls[i_control];
@@ -166,6 +213,8 @@ void *iopattern_update_outputs(void *arg)
             if (c->fmax == 0) {
                 uint64_t value = panel_mode_control_value(c, c->value);
                 // no averaging: brightness only 0 or 1, all phases identical
+                if (value)
+                    lit_phases[c_muxcode] = (1 << IOPATTERN_OUTPUT_PHASES) - 1;
                 for (phase = 0; phase < IOPATTERN_OUTPUT_PHASES; phase++) {
                     blinkenbus_outputcontrol_to_cache(blinkenbus_output_caches[phase][c_muxcode], c,
                             value);
@@ -202,12 +251,15 @@ void *iopattern_update_outputs(void *arg)
 
                     // override low passed pattern by lamp test
                     value = panel_mode_control_value(c, value);
+                    if (value)
+                        lit_phases[c_muxcode] |= 1 << phase;
 
                     blinkenbus_outputcontrol_to_cache(blinkenbus_output_caches[phase][c_muxcode], c,
                             value);
                 }
             }
         }
+        iopattern_rows_update(lit_phases);
     } while (*terminate == 0);
     return 0;
 }
@@ -20,6 +20,7 @@
  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+ 17-Oct-2026  agent   per mux row change tracking for gpio_mux()
  17-Sep-2016  JH      created
  */
 #ifndef IOPATTERN_H_
@@ -33,7 +34,15 @@
 #define IOPATTERN_OUTPUT_BRIGHTNESS_LEVELS   16  // brightness levels. Not changeable without code rework
 #define IOPATTERN_OUTPUT_PHASES   15
 
+// state of a lamp mux row over all output phases, written by iopattern thread
+typedef struct {
+    volatile unsigned generation; // incremented when any phase cache of the row changed
+    volatile unsigned lit_phases; // bit mask: phases in which some lamp of the row is ON
+    volatile int is_static; // all phases identical: the row has no brightness detail
+} iopattern_row_t;
+
 #ifndef IOPATTERN_C_
+extern iopattern_row_t iopattern_rows[MAX_MUX_CODE + 1];
 extern blinkenbus_map_t blinkenbus_output_caches[IOPATTERN_OUTPUT_PHASES][MAX_MUX_CODE+1];
 //extern blinkenbus_map_t blinkenbus_input_cache;
 //extern unsigned long blinkenbus_min_cycle_time_ns, blinkenbus_max_cycle_time_ns ;
@@ -20,6 +20,12 @@
  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+ 17-Oct-2026  agent option -rw: RPC worker threads
+ 17-Oct-2026  agent runtime metrics over RPC_PARAM_CLASS_BUS
+ 17-Oct-2026  agent lamp row write statistics in get_info
+ 17-Oct-2026  agent options -mc, -mw: MUX thread CPU and busy wait, MUX jitter in get_info
+ 17-Oct-2026  agent shared memory image for clients on the same host
+ 17-Oct-2026  agent answer input change subscriptions in main loop
  20-Sep-2016  JH    Switch polling through history-based low pass
                     Lamp flicker reduction through 50Hz low pass thread
  04-Aug-2016  JH    Switch polling with reduced frequency, to supress contact bounce
@@ -62,6 +68,7 @@
 
 #include "blinkenlight_panels.h"
 #include "blinkenlight_api_server_procs.h"
+#include "blinkenlight_api_server_reactor.h"
 
 ///// for Blinkenlight API server
 #include "rpc_blinkenlight_api.h"
@@ -202,13 +209,18 @@ static void on_blinkenlight_api_panel_set_mode(blinkenlight_panel_t *p, int new_
 
 static char *on_blinkenlight_api_get_info()
 {
-    static char buffer[1024];
+    static char buffer[2048];
+    char jitter_text[512];
 
     sprintf(buffer, "Server info ...............: %s\n"
             "Server program name........: %s\n"
             "Server command line options: %s\n"
-            "Server compile time .......: " __DATE__ " " __TIME__ "\n", //
-            program_info, program_name, program_options);
+            "Server compile time .......: " __DATE__ " " __TIME__ "\n"
+            "Telemetrics ...............: %s\n"
+            "Lamp rows .................: %u written, %u already latched, %u dark\n", //
+            program_info, program_name, program_options,
+            rtsched_histogram_text(&gpio_mux_sched, jitter_text, sizeof(jitter_text)),
+            gpio_mux_rows_written, gpio_mux_rows_latched, gpio_mux_rows_dark);
 
     return buffer;
 }
@@ -250,6 +262,8 @@ static void threads_start()
         }
         printf("Created \"iopattern\" thread\n");
 
+    blinkenlight_api_metrics_mux_sched = &gpio_mux_sched;
+    blinkenlight_api_metrics_update_thread = &iopattern_thread;
 
     sleep(2); // allow 2 sec for multiplex to start
 }
@@ -263,10 +277,6 @@ void blinkenlight_api_server(void)
 {
     register SVCXPRT *transp;
 
-    // entry to server stub
-
-    void blinkenlightd_1(struct svc_req *rqstp, register SVCXPRT *transp);
-
     pmap_unset(BLINKENLIGHTD, BLINKENLIGHTD_VERS);
 
     transp = svcudp_create(RPC_ANYSOCK);
@@ -274,7 +284,8 @@ void blinkenlight_api_server(void)
         print(LOG_ERR, "%s", "cannot create udp service.");
         exit(1);
     }
-    if (!svc_register(transp, BLINKENLIGHTD, BLINKENLIGHTD_VERS, blinkenlightd_1, IPPROTO_UDP)) {
+    if (!svc_register(transp, BLINKENLIGHTD, BLINKENLIGHTD_VERS, blinkenlight_api_server_dispatch,
+            IPPROTO_UDP)) {
         print(LOG_ERR, "%s", "unable to register (BLINKENLIGHTD, BLINKENLIGHTD_VERS, udp).");
         exit(1);
     }
@@ -284,39 +295,19 @@ void blinkenlight_api_server(void)
         print(LOG_ERR, "%s", "cannot create tcp service.");
         exit(1);
     }
-    if (!svc_register(transp, BLINKENLIGHTD, BLINKENLIGHTD_VERS, blinkenlightd_1, IPPROTO_TCP)) {
+    if (!svc_register(transp, BLINKENLIGHTD, BLINKENLIGHTD_VERS, blinkenlight_api_server_dispatch,
+            IPPROTO_TCP)) {
         print(LOG_ERR, "%s", "unable to register (BLINKENLIGHTD, BLINKENLIGHTD_VERS, tcp).");
         exit(1);
     }
 
-    // svc_run();
-    // alternate implementation of svn_run() with periodically timeout and
-    // 	calling of callback
-    {
-        fd_set readfds;
-        struct timeval tv;
-        int dtbsz = getdtablesize();
-        for (;;) {
-            readfds = svc_fdset;
-            tv.tv_sec = 0;
-            tv.tv_usec = 1000 * 2; // every 10 ms*time_slice_ms;
-            switch (select(dtbsz, &readfds, NULL, NULL, &tv)) {
-            case -1:
-                if (errno == EINTR)
-                    continue;
-                perror("select");
-                return;
-            case 0: // timeout
-                    // provide the panel simulation with computing time
-                // not needed:RPC calls control value get/set callbacks
-                break;
-            default:
-                svc_getreqset(&readfds);
-                break;
-            }
-            /**/
-        }
-    }
+    // clients on the same host may exchange control values over shared memory
+    blinkenlight_api_server_shm_create();
+
+    // svc_run() replacement: serve RPC at once, periodic work on timers
+    if (blinkenlight_api_reactor_init() != 0)
+        exit(1);
+    blinkenlight_api_reactor_run();
 
     print(LOG_ERR, "%s", "svc_run returned");
     exit(1);
@@ -395,6 +386,17 @@ static void parse_commandline(int argc, char **argv)
             "Row frequency for lamp multiplexing. There are 3 rows.\n"
                     "!! For values != 1000 (1 kHz) the lamp protection watchdog will not work correctly !!",
             "10000", "multiplex with 10 kHz, every row is shown 3333x per second", NULL, NULL);
+    getopt_def(&getopt_parser, "mc", "mux_cpu", "cpu", NULL, NULL,
+            "run the multiplexing thread on this CPU only",
+            "1", "keep CPU 0 for the RPC server and the system", NULL, NULL);
+    getopt_def(&getopt_parser, "mw", "mux_spin", "us", NULL, "10",
+            "the multiplexing thread sleeps until shortly before the start\n"
+                    "of the next row, then busy waits the last <us> microseconds.",
+            "50", "compensate 50 us wake up latency", NULL, NULL);
+    getopt_def(&getopt_parser, "rw", "rpc_workers", "count", NULL, NULL,
+            "threads serving RPC requests of TCP clients in parallel.\n"
+                    "0 = serve all requests in the RPC thread. Default: CPU count - 1",
+            "0", "single core: no thread switches", NULL, NULL);
 
 /*    getopt_def(&getopt_parser, "sf", "switchmuxfrequency", "switchmuxfrequency", NULL, "15",
             "Row frequency for switch polling. Effective polling frequency is 1/3 of that.\n"
@@ -414,6 +416,17 @@ static void parse_commandline(int argc, char **argv)
         } else if (getopt_isoption(&getopt_parser, "muxfrequency")) {
             if (getopt_arg_i(&getopt_parser, "frequency", &opt_mux_frequency) < 0)
                 commandline_option_error();
+        } else if (getopt_isoption(&getopt_parser, "mux_cpu")) {
+            if (getopt_arg_i(&getopt_parser, "cpu", &rtsched_cpu) < 0)
+                commandline_option_error();
+        } else if (getopt_isoption(&getopt_parser, "mux_spin")) {
+            unsigned spin_us;
+            if (getopt_arg_u(&getopt_parser, "us", &spin_us) < 0)
+                commandline_option_error();
+            rtsched_spin_ns = 1000 * spin_us;
+        } else if (getopt_isoption(&getopt_parser, "rpc_workers")) {
+            if (getopt_arg_i(&getopt_parser, "count", &blinkenlight_api_reactor_workers) < 0)
+                commandline_option_error();
 /*
         } else if (getopt_isoption(&getopt_parser, "switchmuxfrequency")) {
             if (getopt_arg_i(&getopt_parser, "switchmuxfrequency", &opt_switch_mux_frequency) < 0)
@@ -37,6 +37,8 @@
 #include <unistd.h>
 #include <fcntl.h> // extra
 
+#include "rtsched.h"
+
 
 //#define BCM2708_PERI_BASE       0x3f000000
 //#define GPIO_BASE               (BCM2708_PERI_BASE + 0x200000)	// GPIO controller
@@ -53,6 +55,7 @@ struct bcm2835_peripheral {
 
 
 #ifndef _GPIO_C_
+extern rtsched_t blink_sched; // timing of LED mux phases
 //extern volatile unsigned int gpio_switchstatus[3] ; // bitfields: 3 rows of up to 12 switches
 //extern volatile unsigned int gpio_ledstatus[8] ;	// bitfields: 8 ledrows of up to 12 LEDs
 #endif
@@ -20,6 +20,7 @@
  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+ 17-Oct-2026  agent phase values of a control by bit plane transposition
  05-Jul-2017  MH    added a variable for GPIOPATTERN_UPDATE_PERIOD_US
  08-May-2016  JH    fix: MMR0 converted code -> led pattern BEFORE history/low pass
  01-Apr-2016  OV    almost perfect before VCF SE
@@ -474,6 +475,46 @@ mask = 0 ;
     }
 }
 
+#if GPIOPATTERN_LED_BRIGHTNESS_PHASES > 32
+#error "brightness_phase_masks[] hold max 32 phases"
+#endif
+// brightness_phase_lookup[level][] as bit mask: bit <phase> set, if LED is ON in phase
+static uint32_t brightness_phase_masks[GPIOPATTERN_LED_BRIGHTNESS_LEVELS];
+
+static void brightness_phase_masks_init(void)
+{
+	unsigned level, phase;
+	for (level = 0; level < GPIOPATTERN_LED_BRIGHTNESS_LEVELS; level++) {
+		brightness_phase_masks[level] = 0;
+		for (phase = 0; phase < GPIOPATTERN_LED_BRIGHTNESS_PHASES; phase++)
+			if (brightness_phase_lookup[level][phase])
+				brightness_phase_masks[level] |= (uint32_t) 1 << phase;
+	}
+}
+
+/*
+ * control value for every display phase, from the low-passed bits.
+ * Each value bit gives a row of ON phases for its brightness,
+ * transposing the bit matrix gives a row of value bits for each phase.
+ */
+static void gpiopattern_phase_values(blinkenlight_control_t *c,
+		uint32_t phase_values[32])
+{
+	unsigned bitidx;
+	for (bitidx = 0; bitidx < 32; bitidx++) {
+		unsigned bit_brightness;
+		if (bitidx >= c->value_bitlen) {
+			phase_values[bitidx] = 0;
+			continue;
+		}
+		bit_brightness = ((unsigned) (c->averaged_value_bits[bitidx])
+				* (GPIOPATTERN_LED_BRIGHTNESS_LEVELS)) / 256; // from 0.. 255 to
+		assert(bit_brightness < GPIOPATTERN_LED_BRIGHTNESS_LEVELS);
+		phase_values[bitidx] = brightness_phase_masks[bit_brightness];
+	}
+	transpose_bits32(phase_values); // now phase_values[phase] = value bits
+}
+
 /*
  * - averages the Blinkenlight API outputs,
  * - generates the LED brightness patterns
@@ -487,6 +528,7 @@ mask = 0 ;
  */
 void *gpiopattern_update_leds(int *terminate)
 {
+	brightness_phase_masks_init();
 
 	while (*terminate == 0) {
 		blinkenlight_panel_t *p = gpiopattern_blinkenlight_panel; // short alias
@@ -506,7 +548,7 @@ void *gpiopattern_update_leds(int *terminate)
 		// else flicker by co-running gpio_mux may occur.
 		for (i = 0; i < p->controls_count; i++) {
 			blinkenlight_control_t *c = &p->controls[i];
-			unsigned bitidx;
+			uint32_t phase_values[32];
 			unsigned phase;
 			if (c->is_input)
 				continue;
@@ -525,26 +567,13 @@ void *gpiopattern_update_leds(int *terminate)
 			 */
 
 			// build the display value from the low-passed bits.
-			// for all display phases :
+			// all display phases at once
+			gpiopattern_phase_values(c, phase_values);
 			for (phase = 0; phase < GPIOPATTERN_LED_BRIGHTNESS_PHASES; phase++) {
-				unsigned value;
-
 				// mount phase value
 				volatile uint32_t *gpio_ledstatus = // alias
 						gpiopattern_ledstatus_phases[gpiopattern_ledstatus_phases_writeidx][phase];
-				value = 0;
-				// for all bits :
-				for (bitidx = 0; bitidx < c->value_bitlen; bitidx++) {
-					// mount phase bit
-					unsigned bit_brightness = ((unsigned) (c->averaged_value_bits[bitidx])
-							* (GPIOPATTERN_LED_BRIGHTNESS_LEVELS)) / 256; // from 0.. 255 to
-
-					assert(bit_brightness < GPIOPATTERN_LED_BRIGHTNESS_LEVELS);
-					if (brightness_phase_lookup[bit_brightness][phase])
-						value |= 1 << bitidx;
-
-				}
-				value2gpio_ledstatus_value(p, c, value, gpio_ledstatus); // fill in to gpio
+				value2gpio_ledstatus_value(p, c, phase_values[phase], gpio_ledstatus); // fill in to gpio
 			}
 		}
 
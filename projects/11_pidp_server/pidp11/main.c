@@ -22,6 +22,10 @@
 
 
  27-Dec-2018  SC/MH OV: added MH fix occasional blinking LEDs (LAMPTEST in the gpiopattern thread)
+ 17-Oct-2026  agent runtime metrics over RPC_PARAM_CLASS_BUS
+ 17-Oct-2026  agent options -c, -w for LED mux timing, jitter in get_info
+ 17-Oct-2026  agent shared memory image for clients on the same host
+ 17-Oct-2026  agent answer input change subscriptions in main loop
  03-Feb-2018  JH    fixed SUPER-USER-KERNEL encoding
  07-Sep-2017  MH    Added further command line option (-L)
  05-Jul-2017  MH    Added more options to the command line (-h -a -d -s)
@@ -63,6 +67,7 @@
 
 #include "blinkenlight_panels.h"
 #include "blinkenlight_api_server_procs.h"
+#include "blinkenlight_api_server_reactor.h"
 
 ///// for Blinkenlight API server
 #include "rpc_blinkenlight_api.h"
@@ -77,6 +82,7 @@
 #include "main.h"
 #include "gpio.h"
 #include "gpiopattern.h"
+#include "rtsched.h"
 
 char program_info[1024];
 char program_name[1024]; // argv[0]
@@ -272,13 +278,16 @@ static void on_blinkenlight_api_panel_set_mode(blinkenlight_panel_t *p, int new_
 
 static char *on_blinkenlight_api_get_info()
 {
-    static char buffer[1024];
+    static char buffer[2048];
+    char jitter_text[512];
 
     sprintf(buffer, "Server info ...............: %s\n"
             "Server program name........: %s\n"
             "Server command line options: %s\n"
-            "Server compile time .......: " __DATE__ " " __TIME__ "\n", //
-            program_info, program_name, program_options);
+            "Server compile time .......: " __DATE__ " " __TIME__ "\n"
+            "Telemetrics  : %s\n", //
+            program_info, program_name, program_options,
+            rtsched_histogram_text(&blink_sched, jitter_text, sizeof(jitter_text)));
 
     return buffer;
 }
@@ -304,6 +313,7 @@ static void gpio_mux_thread_start()
         exit(EXIT_FAILURE);
     }
 //    printf("Created \"gpio_mux\" thread\n");
+    blinkenlight_api_metrics_mux_sched = &blink_sched;
 
     sleep(2); // allow 2 sec for multiplex to start
 }
@@ -320,6 +330,7 @@ static void gpiopattern_start_thread()
         exit(EXIT_FAILURE);
     }
     //printf("Created \"gpiopattern_update_leds\" thread\n");
+    blinkenlight_api_metrics_update_thread = &gpiopattern_thread;
 }
 
 /******************************************************
@@ -331,10 +342,6 @@ void blinkenlight_api_server(void)
 {
     register SVCXPRT *transp;
 
-// entry to server stub
-
-    void blinkenlightd_1(struct svc_req *rqstp, register SVCXPRT *transp);
-
     pmap_unset(BLINKENLIGHTD, BLINKENLIGHTD_VERS);
 
     transp = svcudp_create(RPC_ANYSOCK);
@@ -342,7 +349,8 @@ void blinkenlight_api_server(void)
         print(LOG_ERR, "%s", "cannot create udp service.");
         exit(1);
     }
-    if (!svc_register(transp, BLINKENLIGHTD, BLINKENLIGHTD_VERS, blinkenlightd_1, IPPROTO_UDP)) {
+    if (!svc_register(transp, BLINKENLIGHTD, BLINKENLIGHTD_VERS, blinkenlight_api_server_dispatch,
+            IPPROTO_UDP)) {
         print(LOG_ERR, "%s", "unable to register (BLINKENLIGHTD, BLINKENLIGHTD_VERS, udp).");
         exit(1);
     }
@@ -352,39 +360,19 @@ void blinkenlight_api_server(void)
         print(LOG_ERR, "%s", "cannot create tcp service.");
         exit(1);
     }
-    if (!svc_register(transp, BLINKENLIGHTD, BLINKENLIGHTD_VERS, blinkenlightd_1, IPPROTO_TCP)) {
+    if (!svc_register(transp, BLINKENLIGHTD, BLINKENLIGHTD_VERS, blinkenlight_api_server_dispatch,
+            IPPROTO_TCP)) {
         print(LOG_ERR, "%s", "unable to register (BLINKENLIGHTD, BLINKENLIGHTD_VERS, tcp).");
         exit(1);
     }
 
-    // svc_run();
-    // alternate implementation of svn_run() with periodically timeout and
-    // 	calling of callback
-    {
-        fd_set readfds;
-        struct timeval tv;
-        int dtbsz = getdtablesize();
-        for (;;) {
-            readfds = svc_fdset;
-            tv.tv_sec = 0;
-            tv.tv_usec = 1000 * 2; // every 10 ms*time_slice_ms;
-            switch (select(dtbsz, &readfds, NULL, NULL, &tv)) {
-            case -1:
-                if (errno == EINTR)
-                    continue;
-                perror("select");
-                return;
-            case 0: // timeout
-                    // provide the panel simulation with computing time
-                // not needed:RPC calls control value get/set callbacks
-                break;
-            default:
-                svc_getreqset(&readfds);
-                break;
-            }
-            /**/
-        }
-    }
+    // clients on the same host may exchange control values over shared memory
+    blinkenlight_api_server_shm_create();
+
+    // svc_run() replacement: serve RPC at once, periodic work on timers
+    if (blinkenlight_api_reactor_init() != 0)
+        exit(1);
+    blinkenlight_api_reactor_run();
 
     print(LOG_ERR, "%s", "svc_run returned");
     exit(1);
@@ -416,6 +404,7 @@ static void help(void)
     fprintf(stderr, "\n");
     fprintf(stderr, "Usage:\n");
     fprintf(stderr, "  pidp11_blinkenlightd [-h] [-b] [-v] [-t] [-L] [-a 0..7] [-d 0..3] [-s <n>]\n");
+    fprintf(stderr, "                        [-c <cpu>] [-w <us>]\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "  -h          display this help and exit\n");
 //  fprintf(stderr, "  - <port>    TCP port for RCP access.\n");
@@ -433,6 +422,9 @@ static void help(void)
     fprintf(stderr, "                default is -d%d\n", knobValue[0]);
     fprintf(stderr, "  -s <n>      refresh value for panel updates: use with caution\n");
     fprintf(stderr, "                default is -s%ld\n", gpiopattern_update_period_us);
+    fprintf(stderr, "  -c <cpu>    run LED multiplexing on this CPU only\n");
+    fprintf(stderr, "  -w <us>     LED multiplexing busy waits the last <us> of each phase\n");
+    fprintf(stderr, "                default is -w%u\n", RTSCHED_DEFAULT_SPIN_NS / 1000);
     fprintf(stderr, "\n");
 }
 
@@ -455,7 +447,7 @@ static int parse_commandline(int argc, char **argv)
 
     opterr = 0;
 
-    while ((c = getopt(argc, argv, "hbvtLa:d:s:")) != -1)
+    while ((c = getopt(argc, argv, "hbvtLa:d:s:c:w:")) != -1)
         switch (c) {
         case 'h':
             help();
@@ -472,6 +464,12 @@ static int parse_commandline(int argc, char **argv)
         case 'L':
             panel_lock = 1;
             break;
+        case 'c':
+            rtsched_cpu = atoi(optarg);
+            break;
+        case 'w':
+            rtsched_spin_ns = 1000 * atoi(optarg);
+            break;
         case 'a':
             knobValue[0] = *optarg & 0x7;
             break;
@@ -20,6 +20,7 @@
  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+ 17-Oct-2026  agent LED rows and switch scan on absolute deadlines (rtsched.c)
  15-Mar-2016  JH	display patterns for brightness levels
  16-Nov-2015  JH    acquired from Oscar
 
@@ -54,6 +55,10 @@ static unsigned get_dt_ranges(const char *filename, unsigned offset); // Pi 2 de
 
 struct bcm2835_peripheral gpio; // needs initialisation
 
+// every LED row is lit for one phase, switch scanning is another phase
+rtsched_t blink_sched;
+#define LEDROW_PAUSE_NS	10000	// all rows off, may help against udn2981 ghosting
+
 // long intervl = 300000; // light each row of leds this long
 //long intervl = 25000; // light each row of leds 25 us, if 64 bit pattern
 long intervl = 50000; // light each row of leds 50 us, almost flickerfree at 32 phases
@@ -193,6 +198,8 @@ void *blink(int *terminate)
 
 	printf("\nFP on\n");
 
+	rtsched_init(&blink_sched, "LED mux");
+
 
 	while (*terminate == 0) {
 		unsigned phase;
@@ -224,24 +231,25 @@ void *blink(int *terminate)
 						GPIO_CLR = 1 << cols[k];
 				}
 
-				// Toggle this ledrow on
+				// Toggle this ledrow on, exactly at start of its phase
+				rtsched_phase(&blink_sched, intervl + LEDROW_PAUSE_NS);
 				INP_GPIO(ledrows[i]);
 				GPIO_SET = 1 << ledrows[i]; // test for flash problem
 				OUT_GPIO(ledrows[i]);
 				/*test* /			GPIO_SET = 1 << ledrows[i]; /**/
 
-				nanosleep((struct timespec[]
-				) {	{	0, intervl}}, NULL);
+				rtsched_sleep_until(&blink_sched, blink_sched.phase_start_ns + intervl);
 
 				// Toggle ledrow off
 				GPIO_CLR = 1 << ledrows[i]; // superstition
 				INP_GPIO(ledrows[i]);
-				usleep(10); // waste of cpu cycles but may help against udn2981 ghosting, not flashes though
+				// rest of phase: pause against ghosting
 			}
 
 //nanosleep ((struct timespec[]){{0, intervl}}, NULL); // test
 
 			// prepare for reading switches
+			rtsched_phase(&blink_sched, intervl / 5);
 			for (i = 0; i < 12; i++)
 				INP_GPIO(cols[i]); // flip columns to input. Need internal pull-ups enabled.
 
@@ -251,10 +259,7 @@ void *blink(int *terminate)
 				OUT_GPIO(rows[i]); // turn on one switch row
 				GPIO_CLR = 1 << rows[i]; // and output 0V to overrule built-in pull-up from column input pin
 
-				nanosleep((struct timespec[]
-				)
-				{
-					{	0, intervl / 100}}, NULL); // probably unnecessary long wait, maybe put above this loop also
+				rtsched_delay(&blink_sched, intervl / 100); // probably unnecessary long wait, maybe put above this loop also
 
 				switchscan = 0;
 				for (j = 0; j < 12; j++) // 12 switches in each row